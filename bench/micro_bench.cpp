@@ -0,0 +1,619 @@
+/* File:            micro_bench.cpp
+ * Author:          Vish Potnis
+ * Description:     - Google Benchmark microbenchmarks for the per frame kernels
+ *                  - Every benchmark processes a batch of inputs per iteration and reports items per second
+ *                  - Replacement kernels should be added next to the baseline they replace
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AsteroidGame.h"
+#include "CVector.h"
+#include "GameObject.h"
+#include "GameObjectAsteroid.h"
+#include "CExplosionSystem.h"
+#include "CParticleSystem.h"
+#include "CSoftCompositor.h"
+#include "CFrameCapture.h"
+#include "SimBatch.h"
+#include "SimState.h"
+#include "CRollbackRing.h"
+#include "CAsteroidPhysics.h"
+#include "CPerfCounters.h"
+
+namespace
+{
+    // batch sizes used by every benchmark
+    constexpr int BATCH_MIN{64};
+    constexpr int BATCH_MAX{4096};
+
+    // fixed seed so every run benchmarks the same inputs
+    std::mt19937 makeRng() { return std::mt19937(1234);}
+
+    // random polar inputs in the ranges used by the game (velocities and angles in degrees)
+    struct PolarInput
+    {
+        double mag;
+        double angle;
+    };
+
+    std::vector<PolarInput> makePolarInputs(int count)
+    {
+        std::mt19937 rng = makeRng();
+        std::uniform_real_distribution<double> randomMag(0, AsteroidConstants::LASER_VELOCITY);
+        std::uniform_real_distribution<double> randomAngle(-180, 180);
+
+        std::vector<PolarInput> inputs(count);
+        for(auto& input : inputs){
+            input = PolarInput{randomMag(rng), randomAngle(rng)};
+        }
+        return inputs;
+    }
+
+    // asteroid positions for each world wrap case of calculateRenderRectangles
+    enum class WrapCase
+    {
+        NONE,
+        LEFT,
+        RIGHT,
+        TOP,
+        BOTTOM,
+        TOP_LEFT,
+        TOP_RIGHT,
+        BOTTOM_LEFT,
+        BOTTOM_RIGHT,
+        WRAP_TOTAL
+    };
+
+    constexpr int ASTEROID_SIZE{100};
+
+    Point getWrapPosition(WrapCase wrapCase)
+    {
+        const double w = AsteroidConstants::WORLD_WIDTH;
+        const double h = AsteroidConstants::WORLD_HEIGHT;
+        const double edge = ASTEROID_SIZE/4;
+
+        switch(wrapCase){
+            case WrapCase::NONE:            return Point{w/2, h/2};
+            case WrapCase::LEFT:            return Point{edge, h/2};
+            case WrapCase::RIGHT:           return Point{w - edge, h/2};
+            case WrapCase::TOP:             return Point{w/2, edge};
+            case WrapCase::BOTTOM:          return Point{w/2, h - edge};
+            case WrapCase::TOP_LEFT:        return Point{edge, edge};
+            case WrapCase::TOP_RIGHT:       return Point{w - edge, edge};
+            case WrapCase::BOTTOM_LEFT:     return Point{edge, h - edge};
+            case WrapCase::BOTTOM_RIGHT:    return Point{w - edge, h - edge};
+            default:                        return Point{w/2, h/2};
+        }
+    }
+
+    const char* getWrapName(WrapCase wrapCase)
+    {
+        switch(wrapCase){
+            case WrapCase::NONE:            return "none";
+            case WrapCase::LEFT:            return "left";
+            case WrapCase::RIGHT:           return "right";
+            case WrapCase::TOP:             return "top";
+            case WrapCase::BOTTOM:          return "bottom";
+            case WrapCase::TOP_LEFT:        return "top_left";
+            case WrapCase::TOP_RIGHT:       return "top_right";
+            case WrapCase::BOTTOM_LEFT:     return "bottom_left";
+            case WrapCase::BOTTOM_RIGHT:    return "bottom_right";
+            default:                        return "";
+        }
+    }
+
+    // bursts of every asteroid size at random world positions until count particles are live
+    void fillParticles(CParticleSystem& particles, int count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<double> randomX(0, AsteroidConstants::WORLD_WIDTH);
+        std::uniform_real_distribution<double> randomY(0, AsteroidConstants::WORLD_HEIGHT);
+        const int bursts[] = {AsteroidConstants::PARTICLE_BURST_BIG, AsteroidConstants::PARTICLE_BURST_MED, AsteroidConstants::PARTICLE_BURST_SMALL};
+
+        for(int i = 0; particles.getCount() < count; i++){
+            int burst = std::min(bursts[i % 3], count - particles.getCount());
+            particles.emitBurst(Point{randomX(rng), randomY(rng)}, burst, AsteroidConstants::PARTICLE_SPEED, 0, 0, SDL_Color{200, 200, 200, 255});
+        }
+    }
+
+    // premultiplied ARGB pixels, a third each opaque, transparent and translucent like sprite edges
+    std::vector<Uint32> makePremultipliedRow(int count, std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> randomByte(0, 255);
+        std::vector<Uint32> row(count);
+        for(int i = 0; i < count; i++){
+            Uint32 a = (i % 3 == 0) ? 255 : (i % 3 == 1) ? 0 : randomByte(rng);
+            Uint32 r = randomByte(rng) * a / 255;
+            Uint32 g = randomByte(rng) * a / 255;
+            Uint32 b = randomByte(rng) * a / 255;
+            row[i] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+        return row;
+    }
+
+    const char* getKernelName(BlendKernel kernel)
+    {
+        switch(kernel){
+            case BlendKernel::SCALAR:       return "scalar";
+            case BlendKernel::SSE2:         return "sse2";
+            case BlendKernel::AVX2:         return "avx2";
+            default:                        return "";
+        }
+    }
+
+    const char* getTypeName(ObjectType type)
+    {
+        switch(type){
+            case ObjectType::STATIC:        return "static";
+            case ObjectType::ASTEROID:      return "asteroid";
+            case ObjectType::SHIP:          return "ship";
+            case ObjectType::LASER:         return "laser";
+            default:                        return "";
+        }
+    }
+
+    // hardware counters of the benchmark thread, opened on first use, benchmarks run without them when they are unavailable
+    CPerfCounters& getPerfCounters()
+    {
+        static CPerfCounters counters;
+        static bool opened = counters.open();
+        (void)opened;
+        return counters;
+    }
+
+    // counters per item since start, read right before the timed loop
+    void reportPerfCounters(benchmark::State& state, const PerfValues& start, std::int64_t items)
+    {
+        CPerfCounters& counters = getPerfCounters();
+        if(!counters.isOpen() || items <= 0) return;
+
+        PerfValues delta = counters.read() - start;
+        for(int i = 0; i < static_cast<int>(PerfCounter::PERF_COUNTER_TOTAL); i++){
+            PerfCounter counter = static_cast<PerfCounter>(i);
+            if(!counters.isAvailable(counter)) continue;
+            state.counters[std::string(CPerfCounters::getName(counter)) + "/item"] = static_cast<double>(delta.get(counter)) / items;
+        }
+        if(counters.isAvailable(PerfCounter::CYCLES) && counters.isAvailable(PerfCounter::INSTRUCTIONS) && delta.get(PerfCounter::CYCLES) > 0){
+            state.counters["IPC"] = static_cast<double>(delta.get(PerfCounter::INSTRUCTIONS)) / delta.get(PerfCounter::CYCLES);
+        }
+    }
+}
+
+
+///// CVector /////
+
+static void BM_CVectorPolar(benchmark::State& state)
+{
+    const int count = state.range(0);
+    std::vector<PolarInput> inputs = makePolarInputs(count);
+
+    for(auto _ : state){
+        for(const auto& input : inputs){
+            CVector vec{input.mag, input.angle, VectorType::POLAR};
+            benchmark::DoNotOptimize(vec);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CVectorPolar)->RangeMultiplier(4)->Range(BATCH_MIN, BATCH_MAX);
+
+static void BM_CVectorXY(benchmark::State& state)
+{
+    const int count = state.range(0);
+    std::vector<PolarInput> inputs = makePolarInputs(count);
+
+    for(auto _ : state){
+        for(const auto& input : inputs){
+            CVector vec{input.mag, input.angle, VectorType::XY};
+            benchmark::DoNotOptimize(vec);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CVectorXY)->RangeMultiplier(4)->Range(BATCH_MIN, BATCH_MAX);
+
+static void BM_CVectorAdd(benchmark::State& state)
+{
+    const int count = state.range(0);
+    std::vector<PolarInput> inputs = makePolarInputs(count);
+
+    std::vector<CVector> vectors;
+    vectors.reserve(count);
+    for(const auto& input : inputs){
+        vectors.emplace_back(input.mag, input.angle, VectorType::POLAR);
+    }
+
+    // ship thrust: accumulate every vector onto a running velocity
+    for(auto _ : state){
+        CVector sum;
+        for(const auto& vec : vectors){
+            sum = sum + vec;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CVectorAdd)->RangeMultiplier(4)->Range(BATCH_MIN, BATCH_MAX);
+
+
+///// GameObjectAsteroid /////
+
+// range(0) is the WrapCase, range(1) the batch size
+static void BM_CalculateRenderRectangles(benchmark::State& state)
+{
+    const WrapCase wrapCase = static_cast<WrapCase>(state.range(0));
+    const int count = state.range(1);
+    const Point pos = getWrapPosition(wrapCase);
+
+    std::vector<SDL_Rect> srcRects;
+    std::vector<SDL_Rect> dstRects;
+    srcRects.reserve(4);
+    dstRects.reserve(4);
+
+    PerfValues perfStart = getPerfCounters().read();
+    for(auto _ : state){
+        for(int i = 0; i < count; i++){
+            srcRects.clear();
+            dstRects.clear();
+            GameObjectAsteroid::calculateRenderRectangles(pos.x, pos.y, ASTEROID_SIZE, ASTEROID_SIZE,
+                                                          AsteroidConstants::WORLD_WIDTH, AsteroidConstants::WORLD_HEIGHT, srcRects, dstRects);
+            benchmark::DoNotOptimize(dstRects.data());
+        }
+        benchmark::ClobberMemory();
+    }
+    reportPerfCounters(state, perfStart, state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetLabel(getWrapName(wrapCase));
+}
+BENCHMARK(BM_CalculateRenderRectangles)
+    ->ArgsProduct({benchmark::CreateDenseRange(0, static_cast<int>(WrapCase::WRAP_TOTAL) - 1, 1), {BATCH_MIN, BATCH_MAX}});
+
+static void BM_GetAsteroidTexture(benchmark::State& state)
+{
+    const int count = state.range(0);
+
+    std::mt19937 rng = makeRng();
+    std::uniform_int_distribution<int> randomAttr(0, 2);
+    std::vector<std::pair<AsteroidSize, AsteroidColor>> inputs(count);
+    for(auto& input : inputs){
+        input = {static_cast<AsteroidSize>(randomAttr(rng)), static_cast<AsteroidColor>(randomAttr(rng))};
+    }
+
+    for(auto _ : state){
+        for(const auto& input : inputs){
+            benchmark::DoNotOptimize(GameObjectAsteroid::getAsteroidTexture(input.first, input.second));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GetAsteroidTexture)->RangeMultiplier(4)->Range(BATCH_MIN, BATCH_MAX);
+
+
+///// AsteroidGame /////
+
+// range(0) is the number of rect pairs, about a quarter of them overlap
+static void BM_CheckCollision(benchmark::State& state)
+{
+    const int count = state.range(0);
+
+    std::mt19937 rng = makeRng();
+    std::uniform_int_distribution<int> randomX(0, AsteroidConstants::SCREEN_WIDTH);
+    std::uniform_int_distribution<int> randomY(0, AsteroidConstants::SCREEN_HEIGHT);
+    std::uniform_int_distribution<int> randomSize(5, 200);
+
+    std::vector<SDL_Rect> a(count);
+    std::vector<SDL_Rect> b(count);
+    for(int i = 0; i < count; i++){
+        a[i] = SDL_Rect{randomX(rng), randomY(rng), randomSize(rng), randomSize(rng)};
+        b[i] = SDL_Rect{randomX(rng), randomY(rng), randomSize(rng), randomSize(rng)};
+    }
+
+    PerfValues perfStart = getPerfCounters().read();
+    for(auto _ : state){
+        int hits = 0;
+        for(int i = 0; i < count; i++){
+            hits += AsteroidGame::checkCollision(a[i], b[i]);
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    reportPerfCounters(state, perfStart, state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CheckCollision)->RangeMultiplier(4)->Range(BATCH_MIN, BATCH_MAX);
+
+
+///// GameObject /////
+
+// range(0) is the ObjectType, range(1) the batch size
+// textures are not loaded so only the allocation and construction cost is measured
+static void BM_GameObjectCreate(benchmark::State& state)
+{
+    const ObjectType type = static_cast<ObjectType>(state.range(0));
+    const int count = state.range(1);
+
+    CTexture tex;
+    std::vector<std::unique_ptr<GameObject>> objects;
+    objects.reserve(count);
+
+    for(auto _ : state){
+        for(int i = 0; i < count; i++){
+            objects.push_back(GameObject::Create(type, Point{100, 100}, tex, CVector{100, 45, VectorType::POLAR}));
+        }
+        benchmark::DoNotOptimize(objects.data());
+
+        // destroying the batch is part of the object lifetime cost
+        objects.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetLabel(getTypeName(type));
+}
+BENCHMARK(BM_GameObjectCreate)
+    ->ArgsProduct({{static_cast<int>(ObjectType::ASTEROID), static_cast<int>(ObjectType::LASER)},
+                   {BATCH_MIN, BATCH_MAX}});
+
+
+///// CExplosionSystem /////
+
+// range(0) is the batch size
+// explosions replaced the explosion game objects, a batch is spawned and removed by the update after its animation
+static void BM_ExplosionSystemLifetime(benchmark::State& state)
+{
+    const int count = state.range(0);
+    CExplosionSystem explosions(count);
+    const Uint32 end = CExplosionSystem::getAnimationDuration();
+
+    for(auto _ : state){
+        for(int i = 0; i < count; i++){
+            explosions.spawn(Point{100.0 + i, 100}, static_cast<AsteroidSize>(i % 3), 0);
+        }
+        explosions.update(end);
+        benchmark::DoNotOptimize(explosions.getCount());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ExplosionSystemLifetime)->Arg(AsteroidConstants::EXPLOSION_MAX)->Arg(BATCH_MAX);
+
+
+///// CParticleSystem /////
+
+// range(0) is the number of live particles, up to PARTICLE_MAX
+// every iteration is one 60 fps frame: particles are integrated and the expired ones are emitted again so the count stays the same
+static void BM_ParticleSystemUpdate(benchmark::State& state)
+{
+    const int count = state.range(0);
+    CParticleSystem particles(count);
+    std::mt19937 rng = makeRng();
+    fillParticles(particles, count, rng);
+
+    Uint32 time = particles.getLastUpdated();
+    PerfValues perfStart = getPerfCounters().read();
+    for(auto _ : state){
+        time += AsteroidConstants::TICKS_PER_FRAME;
+        particles.update(time);
+        fillParticles(particles, count, rng);
+        benchmark::DoNotOptimize(particles.getCount());
+    }
+    reportPerfCounters(state, perfStart, state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ParticleSystemUpdate)->RangeMultiplier(10)->Range(1000, AsteroidConstants::PARTICLE_MAX);
+
+// range(0) is the number of live particles spread over the world
+// every iteration culls them against a screen sized view, builds the quads of the visible ones and submits them in one geometry call
+// the software renderer also rasterizes the quads, items are live particles
+static void BM_ParticleSystemRender(benchmark::State& state)
+{
+    const int count = state.range(0);
+    CParticleSystem particles(count);
+    std::mt19937 rng = makeRng();
+    fillParticles(particles, count, rng);
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, AsteroidConstants::SCREEN_WIDTH, AsteroidConstants::SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = surface != nullptr ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if(renderer == nullptr){
+        state.SkipWithError("software renderer not available");
+        SDL_FreeSurface(surface);
+        return;
+    }
+
+    CCamera camera(AsteroidConstants::SCREEN_WIDTH, AsteroidConstants::SCREEN_HEIGHT, AsteroidConstants::WORLD_WIDTH, AsteroidConstants::WORLD_HEIGHT);
+    camera.follow(Point{AsteroidConstants::WORLD_WIDTH / 2.0, AsteroidConstants::WORLD_HEIGHT / 2.0});
+
+    PerfValues perfStart = getPerfCounters().read();
+    for(auto _ : state){
+        particles.render(*renderer, camera);
+    }
+    reportPerfCounters(state, perfStart, state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * count);
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+}
+BENCHMARK(BM_ParticleSystemRender)->RangeMultiplier(10)->Range(1000, AsteroidConstants::PARTICLE_MAX);
+
+
+///// CSoftCompositor /////
+
+// range(0) is the BlendKernel, every kernel blends the same 1024 pixel source row over the same destination row
+// kernels not compiled in or not supported by the CPU are skipped, items are pixels
+static void BM_BlendRow(benchmark::State& state)
+{
+    constexpr int ROW_PIXELS{1024};
+    const BlendKernel kernel = static_cast<BlendKernel>(state.range(0));
+    state.SetLabel(getKernelName(kernel));
+
+    CSoftCompositor::BlendRowFn blendRow = CSoftCompositor::getBlendKernel(kernel);
+    if(blendRow == nullptr){
+        state.SkipWithError("kernel not available on this CPU");
+        return;
+    }
+
+    std::mt19937 rng = makeRng();
+    std::vector<Uint32> src = makePremultipliedRow(ROW_PIXELS, rng);
+    std::vector<Uint32> dst = makePremultipliedRow(ROW_PIXELS, rng);
+
+    PerfValues perfStart = getPerfCounters().read();
+    for(auto _ : state){
+        blendRow(dst.data(), src.data(), ROW_PIXELS);
+        benchmark::ClobberMemory();
+    }
+    reportPerfCounters(state, perfStart, state.iterations() * ROW_PIXELS);
+    state.SetItemsProcessed(state.iterations() * ROW_PIXELS);
+}
+BENCHMARK(BM_BlendRow)->DenseRange(0, static_cast<int>(BlendKernel::BLEND_KERNEL_TOTAL) - 1);
+
+
+///// CFrameCapture /////
+
+// whole SCREEN_WIDTH x SCREEN_HEIGHT frame to RGBA bytes as the raw capture writes it, items are pixels
+static void BM_CaptureConvertRgba(benchmark::State& state)
+{
+    constexpr int PIXELS{AsteroidConstants::SCREEN_WIDTH * AsteroidConstants::SCREEN_HEIGHT};
+    std::mt19937 rng = makeRng();
+    std::vector<Uint32> frame = makePremultipliedRow(PIXELS, rng);
+    std::vector<Uint8> converted(PIXELS * 4);
+
+    PerfValues perfStart = getPerfCounters().read();
+    for(auto _ : state){
+        CFrameCapture::convertRgba(frame.data(), converted.data(), PIXELS);
+        benchmark::ClobberMemory();
+    }
+    reportPerfCounters(state, perfStart, state.iterations() * PIXELS);
+    state.SetItemsProcessed(state.iterations() * PIXELS);
+}
+BENCHMARK(BM_CaptureConvertRgba);
+
+// luma plane of a SCREEN_WIDTH x SCREEN_HEIGHT frame row by row as the Y4M capture writes it, items are pixels
+static void BM_CaptureConvertLuma(benchmark::State& state)
+{
+    constexpr int PIXELS{AsteroidConstants::SCREEN_WIDTH * AsteroidConstants::SCREEN_HEIGHT};
+    std::mt19937 rng = makeRng();
+    std::vector<Uint32> frame = makePremultipliedRow(PIXELS, rng);
+    std::vector<Uint8> luma(PIXELS);
+
+    PerfValues perfStart = getPerfCounters().read();
+    for(auto _ : state){
+        for(int y = 0; y < AsteroidConstants::SCREEN_HEIGHT; y++){
+            CFrameCapture::convertLuma(frame.data() + y*AsteroidConstants::SCREEN_WIDTH, luma.data() + y*AsteroidConstants::SCREEN_WIDTH,
+                                       AsteroidConstants::SCREEN_WIDTH);
+        }
+        benchmark::ClobberMemory();
+    }
+    reportPerfCounters(state, perfStart, state.iterations() * PIXELS);
+    state.SetItemsProcessed(state.iterations() * PIXELS);
+}
+BENCHMARK(BM_CaptureConvertLuma);
+
+
+///// SimBatch /////
+
+// range(0) is the number of worlds, range(1) the number of threads
+// worlds are stepped with random controls and restarted when done, items are world steps
+static void BM_SimBatchStep(benchmark::State& state)
+{
+    const int numWorlds = state.range(0);
+    const int numThreads = state.range(1);
+
+    SimBatch batch(numWorlds, numThreads, 1234);
+
+    std::mt19937 rng = makeRng();
+    std::uniform_int_distribution<int> randomFlag(0, 1);
+    std::vector<SimControls> controls(numWorlds);
+    for(auto& control : controls){
+        control = SimControls{static_cast<Uint8>(randomFlag(rng)), static_cast<Uint8>(randomFlag(rng)), static_cast<Uint8>(randomFlag(rng)), 0,
+                              static_cast<Uint8>(randomFlag(rng))};
+    }
+
+    for(auto _ : state){
+        batch.step(controls.data());
+        batch.resetDone();
+    }
+    state.SetItemsProcessed(state.iterations() * numWorlds);
+}
+BENCHMARK(BM_SimBatchStep)->ArgsProduct({{64, 1024}, {1, 4}})->UseRealTime();
+
+
+///// SimState /////
+
+// range(0) is the level the world is at, the asteroid count grows with the level
+// items are save/restore round trips of the complete world state into a rollback ring
+static void BM_SimStateSaveLoad(benchmark::State& state)
+{
+    SimWorld world(1234);
+    world.reset(state.range(0));
+
+    CRollbackRing<SimState> ring(AsteroidConstants::REWIND_FRAMES);
+    std::uint32_t frame = 0;
+
+    PerfValues perfStart = getPerfCounters().read();
+    for(auto _ : state){
+        world.saveState(ring.record(frame));
+        world.loadState(*ring.find(frame));
+        frame++;
+    }
+    reportPerfCounters(state, perfStart, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(std::to_string(world.getAsteroids().size()) + " asteroids");
+}
+BENCHMARK(BM_SimStateSaveLoad)->Arg(1)->Arg(10)->Arg(40);
+
+
+///// CAsteroidPhysics /////
+
+// range(0) is the number of asteroids, range(1) the share of the world covered by them in percent
+// mostly small asteroids with some medium and big ones, moving at level speeds in random directions
+// items are bodies per solve, the bodies are added again every iteration like the game does each frame
+static void BM_AsteroidContacts(benchmark::State& state)
+{
+    const int count = state.range(0);
+    const double coverage = state.range(1) / 100.0;
+
+    const AsteroidSize sizes[] = {AsteroidSize::SMALL, AsteroidSize::SMALL, AsteroidSize::SMALL, AsteroidSize::MED, AsteroidSize::BIG};
+    std::mt19937 rng = makeRng();
+    std::uniform_int_distribution<int> randomSize(0, 4);
+    std::vector<AsteroidSize> bodySizes(count);
+    double area = 0;
+    for(auto& size : bodySizes){
+        size = sizes[randomSize(rng)];
+        double radius = (SimWorld::getAsteroidWidth(size) + SimWorld::getAsteroidHeight(size)) / 4.0;
+        area += AsteroidConstants::PI * radius * radius;
+    }
+
+    // square world sized for the coverage
+    const int worldSize = static_cast<int>(std::sqrt(area / coverage));
+    std::uniform_real_distribution<double> randomPos(0, worldSize);
+    std::uniform_real_distribution<double> randomAngle(-180, 180);
+    std::vector<Point> positions(count);
+    std::vector<CVector> velocities(count);
+    for(int i = 0; i < count; i++){
+        positions[i] = Point{randomPos(rng), randomPos(rng)};
+        velocities[i] = CVector(AsteroidConstants::INIT_ASTEROID_VELOCITY, randomAngle(rng), VectorType::POLAR);
+    }
+
+    CAsteroidPhysics physics(worldSize, worldSize);
+    physics.reserve(count);
+    PerfValues perfStart = getPerfCounters().read();
+    for(auto _ : state){
+        physics.clear();
+        for(int i = 0; i < count; i++){
+            double radius = (SimWorld::getAsteroidWidth(bodySizes[i]) + SimWorld::getAsteroidHeight(bodySizes[i])) / 4.0;
+            physics.add(positions[i], velocities[i].getXProjection(), velocities[i].getYProjection(), radius, GameObjectAsteroid::getMass(bodySizes[i]));
+        }
+        physics.solve();
+        benchmark::DoNotOptimize(physics.getContacts());
+    }
+    reportPerfCounters(state, perfStart, state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["pair_tests"] = static_cast<double>(physics.getPairTests());
+    state.counters["contacts"] = physics.getContacts();
+    state.SetLabel(std::to_string(worldSize) + "px world");
+}
+BENCHMARK(BM_AsteroidContacts)->ArgsProduct({{1000, 10000}, {2, 40}})->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
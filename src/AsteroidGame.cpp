@@ -8,13 +8,49 @@
 
 #include "AsteroidGame.h"
 
+namespace
+{
+    // keys controlling the ship of a local player
+    struct ShipKeys
+    {
+        SDL_Keycode rotateLeft;
+        SDL_Keycode rotateRight;
+        SDL_Keycode moveForward;
+        SDL_Keycode moveBackward;
+        SDL_Keycode shoot;
+    };
+
+    const ShipKeys SHIP_KEYS[AsteroidConstants::MAX_LOCAL_PLAYERS] =
+    {
+        {SDLK_a, SDLK_d, SDLK_w, SDLK_s, SDLK_SPACE},
+        {SDLK_LEFT, SDLK_RIGHT, SDLK_UP, SDLK_DOWN, SDLK_RSHIFT},
+    };
+
+    // player whose camera shows as much of the world as fits in the viewport
+    LocalPlayer makePlayer(const SDL_Rect& viewport)
+    {
+        return LocalPlayer{nullptr, CCamera(viewport.w, viewport.h, AsteroidConstants::WORLD_WIDTH, AsteroidConstants::WORLD_HEIGHT),
+                           viewport, true, 0, false, CTexture(), nullptr, CAutopilot()};
+    }
+}
+
 //////////// Public functions ////////////
 
 // initalize SDL assets, load textures, load fonts, create background image object
 AsteroidGame::AsteroidGame()
     : _window(nullptr, SDL_DestroyWindow), _renderer(nullptr, SDL_DestroyRenderer),
-      _state(GameState::RUNNING), _currentColor(AsteroidColor::GREY), _currentLevel(1), _score(0)
+      _explosions(AsteroidConstants::EXPLOSION_MAX), _particles(CConfig::get().particleCapacity),
+      _timers(SDL_GetTicks()),
+      _asteroidGrid(AsteroidConstants::WORLD_WIDTH, AsteroidConstants::WORLD_HEIGHT, AsteroidConstants::GRID_CELL_SIZE),
+      _physics(AsteroidConstants::WORLD_WIDTH, AsteroidConstants::WORLD_HEIGHT), _frameCount(0),
+      _rng(std::random_device{}()), _rewindRing(CConfig::get().rewindFrames), _rewinding(false), _recordOverflow(false), _recordOverflowReported(false),
+      _autopilot(false), _soakIdleCheck(false), _lastIdleCheck(0), _lateInput(false), _compositorCheck(false),
+      _presentUs(0), _pausedAt(0), _state(GameState::RUNNING), _currentColor(AsteroidColor::GREY), _currentLevel(1)
 {
+    // one player on the whole screen, enableCoop splits it
+    _players.reserve(AsteroidConstants::MAX_LOCAL_PLAYERS);
+    _players.push_back(makePlayer(SDL_Rect{0, 0, AsteroidConstants::SCREEN_WIDTH, AsteroidConstants::SCREEN_HEIGHT}));
+
     if(!init())
         exit(0);
     if(!loadTextures())
@@ -39,8 +75,13 @@ AsteroidGame::~AsteroidGame()
 // top level call to run the game
 void AsteroidGame::run()
 {
-    // initialize the game with a main menu
-    runMainMenu();
+    // initialize the game with a main menu, the bot starts right away
+    if(_autopilot){
+        _state = GameState::RUNNING;
+    }
+    else{
+        runMainMenu();
+    }
     
     // run level, if level is complete show next level menu
     // if game over during the level then show game over menu
@@ -57,12 +98,231 @@ void AsteroidGame::run()
 
 }
 
+// level the first game starts at, asteroid colors advance as if the previous levels were played
+void AsteroidGame::setStartLevel(int level)
+{
+    _currentLevel = std::max(level, 1);
+    _currentColor = AsteroidColor::GREY;
+    for(int i = 1; i < _currentLevel; i++){
+        _currentColor = GameObjectAsteroid::getNextColor(_currentColor);
+    }
+}
+
+// let the bot play, menus are skipped
+// after a game over the bot retries the same level with the score reset
+void AsteroidGame::enableAutopilot()
+{
+    _autopilot = true;
+}
+
+// play with the bot for durationMs while tracking resource growth
+void AsteroidGame::enableSoak(Uint32 durationMs)
+{
+    enableAutopilot();
+    _soak = std::make_unique<CSoakMonitor>(durationMs);
+}
+
+// soak test detected a leak or frame time decay
+bool AsteroidGame::hasSoakFailed() const
+{
+    return _soak && _soak->hasFailed();
+}
+
+// poll input as late as possible before the next present
+// the frame delay moves from after the present to before polling input, so input is sampled closer to the vsync it is shown at
+void AsteroidGame::enableLateInput()
+{
+    _lateInput = true;
+}
+
+// idle after frames over the save state caps during the soak test and fail if objects jump
+void AsteroidGame::enableSoakIdleCheck()
+{
+    _soakIdleCheck = true;
+}
+
+// input to present latency per input type
+void AsteroidGame::printLatencyReport() const
+{
+    _inputLatency.printReport();
+}
+
+// compose level frames on the CPU into a streaming texture instead of drawing every object with the renderer
+// needs the pixel copies kept by CTexture::keepPixelCopies and the pre-rotated sprites, menus are still drawn by SDL
+bool AsteroidGame::enableSoftCompositor(bool check)
+{
+    if(_players.size() > 1){
+        std::cout << "Software compositor composes a single view, the split screen uses the SDL renderer\n";
+        return false;
+    }
+
+    const CTexture& background = _mainTextures[static_cast<int>(TextureType::TEX_BACKGROUND)];
+    if(background.getPixels() == nullptr || !_shipRotations.isBuilt() || !_laserRotations.isBuilt()){
+        std::cout << "Software compositor needs texture pixel copies and render targets, using the SDL renderer\n";
+        return false;
+    }
+
+    _compositor = std::make_unique<CSoftCompositor>();
+    if(!_compositor->init(*_renderer, AsteroidConstants::SCREEN_WIDTH, AsteroidConstants::SCREEN_HEIGHT, CConfig::get().threads)){
+        _compositor.reset();
+        return false;
+    }
+
+    // the SDL image is read back at the screen size, so a scaled output cannot be compared
+    int outputWidth = 0;
+    int outputHeight = 0;
+    SDL_GetRendererOutputSize(_renderer.get(), &outputWidth, &outputHeight);
+    _compositorCheck = check;
+    if(check && (outputWidth != AsteroidConstants::SCREEN_WIDTH || outputHeight != AsteroidConstants::SCREEN_HEIGHT)){
+        std::cout << "Compositor check needs an output of the screen size, check disabled\n";
+        _compositorCheck = false;
+    }
+    if(_compositorCheck){
+        _compositorReference.resize(AsteroidConstants::SCREEN_WIDTH * AsteroidConstants::SCREEN_HEIGHT);
+    }
+    return true;
+}
+
+// a checked frame differed from the SDL renderer image
+bool AsteroidGame::hasCompositorFailed() const
+{
+    return _compositor && _compositorCheck && _compositor->hasFailed();
+}
+
+// frames compared with the SDL renderer and their largest difference
+void AsteroidGame::printCompositorReport() const
+{
+    if(_compositor && _compositorCheck){
+        _compositor->printCheckSummary();
+    }
+}
+
+// record level frames to a Y4M or raw RGBA file at the renderer output size
+bool AsteroidGame::enableCapture(const std::string& path)
+{
+    int width = 0;
+    int height = 0;
+    SDL_GetRendererOutputSize(_renderer.get(), &width, &height);
+
+    // without a frame cap the video keeps the default frame rate
+    int fps = CConfig::get().fps > 0 ? CConfig::get().fps : AsteroidConstants::FPS;
+    _capture = std::make_unique<CFrameCapture>(path, width, height, fps);
+    if(!_capture->isOpen()){
+        std::cout << "Unable to open capture file " << path << "!\n";
+        _capture.reset();
+        return false;
+    }
+    return true;
+}
+
+// lower quality levels when level frames exceed the frame budget, raise them again when headroom returns
+// render scaling needs render targets and a single view, the software compositor always composes at the screen size
+bool AsteroidGame::enableGovernor()
+{
+    int ticksPerFrame = CConfig::get().getTicksPerFrame();
+    if(ticksPerFrame <= 0){
+        std::cout << "Governor needs a frame cap, set fps above 0\n";
+        return false;
+    }
+
+    bool allowScaling = !_compositor && _players.size() == 1 && SDL_RenderTargetSupported(_renderer.get());
+    _governor.enable(static_cast<std::uint64_t>(ticksPerFrame) * 1000, allowScaling);
+    return true;
+}
+
+// two local players on a split screen, each view is one side of the screen and follows its own ship
+// the world is simulated once for both, every view only draws what its camera sees
+void AsteroidGame::enableCoop()
+{
+    int viewWidth = AsteroidConstants::SCREEN_WIDTH / AsteroidConstants::MAX_LOCAL_PLAYERS;
+    _players.clear();
+    for(int i = 0; i < AsteroidConstants::MAX_LOCAL_PLAYERS; i++){
+        _players.push_back(makePlayer(SDL_Rect{i * viewWidth, 0, viewWidth, AsteroidConstants::SCREEN_HEIGHT}));
+    }
+}
+
+// join a multiplayer server on the loopback interface and play until escape or the connection is lost
+// the server runs the simulation, the client only sends its controls and renders the snapshots it receives
+void AsteroidGame::runNetworkGame(std::uint16_t serverPort)
+{
+    NetClient client;
+    if(!client.connect(serverPort, AsteroidConstants::NET_TIMEOUT_MS))
+        return;
+
+    SimControls controls{};
+    std::uint8_t shotCounter = 0;
+    NetSnapshot snapshot;
+
+    _currentLevel = 0;
+    _players[0].score = 0;
+
+    SDL_Event event;
+    bool running = true;
+    while(running){
+        TRACE_SCOPE("frame");
+
+        Uint32 startTick = SDL_GetTicks();
+
+        while(SDL_PollEvent(&event) != 0){
+            if(event.type == SDL_QUIT){
+                _state = GameState::QUIT;
+                running = false;
+            }
+            else if(event.type == SDL_KEYDOWN || event.type == SDL_KEYUP){
+                Uint8 pressed = event.type == SDL_KEYDOWN;
+                switch(event.key.keysym.sym)
+                {
+                    case SDLK_a:    controls.rotateLeft = pressed;      break;
+                    case SDLK_d:    controls.rotateRight = pressed;     break;
+                    case SDLK_w:    controls.moveForward = pressed;     break;
+                    case SDLK_s:    controls.moveBackward = pressed;    break;
+                    case SDLK_SPACE:
+                        if(!pressed){
+                            shotCounter++;
+                            playLaserSound();
+                        }
+                        break;
+                    case SDLK_ESCAPE:   if(!pressed) running = false;   break;
+                    case SDLK_F12:      if(!pressed) CTracer::flush();  break;
+                    default:                                            break;
+                }
+            }
+        }
+
+        client.sendInput(controls, shotCounter);
+
+        Uint32 now = SDL_GetTicks();
+        client.receive(now);
+        if(client.hasTimedOut(now)){
+            std::cout << "Lost connection to server!\n";
+            break;
+        }
+
+        // the server keeps running, so input and snapshots are still exchanged while the window is idle, only drawing stops
+        if(!CInputQueue::isIdle(*_window) && client.getInterpolated(now, snapshot)){
+            TRACE_SCOPE("renderSnapshot");
+            renderSnapshot(snapshot);
+        }
+
+        // limit FPS
+        Uint32 frameTicks = SDL_GetTicks() - startTick;
+        Uint32 ticksPerFrame = CConfig::get().getTicksPerFrame();
+        if(frameTicks < ticksPerFrame){
+            TRACE_SCOPE("frameDelay");
+            SDL_Delay(ticksPerFrame - frameTicks);
+        }
+    }
+
+    client.disconnect();
+}
+
 //////////// Private functions ////////////
 
 
 // initialize SDL assets
 bool AsteroidGame::init()
 {
+    TRACE_SCOPE("AsteroidGame::init");
 
     // initialize SDL
     if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0){
@@ -82,7 +342,8 @@ bool AsteroidGame::init()
     }
 
     // initialize SDL_mixer
-    if( Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0){
+    const GameConfig& config = CConfig::get();
+    if( Mix_OpenAudio(config.audioFrequency, MIX_DEFAULT_FORMAT, 2, config.audioBuffer) < 0){
         std::cout << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << "\n";
         return false;
     }
@@ -94,25 +355,36 @@ bool AsteroidGame::init()
     }
 
     // Create window
-    _window.reset(SDL_CreateWindow("Asteroids", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, AsteroidConstants::SCREEN_WIDTH, AsteroidConstants::SCREEN_HEIGHT, SDL_WINDOW_SHOWN));
+    _window.reset(SDL_CreateWindow("Asteroids", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, config.windowWidth, config.windowHeight, SDL_WINDOW_SHOWN));
     if(_window == nullptr){
         std::cout << "Window could not be created! SDL_Error: " << SDL_GetError() << "\n";
         return false;
     }
 
-    // Create renderer for window
-    _renderer.reset(SDL_CreateRenderer(_window.get(), -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC));
+    // Create renderer for window, a named driver is requested through the render driver hint
+    Uint32 rendererFlags = config.renderer == "software" ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED;
+    if(config.vsync) rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    if(config.renderer != "auto" && !SDL_SetHint(SDL_HINT_RENDER_DRIVER, config.renderer.c_str())){
+        std::cout << "Warning: Render driver " << config.renderer << " not set!\n";
+    }
+    _renderer.reset(SDL_CreateRenderer(_window.get(), -1, rendererFlags));
     if(_renderer == nullptr){
         std::cout << "Renderer could not be created! SDL Error: " << SDL_GetError() << "\n";
         return false;
     }        
 
+    // the game is drawn at the screen size and scaled to the window
+    if(config.windowWidth != AsteroidConstants::SCREEN_WIDTH || config.windowHeight != AsteroidConstants::SCREEN_HEIGHT){
+        SDL_RenderSetLogicalSize(_renderer.get(), AsteroidConstants::SCREEN_WIDTH, AsteroidConstants::SCREEN_HEIGHT);
+    }
+
     return true;
 }
 
 // load fonts with SDL_ttf
 bool AsteroidGame::loadFonts()
 {
+    TRACE_SCOPE("AsteroidGame::loadFonts");
     bool success = true;
 
     for(unsigned int i = 0; i < static_cast<unsigned int>(FontType::FONT_TOTAL); i++){
@@ -147,6 +419,7 @@ bool AsteroidGame::loadFonts()
 // load sounds with SDL_mixer
 bool AsteroidGame::loadSounds()
 {
+    TRACE_SCOPE("AsteroidGame::loadSounds");
     bool success = true;
 
     for(unsigned int i = 0; i < static_cast<unsigned int>(SoundType::SOUND_TOTAL); i++){
@@ -176,6 +449,7 @@ std::string AsteroidGame::getSoundPath(SoundType type) const
 // load sprites into texture objects
 bool AsteroidGame::loadTextures()
 {
+    TRACE_SCOPE("AsteroidGame::loadTextures");
     bool success = true;
 
     for(unsigned int i = 0; i < static_cast<unsigned int>(TextureType::TEX_TOTAL); i++){
@@ -183,6 +457,15 @@ bool AsteroidGame::loadTextures()
         success &= tmp.loadFromFile(*_renderer, getTexturePath(static_cast<TextureType>(i)));
         _mainTextures.push_back(std::move(tmp));
     }
+
+    // ship and lasers only turn in SHIP_ROTATION_STEP steps, so every orientation is rasterized once here
+    // without render targets they are rotated on every draw instead
+    if(success){
+        const CTexture& ship = _mainTextures[static_cast<int>(TextureType::TEX_SHIP)];
+        const CTexture& laser = _mainTextures[static_cast<int>(TextureType::TEX_LASER)];
+        _shipRotations.build(*_renderer, ship, ship.getWidth()/AsteroidConstants::SCALE_SHIP_W, ship.getHeight()/AsteroidConstants::SCALE_SHIP_H);
+        _laserRotations.build(*_renderer, laser, laser.getWidth()/AsteroidConstants::SCALE_LASER_W, laser.getHeight()/AsteroidConstants::SCALE_LASER_H);
+    }
     return success;
 }
 
@@ -210,182 +493,708 @@ std::string AsteroidGame::getTexturePath(TextureType type) const
 // main game loop
 void AsteroidGame::runLevel()
 {
-    SDL_Event event;
+    while(_state == GameState::RUNNING || _state == GameState::PAUSED){
+        TRACE_SCOPE("frame");
 
-    while(_state == GameState::RUNNING){
+        if(_lateInput){
+            TRACE_SCOPE("lateInputDelay");
+            Uint32 now = SDL_GetTicks();
+            _input.waitUntil(now + _inputLatency.getLateSampleDelay(now));
+        }
 
         Uint32 startTick = SDL_GetTicks();
-            
-        handleInput(event);
+        std::uint64_t workStartUs = CInputQueue::nowUs();
+        _presentUs = 0;
+        _inputLatency.beginWork(startTick);
+        if(_soak) _soak->beginFrame();
 
-        updateObjects();
-        renderObjects();
-        deleteExpiredObjects();
-
-        checkShipCollision();            
-        checkAsteroidCollision();      
+        {
+            TRACE_SCOPE("handleInput");
+            ALLOC_PHASE(AllocPhase::INPUT);
+            PERF_PHASE(AllocPhase::INPUT);
+            handleInput();
+        }
+        // nothing is simulated or presented while the window cannot be seen or used, the bot keeps playing
+        if(!_autopilot && _state != GameState::QUIT && CInputQueue::isIdle(*_window)){
+            idle();
+            continue;
+        }
+        if(_autopilot && _state == GameState::RUNNING && !_rewinding){
+            TRACE_SCOPE("updateAutopilot");
+            ALLOC_PHASE(AllocPhase::INPUT);
+            PERF_PHASE(AllocPhase::INPUT);
+            updateAutopilot();
+        }
+        // while paused the world is frozen and only the pause menu is drawn
+        // while the rewind key is held recorded frames are played back in reverse
+        if(_state == GameState::PAUSED){
+            TRACE_SCOPE("renderPauseMenu");
+            _pauseMenu->render();
+        }
+        else if(_rewinding){
+            {
+                TRACE_SCOPE("rewindFrame");
+                // restoring a frame rebuilds every object, like loading a save it is not part of the frame allocation budget
+                ALLOC_PHASE(AllocPhase::OTHER);
+                PERF_PHASE(AllocPhase::OTHER);
+                rewindFrame();
+            }
+            {
+                TRACE_SCOPE("renderObjects");
+                ALLOC_PHASE(AllocPhase::RENDER);
+                PERF_PHASE(AllocPhase::RENDER);
+                renderObjects();
+            }
+            presentFrame();
+        }
+        else{
+            {
+                TRACE_SCOPE("updateObjects");
+                ALLOC_PHASE(AllocPhase::UPDATE);
+                PERF_PHASE(AllocPhase::UPDATE);
+                updateObjects();
+            }
+            {
+                TRACE_SCOPE("renderObjects");
+                ALLOC_PHASE(AllocPhase::RENDER);
+                PERF_PHASE(AllocPhase::RENDER);
+                renderObjects();
+            }
+            presentFrame();
+            {
+                TRACE_SCOPE("deleteExpiredObjects");
+                ALLOC_PHASE(AllocPhase::EXPIRY);
+                PERF_PHASE(AllocPhase::EXPIRY);
+                deleteExpiredObjects();
+            }
+            {
+                TRACE_SCOPE("checkCollisions");
+                ALLOC_PHASE(AllocPhase::COLLISION);
+                PERF_PHASE(AllocPhase::COLLISION);
+                checkShipCollision();            
+                checkAsteroidCollision();      
+            }
+            {
+                TRACE_SCOPE("processEvents");
+                ALLOC_PHASE(AllocPhase::EVENTS);
+                PERF_PHASE(AllocPhase::EVENTS);
+                processEvents();
+            }
 
-        checkLevelCompleted(); 
+            checkLevelCompleted(); 
+            {
+                TRACE_SCOPE("recordFrame");
+                ALLOC_PHASE(AllocPhase::RECORD);
+                PERF_PHASE(AllocPhase::RECORD);
+                recordFrame();
+            }
+        }
 
         // limit FPS
         Uint32 endTick = SDL_GetTicks();
         Uint32 frameTicks = endTick - startTick;        
-        if(frameTicks < AsteroidConstants::TICKS_PER_FRAME){
-            SDL_Delay(AsteroidConstants::TICKS_PER_FRAME - frameTicks);
+        updateMetrics(CInputQueue::nowUs() - workStartUs - _presentUs);
+        if(_soak) updateSoak();
+
+        // time blocked in the present is waiting for the display, paused frames only draw the menu
+        if(_state == GameState::RUNNING){
+            _governor.addFrame(CInputQueue::nowUs() - workStartUs - _presentUs);
+        }
+
+        // input arriving during the wait is collected right away and handled at the start of the next frame
+        // at the lowest quality level frames are spaced several frame cap intervals apart
+        // objects move, ships turn and bots shoot by elapsed time, so only the smoothness drops and not the game speed
+        Uint32 ticksPerFrame = CConfig::get().getTicksPerFrame() * _governor.getSettings().frameInterval;
+        if(!_lateInput && frameTicks < ticksPerFrame){
+            TRACE_SCOPE("frameDelay");
+            _input.waitUntil(startTick + ticksPerFrame);
         }
     }
     cleanupLevel();
 }
 
-// handle keyboard input             
-void AsteroidGame::handleInput(SDL_Event &event)
+// handle keyboard input collected since the last frame
+// movement keys released while paused still stop the ship so it does not keep moving after resuming
+void AsteroidGame::handleInput()
 {
+    _input.pump();
 
-    while(SDL_PollEvent(&event) != 0){
+    InputEvent event;
+    while(_input.pop(event)){
         if(event.type == SDL_QUIT){
             _state = GameState::QUIT;
         }
-        else if(event.type == SDL_KEYDOWN)
+        else if(_state == GameState::PAUSED){
+            if(event.type == SDL_KEYUP){
+                switch(event.key)
+                {
+                    case SDLK_RETURN:   resumeGame();                                       break;
+                    default:            handleShipKey(event.key, false, event.timestamp);   break;
+                }
+            }
+        }
+        else if(event.type == SDL_KEYDOWN && !event.repeat)
         {
-            switch (event.key.keysym.sym)
+            switch (event.key)
             {
-                case SDLK_a:    _pShip->setRotateLeft(true);    break;
-                case SDLK_d:    _pShip->setRotateRight(true);   break;
-                case SDLK_w:    _pShip->setMoveForward(true);   break;
-                case SDLK_s:    _pShip->setMoveBackward(true);  break;
-                default:                                        break;
+                case SDLK_BACKSPACE:    _rewinding = true;                                  break;
+                default:                handleShipKey(event.key, true, event.timestamp);    break;
             }
         }
         else if(event.type == SDL_KEYUP)
         {
-            switch(event.key.keysym.sym)
+            switch(event.key)
             {
-                case SDLK_a:        _pShip->setRotateLeft(false);   break;
-                case SDLK_d:        _pShip->setRotateRight(false);  break;
-                case SDLK_w:        _pShip->setMoveForward(false);  break;
-                case SDLK_s:        _pShip->setMoveBackward(false); break;
-                case SDLK_SPACE:    shootLaser();                   break;
-                case SDLK_ESCAPE:   runPauseMenu();                 break;
-                default:                                            break;
+                case SDLK_ESCAPE:   pauseGame();                    break;
+                case SDLK_F12:      CTracer::flush();               break;
+                case SDLK_BACKSPACE: _rewinding = false;            break;
+                case SDLK_F5:       quickSave();                    break;
+                case SDLK_F9:       quickLoad();                    break;
+                default:            handleShipKey(event.key, false, event.timestamp);   break;
+
+            }
+        }
+    }
+}
+
+// move or shoot with the ship of the player the key is mapped to, lasers are fired when the key is released
+// while paused releases only stop the ship, inputs of a crashed ship are not timed for the latency report
+void AsteroidGame::handleShipKey(SDL_Keycode key, bool pressed, Uint32 timestamp)
+{
+    bool paused = _state == GameState::PAUSED;
+    for(int i = 0; i < static_cast<int>(_players.size()); i++){
+        const ShipKeys& keys = SHIP_KEYS[i];
+        GameObjectShip& ship = *_players[i].ship;
+        InputType type = InputType::RELEASE;
+
+        if(key == keys.rotateLeft)          { ship.setRotateLeft(pressed);      type = InputType::ROTATE_LEFT;}
+        else if(key == keys.rotateRight)    { ship.setRotateRight(pressed);     type = InputType::ROTATE_RIGHT;}
+        else if(key == keys.moveForward)    { ship.setMoveForward(pressed);     type = InputType::MOVE_FORWARD;}
+        else if(key == keys.moveBackward)   { ship.setMoveBackward(pressed);    type = InputType::MOVE_BACKWARD;}
+        else if(key == keys.shoot){
+            if(pressed || paused) return;
+            shootLaser(i);
+            type = InputType::SHOOT;
+        }
+        else{
+            continue;
+        }
+
+        if(!paused && _players[i].alive){
+            _inputLatency.addInput(pressed || type == InputType::SHOOT ? type : InputType::RELEASE, timestamp);
+        }
+        return;
+    }
+}
+
+// record end of frame gauges and hand the frame to the metrics registry
+void AsteroidGame::updateMetrics(std::uint64_t frameUs)
+{
+    int score = 0;
+    for(const LocalPlayer& player: _players){
+        score += player.score;
+    }
 
+    CMetrics::set(Metric::FRAME_TIME_US, frameUs);
+    CMetrics::set(Metric::ASTEROIDS, _asteroidHash.size());
+    CMetrics::set(Metric::LASERS, _laserHash.size());
+    CMetrics::set(Metric::EXPLOSIONS, _explosions.getCount());
+    CMetrics::set(Metric::PARTICLES, _particles.getCount());
+    CMetrics::set(Metric::QUALITY_LEVEL, static_cast<int>(_governor.getLevel()));
+    CMetrics::set(Metric::LEVEL, _currentLevel);
+    CMetrics::set(Metric::SCORE, score);
+    CMetrics::set(Metric::SOUND_VOICES, Mix_Playing(-1));
+    CMetrics::set(Metric::SOUND_CHANNELS, Mix_AllocateChannels(-1));
+    CMetrics::endFrame(SDL_GetTicks());
+    CAllocTracker::endFrame();
+    CPerfPhases::endFrame(static_cast<int>(_asteroidHash.size() + _laserHash.size()) + _explosions.getCount() + _particles.getCount());
+}
+
+// set the ship controls chosen by the bots, every player's ship has its own bot
+// a bot sees the asteroids within AUTOPILOT_VIEW_RADIUS of its ship and shoots through the same path as the shoot key
+void AsteroidGame::updateAutopilot()
+{
+    for(int i = 0; i < static_cast<int>(_players.size()); i++){
+        LocalPlayer& player = _players[i];
+        if(!player.alive) continue;
+
+        Point shipPos = player.ship->getPos();
+        int radius = AsteroidConstants::AUTOPILOT_VIEW_RADIUS;
+        SDL_Rect viewRect{static_cast<int>(shipPos.x) - radius, static_cast<int>(shipPos.y) - radius, 2 * radius, 2 * radius};
+
+        _queryResult.clear();
+        _asteroidGrid.query(viewRect, _queryResult);
+
+        // the grid was built before this frame's collisions, asteroids destroyed since then are skipped
+        _botTargets.clear();
+        for(int id: _queryResult){
+            auto it = _asteroidHash.find(id);
+            if(it == _asteroidHash.end()) continue;
+            const GameObjectAsteroid& asteroid = *it->second;
+            CVector velocity = asteroid.getVelocity();
+            _botTargets.push_back(AutopilotTarget{asteroid.getPos(), velocity.getXProjection(), velocity.getYProjection(), asteroid.getHalfExtent()});
+        }
+        // with nothing close the bot is shown every asteroid so it can fly to the remaining ones
+        if(_botTargets.empty()){
+            for(const auto& pair: _asteroidHash){
+                CVector velocity = pair.second->getVelocity();
+                _botTargets.push_back(AutopilotTarget{pair.second->getPos(), velocity.getXProjection(), velocity.getYProjection(), pair.second->getHalfExtent()});
             }
         }
+
+        SimControls controls = player.bot.update(shipPos, player.ship->getRotation(), _botTargets, SDL_GetTicks());
+        player.ship->setRotateLeft(controls.rotateLeft);
+        player.ship->setRotateRight(controls.rotateRight);
+        player.ship->setMoveForward(controls.moveForward);
+        player.ship->setMoveBackward(controls.moveBackward);
+        if(controls.shoot){
+            shootLaser(i);
+        }
+    }
+}
+
+// sample resources for the soak test, ends the game when it is finished or failed
+// frame time is measured without the frame delay so decay is visible below the frame cap
+void AsteroidGame::updateSoak()
+{
+    _soak->endFrame();
+
+    Uint32 now = SDL_GetTicks();
+
+    // opt-in, idle right after a frame that did not fit a save state, at most once per sample interval
+    if(_soakIdleCheck && _recordOverflow && _state == GameState::RUNNING && now - _lastIdleCheck >= static_cast<Uint32>(AsteroidConstants::SOAK_SAMPLE_MS)){
+        checkIdleResume();
+        _lastIdleCheck = now;
+    }
+
+    if(_soak->isSampleDue(now) || _soak->isFinished(now)){
+        SoakCounts counts{_currentLevel, static_cast<int>(_asteroidHash.size()), static_cast<int>(_laserHash.size()),
+                          _explosions.getCount(), _particles.getCount(),
+                          _timers.getPending(), CTexture::getLiveCount()};
+        _soak->addSample(now, counts);
+    }
+    if(_soak->isFinished(now) || _soak->hasFailed()){
+        _soak->printSummary();
+        _state = GameState::QUIT;
+    }
+}
+
+// soak self check, idle for SOAK_IDLE_CHECK_MS after a frame over the save state caps and verify nothing jumps
+// recordFrame has just dropped the rewind ring, so continuing cannot rely on a recorded frame
+void AsteroidGame::checkIdleResume()
+{
+    TRACE_SCOPE("checkIdleResume");
+    ALLOC_PHASE(AllocPhase::OTHER);
+
+    Uint32 idleStart = SDL_GetTicks();
+    Uint32 stepBefore = getLongestStep(idleStart);
+    SDL_Delay(AsteroidConstants::SOAK_IDLE_CHECK_MS);
+    resumeAfterIdle(idleStart);
+
+    _soak->checkIdleResume(AsteroidConstants::SOAK_IDLE_CHECK_MS, stepBefore, getLongestStep(SDL_GetTicks()));
+}
+
+// longest time any object or the particles have not been updated for, the next update moves them over this time
+Uint32 AsteroidGame::getLongestStep(Uint32 now) const
+{
+    Uint32 longest = now - _particles.getLastUpdated();
+    for(const auto& player : _players){
+        if(player.ship) longest = std::max(longest, now - player.ship->getLastUpdated());
+    }
+    for(const auto& [id, laser] : _laserHash){
+        longest = std::max(longest, now - laser->getLastUpdated());
     }
+    for(const auto& [id, asteroid] : _asteroidHash){
+        longest = std::max(longest, now - asteroid->getLastUpdated());
+    }
+    return longest;
 }
 
-// render all active game objects
+// render all active game objects inside the camera view of every player
 void AsteroidGame::renderObjects()
 {
-    // clear screen
-    SDL_SetRenderDrawColor( _renderer.get(), 0x00, 0x00, 0x00, 0xFF );
-    SDL_RenderClear( _renderer.get() );
+    refreshScoreText();
+
+    if(_compositor){
+        // every COMPOSITOR_CHECK_INTERVAL frames the frame is drawn by SDL first and read back as reference
+        const Uint32* reference = nullptr;
+        if(_compositorCheck && _frameCount % AsteroidConstants::COMPOSITOR_CHECK_INTERVAL == 0){
+            TRACE_SCOPE("compositorCheck");
+            SDL_SetRenderDrawColor( _renderer.get(), 0x00, 0x00, 0x00, 0xFF );
+            SDL_RenderClear( _renderer.get() );
+            drawObjects(_players[0].camera);
+            drawHud(_players[0]);
+            if(SDL_RenderReadPixels(_renderer.get(), nullptr, SDL_PIXELFORMAT_ARGB8888, _compositorReference.data(), AsteroidConstants::SCREEN_WIDTH * sizeof(Uint32)) == 0){
+                reference = _compositorReference.data();
+            }
+        }
 
-    // render background image
-    SDL_Rect backgroundRect{0,0,AsteroidConstants::SCREEN_WIDTH, AsteroidConstants::SCREEN_HEIGHT};
-    _backgroundObject->render(*_renderer, backgroundRect);
+        _compositor->begin();
+        drawObjects(_players[0].camera);
+        drawHud(_players[0]);
+        _compositor->end(*_renderer, reference);
+    }
+    else{
+        // clear screen
+        SDL_SetRenderDrawColor( _renderer.get(), 0x00, 0x00, 0x00, 0xFF );
+        SDL_RenderClear( _renderer.get() );
+
+        // on a split screen every view is drawn into its own viewport, which also clips it
+        bool split = _players.size() > 1;
+        int renderPercent = _governor.getSettings().renderPercent;
+        for(const LocalPlayer& player: _players){
+            if(split) SDL_RenderSetViewport(_renderer.get(), &player.viewport);
+
+            if(renderPercent < 100){
+                drawObjectsScaled(player.camera, renderPercent);
+            }
+            else{
+                drawObjects(player.camera);
+            }
+            drawHud(player);
+        }
+
+        if(split){
+            SDL_RenderSetViewport(_renderer.get(), nullptr);
 
-    // render explosions
-    for(auto& explosion: _explosionHash){
-        explosion.second->render(*_renderer);        
+            // dark line between the views
+            SDL_SetRenderDrawColor( _renderer.get(), 0x00, 0x00, 0x00, 0xFF );
+            for(std::size_t i = 1; i < _players.size(); i++){
+                SDL_Rect divider{_players[i].viewport.x - 1, 0, 2, AsteroidConstants::SCREEN_HEIGHT};
+                SDL_RenderFillRect(_renderer.get(), &divider);
+            }
+        }
     }
 
-    // render asteroids
-    for(auto const& asteroid: _asteroidHash){
-        asteroid.second->render(*_renderer);
+    // the frame is read back before presenting, the back buffer is undefined afterwards
+    if(_capture){
+        _capture->captureFrame(*_renderer);
+    }
+}
+
+// update screen, inputs applied this frame become visible
+// called outside the RENDER phase, time blocked waiting for the display is not counted as render work
+void AsteroidGame::presentFrame()
+{
+    _inputLatency.endWork(SDL_GetTicks());
+    {
+        TRACE_SCOPE("SDL_RenderPresent");
+        std::uint64_t presentStartUs = CInputQueue::nowUs();
+        SDL_RenderPresent( _renderer.get() );
+        _presentUs = CInputQueue::nowUs() - presentStartUs;
+    }
+    _inputLatency.onPresent(SDL_GetTicks());
+}
+
+// draw calls of a level view, recorded by the software compositor when it is enabled
+// every view culls on its own, the debris of a view is drawn with one geometry call of the particles it sees
+void AsteroidGame::drawObjects(const CCamera& camera)
+{
+    // render background image
+    renderBackground(camera);
+
+    // render explosions, all the ones in view with one geometry call
+    _explosions.render(*_renderer, _mainTextures[static_cast<int>(TextureType::TEX_EXPLOSION_SPRITE_SHEET)], camera);
+
+    // render explosion debris
+    _particles.render(*_renderer, camera);
+
+    // render asteroids, only the ones near the view are looked up from the spatial index
+    // IDs the hash no longer holds are skipped, the grid is only rebuilt once per frame
+    _queryResult.clear();
+    _asteroidGrid.query(camera.getViewRect(), _queryResult);
+    for(int id: _queryResult){
+        auto it = _asteroidHash.find(id);
+        if(it == _asteroidHash.end()) continue;
+        it->second->render(*_renderer, camera);
     }
 
     // render lasers
     for(auto const& laser: _laserHash){
-        laser.second->render(*_renderer);
+        laser.second->render(*_renderer, camera);
     }    
-    // render ship
-    _pShip->render(*_renderer);
+    // render ships, crashed ones are gone until the next level
+    for(const LocalPlayer& player: _players){
+        if(player.alive) player.ship->render(*_renderer, camera);
+    }
+}
 
-    // render level and score text
+// draw the level into a target of percent of the screen size and stretch it over the screen
+// the renderer scale maps the screen coordinates of the draw calls onto the smaller target
+void AsteroidGame::drawObjectsScaled(const CCamera& camera, int percent)
+{
+    int width = AsteroidConstants::SCREEN_WIDTH * percent / 100;
+    int height = AsteroidConstants::SCREEN_HEIGHT * percent / 100;
+    if(_scaledTarget.getWidth() != width || _scaledTarget.getHeight() != height){
+        if(!_scaledTarget.createTarget(*_renderer, width, height)){
+            drawObjects(camera);
+            return;
+        }
+        // the stretched frame replaces the whole screen
+        SDL_SetTextureBlendMode(&_scaledTarget.getTexture(), SDL_BLENDMODE_NONE);
+    }
+
+    // switching back to the window restores its scale and viewport
+    SDL_SetRenderTarget(_renderer.get(), &_scaledTarget.getTexture());
+    float scale = static_cast<float>(percent) / 100;
+    SDL_RenderSetScale(_renderer.get(), scale, scale);
+    SDL_RenderClear(_renderer.get());
+    drawObjects(camera);
+    SDL_SetRenderTarget(_renderer.get(), nullptr);
+
+    SDL_Rect screenRect{0, 0, AsteroidConstants::SCREEN_WIDTH, AsteroidConstants::SCREEN_HEIGHT};
+    _scaledTarget.render(*_renderer, nullptr, screenRect);
+}
+
+// level and score text of a player's view, always drawn at full resolution
+void AsteroidGame::drawHud(const LocalPlayer& player)
+{
     _fontObjectLevel->render(*_renderer);
-    _fontObjectScore->render(*_renderer);
+    player.scoreObject->render(*_renderer);
+}
+
+// tile background image scrolled by the camera position
+void AsteroidGame::renderBackground(const CCamera& camera)
+{
+    const int tileWidth = AsteroidConstants::SCREEN_WIDTH;
+    const int tileHeight = AsteroidConstants::SCREEN_HEIGHT;
+
+    SDL_Rect view = camera.getViewRect();
+    int offsetX = -(((view.x % tileWidth) + tileWidth) % tileWidth);
+    int offsetY = -(((view.y % tileHeight) + tileHeight) % tileHeight);
+
+    for(int y = offsetY; y < view.h; y += tileHeight){
+        for(int x = offsetX; x < view.w; x += tileWidth){
+            SDL_Rect backgroundRect{x, y, tileWidth, tileHeight};
+            _backgroundObject->render(*_renderer, backgroundRect);
+        }
+    }
+}
+
+// render a multiplayer snapshot received from the server
+void AsteroidGame::renderSnapshot(const NetSnapshot& snapshot)
+{
+    // the shared score is shown as the first player's score
+    LocalPlayer& player = _players[0];
+
+    // level and score text only change on level completion and asteroid hits
+    if(snapshot.level != _currentLevel){
+        _currentLevel = snapshot.level;
+        player.score = snapshot.totalScore;
+        initHud();
+    }
+    if(snapshot.totalScore != player.score){
+        updateScore(0, snapshot.totalScore - player.score);
+    }
+    refreshScoreText();
+
+    // follow own ship, the view stays where it was while the ship waits to respawn
+    AsteroidColor color = static_cast<AsteroidColor>(snapshot.color);
+    for(const NetEntity& entity: snapshot.entities){
+        if(entity.type == NetEntityType::SHIP && entity.attr == snapshot.ship){
+            player.camera.follow(Point{CSnapshotCodec::toPosition(entity.x), CSnapshotCodec::toPosition(entity.y)});
+        }
+    }
+
+    // clear screen
+    SDL_SetRenderDrawColor( _renderer.get(), 0x00, 0x00, 0x00, 0xFF );
+    SDL_RenderClear( _renderer.get() );
+
+    renderBackground(player.camera);
+
+    // entities are in id order, ships first followed by asteroids and lasers in creation order
+    for(const NetEntity& entity: snapshot.entities){
+        renderNetworkEntity(entity, color, entity.type == NetEntityType::SHIP && entity.attr == snapshot.ship);
+    }
+
+    // render level and score text
+    drawHud(player);
 
     // update screen
+    TRACE_SCOPE("SDL_RenderPresent");
     SDL_RenderPresent( _renderer.get() );
 }
 
+// render one snapshot entity centered on its position, other players' ships are tinted
+void AsteroidGame::renderNetworkEntity(const NetEntity& entity, AsteroidColor color, bool ownShip)
+{
+    CTexture* tex = nullptr;
+    const CSpriteRotations* rotations = nullptr;
+    int width = 0;
+    int height = 0;
+    double rotation = CSnapshotCodec::toRotation(entity.rotation);
+
+    switch(entity.type){
+        case NetEntityType::SHIP:
+            tex = &_mainTextures[static_cast<int>(TextureType::TEX_SHIP)];
+            rotations = &_shipRotations;
+            width = AsteroidConstants::SIM_SHIP_W;
+            height = AsteroidConstants::SIM_SHIP_H;
+            break;
+        case NetEntityType::ASTEROID:{
+            AsteroidSize size = static_cast<AsteroidSize>(entity.attr);
+            tex = &_mainTextures[static_cast<int>(GameObjectAsteroid::getAsteroidTexture(size, color))];
+            width = SimWorld::getAsteroidWidth(size);
+            height = SimWorld::getAsteroidHeight(size);
+            rotation = 0;
+            break;
+        }
+        case NetEntityType::LASER:
+            tex = &_mainTextures[static_cast<int>(TextureType::TEX_LASER)];
+            rotations = &_laserRotations;
+            width = AsteroidConstants::SIM_LASER_W;
+            height = AsteroidConstants::SIM_LASER_H;
+            break;
+        default:
+            // the codec rejects unknown types, nothing to draw if one gets through
+            return;
+    }
+
+    // pre-rotated sprites have the same size as the simulated ship and laser
+    if(rotations != nullptr && !rotations->isBuilt()) rotations = nullptr;
+
+    Point pos{CSnapshotCodec::toPosition(entity.x), CSnapshotCodec::toPosition(entity.y)};
+    SDL_Rect worldRect{static_cast<int>(pos.x) - width/2, static_cast<int>(pos.y) - height/2, width, height};
+    if(rotations != nullptr) worldRect = rotations->getBounds(pos, rotation);
+    const CCamera& camera = _players[0].camera;
+    SDL_Rect dstRect = camera.worldToScreen(worldRect);
+    if(!camera.isVisible(dstRect)) return;
+
+    SDL_Texture& texture = rotations != nullptr ? rotations->getTexture() : tex->getTexture();
+    bool tinted = entity.type == NetEntityType::SHIP && !ownShip;
+    if(tinted) SDL_SetTextureColorMod(&texture, 0x80, 0xC0, 0xFF);
+
+    if(rotations != nullptr){
+        rotations->render(*_renderer, rotation, dstRect);
+    }
+    else{
+        SDL_RenderCopyEx( _renderer.get(), &texture, nullptr, &dstRect, rotation, nullptr, SDL_FLIP_NONE);
+        CMetrics::add(Metric::RENDER_COPY_EX);
+    }
+
+    if(tinted) SDL_SetTextureColorMod(&texture, 0xFF, 0xFF, 0xFF);
+}
+
 // update all non-static game objects based on time delta
 void AsteroidGame::updateObjects()
 {
     Uint32 time = SDL_GetTicks();
+    _frameCount++;
+
+    // update ship positions based on current movement booleans and move the cameras with them
+    // the camera of a crashed ship stays where it crashed
+    for(LocalPlayer& player: _players){
+        if(!player.alive) continue;
+        player.ship->update(time);
+        player.camera.follow(player.ship->getPos());
+    }
 
     // update asteroid position
+    // asteroids away from every view move in straight lines, so they are updated every few frames with a larger time delta
     for(auto& asteroid: _asteroidHash){
-        asteroid.second->update(time);
+        bool nearView = false;
+        for(const LocalPlayer& player: _players){
+            nearView = nearView || player.camera.isInView(asteroid.second->getPos(), asteroid.second->getHalfExtent() + AsteroidConstants::GRID_CELL_SIZE);
+        }
+        if(nearView || (_frameCount + asteroid.first) % AsteroidConstants::OFFVIEW_UPDATE_INTERVAL == 0){
+            asteroid.second->update(time);
+        }
     }
+    resolveAsteroidContacts();
+    updateAsteroidGrid();
+
     // update laser position
     for(auto& laser: _laserHash){
         laser.second->update(time);
     }
-    // update explosion animation
-    for(auto& explosion: _explosionHash){
-        explosion.second->update(time);
-    }
-    // update ship position based on current movement booleans
-    _pShip->update(time);
+    // update explosion debris
+    _particles.update(time);
 
 }
 
-// delete offscreen lasers or expired explosion animation objects
-void AsteroidGame::deleteExpiredObjects()
+// bounce touching asteroids off each other, only the asteroids involved in a contact are written back
+void AsteroidGame::resolveAsteroidContacts()
 {
-    // check for expired explosion animations and delete the game object
-    std::vector<int> expiredExplosionID;
-    for(auto& explosion: _explosionHash){
-        if(explosion.second->isAnimationDone()){
-            expiredExplosionID.push_back(explosion.first);
-        }
-    }
-    for(int id: expiredExplosionID){
-        _explosionHash.erase(id);
+    _physics.clear();
+    _physicsBodies.clear();
+    for(auto& asteroid: _asteroidHash){
+        GameObjectAsteroid& body = *asteroid.second;
+        CVector velocity = body.getVelocity();
+        _physics.add(body.getPos(), velocity.getXProjection(), velocity.getYProjection(), body.getRadius(), GameObjectAsteroid::getMass(body.getSize()));
+        _physicsBodies.push_back(&body);
     }
 
-    // check for offscreen lasers and delete the game object
-    std::vector<int> expiredLaserID;
-    for(auto& laser: _laserHash){
-        if(laser.second->checkOffscreen()){
-            expiredLaserID.push_back(laser.first);
-        }
+    _physics.solve();
+    CMetrics::add(Metric::CONTACT_TESTS, _physics.getPairTests());
+
+    for(int i = 0; i < _physics.getSize(); i++){
+        if(!_physics.isChanged(i)) continue;
+
+        _physicsBodies[i]->setMotion(_physics.getPos(i), CVector(_physics.getVelX(i), _physics.getVelY(i), VectorType::XY));
     }
-    for(int id: expiredLaserID){
-        _laserHash.erase(id);
+}
+
+// rebuild spatial index of asteroid positions
+void AsteroidGame::updateAsteroidGrid()
+{
+    _asteroidGrid.clear();
+    for(auto const& asteroid: _asteroidHash){
+        _asteroidGrid.insert(asteroid.first, asteroid.second->getPos(), asteroid.second->getHalfExtent());
     }
 }
 
-// initialize level with asteroids and ship based on current level
+// fire due timers deleting expired lasers, remove finished explosion animations
+// laser expiry is scheduled when the laser is created so only lasers that actually expire are touched
+void AsteroidGame::deleteExpiredObjects()
+{
+    Uint32 now = SDL_GetTicks();
+    _timers.advance(now);
+    _explosions.update(now);
+}
+
+// initialize level with asteroids and ships based on current level
 void AsteroidGame::initLevel()
 {
+    TRACE_SCOPE("AsteroidGame::initLevel");
 
-    // set number of asteroids equal to current level 
-    int numAsteroid = _currentLevel;
+    // set number of asteroids equal to current level for every screen sized area of the world
+    int screensPerWorld = (AsteroidConstants::WORLD_WIDTH * AsteroidConstants::WORLD_HEIGHT) / (AsteroidConstants::SCREEN_WIDTH * AsteroidConstants::SCREEN_HEIGHT);
+    int numAsteroid = _currentLevel * std::max(screensPerWorld, 1);
 
     // velocity is based on current level multiplier
     double asteroidVelocity = AsteroidConstants::INIT_ASTEROID_VELOCITY * std::pow(AsteroidConstants::ASTEROID_VELOCITY_MULTIPLIER, _currentLevel-1);
 
-    // random starting position
-    Point pos = getRandomCorner();
-
     // random angle for the velocity vector
-    std::random_device rd;
     std::uniform_int_distribution<> randomAngle(0, 360);                
 
-    // create the asteroids and ship
+    // create the ships and the asteroids around them
+    createShips();
+
     AsteroidSize size = AsteroidSize::BIG;
     CTexture& tex = _mainTextures[static_cast<int>(GameObjectAsteroid::getAsteroidTexture(size, _currentColor))];    
 
     for(int i = 0; i < numAsteroid; i++){
-        double angle = static_cast<double>(randomAngle(rd));
+        double angle = static_cast<double>(randomAngle(_rng));
         CVector velocity{asteroidVelocity, angle, VectorType::POLAR};
 
-        createAsteroid(pos, velocity, tex, size, _currentColor);
+        createAsteroid(getRandomSpawnPosition(), velocity, tex, size, _currentColor);
     }
-    createShip();
+    updateAsteroidGrid();
+    _frameCount = 0;
+    _rewindRing.clear();
+    _rewinding = false;
+    for(LocalPlayer& player: _players){
+        player.bot.reset();
+    }
+    _input.clear();
+
+    initHud();
+}
 
+// create level and score text objects for the current level and score
+// every player's score is right aligned in their view
+void AsteroidGame::initHud()
+{
     SDL_Color whiteTextColor{255,255,255,255};
 
     // create font object for level text
@@ -397,39 +1206,57 @@ void AsteroidGame::initLevel()
     std::unique_ptr<GameObject> pGameObject = GameObject::Create(ObjectType::STATIC, levelPos, _fontTextureLevel); 
     _fontObjectLevel = static_unique_ptr_cast<GameObjectStatic, GameObject>(std::move(pGameObject));    
 
-    // create font object for score text
-    ss.str("");
-    ss << "Score: " << std::setw(5) << _score;
-    _fontTextureScore.loadFromRenderedText(*_renderer, _mainFonts[static_cast<int>(FontType::MENU)], ss.str(), whiteTextColor);
-
-    Point scorePos{AsteroidConstants::FONT_SCORE_POS_X, AsteroidConstants::FONT_SCORE_POS_Y};    
-    std::unique_ptr<GameObject> pGameObject2 = GameObject::Create(ObjectType::STATIC, scorePos, _fontTextureScore); 
-    _fontObjectScore = static_unique_ptr_cast<GameObjectStatic, GameObject>(std::move(pGameObject2));
-
+    // create font objects for score text
+    for(LocalPlayer& player: _players){
+        player.scoreTextDirty = false;
+        ss.str("");
+        ss << "Score: " << std::setw(5) << player.score;
+        player.scoreTexture.loadFromRenderedText(*_renderer, _mainFonts[static_cast<int>(FontType::MENU)], ss.str(), whiteTextColor);
+
+        int scoreX = player.viewport.w - (AsteroidConstants::SCREEN_WIDTH - AsteroidConstants::FONT_SCORE_POS_X);
+        Point scorePos{static_cast<double>(scoreX), AsteroidConstants::FONT_SCORE_POS_Y};
+        std::unique_ptr<GameObject> pGameObject2 = GameObject::Create(ObjectType::STATIC, scorePos, player.scoreTexture); 
+        player.scoreObject = static_unique_ptr_cast<GameObjectStatic, GameObject>(std::move(pGameObject2));
+    }
 }
 
-// wrapper for factory method for creating ship object
-void AsteroidGame::createShip()
+// wrapper for factory method for creating the ship of every player in the center of the world
+// on a split screen the ships start side by side, COOP_SHIP_SPACING apart
+void AsteroidGame::createShips()
 {
-    Point pos{AsteroidConstants::SCREEN_WIDTH/2, AsteroidConstants::SCREEN_HEIGHT/2};
     CVector velocity{0,0,VectorType::POLAR};
-
     CTexture& tex = _mainTextures[static_cast<int>(TextureType::TEX_SHIP)];
 
-    std::unique_ptr<GameObject> pGameObject = GameObject::Create(ObjectType::SHIP, pos, tex, velocity);
-    _pShip = static_unique_ptr_cast<GameObjectShip, GameObject>(std::move(pGameObject));
+    int numPlayers = static_cast<int>(_players.size());
+    for(int i = 0; i < numPlayers; i++){
+        double offset = (i - (numPlayers - 1) / 2.0) * AsteroidConstants::COOP_SHIP_SPACING;
+        Point pos{AsteroidConstants::WORLD_WIDTH/2 + offset, AsteroidConstants::WORLD_HEIGHT/2};
 
+        LocalPlayer& player = _players[i];
+        std::unique_ptr<GameObject> pGameObject = GameObject::Create(ObjectType::SHIP, pos, tex, velocity);
+        player.ship = static_unique_ptr_cast<GameObjectShip, GameObject>(std::move(pGameObject));
+        player.ship->setRotationCache(&_shipRotations);
+        player.alive = true;
+
+        player.camera.follow(pos);
+    }
 }
 
-// wrapper for factory method for creating laser objects
-void AsteroidGame::createLaser(Point pos, CVector velocity)
+// wrapper for factory method for creating laser objects, owner is the player credited with its hits
+void AsteroidGame::createLaser(Point pos, CVector velocity, Uint32 spawnTime, int owner)
 {
     CTexture& tex = _mainTextures[static_cast<int>(TextureType::TEX_LASER)];
 
     std::unique_ptr<GameObject> pLaserGO = GameObject::Create(ObjectType::LASER, pos, tex, velocity, velocity.getAngle() + 90);         
     std::unique_ptr<GameObjectLaser> pLaser = static_unique_ptr_cast<GameObjectLaser, GameObject>(std::move(pLaserGO));
-
-    _laserHash.insert(std::make_pair( pLaser->getID(), std::move(pLaser)) );
+    pLaser->setSpawnTime(spawnTime);
+    pLaser->setOwner(owner);
+    pLaser->setRotationCache(&_laserRotations);
+
+    // lasers that did not hit anything are removed once they are out of range
+    int id = pLaser->getID();
+    _laserHash.insert(std::make_pair(id, std::move(pLaser)) );
+    _timers.scheduleAt(spawnTime + AsteroidConstants::LASER_LIFETIME_MS, [this, id]{ _laserHash.erase(id); });
 }
 
 // wrapper for factory method for creating asteroid objects
@@ -443,84 +1270,125 @@ void AsteroidGame::createAsteroid(Point pos, CVector velocity, CTexture& tex, As
     _asteroidHash.insert(std::make_pair(pAsteroid->getID(), std::move(pAsteroid)) );
 }
 
-// wrapper for factory method for creating explosion objects
-void AsteroidGame::createExplosion(Point pos, AsteroidSize size)
+// start an explosion animation, it is removed by deleteExpiredObjects once it has played through
+void AsteroidGame::createExplosion(Point pos, AsteroidSize size, Uint32 spawnTime)
 {   
-    CTexture& tex = _mainTextures[static_cast<int>(TextureType::TEX_EXPLOSION_SPRITE_SHEET)];
-    
-    std::unique_ptr<GameObject> pExplosionGO = GameObject::Create(ObjectType::EXPLOSION, pos, tex);
-    std::unique_ptr<GameObjectExplosion> pExplosion = static_unique_ptr_cast<GameObjectExplosion, GameObject>(std::move(pExplosionGO));
-
-    pExplosion->setSize(size);
+    // the governor limits concurrent animations on slow hosts
+    int maxExplosions = _governor.getSettings().maxExplosions;
+    if(maxExplosions > 0 && _explosions.getCount() >= maxExplosions) return;
 
-    _explosionHash.insert(std::make_pair(pExplosion->getID(), std::move(pExplosion)) );
+    _explosions.spawn(pos, size, spawnTime);
 }
 
 
-// check ship <-> asteroid collision
+// check ship <-> asteroid collision for every ship
+// a crashed ship is out until the next level, the game is over when no ship is left
 void AsteroidGame::checkShipCollision()
 {
-    // check if the bounding box for the ship overlaps with any of the asteroid bounding boxes
-    const SDL_Rect &shipRect = _pShip->getBoundingBox();
-    
-    for(auto const &asteroid: _asteroidHash){
-        const std::vector<SDL_Rect> &boxes = asteroid.second->getBoundingBoxes();
-        for(const SDL_Rect &box: boxes){
-            if(checkCollision(shipRect, box)){
-                _state = GameState::GAMEOVER;
-                return;
-            }
-                
+    bool anyAlive = false;
+    for(LocalPlayer& player: _players){
+        if(!player.alive) continue;
+
+        // check if the bounding box for the ship overlaps with any of the nearby asteroid bounding boxes
+        if(findAsteroidHit(player.ship->getBoundingBox()) < 0){
+            anyAlive = true;
+            continue;
+        }
+
+        // with a single ship the game ends right away
+        player.alive = false;
+        if(_players.size() > 1){
+            createExplosion(player.ship->getPos(), AsteroidSize::BIG, SDL_GetTicks());
+            playExplosionSound();
         }
     }
+
+    if(!anyAlive){
+        _state = GameState::GAMEOVER;
+    }
 }
 
 // check laser <-> asteroid collision
+// consequences are emitted as events and handled in processEvents, the score goes to the player who fired the laser
 void AsteroidGame::checkAsteroidCollision()
 {
-    std::vector<int> asteroidCollideIdx;
-    std::vector<int> laserCollideIdx;
-
-    // iterate through all the onscreen active lasers
+    // iterate through all the active lasers
     for(const auto &laser: _laserHash){
-        const SDL_Rect &laserRect = laser.second->getBoundingBox();
-        bool collide = false;
-
-        // check if current laser collides with an asteroid
-        // if there is a collision store the asteroid and laser IDs
-        for(const auto &asteroid: _asteroidHash){
-            const std::vector<SDL_Rect> &boxes = asteroid.second->getBoundingBoxes();
-            for(const SDL_Rect &box: boxes){
-                if(checkCollision(laserRect, box)){
-                    asteroidCollideIdx.push_back(asteroid.first);
-                    collide = true;
-                    break;
-                }                    
-            }
-            if(collide){
-                laserCollideIdx.push_back(laser.first);
-                break;
+        // check if current laser collides with a nearby asteroid
+        int id = findAsteroidHit(laser.second->getBoundingBox());
+        if(id >= 0){
+            _events.emit(AsteroidDestroyedEvent{id, laser.first});
+            _events.emit(LaserSpentEvent{laser.first});
+            _events.emit(ScoreDeltaEvent{id, AsteroidConstants::SCORE_PER_ASTEROID, laser.second->getOwner()});
+        }
+    }
+}
+
+// ID of a nearby asteroid whose bounding boxes overlap rect, -1 if there is none
+// ships and lasers are checked through the same spatial index query
+int AsteroidGame::findAsteroidHit(const SDL_Rect& rect)
+{
+    _queryResult.clear();
+    _asteroidGrid.query(rect, _queryResult);
+
+    for(int id: _queryResult){
+        // asteroids destroyed since the grid was built are skipped
+        auto it = _asteroidHash.find(id);
+        if(it == _asteroidHash.end()) continue;
+        const std::vector<SDL_Rect> &boxes = it->second->getBoundingBoxes();
+        for(const SDL_Rect &box: boxes){
+            if(checkCollision(rect, box)){
+                return id;
             }
+        }
+    }
+    return -1;
+}
+
+// handle the events emitted this frame in batches
+// an asteroid hit by several lasers in the same frame is only split and scored once
+void AsteroidGame::processEvents()
+{
+    if(_events.empty()) return;
+
+    _events.deduplicate();
 
+    // spawn and explosion: split every destroyed asteroid into smaller ones
+    const std::vector<AsteroidDestroyedEvent>& destroyed = _events.getAsteroidDestroyed();
+    for(const AsteroidDestroyedEvent& event: destroyed){
+        auto it = _asteroidHash.find(event.asteroidID);
+        if(it != _asteroidHash.end()){
+            splitAsteroid(*it->second);
+            _asteroidHash.erase(it);
         }
     }
 
-    // for every destroyed asteroid split it into smaller ones and update score
-    for(int idx: asteroidCollideIdx){
-        splitAsteroid(*_asteroidHash[idx].get());
-        _asteroidHash.erase(idx);
-        updateScore(10);
+    // delete spent lasers
+    for(const LaserSpentEvent& event: _events.getLaserSpent()){
+        _laserHash.erase(event.laserID);
     }
-    // delete colided lasers
-    for(int idx: laserCollideIdx){
-        _laserHash.erase(idx);
+
+    // audio: one explosion sound per frame no matter how many asteroids were hit
+    if(!destroyed.empty()){
+        playExplosionSound();
     }
-   
+
+    // score: credited to the player whose laser hit, each score texture is regenerated once per frame
+    for(int i = 0; i < static_cast<int>(_players.size()); i++){
+        int scoreDelta = _events.getScoreDelta(i);
+        if(scoreDelta != 0){
+            updateScore(i, scoreDelta);
+        }
+    }
+
+    _events.clear();
 }
 
 // check collision between 2 SDL_Rect bounding boxes
-bool AsteroidGame::checkCollision(const SDL_Rect &a, const SDL_Rect &b) const
+bool AsteroidGame::checkCollision(const SDL_Rect &a, const SDL_Rect &b)
 {
+    CMetrics::add(Metric::COLLISION_TESTS);
+
     // calculate the sides of rect A
     int leftA = a.x;
     int rightA = a.x + a.w;
@@ -541,28 +1409,36 @@ bool AsteroidGame::checkCollision(const SDL_Rect &a, const SDL_Rect &b) const
 }
 
 
-// determine velocity vector to create laser after keyboard input
-void AsteroidGame::shootLaser()
+// determine velocity vector to create laser after keyboard input, crashed ships can not shoot
+void AsteroidGame::shootLaser(int player)
 {
-    Point laserPos = _pShip->getPos();
-    double velocityAngle = _pShip->getRotation() - 90;
+    const GameObjectShip& ship = *_players[player].ship;
+    if(!_players[player].alive) return;
+
+    Point laserPos = ship.getPos();
+    double velocityAngle = ship.getRotation() - 90;
 
     CVector velocity{AsteroidConstants::LASER_VELOCITY, velocityAngle, VectorType::POLAR};
 
-    createLaser(laserPos, velocity);
+    createLaser(laserPos, velocity, SDL_GetTicks(), player);
     playLaserSound();    
 }
 
 // split current asteroid into 2 smaller asteroids
 void AsteroidGame::splitAsteroid(GameObjectAsteroid& asteroid)
 {
-    playExplosionSound();
     AsteroidSize currentSize = asteroid.getSize();
     Point pos = asteroid.getPos();
+    CVector currentVelocity = asteroid.getVelocity();
+
+    // debris burst carries some of the asteroid momentum
+    int debrisCount = GameObjectAsteroid::getDebrisCount(currentSize) * _governor.getSettings().particlePercent / 100;
+    _particles.emitBurst(pos, debrisCount, AsteroidConstants::PARTICLE_SPEED,
+                         currentVelocity.getXProjection()/2, currentVelocity.getYProjection()/2, GameObjectAsteroid::getDebrisColor(_currentColor));
 
     // if current asteroid is the smallest size then only create an explosion
     if(currentSize == AsteroidSize::SMALL){
-        createExplosion(pos, currentSize);
+        createExplosion(pos, currentSize, SDL_GetTicks());
         return;
     }
 
@@ -573,11 +1449,10 @@ void AsteroidGame::splitAsteroid(GameObjectAsteroid& asteroid)
     int nextTexIdx = static_cast<int>(GameObjectAsteroid::getAsteroidTexture(nextSize, _currentColor));
     CTexture& tex = _mainTextures[nextTexIdx];
     
-    CVector currentVelocity = asteroid.getVelocity();
     CVector velocity1(currentVelocity.getMag(), currentVelocity.getAngle() - 45, VectorType::POLAR);
     CVector velocity2(currentVelocity.getMag(), currentVelocity.getAngle() + 45, VectorType::POLAR);
 
-    createExplosion(pos, currentSize);
+    createExplosion(pos, currentSize, SDL_GetTicks());
     createAsteroid(pos, velocity1, tex, nextSize, _currentColor);
     createAsteroid(pos, velocity2, tex, nextSize, _currentColor);
 
@@ -594,10 +1469,159 @@ void AsteroidGame::checkLevelCompleted()
 }
 
 
+// copy the current frame into a flat save state, false if it does not fit
+// times of lasers and explosions are kept on the SDL_GetTicks clock, state.time is the time of the capture
+bool AsteroidGame::captureState(SimState& state) const
+{
+    if(_asteroidHash.size() > AsteroidConstants::SIM_MAX_ASTEROIDS || _laserHash.size() > AsteroidConstants::SIM_MAX_LASERS ||
+       _explosions.getCount() > AsteroidConstants::SIM_MAX_EXPLOSIONS){
+        return false;
+    }
+
+    state.level = _currentLevel;
+    state.color = _currentColor;
+    state.done = false;
+    state.time = SDL_GetTicks();
+    state.stepCount = _frameCount;
+    state.nextID = 0;
+    state.rng = _rng;
+
+    state.numShips = static_cast<int>(_players.size());
+    for(int i = 0; i < state.numShips; i++){
+        const LocalPlayer& player = _players[i];
+        CVector shipVelocity = player.ship->getVelocity();
+        state.ships[i] = SimShip{player.ship->getPos(), shipVelocity.getXProjection(), shipVelocity.getYProjection(), player.ship->getRotation(),
+                                 true, player.alive, 0, player.score};
+    }
+
+    state.numAsteroids = 0;
+    for(auto const& asteroid: _asteroidHash){
+        CVector velocity = asteroid.second->getVelocity();
+        state.asteroids[state.numAsteroids++] = SimAsteroid{asteroid.first, asteroid.second->getPos(), velocity.getXProjection(), velocity.getYProjection(),
+                                                            asteroid.second->getSize()};
+    }
+
+    state.numLasers = 0;
+    for(auto const& laser: _laserHash){
+        CVector velocity = laser.second->getVelocity();
+        state.lasers[state.numLasers++] = SimLaser{laser.first, laser.second->getPos(), velocity.getXProjection(), velocity.getYProjection(),
+                                                   laser.second->getSpawnTime() + AsteroidConstants::LASER_LIFETIME_MS, laser.second->getOwner()};
+    }
+
+    state.numExplosions = _explosions.getCount();
+    for(int i = 0; i < state.numExplosions; i++){
+        state.explosions[i] = SimExplosion{_explosions.getPos(i), _explosions.getSize(i), _explosions.getSpawnTime(i)};
+    }
+    return true;
+}
+
+// rebuild the game objects from a save state
+// the textures are looked up again from the saved sizes and color, timers continue with the time that was left when the state was captured,
+// which also moves states saved on an earlier run of the game onto the current clock
+void AsteroidGame::restoreState(const SimState& state)
+{
+    Uint32 now = SDL_GetTicks();
+    Uint32 shift = now - state.time;
+
+    cleanupLevel();
+
+    _currentLevel = state.level;
+    _currentColor = state.color;
+    _frameCount = state.stepCount;
+    _rng = state.rng;
+
+    for(int i = 0; i < state.numShips && i < static_cast<int>(_players.size()); i++){
+        LocalPlayer& player = _players[i];
+        const SimShip& ship = state.ships[i];
+        player.score = ship.score;
+        player.alive = ship.alive;
+        player.ship->restore(ship.pos, ship.rotation);
+        player.camera.follow(ship.pos);
+    }
+
+    for(int i = 0; i < state.numAsteroids; i++){
+        const SimAsteroid& asteroid = state.asteroids[i];
+        CTexture& tex = _mainTextures[static_cast<int>(GameObjectAsteroid::getAsteroidTexture(asteroid.size, _currentColor))];
+        createAsteroid(asteroid.pos, CVector{asteroid.velX, asteroid.velY, VectorType::XY}, tex, asteroid.size, _currentColor);
+    }
+    for(int i = 0; i < state.numLasers; i++){
+        const SimLaser& laser = state.lasers[i];
+        createLaser(laser.pos, CVector{laser.velX, laser.velY, VectorType::XY}, laser.expireTime - AsteroidConstants::LASER_LIFETIME_MS + shift, laser.owner);
+    }
+    for(int i = 0; i < state.numExplosions; i++){
+        const SimExplosion& explosion = state.explosions[i];
+        createExplosion(explosion.pos, explosion.size, explosion.startTime + shift);
+    }
+    updateAsteroidGrid();
+
+    initHud();
+}
+
+// keep the current frame for rewinding, the ring is dropped if the frame is too large for a save state
+// the object counts grow with the level without bound, so overflows are counted in the metrics and printed once
+void AsteroidGame::recordFrame()
+{
+    if(_state != GameState::RUNNING) return;
+
+    _recordOverflow = !captureState(_rewindRing.record(_frameCount));
+    if(_recordOverflow){
+        _rewindRing.clear();
+        CMetrics::add(Metric::REWIND_OVERFLOWS);
+        if(!_recordOverflowReported){
+            std::cout << "Rewind disabled on level " << _currentLevel << ": " << _asteroidHash.size() << " asteroids, " << _laserHash.size()
+                      << " lasers and " << _explosions.getCount() << " explosions exceed the save state capacity of "
+                      << AsteroidConstants::SIM_MAX_ASTEROIDS << ", " << AsteroidConstants::SIM_MAX_LASERS << " and "
+                      << AsteroidConstants::SIM_MAX_EXPLOSIONS << "\n";
+            _recordOverflowReported = true;
+        }
+    }
+}
+
+// step back to the previous recorded frame, the oldest frame is kept once the ring runs out
+void AsteroidGame::rewindFrame()
+{
+    if(_rewindRing.isEmpty()) return;
+
+    if(_rewindRing.getSize() > 1){
+        _rewindRing.discardNewest();
+    }
+    restoreState(*_rewindRing.find(_rewindRing.getNewestFrame()));
+}
+
+// write the current frame to QUICKSAVE_FILE
+void AsteroidGame::quickSave()
+{
+    ALLOC_PHASE(AllocPhase::OTHER);
+    std::unique_ptr<SimState> pState = std::make_unique<SimState>();
+    if(!captureState(*pState)){
+        std::cout << "Too many objects to save the game!\n";
+        return;
+    }
+    if(pState->saveToFile(AsteroidConstants::QUICKSAVE_FILE)){
+        std::cout << "Game saved to " << AsteroidConstants::QUICKSAVE_FILE << "\n";
+    }
+}
+
+// continue from QUICKSAVE_FILE
+void AsteroidGame::quickLoad()
+{
+    ALLOC_PHASE(AllocPhase::OTHER);
+    std::unique_ptr<SimState> pState = std::make_unique<SimState>();
+    if(!pState->loadFromFile(AsteroidConstants::QUICKSAVE_FILE) || pState->numShips != static_cast<int>(_players.size())){
+        return;
+    }
+
+    restoreState(*pState);
+    _rewindRing.clear();
+}
+
 // clean up game objects
 void AsteroidGame::cleanupLevel()
 {
-    _explosionHash.clear();
+    _timers.reset(SDL_GetTicks());
+    _events.clear();
+    _explosions.clear();
+    _particles.clear();
     _laserHash.clear();
     _asteroidHash.clear();
 }
@@ -624,32 +1648,59 @@ void AsteroidGame::cleanup()
 }
 
 // utility function for determining initial position for asteroids
-// randomly give one of the four corners
-Point AsteroidGame::getRandomCorner() const
+// random position in the world that is not too close to any ship
+Point AsteroidGame::getRandomSpawnPosition()
 {
-    std::random_device rd;
-    std::uniform_int_distribution<> rdCorner(0, 3);
-
-    int corner = rdCorner(rd);
-
-    switch(corner){
-        case 0:     return Point{100, 100};
-        case 1:     return Point{100, AsteroidConstants::SCREEN_HEIGHT-100};
-        case 2:     return Point{AsteroidConstants::SCREEN_WIDTH-100, 100};
-        case 3:     return Point{AsteroidConstants::SCREEN_WIDTH-100, AsteroidConstants::SCREEN_HEIGHT-100};
-        default:    return Point{0, 0};
+    std::uniform_real_distribution<> rdX(0, AsteroidConstants::WORLD_WIDTH);
+    std::uniform_real_distribution<> rdY(0, AsteroidConstants::WORLD_HEIGHT);
+
+    // distance to the closest ship across the world wrap
+    auto getShipDistance = [this](const Point& pos){
+        double closest = std::numeric_limits<double>::max();
+        for(const LocalPlayer& player: _players){
+            Point shipPos = player.ship->getPos();
+            closest = std::min(closest, std::hypot(SimWorld::wrapDelta(pos.x - shipPos.x, AsteroidConstants::WORLD_WIDTH),
+                                                   SimWorld::wrapDelta(pos.y - shipPos.y, AsteroidConstants::WORLD_HEIGHT)));
+        }
+        return closest;
+    };
+
+    // after SPAWN_ATTEMPTS the candidate farthest from the ships is used, the loop always ends
+    Point best{0, 0};
+    double bestDistance = -1;
+    for(int attempt = 0; attempt < AsteroidConstants::SPAWN_ATTEMPTS; attempt++){
+        Point pos{rdX(_rng), rdY(_rng)};
+        double distance = getShipDistance(pos);
+        if(distance >= AsteroidConstants::SPAWN_SAFE_RADIUS) return pos;
+        if(distance > bestDistance){
+            best = pos;
+            bestDistance = distance;
+        }
     }
+    return best;
+}
+
+// update score of a player, the score texture is redrawn by refreshScoreText
+void AsteroidGame::updateScore(int player, int scoreIncrease)
+{
+    _players[player].score += scoreIncrease;
+    _players[player].scoreTextDirty = true;
 }
 
-// update score and regenerate score texture
-void AsteroidGame::updateScore(int scoreIncrease)
+// redraw the score textures that changed, the governor spreads the redraws over several frames on slow hosts
+void AsteroidGame::refreshScoreText()
 {
-    _score += scoreIncrease;
+    if(!_governor.isHudRefreshDue(_frameCount)) return;
 
     SDL_Color whiteTextColor{255,255,255,255};
-    std::stringstream ss("");
-    ss << "Score: " << std::setw(5) << _score;
-    _fontTextureScore.loadFromRenderedText(*_renderer, _mainFonts[static_cast<int>(FontType::MENU)], ss.str(), whiteTextColor);
+    for(LocalPlayer& player: _players){
+        if(!player.scoreTextDirty) continue;
+        player.scoreTextDirty = false;
+
+        std::stringstream ss("");
+        ss << "Score: " << std::setw(5) << player.score;
+        player.scoreTexture.loadFromRenderedText(*_renderer, _mainFonts[static_cast<int>(FontType::MENU)], ss.str(), whiteTextColor);
+    }
 }
 
 
@@ -663,11 +1714,22 @@ void AsteroidGame::runMainMenu()
 // display the gave over menu
 void AsteroidGame::runGameOverMenu()
 {
+    // the bot retries the level it lost with the scores reset
+    if(_autopilot){
+        for(LocalPlayer& player: _players){
+            player.score = 0;
+        }
+        _state = GameState::RUNNING;
+        return;
+    }
+
     MenuGameOver gameOverMenu(*_renderer, *_backgroundObject, _mainFonts);
     _state = gameOverMenu.run();
     if(_state == GameState::PLAY_AGAIN){
         _currentLevel = 1;
-        _score = 0;
+        for(LocalPlayer& player: _players){
+            player.score = 0;
+        }
         _state = GameState::RUNNING;
     }
 }
@@ -675,25 +1737,86 @@ void AsteroidGame::runGameOverMenu()
 // display the next level menu
 void AsteroidGame::runNextMenu()
 {
+    if(_autopilot){
+        _state = GameState::RUNNING;
+        return;
+    }
+
     MenuNext nextMenu(*_renderer, *_backgroundObject, _mainFonts);
     _state = nextMenu.run();
 }
     
-// display the pause menu
-void AsteroidGame::runPauseMenu()
+// pause the level, the frame loop keeps running and only draws the pause menu until enter is released
+void AsteroidGame::pauseGame()
+{
+    // menus are not part of the frame allocation budget
+    ALLOC_PHASE(AllocPhase::OTHER);
+    _state = GameState::PAUSED;
+    _rewinding = false;
+    _pauseMenu = std::make_unique<MenuPause>(*_renderer, *_backgroundObject, _mainFonts);
+    _inputLatency.discardPending();
+    _pausedAt = SDL_GetTicks();
+}
+
+// continue the level where it was paused, object times are shifted so nothing jumps by the paused time
+void AsteroidGame::resumeGame()
 {
-    MenuPause pauseMenu(*_renderer, *_backgroundObject, _mainFonts);
-    _state = pauseMenu.run();
+    ALLOC_PHASE(AllocPhase::OTHER);
+    _pauseMenu.reset();
+    _state = GameState::RUNNING;
+    skipTime(SDL_GetTicks() - _pausedAt);
+}
+
+// move every object clock and timer delta ms later, the level continues as if the time in between did not pass
+// objects, IDs and textures are kept as they are, nothing depends on the rewind ring holding the current frame
+void AsteroidGame::skipTime(Uint32 delta)
+{
+    for(auto& player : _players){
+        if(player.ship) player.ship->shiftTime(delta);
+    }
+    for(auto& [id, laser] : _laserHash){
+        laser->shiftTime(delta);
+    }
+    for(auto& [id, asteroid] : _asteroidHash){
+        asteroid->shiftTime(delta);
+    }
+    _explosions.shiftTime(delta);
+    _particles.shiftTime(delta);
+    _timers.shift(delta);
+}
+
+// sleep while the window is hidden, minimized or unfocused, then continue the level where it stopped
+// object times are shifted like after a pause, so nothing jumps by the idle time, a paused level stays paused
+void AsteroidGame::idle()
+{
+    TRACE_SCOPE("idle");
+    ALLOC_PHASE(AllocPhase::OTHER);
+    _rewinding = false;
+    _inputLatency.discardPending();
+
+    Uint32 idleStart = SDL_GetTicks();
+    _input.waitWhileIdle(*_window);
+    resumeAfterIdle(idleStart);
+}
+
+// shift the level clocks over the idle time, a paused level is shifted by the whole paused time when it resumes
+void AsteroidGame::resumeAfterIdle(Uint32 idleStart)
+{
+    if(_state == GameState::RUNNING){
+        skipTime(SDL_GetTicks() - idleStart);
+    }
 }
 
 // play laser sound
 void AsteroidGame::playLaserSound()
 {
     Mix_PlayChannel(-1, _mainSounds[static_cast<int>(SoundType::LASER)], 0);
+    CMetrics::add(Metric::SOUNDS);
 }                      
     
 // play explosion sound
 void AsteroidGame::playExplosionSound()
 {
     Mix_PlayChannel(-1, _mainSounds[static_cast<int>(SoundType::EXPLOSION)], 0);
+    CMetrics::add(Metric::SOUNDS);
 }
\ No newline at end of file
@@ -22,15 +22,41 @@
 #include <string>
 #include <sstream>
 #include <random>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include "constants.h"
 #include "utility.h"
 #include "CTexture.h"
+#include "CCamera.h"
+#include "CSpatialGrid.h"
+#include "CAsteroidPhysics.h"
+#include "CParticleSystem.h"
+#include "CTimerWheel.h"
+#include "CEventBus.h"
+#include "CTracer.h"
+#include "CMetrics.h"
+#include "CAllocTracker.h"
+#include "CPerfCounters.h"
+#include "NetClient.h"
+#include "CRandom.h"
+#include "CRollbackRing.h"
+#include "SimState.h"
+#include "CAutopilot.h"
+#include "CSoakMonitor.h"
+#include "CInputLatency.h"
+#include "CInputQueue.h"
+#include "CSpriteRotations.h"
+#include "CSoftCompositor.h"
+#include "CFrameCapture.h"
+#include "CConfig.h"
+#include "CFrameGovernor.h"
+#include "CExplosionSystem.h"
 #include "GameObject.h"
 #include "GameObjectAsteroid.h"
 #include "GameObjectShip.h"
 #include "GameObjectLaser.h"
-#include "GameObjectExplosion.h"
 #include "GameObjectStatic.h"
 
 #include "MenuMain.h"
@@ -38,6 +64,20 @@
 #include "MenuPause.h"
 #include "MenuNext.h"
 
+// ship, view and score of one local player, split screen co-op has two
+struct LocalPlayer
+{
+    std::unique_ptr<GameObjectShip> ship;
+    CCamera camera;                                 // view into the world, follows the ship
+    SDL_Rect viewport;                              // screen area the view is drawn in
+    bool alive;                                     // false after crashing until the next level starts
+    int score;
+    bool scoreTextDirty;                            // score changed since the score texture was drawn
+    CTexture scoreTexture;                          // loaded font to display score
+    std::unique_ptr<GameObjectStatic> scoreObject;  // loaded texture/object to display score
+    CAutopilot bot;                                 // bot choosing the ship controls in autopilot mode
+};
+
 class AsteroidGame{
 
     public:
@@ -46,6 +86,23 @@ class AsteroidGame{
 
         // top level call to run the game
         void run();                
+        void runNetworkGame(std::uint16_t serverPort);     // join a multiplayer server on the loopback interface
+
+        void setStartLevel(int level);                  // level the first game starts at
+        void enableAutopilot();                         // let the bot play, menus are skipped
+        void enableSoak(Uint32 durationMs);             // play with the bot for durationMs while tracking resource growth
+        bool hasSoakFailed() const;                     // soak test detected a leak or frame time decay
+        void enableSoakIdleCheck();                     // idle after frames over the save state caps during the soak test and fail if objects jump
+        void enableLateInput();                         // poll input as late as possible before the next present
+        void printLatencyReport() const;                // input to present latency per input type
+        bool enableSoftCompositor(bool check);          // compose level frames on the CPU, check compares frames with the SDL renderer
+        bool hasCompositorFailed() const;               // a checked frame differed from the SDL renderer image
+        void printCompositorReport() const;             // frames compared with the SDL renderer and their largest difference
+        bool enableCapture(const std::string& path);    // record level frames to a Y4M or raw RGBA file
+        bool enableGovernor();                          // lower quality when level frames exceed the frame budget, raise it when headroom returns
+        void enableCoop();                              // two local players on a split screen sharing one world
+
+        static bool checkCollision(const SDL_Rect &a, const SDL_Rect &b);   // check collision between 2 SDL_Rect bounding boxes
 
     private:
 
@@ -59,39 +116,68 @@ class AsteroidGame{
         std::string getTexturePath(TextureType type) const; // utility function for getting file paths
         
         void runLevel();                    // main game loop
-
-        void handleInput(SDL_Event &e);     // handle keyboard input             
-        void renderObjects();               // render all active game objects
+        void renderSnapshot(const NetSnapshot& snapshot);       // render a multiplayer snapshot received from the server
+        void renderNetworkEntity(const NetEntity& entity, AsteroidColor color, bool ownShip);
+        void updateMetrics(std::uint64_t frameUs);  // record end of frame gauges and hand the frame to the metrics registry
+        void updateAutopilot();             // set the ship controls chosen by the bots
+        void updateSoak();                  // sample resources for the soak test, ends the game when it is finished or failed
+        void checkIdleResume();             // soak self check, idle after a frame over the save state caps and verify nothing jumps
+        Uint32 getLongestStep(Uint32 now) const;    // longest time any object has not been updated for
+
+        void handleInput();                 // handle keyboard input collected since the last frame
+        void handleShipKey(SDL_Keycode key, bool pressed, Uint32 timestamp);    // move or shoot with the ship of the player the key belongs to
+        void renderObjects();               // render all active game objects inside the camera view of every player
+        void presentFrame();                // show the rendered level frame and time the present
+        void drawObjects(const CCamera& camera);    // draw calls of a level view, recorded by the software compositor when it is enabled
+        void drawObjectsScaled(const CCamera& camera, int percent);    // draw the level into a smaller target and stretch it over the screen
+        void drawHud(const LocalPlayer& player);    // level and score text, always drawn at full resolution
+        void renderBackground(const CCamera& camera);   // tile background image scrolled by the camera position
         void updateObjects();               // update all non-static game objects based on time delta
-        void deleteExpiredObjects();        // delete offscreen lasers or expired explosion animation objects
+        void resolveAsteroidContacts();     // bounce touching asteroids off each other
+        void updateAsteroidGrid();          // rebuild spatial index of asteroid positions
+        void deleteExpiredObjects();        // fire due timers deleting expired lasers, remove finished explosion animations
 
-        void initLevel();                   // initialize level with asteroids and ship based on current level
+        void initLevel();                   // initialize level with asteroids and ships based on current level
+        void initHud();                     // create level and score text objects for the current level and score
 
         // wrappers for static factory method for creating game objects
-        void createShip();
-        void createLaser(Point pos, CVector velocity);
+        void createShips();
+        void createLaser(Point pos, CVector velocity, Uint32 spawnTime, int owner);
         void createAsteroid(Point pos, CVector velocity, CTexture& tex, AsteroidSize size, AsteroidColor color);
-        void createExplosion(Point pos, AsteroidSize size);
+        void createExplosion(Point pos, AsteroidSize size, Uint32 spawnTime);
 
-        void checkShipCollision();                                        // check ship <-> asteroid collision
+        void checkShipCollision();                                        // check ship <-> asteroid collision for every ship
         void checkAsteroidCollision();                                    // check laser <-> asteroid collision
-        bool checkCollision(const SDL_Rect &a, const SDL_Rect &b) const;  // check collision between 2 SDL_Rect bounding boxes
+        int findAsteroidHit(const SDL_Rect& rect);                        // ID of a nearby asteroid overlapping rect, -1 if there is none
+        void processEvents();                                             // handle collision consequences emitted this frame
 
-        void shootLaser();                              // determine velocity vector to create laser after keyboard input
+        void shootLaser(int player);                    // determine velocity vector to create laser after keyboard input
         void splitAsteroid(GameObjectAsteroid& asteroid);   // split current asteroid into 2 smaller asteroid
 
         void checkLevelCompleted();         // check if any asteroids are remaining in the level
 
+        bool captureState(SimState& state) const;   // copy the current frame into a flat save state, false if it does not fit
+        void restoreState(const SimState& state);   // rebuild the game objects from a save state
+        void recordFrame();                         // keep the current frame for rewinding
+        void rewindFrame();                         // step back to the previous recorded frame
+        void quickSave();                           // write the current frame to QUICKSAVE_FILE
+        void quickLoad();                           // continue from QUICKSAVE_FILE
+
         void cleanupLevel();                    // clean up game objects
         void cleanup();                         // clean up fonts/sounds and SDL assets
 
-        Point getRandomCorner() const;              // utility function for determining initial position for asteroids
-        void updateScore(int scoreIncrease);        // update score and regenerate score texture
+        Point getRandomSpawnPosition();             // utility function for determining initial position for asteroids
+        void updateScore(int player, int scoreIncrease);    // update score of a player, the score texture is redrawn by refreshScoreText
+        void refreshScoreText();                    // redraw the score textures that changed if the governor allows it
 
         void runMainMenu();                         // display the main menu
         void runGameOverMenu();                     // display the game over menu
         void runNextMenu();                         // display the next level menu
-        void runPauseMenu();                        // display the pause menu
+        void pauseGame();                           // switch to the paused state and show the pause menu
+        void resumeGame();                          // continue the level where it was paused
+        void skipTime(Uint32 delta);                // move every object clock and timer delta ms later so the level does not jump by delta
+        void idle();                                // sleep while the window is hidden, minimized or unfocused, then continue without a time jump
+        void resumeAfterIdle(Uint32 idleStart);     // shift the level clocks over the idle time, a paused level is shifted when it resumes
 
         void playLaserSound();                      // play laser sound
         void playExplosionSound();                  // play explosion sound
@@ -102,27 +188,63 @@ class AsteroidGame{
         SDL_Renderer_unique_ptr _renderer;      // pointer to the GPU renderer
 
         std::vector<CTexture> _mainTextures;    // vector holding the main loaded textures
+        CSpriteRotations _shipRotations;        // ship sprite pre-rotated to every orientation
+        CSpriteRotations _laserRotations;       // laser sprite pre-rotated to every orientation
         std::vector<TTF_Font*> _mainFonts;      // vector holding the fonts converted by SDL_TTF
         std::vector<Mix_Chunk*> _mainSounds;    // vector holding the loaded sounds
         
         
-        std::unique_ptr<GameObjectShip> _pShip;                                         // Game object for the ship
+        std::vector<LocalPlayer> _players;                                              // ship, view and score of each local player, the first one also plays network games
         std::unordered_map<int, std::unique_ptr<GameObjectLaser>> _laserHash;           // Hashmap for active laser objects with a unique ID as the key
         std::unordered_map<int, std::unique_ptr<GameObjectAsteroid>> _asteroidHash;     // Hashmap for active asteroid objects with a unique ID as the key
-        std::unordered_map<int, std::unique_ptr<GameObjectExplosion>> _explosionHash;   // Hashmap for active explosion objects with a unique ID as the key        
         std::unique_ptr<GameObjectStatic> _backgroundObject;                            // Game object for the background image
+        CExplosionSystem _explosions;                                                   // explosion animations
+        CParticleSystem _particles;                                                     // explosion debris particles
+        CTimerWheel _timers;                                                            // scheduled game events such as object expiry
+        CEventBus _events;                                                              // game events emitted during the current frame
+
+        CSpatialGrid _asteroidGrid;         // spatial index of asteroids used for view culling and collision queries
+        std::vector<int> _queryResult;      // scratch buffer for spatial index queries
+        CAsteroidPhysics _physics;          // elastic contacts between asteroids
+        std::vector<GameObjectAsteroid*> _physicsBodies;    // asteroid of each physics body, in the order they were added
+        unsigned int _frameCount;           // frames run in current level, used to stagger off view updates
+
+        CRandom _rng;                               // random generator for asteroid spawns, part of the save state
+        CRollbackRing<SimState> _rewindRing;        // states of the last REWIND_FRAMES frames
+        bool _rewinding;                            // rewind key is held, frames are played back instead of simulated
+        bool _recordOverflow;                       // the last recorded frame did not fit a save state and the rewind ring was dropped
+        bool _recordOverflowReported;               // the overflow was printed, once per game
+
+        bool _autopilot;                            // ships are controlled by the bots
+        std::vector<AutopilotTarget> _botTargets;   // scratch buffer of asteroids around the ship handed to the bot
+        std::unique_ptr<CSoakMonitor> _soak;        // resource tracking, only set in soak mode
+        bool _soakIdleCheck;                        // idle after frames over the save state caps during the soak test
+        Uint32 _lastIdleCheck;                      // SDL ticks of the last idle check
+
+        CInputQueue _input;                         // input events collected during frame waits, handled at the start of a frame
+        CInputLatency _inputLatency;                // latency from input events to the present showing them
+        bool _lateInput;                            // wait before polling input instead of after presenting
+
+        std::unique_ptr<CSoftCompositor> _compositor;   // CPU compositor for level frames, only set when enabled
+        bool _compositorCheck;                          // compare composed frames with the SDL renderer image
+        std::vector<Uint32> _compositorReference;       // frame drawn by the SDL renderer for the comparison
+
+        std::unique_ptr<CFrameCapture> _capture;        // gameplay recording, only set when enabled
+
+        CFrameGovernor _governor;                       // quality levels chosen from recent frame work times
+        CTexture _scaledTarget;                         // reduced resolution frame while the governor scales rendering
+        std::uint64_t _presentUs;                       // time blocked in SDL_RenderPresent this frame, not counted as work
 
         CTexture _fontTextureLevel;         // loaded font to display level        
         std::unique_ptr<GameObjectStatic> _fontObjectLevel;     // loaded texture/object to display level
 
-        CTexture _fontTextureScore;         // loaded font to display score        
-        std::unique_ptr<GameObjectStatic> _fontObjectScore;      // loaded texture/object to display score
+        std::unique_ptr<MenuPause> _pauseMenu;      // pause menu while the level is paused
+        Uint32 _pausedAt;                           // SDL ticks when the level was paused
 
         GameState _state;                   // Game state enum 
         AsteroidColor _currentColor;        // Asteroid color enum, determines color for current level
 
         int _currentLevel;
-        int _score;
 
         
 
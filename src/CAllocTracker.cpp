@@ -0,0 +1,357 @@
+/* File:            CAllocTracker.cpp
+ * Author:          Vish Potnis
+ * Description:     - Global operator new/delete hooks, every allocation is counted for the ALLOCATIONS metric
+ *                  - Opt-in tracking attributes allocations of the game thread to the current frame phase and to the calling function
+ *                  - Optional SDL memory hooks, per frame phase budgets and a report of the top callsites on exit
+ */
+
+#include "CAllocTracker.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#define ALLOC_TRACKER_CALLSITES
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+
+// global allocation hooks
+void* operator new(std::size_t size)
+{
+    CAllocTracker::countAllocation(size);
+    if(size == 0) size = 1;
+    if(void* p = std::malloc(size)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    CAllocTracker::countAllocation(size);
+    if(size == 0) size = 1;
+    return std::malloc(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+// every replaced operator new allocates with malloc, so all deletes free
+void operator delete(void* p) noexcept                              { std::free(p);}
+void operator delete(void* p, std::size_t) noexcept                 { std::free(p);}
+void operator delete(void* p, const std::nothrow_t&) noexcept       { std::free(p);}
+void operator delete[](void* p) noexcept                            { std::free(p);}
+void operator delete[](void* p, std::size_t) noexcept               { std::free(p);}
+void operator delete[](void* p, const std::nothrow_t&) noexcept     { std::free(p);}
+
+namespace
+{
+    thread_local bool t_tracked = false;        // allocations of this thread are attributed, only the thread that enabled tracking
+    thread_local bool t_inHook = false;         // capturing a call stack can allocate, those allocations are not attributed
+
+    // SDL memory hooks, SDL allocates with malloc by default so memory can be freed by either side
+    void* sdlMalloc(size_t size)
+    {
+        CAllocTracker::countAllocation(size);
+        return std::malloc(size);
+    }
+
+    void* sdlCalloc(size_t count, size_t size)
+    {
+        CAllocTracker::countAllocation(count * size);
+        return std::calloc(count, size);
+    }
+
+    void* sdlRealloc(void* p, size_t size)
+    {
+        CAllocTracker::countAllocation(size);
+        return std::realloc(p, size);
+    }
+
+    void sdlFree(void* p)
+    {
+        std::free(p);
+    }
+
+#ifdef ALLOC_TRACKER_CALLSITES
+    // readable name of a code address and its offset in the module for addr2line
+    std::string describeAddress(void* address)
+    {
+        Dl_info info;
+        if(dladdr(address, &info) == 0 || info.dli_fname == nullptr){
+            std::ostringstream out;
+            out << address;
+            return out.str();
+        }
+
+        std::string name = "??";
+        if(info.dli_sname != nullptr){
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            name = (status == 0 && demangled != nullptr) ? demangled : info.dli_sname;
+            std::free(demangled);
+        }
+
+        const char* module = std::strrchr(info.dli_fname, '/');
+        module = module ? module + 1 : info.dli_fname;
+
+        std::ostringstream out;
+        out << name << " (" << module << "+0x" << std::hex
+            << reinterpret_cast<std::uintptr_t>(address) - reinterpret_cast<std::uintptr_t>(info.dli_fbase) << ")";
+        return out.str();
+    }
+
+    // standard library and allocator frames are skipped to find the function that caused the allocation
+    bool isLibraryFrame(const std::string& description)
+    {
+        std::string function = description.substr(0, description.find('('));
+        return function.find("std::") != std::string::npos || function.find("__gnu_cxx::") != std::string::npos ||
+               function.find("operator new") != std::string::npos || function.find("CAllocTracker::") != std::string::npos ||
+               function.find("sdlMalloc") != std::string::npos || function.find("sdlCalloc") != std::string::npos ||
+               function.find("sdlRealloc") != std::string::npos;
+    }
+#endif
+}
+
+// initialize static variables, all plain data so the hooks work during static initialization
+std::atomic<std::int64_t> CAllocTracker::_allocations{0};
+bool CAllocTracker::_enabled = false;
+bool CAllocTracker::_budgets = false;
+bool CAllocTracker::_failed = false;
+bool CAllocTracker::_phases = false;
+std::atomic<AllocPhase> CAllocTracker::_phase{AllocPhase::OTHER};
+std::uint64_t CAllocTracker::_frames = 0;
+std::uint64_t CAllocTracker::_frameCounts[static_cast<int>(AllocPhase::PHASE_TOTAL)] = {};
+std::uint64_t CAllocTracker::_totalCounts[static_cast<int>(AllocPhase::PHASE_TOTAL)] = {};
+std::uint64_t CAllocTracker::_totalBytes[static_cast<int>(AllocPhase::PHASE_TOTAL)] = {};
+std::uint64_t CAllocTracker::_maxCounts[static_cast<int>(AllocPhase::PHASE_TOTAL)] = {};
+bool CAllocTracker::_overBudget[static_cast<int>(AllocPhase::PHASE_TOTAL)] = {};
+CAllocTracker::Callsite CAllocTracker::_callsites[AsteroidConstants::ALLOC_CALLSITES] = {};
+std::uint64_t CAllocTracker::_untracked = 0;
+
+// attribute allocations of the calling thread to phases and callsites
+// other threads (metrics writer, simulation workers) are only counted in the ALLOCATIONS metric
+void CAllocTracker::enable()
+{
+    t_tracked = true;
+    _enabled = true;
+    _phases = true;
+}
+
+// keep the current frame phase without tracking allocations, used by the profiler
+void CAllocTracker::trackPhases()
+{
+    _phases = true;
+}
+
+// check every frame phase against its budget, implies enable
+void CAllocTracker::enableBudgets()
+{
+    enable();
+    _budgets = true;
+}
+
+// route SDL_malloc and friends through the tracker, call before SDL_Init
+void CAllocTracker::hookSdl()
+{
+    if(SDL_SetMemoryFunctions(sdlMalloc, sdlCalloc, sdlRealloc, sdlFree) != 0){
+        std::cout << "Unable to set SDL memory functions! SDL Error: " << SDL_GetError() << "\n";
+    }
+}
+
+// called by every allocation hook on any thread
+void CAllocTracker::countAllocation(std::size_t size)
+{
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    if(!_enabled || !t_tracked || t_inHook) return;
+
+    int phase = static_cast<int>(getPhase());
+    _frameCounts[phase]++;
+    _totalCounts[phase]++;
+    _totalBytes[phase] += size;
+    recordCallsite(size);
+}
+
+// allocations on all threads since the last call
+std::int64_t CAllocTracker::takeAllocationCount()
+{
+    return _allocations.exchange(0, std::memory_order_relaxed);
+}
+
+// close the per phase counts of the frame and check the budgets
+// allocations between frames (menus, level setup) are counted as OTHER in the next frame and are not budgeted
+void CAllocTracker::endFrame()
+{
+    if(!_enabled) return;
+
+    bool checkBudgets = _budgets && _frames >= static_cast<std::uint64_t>(AsteroidConstants::ALLOC_BUDGET_WARMUP_FRAMES);
+    for(int i = 0; i < static_cast<int>(AllocPhase::PHASE_TOTAL); i++){
+        AllocPhase phase = static_cast<AllocPhase>(i);
+        _maxCounts[i] = std::max(_maxCounts[i], _frameCounts[i]);
+
+        int budget = getBudget(phase);
+        if(checkBudgets && budget >= 0 && _frameCounts[i] > static_cast<std::uint64_t>(budget)){
+            _failed = true;
+            if(!_overBudget[i]){
+                _overBudget[i] = true;
+                std::cout << "ALLOCATION BUDGET EXCEEDED: phase " << getPhaseName(phase) << " allocated " << _frameCounts[i]
+                          << " times in frame " << _frames << ", budget is " << budget << "\n";
+            }
+        }
+        _frameCounts[i] = 0;
+    }
+    _frames++;
+}
+
+// allocations per phase and the top callsites
+void CAllocTracker::printReport()
+{
+    if(!_enabled) return;
+
+    // the report allocates itself, stop tracking first
+    _enabled = false;
+
+    std::cout << "Allocations over " << _frames << " frames\n";
+    std::cout << "  phase        total      bytes    per frame  max frame  budget\n";
+    for(int i = 0; i < static_cast<int>(AllocPhase::PHASE_TOTAL); i++){
+        AllocPhase phase = static_cast<AllocPhase>(i);
+        double perFrame = _frames > 0 ? static_cast<double>(_totalCounts[i]) / _frames : 0;
+        std::cout << "  " << std::left << std::setw(10) << getPhaseName(phase) << std::right
+                  << std::setw(8) << _totalCounts[i] << std::setw(11) << _totalBytes[i]
+                  << std::setw(13) << std::fixed << std::setprecision(2) << perFrame << std::defaultfloat
+                  << std::setw(11) << _maxCounts[i] << std::setw(8);
+        if(getBudget(phase) >= 0) std::cout << getBudget(phase);
+        else std::cout << "-";
+        std::cout << (_overBudget[i] ? "  EXCEEDED\n" : "\n");
+    }
+
+#ifdef ALLOC_TRACKER_CALLSITES
+    std::vector<const Callsite*> sites;
+    for(const Callsite& site: _callsites){
+        if(site.hash != 0) sites.push_back(&site);
+    }
+    std::sort(sites.begin(), sites.end(), [](const Callsite* a, const Callsite* b){ return a->count > b->count;});
+    if(sites.size() > static_cast<std::size_t>(AsteroidConstants::ALLOC_REPORT_TOP)){
+        sites.resize(AsteroidConstants::ALLOC_REPORT_TOP);
+    }
+
+    std::cout << "Top allocation callsites\n";
+    for(const Callsite* site: sites){
+        // the first frame outside the standard library is the callsite, the frame after it gives context
+        int first = 0;
+        std::vector<std::string> frames;
+        for(void* address: site->stack){
+            if(address == nullptr) break;
+            frames.push_back(describeAddress(address));
+        }
+        while(first + 1 < static_cast<int>(frames.size()) && isLibraryFrame(frames[first])) first++;
+
+        std::cout << "  " << std::setw(8) << site->count << " allocs " << std::setw(10) << site->bytes << " bytes  "
+                  << std::left << std::setw(10) << getPhaseName(site->phase) << std::right;
+        std::cout << (frames.empty() ? std::string("??") : frames[first]) << "\n";
+        if(first + 1 < static_cast<int>(frames.size())){
+            std::cout << "  " << std::string(46, ' ') << "called from " << frames[first + 1] << "\n";
+        }
+    }
+    if(_untracked > 0){
+        std::cout << "  " << _untracked << " allocations did not fit in the callsite table\n";
+    }
+#else
+    std::cout << "Allocation callsites are not available on this platform\n";
+#endif
+}
+
+// column names used in the report
+const char* CAllocTracker::getPhaseName(AllocPhase phase)
+{
+    switch(phase){
+        case AllocPhase::OTHER:         return "other";
+        case AllocPhase::INPUT:         return "input";
+        case AllocPhase::UPDATE:        return "update";
+        case AllocPhase::RENDER:        return "render";
+        case AllocPhase::EXPIRY:        return "expiry";
+        case AllocPhase::COLLISION:     return "collision";
+        case AllocPhase::EVENTS:        return "events";
+        case AllocPhase::RECORD:        return "record";
+        default:                        return "";
+    }
+}
+
+// allocations allowed per frame, -1 for no limit
+int CAllocTracker::getBudget(AllocPhase phase)
+{
+    switch(phase){
+        case AllocPhase::INPUT:         return AsteroidConstants::ALLOC_BUDGET_INPUT;
+        case AllocPhase::UPDATE:        return AsteroidConstants::ALLOC_BUDGET_UPDATE;
+        case AllocPhase::RENDER:        return AsteroidConstants::ALLOC_BUDGET_RENDER;
+        case AllocPhase::EXPIRY:        return AsteroidConstants::ALLOC_BUDGET_EXPIRY;
+        case AllocPhase::COLLISION:     return AsteroidConstants::ALLOC_BUDGET_COLLISION;
+        case AllocPhase::EVENTS:        return AsteroidConstants::ALLOC_BUDGET_EVENTS;
+        case AllocPhase::RECORD:        return AsteroidConstants::ALLOC_BUDGET_RECORD;
+        default:                        return -1;
+    }
+}
+
+// capture the call stack of an allocation and add it to its slot
+// the table is a fixed array so recording never allocates
+void CAllocTracker::recordCallsite(std::size_t size)
+{
+#ifdef ALLOC_TRACKER_CALLSITES
+    t_inHook = true;
+
+    // skip this function, the allocation hook frames above it are skipped when the report is printed
+    constexpr int SKIP{1};
+    void* stack[AsteroidConstants::ALLOC_STACK_DEPTH + SKIP] = {};
+    int depth = backtrace(stack, AsteroidConstants::ALLOC_STACK_DEPTH + SKIP);
+
+    // FNV-1a over the return addresses and the phase
+    AllocPhase phase = getPhase();
+    std::uint64_t hash = 14695981039346656037ULL ^ static_cast<std::uint64_t>(phase);
+    for(int i = SKIP; i < depth; i++){
+        hash = (hash ^ reinterpret_cast<std::uintptr_t>(stack[i])) * 1099511628211ULL;
+    }
+    if(hash == 0) hash = 1;
+
+    int mask = AsteroidConstants::ALLOC_CALLSITES - 1;
+    int slot = static_cast<int>(hash & mask);
+    for(int probe = 0; probe < AsteroidConstants::ALLOC_CALLSITES; probe++, slot = (slot + 1) & mask){
+        Callsite& site = _callsites[slot];
+        if(site.hash == 0){
+            site.hash = hash;
+            site.phase = phase;
+            for(int i = SKIP; i < depth; i++){
+                site.stack[i - SKIP] = stack[i];
+            }
+        }
+        if(site.hash == hash){
+            site.count++;
+            site.bytes += size;
+            t_inHook = false;
+            return;
+        }
+    }
+    _untracked++;
+
+    t_inHook = false;
+#else
+    (void)size;
+#endif
+}
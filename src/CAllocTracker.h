@@ -0,0 +1,115 @@
+/* File:            CAllocTracker.h
+ * Author:          Vish Potnis
+ * Description:     - Global operator new/delete hooks, every allocation is counted for the ALLOCATIONS metric
+ *                  - Opt-in tracking attributes allocations of the game thread to the current frame phase and to the calling function
+ *                  - Optional SDL memory hooks, per frame phase budgets and a report of the top callsites on exit
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "constants.h"
+#include "CTracer.h"
+
+// part of the frame an allocation happened in, set with ALLOC_PHASE
+enum class AllocPhase
+{
+    OTHER,              // outside the frame phases: menus, level setup, loading, rewinding
+    INPUT,              // event handling and the autopilot
+    UPDATE,             // object movement and the spatial grid rebuild
+    RENDER,
+    EXPIRY,             // timer wheel callbacks deleting lasers, removal of finished explosions
+    COLLISION,
+    EVENTS,             // collision consequences: splitting asteroids, explosions, score
+    RECORD,             // recording frames into the rewind ring
+    PHASE_TOTAL
+};
+
+#define ALLOC_PHASE(phase) CAllocPhaseScope TRACE_CONCAT(allocPhaseScope, __LINE__)(phase)
+
+class CAllocTracker
+{
+    public:
+        static void enable();                   // attribute allocations of the calling thread to phases and callsites
+        static void trackPhases();              // keep the current frame phase without tracking allocations, used by the profiler
+        static void enableBudgets();            // check every frame phase against its budget, implies enable
+        static void hookSdl();                  // route SDL_malloc and friends through the tracker, call before SDL_Init
+
+        static void endFrame();                 // close the per phase counts of the frame and check the budgets
+        static void printReport();              // allocations per phase and the top callsites
+
+        static void countAllocation(std::size_t size);     // called by every allocation hook on any thread
+        static std::int64_t takeAllocationCount();          // allocations on all threads since the last call
+
+        // getters
+        static bool isEnabled() { return _enabled;}
+        static bool isTrackingPhases() { return _phases;}
+        static bool hasFailed() { return _failed;}
+        static AllocPhase getPhase() { return _phase.load(std::memory_order_relaxed);}
+        static void setPhase(AllocPhase phase) { _phase.store(phase, std::memory_order_relaxed);}
+
+        static const char* getPhaseName(AllocPhase phase);
+        static int getBudget(AllocPhase phase);             // allocations allowed per frame, -1 for no limit
+
+    private:
+
+        // allocations with the same call stack in the same phase
+        struct Callsite
+        {
+            std::uint64_t hash;                             // 0 for an empty slot
+            void* stack[AsteroidConstants::ALLOC_STACK_DEPTH];
+            AllocPhase phase;
+            std::uint64_t count;
+            std::uint64_t bytes;
+        };
+
+        static void recordCallsite(std::size_t size);       // capture the call stack of an allocation and add it to its slot
+
+        static std::atomic<std::int64_t> _allocations;
+        static bool _enabled;
+        static bool _budgets;
+        static bool _failed;
+        static bool _phases;
+        static std::atomic<AllocPhase> _phase;          // atomic so a signal handler on the game thread reads it safely
+
+        static std::uint64_t _frames;
+        static std::uint64_t _frameCounts[static_cast<int>(AllocPhase::PHASE_TOTAL)];    // allocations of the current frame
+        static std::uint64_t _totalCounts[static_cast<int>(AllocPhase::PHASE_TOTAL)];
+        static std::uint64_t _totalBytes[static_cast<int>(AllocPhase::PHASE_TOTAL)];
+        static std::uint64_t _maxCounts[static_cast<int>(AllocPhase::PHASE_TOTAL)];      // most allocations in one frame
+        static bool _overBudget[static_cast<int>(AllocPhase::PHASE_TOTAL)];              // budget failure already reported
+
+        static Callsite _callsites[AsteroidConstants::ALLOC_CALLSITES];  // open addressing table, filled without allocating
+        static std::uint64_t _untracked;                                // allocations that did not fit in the table
+};
+
+// sets the allocation phase for the enclosing scope, costs one branch when phases are not tracked
+class CAllocPhaseScope
+{
+    public:
+        explicit CAllocPhaseScope(AllocPhase phase)
+        {
+            if(CAllocTracker::isTrackingPhases()){
+                _previous = CAllocTracker::getPhase();
+                _active = true;
+                CAllocTracker::setPhase(phase);
+            }
+        }
+
+        ~CAllocPhaseScope()
+        {
+            if(_active){
+                CAllocTracker::setPhase(_previous);
+            }
+        }
+
+        CAllocPhaseScope(const CAllocPhaseScope&) = delete;
+        CAllocPhaseScope& operator=(const CAllocPhaseScope&) = delete;
+
+    private:
+        AllocPhase _previous{AllocPhase::OTHER};
+        bool _active{false};
+};
@@ -0,0 +1,259 @@
+/* File:            CAsteroidPhysics.cpp
+ * Author:          Vish Potnis
+ * Description:     - Elastic contacts between asteroids modelled as circles on the wrapping world
+ *                  - Broad phase is a uniform grid filled by a counting sort, bodies are copied into cell order so neighbours are adjacent in memory
+ *                  - Each pair is tested once, slow bodies sleep and pairs of sleeping bodies are skipped
+ */
+
+#include "CAsteroidPhysics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // wrap one coordinate into [0, size)
+    double wrapCoordinate(double value, double size)
+    {
+        if(value < 0) return value + size;
+        if(value >= size) return value - size;
+        return value;
+    }
+
+    // shortest signed distance across the world wrap
+    double wrapDelta(double delta, double size)
+    {
+        if(delta > size/2) return delta - size;
+        if(delta < -size/2) return delta + size;
+        return delta;
+    }
+}
+
+CAsteroidPhysics::CAsteroidPhysics(int worldWidth, int worldHeight)
+    : _worldWidth(worldWidth), _worldHeight(worldHeight), _cols(1), _rows(1),
+      _cellWidth(worldWidth), _cellHeight(worldHeight), _contacts(0), _pairTests(0)
+{}
+
+// remove all bodies, storage is kept for the next frame
+void CAsteroidPhysics::clear()
+{
+    _posX.clear();
+    _posY.clear();
+    _velX.clear();
+    _velY.clear();
+    _radius.clear();
+    _invMass.clear();
+    _changed.clear();
+    _contacts = 0;
+    _pairTests = 0;
+}
+
+void CAsteroidPhysics::reserve(int count)
+{
+    _posX.reserve(count);
+    _posY.reserve(count);
+    _velX.reserve(count);
+    _velY.reserve(count);
+    _radius.reserve(count);
+    _invMass.reserve(count);
+    _changed.reserve(count);
+}
+
+// add a body, returns its index
+int CAsteroidPhysics::add(const Point& pos, double velX, double velY, double radius, double mass)
+{
+    _posX.push_back(pos.x);
+    _posY.push_back(pos.y);
+    _velX.push_back(velX);
+    _velY.push_back(velY);
+    _radius.push_back(radius);
+    _invMass.push_back(mass > 0 ? 1 / mass : 0);
+    _changed.push_back(0);
+    return static_cast<int>(_posX.size()) - 1;
+}
+
+// resolve contacts between the bodies added since clear
+// one pass in cell order, an impulse is only applied to approaching pairs and overlaps are pushed apart
+void CAsteroidPhysics::solve()
+{
+    _contacts = 0;
+    _pairTests = 0;
+    if(getSize() < 2) return;
+
+    buildGrid();
+
+    // every pair of neighbouring cells is visited once from the cell before it
+    const int offsets[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    for(int cell = 0; cell < _cols * _rows; cell++){
+        if(_cellStart[cell] == _cellStart[cell + 1]) continue;
+
+        solveCell(cell, cell);
+
+        int col = cell % _cols;
+        int row = cell / _cols;
+        for(const auto& offset: offsets){
+            // a single column or row is its own neighbour, those offsets are covered by the cell itself
+            if((_cols == 1 && offset[0] != 0) || (_rows == 1 && offset[1] != 0)) continue;
+
+            int neighbourCol = (col + offset[0] + _cols) % _cols;
+            int neighbourRow = (row + offset[1]) % _rows;
+            solveCell(cell, neighbourRow * _cols + neighbourCol);
+        }
+    }
+
+    // copy the changed bodies back to add order
+    for(int sorted = 0; sorted < getSize(); sorted++){
+        if(!_sortedChanged[sorted]) continue;
+
+        int body = _sortedBody[sorted];
+        _posX[body] = _sortedPosX[sorted];
+        _posY[body] = _sortedPosY[sorted];
+        _velX[body] = _sortedVelX[sorted];
+        _velY[body] = _sortedVelY[sorted];
+        _changed[body] = 1;
+    }
+}
+
+// sort the bodies into cells in memory order
+// cells are at least twice the largest radius, and about as many as there are bodies so sparse fields do not visit empty cells
+void CAsteroidPhysics::buildGrid()
+{
+    const int count = getSize();
+
+    double maxRadius = *std::max_element(_radius.begin(), _radius.end());
+    double cellSize = std::max(2 * maxRadius, std::sqrt(static_cast<double>(_worldWidth) * _worldHeight / count));
+    cellSize = std::max(cellSize, 1.0);
+
+    // with fewer than 3 cells a neighbour would be visited from both sides, so the axis gets a single cell
+    _cols = static_cast<int>(_worldWidth / cellSize);
+    _rows = static_cast<int>(_worldHeight / cellSize);
+    if(_cols < 3) _cols = 1;
+    if(_rows < 3) _rows = 1;
+    _cellWidth = static_cast<double>(_worldWidth) / _cols;
+    _cellHeight = static_cast<double>(_worldHeight) / _rows;
+
+    // counting sort by cell, the counts are summed into the end of each cell and counted back down to its start while placing
+    const int cells = _cols * _rows;
+    _bodyCell.resize(count);
+    _cellStart.assign(cells + 1, 0);
+    for(int i = 0; i < count; i++){
+        int col = std::clamp(static_cast<int>(_posX[i] / _cellWidth), 0, _cols - 1);
+        int row = std::clamp(static_cast<int>(_posY[i] / _cellHeight), 0, _rows - 1);
+        _bodyCell[i] = row * _cols + col;
+        _cellStart[_bodyCell[i]]++;
+    }
+    for(int cell = 1; cell < cells; cell++){
+        _cellStart[cell] += _cellStart[cell - 1];
+    }
+    _cellStart[cells] = count;
+
+    _sortedPosX.resize(count);
+    _sortedPosY.resize(count);
+    _sortedVelX.resize(count);
+    _sortedVelY.resize(count);
+    _sortedRadius.resize(count);
+    _sortedInvMass.resize(count);
+    _sortedAwake.resize(count);
+    _sortedChanged.assign(count, 0);
+    _sortedBody.resize(count);
+
+    // placed back to front so bodies keep their add order within a cell
+    for(int i = count - 1; i >= 0; i--){
+        _sortedBody[--_cellStart[_bodyCell[i]]] = i;
+    }
+
+    const double sleepSpeedSq = AsteroidConstants::CONTACT_SLEEP_SPEED * AsteroidConstants::CONTACT_SLEEP_SPEED;
+    for(int sorted = 0; sorted < count; sorted++){
+        int i = _sortedBody[sorted];
+        _sortedPosX[sorted] = _posX[i];
+        _sortedPosY[sorted] = _posY[i];
+        _sortedVelX[sorted] = _velX[i];
+        _sortedVelY[sorted] = _velY[i];
+        _sortedRadius[sorted] = _radius[i];
+        _sortedInvMass[sorted] = _invMass[i];
+        _sortedAwake[sorted] = _velX[i]*_velX[i] + _velY[i]*_velY[i] >= sleepSpeedSq;
+    }
+}
+
+// resolve contacts between the bodies of two cells, or within one cell
+void CAsteroidPhysics::solveCell(int cell, int neighbour)
+{
+    const int begin = _cellStart[cell];
+    const int end = _cellStart[cell + 1];
+
+    if(cell == neighbour){
+        for(int a = begin; a < end; a++){
+            for(int b = a + 1; b < end; b++){
+                if(_sortedAwake[a] || _sortedAwake[b]) solvePair(a, b);
+            }
+        }
+        return;
+    }
+
+    const int neighbourBegin = _cellStart[neighbour];
+    const int neighbourEnd = _cellStart[neighbour + 1];
+    for(int a = begin; a < end; a++){
+        for(int b = neighbourBegin; b < neighbourEnd; b++){
+            if(_sortedAwake[a] || _sortedAwake[b]) solvePair(a, b);
+        }
+    }
+}
+
+// resolve one pair, indices in cell order
+void CAsteroidPhysics::solvePair(int a, int b)
+{
+    _pairTests++;
+
+    double dx = wrapDelta(_sortedPosX[b] - _sortedPosX[a], _worldWidth);
+    double dy = wrapDelta(_sortedPosY[b] - _sortedPosY[a], _worldHeight);
+    double minDist = _sortedRadius[a] + _sortedRadius[b];
+    double distSq = dx*dx + dy*dy;
+    if(distSq >= minDist*minDist) return;
+
+    _contacts++;
+    double invMassA = _sortedInvMass[a];
+    double invMassB = _sortedInvMass[b];
+    double invMassSum = invMassA + invMassB;
+    if(invMassSum <= 0) return;
+
+    // contact normal from a to b, bodies at the same position are pushed apart along x
+    double dist = std::sqrt(distSq);
+    double nx = dist > 0 ? dx / dist : 1;
+    double ny = dist > 0 ? dy / dist : 0;
+
+    // impulse along the normal while the bodies approach, pairs already separating keep their velocities
+    double approach = (_sortedVelX[b] - _sortedVelX[a])*nx + (_sortedVelY[b] - _sortedVelY[a])*ny;
+    if(approach < 0){
+        double impulse = -(1 + AsteroidConstants::CONTACT_RESTITUTION) * approach / invMassSum;
+        _sortedVelX[a] -= impulse * invMassA * nx;
+        _sortedVelY[a] -= impulse * invMassA * ny;
+        _sortedVelX[b] += impulse * invMassB * nx;
+        _sortedVelY[b] += impulse * invMassB * ny;
+        _sortedAwake[a] = 1;
+        _sortedAwake[b] = 1;
+    }
+
+    // overlap beyond the slop is removed gradually, the lighter body moves further
+    double overlap = minDist - dist - AsteroidConstants::CONTACT_SLOP;
+    if(overlap > 0){
+        double push = overlap * AsteroidConstants::CONTACT_CORRECTION / invMassSum;
+        _sortedPosX[a] = wrapCoordinate(_sortedPosX[a] - push * invMassA * nx, _worldWidth);
+        _sortedPosY[a] = wrapCoordinate(_sortedPosY[a] - push * invMassA * ny, _worldHeight);
+        _sortedPosX[b] = wrapCoordinate(_sortedPosX[b] + push * invMassB * nx, _worldWidth);
+        _sortedPosY[b] = wrapCoordinate(_sortedPosY[b] + push * invMassB * ny, _worldHeight);
+    }
+
+    _sortedChanged[a] = 1;
+    _sortedChanged[b] = 1;
+}
+
+// results of the last solve, by the index returned from add
+bool CAsteroidPhysics::isChanged(int body) const { return _changed[body] != 0;}
+Point CAsteroidPhysics::getPos(int body) const { return Point{_posX[body], _posY[body]};}
+double CAsteroidPhysics::getVelX(int body) const { return _velX[body];}
+double CAsteroidPhysics::getVelY(int body) const { return _velY[body];}
+
+int CAsteroidPhysics::getSize() const { return static_cast<int>(_posX.size());}
+int CAsteroidPhysics::getContacts() const { return _contacts;}
+std::int64_t CAsteroidPhysics::getPairTests() const { return _pairTests;}
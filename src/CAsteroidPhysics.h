@@ -0,0 +1,76 @@
+/* File:            CAsteroidPhysics.h
+ * Author:          Vish Potnis
+ * Description:     - Elastic contacts between asteroids modelled as circles on the wrapping world
+ *                  - Broad phase is a uniform grid filled by a counting sort, bodies are copied into cell order so neighbours are adjacent in memory
+ *                  - Each pair is tested once, slow bodies sleep and pairs of sleeping bodies are skipped
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+#include "utility.h"
+
+class CAsteroidPhysics
+{
+    public:
+        CAsteroidPhysics(int worldWidth, int worldHeight);
+
+        void clear();                                   // remove all bodies, storage is kept for the next frame
+        void reserve(int count);
+        int add(const Point& pos, double velX, double velY, double radius, double mass);    // add a body, returns its index
+
+        void solve();                                   // resolve contacts between the bodies added since clear
+
+        // results of the last solve, by the index returned from add
+        bool isChanged(int body) const;                 // position or velocity changed
+        Point getPos(int body) const;
+        double getVelX(int body) const;
+        double getVelY(int body) const;
+
+        int getSize() const;
+        int getContacts() const;                        // touching pairs found by the last solve
+        std::int64_t getPairTests() const;              // pairs tested by the last solve
+
+    private:
+
+        void buildGrid();                               // sort the bodies into cells in memory order
+        void solveCell(int cell, int neighbour);        // resolve contacts between the bodies of two cells, or within one cell
+        void solvePair(int a, int b);                   // resolve one pair, indices in cell order
+
+        int _worldWidth;
+        int _worldHeight;
+
+        // bodies in the order they were added
+        std::vector<double> _posX;
+        std::vector<double> _posY;
+        std::vector<double> _velX;
+        std::vector<double> _velY;
+        std::vector<double> _radius;
+        std::vector<double> _invMass;
+        std::vector<Uint8> _changed;
+
+        // bodies in cell order while solving
+        std::vector<double> _sortedPosX;
+        std::vector<double> _sortedPosY;
+        std::vector<double> _sortedVelX;
+        std::vector<double> _sortedVelY;
+        std::vector<double> _sortedRadius;
+        std::vector<double> _sortedInvMass;
+        std::vector<Uint8> _sortedAwake;
+        std::vector<Uint8> _sortedChanged;
+        std::vector<int> _sortedBody;                   // index in add order of each sorted body
+
+        // uniform grid, cells are at least twice the largest radius so contacts only span neighbouring cells
+        int _cols;
+        int _rows;
+        double _cellWidth;
+        double _cellHeight;
+        std::vector<int> _bodyCell;                     // cell of each body in add order
+        std::vector<int> _cellStart;                    // first sorted body of each cell, one extra entry for the end
+
+        int _contacts;
+        std::int64_t _pairTests;
+};
@@ -0,0 +1,182 @@
+/* File:            CAutopilot.cpp
+ * Author:          Vish Potnis
+ * Description:     - Bot that plays the game by producing ship controls every frame
+ *                  - Evades asteroids that are about to hit the ship, otherwise aims at the nearest asteroid with lead and shoots
+ *                  - Works on plain positions and velocities so it can drive both the game and the simulation
+ */
+
+#include "CAutopilot.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double PI{3.14159265358979323846};
+
+    // half of the ship size used for the contact distance
+    constexpr double SHIP_RADIUS{AsteroidConstants::SIM_SHIP_H / 2.0};
+
+    // lasers travel this far before expiring
+    constexpr double LASER_RANGE{AsteroidConstants::LASER_VELOCITY * AsteroidConstants::LASER_LIFETIME_MS / 1000.0};
+}
+
+CAutopilot::CAutopilot() : _fired(false), _lastShot(0)
+{}
+
+// forget the shot cooldown, called when a level starts
+void CAutopilot::reset()
+{
+    _fired = false;
+}
+
+// controls for the next frame given the ship and the asteroids around it
+// a threat is escaped along the ship axis, forward or backward whichever is closer to the escape direction
+// without a threat the ship turns towards the lead angle of the nearest asteroid and shoots once it is lined up and in range
+// shots are paced in time, so the fire rate does not depend on the frame rate
+SimControls CAutopilot::update(const Point& shipPos, double shipRotation, const std::vector<AutopilotTarget>& targets, Uint32 now)
+{
+    SimControls controls{};
+    bool canShoot = !_fired || now - _lastShot >= static_cast<Uint32>(AsteroidConstants::AUTOPILOT_FIRE_MS);
+
+    double desired = shipRotation;
+    double diff = 0;
+
+    double dirX = 0;
+    double dirY = 0;
+    int threat = findThreat(targets, shipPos, dirX, dirY);
+    if(threat >= 0){
+        // the ship moves along its axis, the escape direction can be reached facing either way
+        double escape = std::atan2(dirY, dirX) * 180 / PI + 90;
+        double forwardDiff = angleDifference(shipRotation, escape);
+        double backwardDiff = angleDifference(shipRotation, escape + 180);
+        if(std::fabs(forwardDiff) <= std::fabs(backwardDiff)){
+            controls.moveForward = true;
+            diff = forwardDiff;
+        }
+        else{
+            controls.moveBackward = true;
+            diff = backwardDiff;
+        }
+        // keep shooting if the threat happens to be in front of the ship
+        desired = getLeadRotation(targets[threat], shipPos);
+        if(std::fabs(angleDifference(shipRotation, desired)) <= AsteroidConstants::AUTOPILOT_AIM_TOLERANCE && canShoot){
+            controls.shoot = true;
+        }
+    }
+    else{
+        // aim at the nearest asteroid, fly towards it while it is out of laser range
+        int nearest = -1;
+        double nearestDist = 0;
+        for(int i = 0; i < static_cast<int>(targets.size()); i++){
+            double dx = wrapDelta(targets[i].pos.x - shipPos.x, AsteroidConstants::WORLD_WIDTH);
+            double dy = wrapDelta(targets[i].pos.y - shipPos.y, AsteroidConstants::WORLD_HEIGHT);
+            double dist = std::hypot(dx, dy);
+            if(nearest < 0 || dist < nearestDist){
+                nearestDist = dist;
+                nearest = i;
+            }
+        }
+        if(nearest < 0){
+            return controls;
+        }
+        desired = getLeadRotation(targets[nearest], shipPos);
+        diff = angleDifference(shipRotation, desired);
+        if(nearestDist > LASER_RANGE / 2){
+            controls.moveForward = std::fabs(diff) < 90;
+        }
+        if(nearestDist < LASER_RANGE && std::fabs(diff) <= AsteroidConstants::AUTOPILOT_AIM_TOLERANCE && canShoot){
+            controls.shoot = true;
+        }
+    }
+
+    // turn in whole rotation steps, the dead band keeps the ship from oscillating around the target angle
+    if(diff > AsteroidConstants::SHIP_ROTATION_STEP / 2.0){
+        controls.rotateRight = true;
+    }
+    else if(diff < -AsteroidConstants::SHIP_ROTATION_STEP / 2.0){
+        controls.rotateLeft = true;
+    }
+
+    if(controls.shoot){
+        _fired = true;
+        _lastShot = now;
+    }
+    return controls;
+}
+
+// index into targets of the asteroid closest to hitting the ship, -1 if none is a threat
+// an asteroid is a threat if it is already within the safe gap or its closest approach brings it there within AUTOPILOT_EVADE_TIME
+// the escape direction points away from where the asteroid will be at its closest approach
+int CAutopilot::findThreat(const std::vector<AutopilotTarget>& targets, const Point& shipPos, double& dirX, double& dirY)
+{
+    int threat = -1;
+    double threatTime = AsteroidConstants::AUTOPILOT_EVADE_TIME;
+
+    for(int i = 0; i < static_cast<int>(targets.size()); i++){
+        const AutopilotTarget& target = targets[i];
+        double dx = wrapDelta(target.pos.x - shipPos.x, AsteroidConstants::WORLD_WIDTH);
+        double dy = wrapDelta(target.pos.y - shipPos.y, AsteroidConstants::WORLD_HEIGHT);
+        double contact = target.radius + SHIP_RADIUS + AsteroidConstants::AUTOPILOT_SAFE_GAP;
+
+        // time of closest approach with the ship standing still
+        double speed2 = target.velX * target.velX + target.velY * target.velY;
+        double time = 0;
+        if(speed2 > 0){
+            time = std::max(0.0, -(dx * target.velX + dy * target.velY) / speed2);
+        }
+        double missX = dx + target.velX * time;
+        double missY = dy + target.velY * time;
+        if(std::hypot(missX, missY) >= contact || time >= threatTime) continue;
+
+        threatTime = time;
+        threat = i;
+
+        // escape sideways from the asteroid path, straight away from it when it is heading at the ship center
+        dirX = -missX;
+        dirY = -missY;
+        if(std::hypot(dirX, dirY) < 1){
+            dirX = -target.velY;
+            dirY = target.velX;
+        }
+        if(std::hypot(dirX, dirY) < 1){
+            dirX = -dx;
+            dirY = -dy;
+        }
+    }
+    return threat;
+}
+
+// rotation in degrees the ship needs to fire at target so the laser meets it
+// the flight time is refined twice from the predicted meeting point
+double CAutopilot::getLeadRotation(const AutopilotTarget& target, const Point& shipPos)
+{
+    double dx = wrapDelta(target.pos.x - shipPos.x, AsteroidConstants::WORLD_WIDTH);
+    double dy = wrapDelta(target.pos.y - shipPos.y, AsteroidConstants::WORLD_HEIGHT);
+
+    double aimX = dx;
+    double aimY = dy;
+    for(int i = 0; i < 2; i++){
+        double time = std::hypot(aimX, aimY) / AsteroidConstants::LASER_VELOCITY;
+        aimX = dx + target.velX * time;
+        aimY = dy + target.velY * time;
+    }
+    // rotation 0 faces up, lasers fly at rotation - 90 degrees
+    return std::atan2(aimY, aimX) * 180 / PI + 90;
+}
+
+// shortest signed distance across the world wrap
+double CAutopilot::wrapDelta(double delta, double worldSize)
+{
+    if(delta > worldSize / 2) delta -= worldSize;
+    if(delta < -worldSize / 2) delta += worldSize;
+    return delta;
+}
+
+// signed degrees to turn from one rotation to another, in [-180, 180)
+double CAutopilot::angleDifference(double from, double to)
+{
+    double diff = std::fmod(to - from + 180, 360);
+    if(diff < 0) diff += 360;
+    return diff - 180;
+}
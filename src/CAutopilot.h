@@ -0,0 +1,50 @@
+/* File:            CAutopilot.h
+ * Author:          Vish Potnis
+ * Description:     - Bot that plays the game by producing ship controls every frame
+ *                  - Evades asteroids that are about to hit the ship, otherwise aims at the nearest asteroid with lead and shoots
+ *                  - Works on plain positions and velocities so it can drive both the game and the simulation
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "constants.h"
+#include "utility.h"
+#include "SimWorld.h"
+
+// asteroid seen by the autopilot
+struct AutopilotTarget
+{
+    Point pos;
+    double velX;
+    double velY;
+    int radius;         // half extent of the asteroid
+};
+
+class CAutopilot
+{
+    public:
+        CAutopilot();
+
+        // controls for the next frame given the ship and the asteroids around it, positions are world coordinates
+        // now is in SDL ticks and paces the shots
+        SimControls update(const Point& shipPos, double shipRotation, const std::vector<AutopilotTarget>& targets, Uint32 now);
+
+        void reset();                       // forget the shot cooldown, called when a level starts
+
+    private:
+
+        // index into targets of the asteroid closest to hitting the ship, -1 if none is a threat
+        // dirX, dirY is set to the direction the ship should escape in
+        static int findThreat(const std::vector<AutopilotTarget>& targets, const Point& shipPos, double& dirX, double& dirY);
+
+        // rotation in degrees the ship needs to fire at target so the laser meets it
+        static double getLeadRotation(const AutopilotTarget& target, const Point& shipPos);
+
+        static double wrapDelta(double delta, double worldSize);    // shortest signed distance across the world wrap
+        static double angleDifference(double from, double to);      // signed degrees to turn from one rotation to another, in [-180, 180)
+
+        bool _fired;            // shot since the last reset
+        Uint32 _lastShot;       // SDL ticks of the last shot, the next one follows AUTOPILOT_FIRE_MS later
+};
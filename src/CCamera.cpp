@@ -0,0 +1,81 @@
+/* File:            CCamera.cpp
+ * Author:          Vish Potnis
+ * Description:     - Camera object
+ *                  - Maps world space positions to screen space
+ *                  - Follows a target through a world that wraps around at its edges
+ */
+
+#include "CCamera.h"
+#include <cmath>
+
+CCamera::CCamera(int viewWidth, int viewHeight, int worldWidth, int worldHeight)
+    : _center{worldWidth/2.0, worldHeight/2.0}, _viewWidth(viewWidth), _viewHeight(viewHeight),
+      _worldWidth(worldWidth), _worldHeight(worldHeight)
+{}
+
+// center the view on the target world position
+void CCamera::follow(const Point& target)
+{
+    _center = target;
+}
+
+// convert world position to screen position
+// the position is taken from the copy of the world closest to the camera so objects across the wrap are drawn next to the view
+Point CCamera::worldToScreen(const Point& pos) const
+{
+    double x = wrapDelta(pos.x - _center.x, _worldWidth) + _viewWidth/2.0;
+    double y = wrapDelta(pos.y - _center.y, _worldHeight) + _viewHeight/2.0;
+    return Point{x, y};
+}
+
+// convert world rectangle to screen rectangle, wrap is decided by the center of the rectangle
+SDL_Rect CCamera::worldToScreen(const SDL_Rect& rect) const
+{
+    Point center = worldToScreen(Point{rect.x + rect.w/2.0, rect.y + rect.h/2.0});
+    int x = static_cast<int>(std::lround(center.x - rect.w/2.0));
+    int y = static_cast<int>(std::lround(center.y - rect.h/2.0));
+    return SDL_Rect{x, y, rect.w, rect.h};
+}
+
+// check if screen rectangle overlaps the view
+bool CCamera::isVisible(const SDL_Rect& screenRect) const
+{
+    if(screenRect.x + screenRect.w <= 0 || screenRect.x >= _viewWidth)
+        return false;
+    if(screenRect.y + screenRect.h <= 0 || screenRect.y >= _viewHeight)
+        return false;
+    return true;
+}
+
+// check if world position is within the view plus margin
+bool CCamera::isInView(const Point& pos, int margin) const
+{
+    Point screenPos = worldToScreen(pos);
+    if(screenPos.x < -margin || screenPos.x > _viewWidth + margin)
+        return false;
+    if(screenPos.y < -margin || screenPos.y > _viewHeight + margin)
+        return false;
+    return true;
+}
+
+// world rectangle covered by the view, can extend past the world edges
+SDL_Rect CCamera::getViewRect() const
+{
+    int left = static_cast<int>(std::floor(_center.x - _viewWidth/2.0));
+    int top = static_cast<int>(std::floor(_center.y - _viewHeight/2.0));
+    return SDL_Rect{left, top, _viewWidth, _viewHeight};
+}
+
+// getter functions
+Point CCamera::getCenter() const { return _center;}
+int CCamera::getViewWidth() const { return _viewWidth;}
+int CCamera::getViewHeight() const { return _viewHeight;}
+
+// shortest signed distance across the world wrap, result is in [-worldSize/2, worldSize/2)
+double CCamera::wrapDelta(double delta, int worldSize) const
+{
+    double half = worldSize/2.0;
+    delta = std::fmod(delta + half, static_cast<double>(worldSize));
+    if(delta < 0) delta += worldSize;
+    return delta - half;
+}
@@ -0,0 +1,43 @@
+/* File:            CCamera.h
+ * Author:          Vish Potnis
+ * Description:     - Camera object
+ *                  - Maps world space positions to screen space
+ *                  - Follows a target through a world that wraps around at its edges
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include "constants.h"
+#include "utility.h"
+
+class CCamera
+{
+    public:
+        CCamera(int viewWidth, int viewHeight, int worldWidth, int worldHeight);
+
+        void follow(const Point& target);                       // center the view on the target world position
+
+        Point worldToScreen(const Point& pos) const;            // convert world position to screen position
+        SDL_Rect worldToScreen(const SDL_Rect& rect) const;     // convert world rectangle to screen rectangle
+
+        bool isVisible(const SDL_Rect& screenRect) const;       // check if screen rectangle overlaps the view
+        bool isInView(const Point& pos, int margin) const;      // check if world position is within the view plus margin
+
+        // getters
+        SDL_Rect getViewRect() const;       // world rectangle covered by the view, can extend past the world edges
+        Point getCenter() const;
+        int getViewWidth() const;
+        int getViewHeight() const;
+
+    private:
+
+        double wrapDelta(double delta, int worldSize) const;   // shortest signed distance across the world wrap
+
+        Point _center;          // world position at the center of the view
+        int _viewWidth;         // width of the view on screen
+        int _viewHeight;        // height of the view on screen
+        int _worldWidth;        // width of the world
+        int _worldHeight;       // height of the world
+};
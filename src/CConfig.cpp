@@ -0,0 +1,159 @@
+/* File:            CConfig.cpp
+ * Author:          Vish Potnis
+ * Description:     - Settings tuned per host without a rebuild: frame cap, vsync, window size, renderer, audio buffer, threads, pool capacities
+ *                  - Loaded at startup from a config file with key = value lines and from --set key=value flags
+ *                  - Gameplay constants stay in constants.h, the simulation, save files and network protocol depend on them
+ */
+
+#include "CConfig.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+GameConfig CConfig::_config;
+
+namespace
+{
+    // one setting, exactly one of the field pointers is set
+    struct ConfigEntry
+    {
+        const char* name;
+        int GameConfig::* intField;
+        bool GameConfig::* boolField;
+        std::string GameConfig::* stringField;
+        int minValue;           // valid range of int settings
+        int maxValue;
+    };
+
+    const ConfigEntry ENTRIES[] =
+    {
+        {"fps",                 &GameConfig::fps,               nullptr, nullptr, 0, 1000},
+        {"vsync",               nullptr, &GameConfig::vsync,             nullptr, 0, 0},
+        {"idle_throttle",       nullptr, &GameConfig::idleThrottle,      nullptr, 0, 0},
+        {"window_width",        &GameConfig::windowWidth,       nullptr, nullptr, 320, 16384},
+        {"window_height",       &GameConfig::windowHeight,      nullptr, nullptr, 240, 16384},
+        {"renderer",            nullptr, nullptr, &GameConfig::renderer,         0, 0},
+        {"audio_frequency",     &GameConfig::audioFrequency,    nullptr, nullptr, 8000, 192000},
+        {"audio_buffer",        &GameConfig::audioBuffer,       nullptr, nullptr, 64, 65536},
+        {"threads",             &GameConfig::threads,           nullptr, nullptr, 0, 256},
+        {"particle_capacity",   &GameConfig::particleCapacity,  nullptr, nullptr, 0, 10000000},
+        {"rewind_frames",       &GameConfig::rewindFrames,      nullptr, nullptr, 1, 36000},
+        {"input_queue_size",    &GameConfig::inputQueueSize,    nullptr, nullptr, 16, 65536},
+        {"capture_ring_frames", &GameConfig::captureRingFrames, nullptr, nullptr, 2, 256},
+        {"metrics_queue_size",  &GameConfig::metricsQueueSize,  nullptr, nullptr, 16, 1 << 20},
+        {"profile_hz",          &GameConfig::profileHz,         nullptr, nullptr, 1, 10000},
+    };
+
+    // strip spaces and tabs at both ends
+    std::string trim(const std::string& text)
+    {
+        std::size_t first = text.find_first_not_of(" \t\r");
+        if(first == std::string::npos) return "";
+        std::size_t last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+}
+
+// frame time of the frame cap in ms, 0 without a cap
+int GameConfig::getTicksPerFrame() const
+{
+    return fps > 0 ? 1000 / fps : 0;
+}
+
+const GameConfig& CConfig::get() { return _config;}
+
+// apply key = value lines, # starts a comment
+bool CConfig::loadFile(const std::string& path)
+{
+    std::ifstream in(path);
+    if(!in){
+        std::cout << "Unable to open config file " << path << "!\n";
+        return false;
+    }
+
+    bool success = true;
+    std::string line;
+    int lineNumber = 0;
+    while(std::getline(in, line)){
+        lineNumber++;
+        line = trim(line.substr(0, line.find('#')));
+        if(line.empty()) continue;
+
+        std::size_t equals = line.find('=');
+        if(equals == std::string::npos){
+            std::cout << path << ":" << lineNumber << ": expected key = value\n";
+            success = false;
+            continue;
+        }
+        success &= set(trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+    }
+    return success;
+}
+
+// apply one setting, false for unknown keys and invalid values
+bool CConfig::set(const std::string& key, const std::string& value)
+{
+    for(const ConfigEntry& entry: ENTRIES){
+        if(key != entry.name) continue;
+
+        if(entry.intField != nullptr){
+            char* end = nullptr;
+            long number = std::strtol(value.c_str(), &end, 10);
+            if(value.empty() || *end != '\0' || number < entry.minValue || number > entry.maxValue){
+                std::cout << "Config " << key << " must be a number from " << entry.minValue << " to " << entry.maxValue << ", got '" << value << "'\n";
+                return false;
+            }
+            _config.*entry.intField = static_cast<int>(number);
+        }
+        else if(entry.boolField != nullptr){
+            if(value == "1" || value == "true" || value == "on"){
+                _config.*entry.boolField = true;
+            }
+            else if(value == "0" || value == "false" || value == "off"){
+                _config.*entry.boolField = false;
+            }
+            else{
+                std::cout << "Config " << key << " must be true or false, got '" << value << "'\n";
+                return false;
+            }
+        }
+        else{
+            _config.*entry.stringField = value;
+        }
+        return true;
+    }
+
+    std::cout << "Unknown config key " << key << "\n";
+    return false;
+}
+
+// apply "key=value"
+bool CConfig::set(const std::string& assignment)
+{
+    std::size_t equals = assignment.find('=');
+    if(equals == std::string::npos){
+        std::cout << "Expected key=value, got '" << assignment << "'\n";
+        return false;
+    }
+    return set(trim(assignment.substr(0, equals)), trim(assignment.substr(equals + 1)));
+}
+
+// print every setting with its effective value
+void CConfig::print()
+{
+    std::cout << "Effective config:\n";
+    for(const ConfigEntry& entry: ENTRIES){
+        std::cout << "  " << entry.name << " = ";
+        if(entry.intField != nullptr){
+            std::cout << _config.*entry.intField;
+        }
+        else if(entry.boolField != nullptr){
+            std::cout << (_config.*entry.boolField ? "true" : "false");
+        }
+        else{
+            std::cout << _config.*entry.stringField;
+        }
+        std::cout << "\n";
+    }
+}
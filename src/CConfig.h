@@ -0,0 +1,49 @@
+/* File:            CConfig.h
+ * Author:          Vish Potnis
+ * Description:     - Settings tuned per host without a rebuild: frame cap, vsync, window size, renderer, audio buffer, threads, pool capacities
+ *                  - Loaded at startup from a config file with key = value lines and from --set key=value flags
+ *                  - Gameplay constants stay in constants.h, the simulation, save files and network protocol depend on them
+ */
+
+#pragma once
+
+#include <string>
+
+#include "constants.h"
+
+// effective settings, defaults are the values of constants.h
+struct GameConfig
+{
+    int fps{AsteroidConstants::FPS};                            // frame cap, 0 for no cap
+    bool vsync{true};                                           // wait for the display refresh in SDL_RenderPresent
+    bool idleThrottle{true};                                    // stop simulating and drawing while the window is hidden, minimized or unfocused
+    int windowWidth{AsteroidConstants::SCREEN_WIDTH};           // window size, the game is scaled from SCREEN_WIDTH x SCREEN_HEIGHT
+    int windowHeight{AsteroidConstants::SCREEN_HEIGHT};
+    std::string renderer{"auto"};                               // SDL render driver (software, opengl, opengles2, direct3d, metal), auto lets SDL pick
+    int audioFrequency{44100};                                  // mixer sample rate
+    int audioBuffer{2048};                                      // mixer buffer in samples, smaller for less latency
+    int threads{0};                                             // software compositor threads, 0 for one per core
+    int particleCapacity{AsteroidConstants::PARTICLE_MAX};      // live explosion particles
+    int rewindFrames{AsteroidConstants::REWIND_FRAMES};         // frames kept for rewinding
+    int inputQueueSize{AsteroidConstants::INPUT_QUEUE_SIZE};    // input events collected between two frames
+    int captureRingFrames{AsteroidConstants::CAPTURE_RING_FRAMES};  // frames waiting for the capture writer
+    int metricsQueueSize{4096};                                 // frames waiting for the metrics writer
+    int profileHz{AsteroidConstants::PROFILER_HZ};              // samples per second of game thread CPU time with --profile
+
+    int getTicksPerFrame() const;                               // frame time of the frame cap in ms, 0 without a cap
+};
+
+class CConfig
+{
+    public:
+        static const GameConfig& get();
+
+        static bool loadFile(const std::string& path);                      // apply key = value lines, # starts a comment
+        static bool set(const std::string& key, const std::string& value);  // apply one setting, false for unknown keys and invalid values
+        static bool set(const std::string& assignment);                     // apply "key=value"
+
+        static void print();                // print every setting with its effective value
+
+    private:
+        static GameConfig _config;
+};
@@ -0,0 +1,76 @@
+/* File:            CEventBus.cpp
+ * Author:          Vish Potnis
+ * Description:     - Per frame buffer for game events
+ *                  - Collision checks emit events, consequences are handled in one batch later in the frame
+ *                  - Duplicate events for the same object are removed before processing
+ */
+
+#include "CEventBus.h"
+#include <algorithm>
+
+// add events to the current frame, numbered in emit order
+void CEventBus::emit(const AsteroidDestroyedEvent& event)
+{
+    _asteroidDestroyed.push_back(event);
+    _asteroidDestroyed.back().order = static_cast<int>(_asteroidDestroyed.size());
+}
+
+void CEventBus::emit(const LaserSpentEvent& event)
+{
+    _laserSpent.push_back(event);
+    _laserSpent.back().order = static_cast<int>(_laserSpent.size());
+}
+
+void CEventBus::emit(const ScoreDeltaEvent& event)
+{
+    _scoreDelta.push_back(event);
+    _scoreDelta.back().order = static_cast<int>(_scoreDelta.size());
+}
+
+// keep only the first event per object for every event type
+// the emit order breaks ties, so std::sort keeps the first event first without the buffer std::stable_sort allocates
+void CEventBus::deduplicate()
+{
+    std::sort(_asteroidDestroyed.begin(), _asteroidDestroyed.end(),
+        [](const AsteroidDestroyedEvent& a, const AsteroidDestroyedEvent& b){
+            return a.asteroidID < b.asteroidID || (a.asteroidID == b.asteroidID && a.order < b.order); });
+    _asteroidDestroyed.erase(std::unique(_asteroidDestroyed.begin(), _asteroidDestroyed.end(),
+        [](const AsteroidDestroyedEvent& a, const AsteroidDestroyedEvent& b){ return a.asteroidID == b.asteroidID; }), _asteroidDestroyed.end());
+
+    std::sort(_laserSpent.begin(), _laserSpent.end(),
+        [](const LaserSpentEvent& a, const LaserSpentEvent& b){ return a.laserID < b.laserID || (a.laserID == b.laserID && a.order < b.order); });
+    _laserSpent.erase(std::unique(_laserSpent.begin(), _laserSpent.end(),
+        [](const LaserSpentEvent& a, const LaserSpentEvent& b){ return a.laserID == b.laserID; }), _laserSpent.end());
+
+    std::sort(_scoreDelta.begin(), _scoreDelta.end(),
+        [](const ScoreDeltaEvent& a, const ScoreDeltaEvent& b){ return a.sourceID < b.sourceID || (a.sourceID == b.sourceID && a.order < b.order); });
+    _scoreDelta.erase(std::unique(_scoreDelta.begin(), _scoreDelta.end(),
+        [](const ScoreDeltaEvent& a, const ScoreDeltaEvent& b){ return a.sourceID == b.sourceID; }), _scoreDelta.end());
+}
+
+// drop all events, buffer capacity is kept for the next frame
+void CEventBus::clear()
+{
+    _asteroidDestroyed.clear();
+    _laserSpent.clear();
+    _scoreDelta.clear();
+}
+
+// getters
+const std::vector<AsteroidDestroyedEvent>& CEventBus::getAsteroidDestroyed() const { return _asteroidDestroyed;}
+const std::vector<LaserSpentEvent>& CEventBus::getLaserSpent() const { return _laserSpent;}
+
+// sum of the score changes credited to a player
+int CEventBus::getScoreDelta(int player) const
+{
+    int total = 0;
+    for(const ScoreDeltaEvent& event: _scoreDelta){
+        if(event.player == player) total += event.delta;
+    }
+    return total;
+}
+
+bool CEventBus::empty() const
+{
+    return _asteroidDestroyed.empty() && _laserSpent.empty() && _scoreDelta.empty();
+}
@@ -0,0 +1,60 @@
+/* File:            CEventBus.h
+ * Author:          Vish Potnis
+ * Description:     - Per frame buffer for game events
+ *                  - Collision checks emit events, consequences are handled in one batch later in the frame
+ *                  - Duplicate events for the same object are removed before processing
+ */
+
+#pragma once
+
+#include <vector>
+
+// asteroid was hit and has to be split or removed
+struct AsteroidDestroyedEvent
+{
+    int asteroidID;
+    int laserID;        // laser that hit the asteroid
+    int order{0};       // position in the frame, set by emit
+};
+
+// laser hit something and has to be removed
+struct LaserSpentEvent
+{
+    int laserID;
+    int order{0};
+};
+
+// score change caused by an object, only one change per source object is counted
+struct ScoreDeltaEvent
+{
+    int sourceID;
+    int delta;
+    int player;         // player credited with the change
+    int order{0};
+};
+
+class CEventBus
+{
+    public:
+        CEventBus() = default;
+
+        // add events to the current frame
+        void emit(const AsteroidDestroyedEvent& event);
+        void emit(const LaserSpentEvent& event);
+        void emit(const ScoreDeltaEvent& event);
+
+        void deduplicate();         // keep only the first event per object for every event type
+        void clear();               // drop all events, buffer capacity is kept for the next frame
+
+        // getters
+        const std::vector<AsteroidDestroyedEvent>& getAsteroidDestroyed() const;
+        const std::vector<LaserSpentEvent>& getLaserSpent() const;
+        int getScoreDelta(int player) const;    // sum of the score changes credited to a player
+        bool empty() const;
+
+    private:
+
+        std::vector<AsteroidDestroyedEvent> _asteroidDestroyed;
+        std::vector<LaserSpentEvent> _laserSpent;
+        std::vector<ScoreDeltaEvent> _scoreDelta;
+};
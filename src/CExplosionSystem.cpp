@@ -0,0 +1,166 @@
+/* File:            CExplosionSystem.cpp
+ * Author:          Vish Potnis
+ * Description:     - Explosion animations of destroyed asteroids and crashed ships
+ *                  - Explosion attributes are stored as separate arrays (structure of arrays)
+ *                  - All visible explosions are drawn from the sprite sheet with a single geometry call
+ */
+
+#include "CExplosionSystem.h"
+#include "CSoftCompositor.h"
+#include <cmath>
+
+namespace
+{
+    // drawn side length of an explosion based on asteroid size
+    int getDrawnSize(AsteroidSize size)
+    {
+        switch(size){
+            case AsteroidSize::BIG:     return 128;
+            case AsteroidSize::MED:     return 64;
+            case AsteroidSize::SMALL:   return 32;
+            default:                    return 128;
+        }
+    }
+}
+
+CExplosionSystem::CExplosionSystem(int capacity)
+    : _capacity(capacity), _count(0)
+{
+    _posX.resize(capacity);
+    _posY.resize(capacity);
+    _spawnTime.resize(capacity);
+    _size.resize(capacity);
+
+    // every explosion is a quad made of 2 triangles, the index pattern never changes
+    _vertices.resize(capacity * 4);
+    _indices.resize(capacity * 6);
+    for(int i = 0; i < capacity; i++){
+        int v = i * 4;
+        int* idx = &_indices[i * 6];
+        idx[0] = v;     idx[1] = v + 1; idx[2] = v + 2;
+        idx[3] = v + 2; idx[4] = v + 1; idx[5] = v + 3;
+    }
+}
+
+// start an animation at spawnTime, false if all slots are in use
+bool CExplosionSystem::spawn(const Point& pos, AsteroidSize size, Uint32 spawnTime)
+{
+    if(_count >= _capacity) return false;
+
+    int e = _count++;
+    _posX[e] = pos.x;
+    _posY[e] = pos.y;
+    _spawnTime[e] = spawnTime;
+    _size[e] = size;
+    return true;
+}
+
+// remove explosions whose animation has played through, the swapped in explosion is checked again on the next iteration
+void CExplosionSystem::update(const Uint32 updateTime)
+{
+    const Uint32 duration = getAnimationDuration();
+
+    int i = 0;
+    while(i < _count){
+        if(static_cast<Sint32>(updateTime - _spawnTime[i]) >= static_cast<Sint32>(duration)){
+            kill(i);
+        }
+        else{
+            i++;
+        }
+    }
+}
+
+// draw all visible explosions with one geometry call, the sprite is picked from the time since spawn
+// with the software compositor each explosion is recorded as a copy of its sprite
+void CExplosionSystem::render(SDL_Renderer& renderer, const CTexture& spriteSheet, const CCamera& camera)
+{
+    if(_count == 0) return;
+
+    const Uint32 now = SDL_GetTicks();
+    const int columns = spriteSheet.getWidth() / AsteroidConstants::EXPLOSION_SPRITE_WIDTH;
+    const float texWidth = static_cast<float>(spriteSheet.getWidth());
+    const float texHeight = static_cast<float>(spriteSheet.getHeight());
+    const SDL_Color white{255, 255, 255, 255};
+
+    CSoftCompositor* compositor = CSoftCompositor::getActive();
+
+    int numVisible = 0;
+    for(int i = 0; i < _count; i++){
+        Sint32 age = static_cast<Sint32>(now - _spawnTime[i]);
+        int currentClip = age / AsteroidConstants::EXPLOSION_FRAME_MS;
+        if(age < 0 || currentClip >= AsteroidConstants::EXPLOSION_SPRITE_NUM || columns == 0) continue;
+
+        int size = getDrawnSize(_size[i]);
+        int left = static_cast<int>(std::round(_posX[i])) - size/2;
+        int top = static_cast<int>(std::round(_posY[i])) - size/2;
+        SDL_Rect dstRect = camera.worldToScreen(SDL_Rect{left, top, size, size});
+        if(!camera.isVisible(dstRect)) continue;
+
+        SDL_Rect clip{(currentClip % columns) * AsteroidConstants::EXPLOSION_SPRITE_WIDTH, (currentClip / columns) * AsteroidConstants::EXPLOSION_SPRITE_HEIGHT,
+                      AsteroidConstants::EXPLOSION_SPRITE_WIDTH, AsteroidConstants::EXPLOSION_SPRITE_HEIGHT};
+
+        if(compositor != nullptr){
+            spriteSheet.render(renderer, &clip, dstRect);
+            continue;
+        }
+
+        // whole pixel corners and texel edge coordinates sample the same texels as a scaled copy of the clip
+        float x0 = static_cast<float>(dstRect.x);
+        float y0 = static_cast<float>(dstRect.y);
+        float x1 = static_cast<float>(dstRect.x + dstRect.w);
+        float y1 = static_cast<float>(dstRect.y + dstRect.h);
+        float u0 = clip.x / texWidth;
+        float v0 = clip.y / texHeight;
+        float u1 = (clip.x + clip.w) / texWidth;
+        float v1 = (clip.y + clip.h) / texHeight;
+
+        SDL_Vertex* v = &_vertices[numVisible * 4];
+        v[0] = SDL_Vertex{SDL_FPoint{x0, y0}, white, SDL_FPoint{u0, v0}};
+        v[1] = SDL_Vertex{SDL_FPoint{x1, y0}, white, SDL_FPoint{u1, v0}};
+        v[2] = SDL_Vertex{SDL_FPoint{x0, y1}, white, SDL_FPoint{u0, v1}};
+        v[3] = SDL_Vertex{SDL_FPoint{x1, y1}, white, SDL_FPoint{u1, v1}};
+        numVisible++;
+    }
+
+    if(numVisible > 0){
+        SDL_RenderGeometry(&renderer, &spriteSheet.getTexture(), _vertices.data(), numVisible * 4, _indices.data(), numVisible * 6);
+        CMetrics::add(Metric::RENDER_GEOMETRY);
+    }
+}
+
+// move every animation delta ms later, the time in between is not played
+void CExplosionSystem::shiftTime(Uint32 delta)
+{
+    for(int i = 0; i < _count; i++){
+        _spawnTime[i] += delta;
+    }
+}
+
+// remove all explosions
+void CExplosionSystem::clear()
+{
+    _count = 0;
+}
+
+// getters
+int CExplosionSystem::getCount() const { return _count;}
+Point CExplosionSystem::getPos(int idx) const { return Point{_posX[idx], _posY[idx]};}
+AsteroidSize CExplosionSystem::getSize(int idx) const { return _size[idx];}
+Uint32 CExplosionSystem::getSpawnTime(int idx) const { return _spawnTime[idx];}
+
+// time in ms to cycle through all the sprites
+Uint32 CExplosionSystem::getAnimationDuration()
+{
+    return AsteroidConstants::EXPLOSION_SPRITE_NUM * AsteroidConstants::EXPLOSION_FRAME_MS;
+}
+
+// swap remove explosion idx with the last live explosion
+void CExplosionSystem::kill(int idx)
+{
+    int last = --_count;
+    _posX[idx] = _posX[last];
+    _posY[idx] = _posY[last];
+    _spawnTime[idx] = _spawnTime[last];
+    _size[idx] = _size[last];
+}
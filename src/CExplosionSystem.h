@@ -0,0 +1,56 @@
+/* File:            CExplosionSystem.h
+ * Author:          Vish Potnis
+ * Description:     - Explosion animations of destroyed asteroids and crashed ships
+ *                  - Explosion attributes are stored as separate arrays (structure of arrays)
+ *                  - All visible explosions are drawn from the sprite sheet with a single geometry call
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <vector>
+
+#include "constants.h"
+#include "utility.h"
+#include "CCamera.h"
+#include "CTexture.h"
+#include "CMetrics.h"
+
+class CExplosionSystem
+{
+    public:
+        explicit CExplosionSystem(int capacity);
+
+        bool spawn(const Point& pos, AsteroidSize size, Uint32 spawnTime);     // start an animation at spawnTime, false if all slots are in use
+
+        void update(const Uint32 updateTime);                   // remove explosions whose animation has played through
+        void render(SDL_Renderer& renderer, const CTexture& spriteSheet, const CCamera& camera);  // draw all visible explosions with one geometry call
+        void shiftTime(Uint32 delta);                           // move every animation delta ms later, the time in between is not played
+        void clear();                                           // remove all explosions
+
+        // getters, idx is below getCount
+        int getCount() const;
+        Point getPos(int idx) const;
+        AsteroidSize getSize(int idx) const;
+        Uint32 getSpawnTime(int idx) const;
+
+        static Uint32 getAnimationDuration();   // time in ms to cycle through all the sprites
+
+    private:
+
+        void kill(int idx);         // swap remove explosion idx with the last live explosion
+
+        int _capacity;              // maximum number of live explosions
+        int _count;                 // number of live explosions
+
+        // explosion attributes, index i across all arrays is one explosion
+        std::vector<double> _posX;
+        std::vector<double> _posY;
+        std::vector<Uint32> _spawnTime;     // start of the animation
+        std::vector<AsteroidSize> _size;    // size of the asteroid that exploded, picks the drawn size
+
+        // geometry buffers reused every frame
+        std::vector<SDL_Vertex> _vertices;
+        std::vector<int> _indices;      // constant quad index pattern, built once
+};
@@ -0,0 +1,279 @@
+/* File:            CFrameCapture.cpp
+ * Author:          Vish Potnis
+ * Description:     - Records the presented frames to a Y4M video or a raw RGBA file
+ *                  - Frames are read back into a ring of preallocated buffers, color conversion and file writes run on a writer thread
+ *                  - The writer repeats or skips frames so the output has a constant frame rate
+ */
+
+#include "CFrameCapture.h"
+#include "CConfig.h"
+#include "CInputQueue.h"
+#include "CMetrics.h"
+#include "CTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    Uint8 clampByte(int v) { return static_cast<Uint8>(std::min(std::max(v, 0), 255));}
+}
+
+// ARGB8888 pixels to bytes in R, G, B, A order
+void CFrameCapture::convertRgba(const Uint32* src, Uint8* dst, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    // swap the red and blue bytes of 4 pixels at a time, the little endian result is R, G, B, A
+    const __m128i keep = _mm_set1_epi32(0xFF00FF00);
+    const __m128i low = _mm_set1_epi32(0x000000FF);
+    for(; i + 4 <= count; i += 4){
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), low);
+        __m128i b = _mm_slli_epi32(_mm_and_si128(p, low), 16);
+        p = _mm_or_si128(_mm_and_si128(p, keep), _mm_or_si128(r, b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i*4), p);
+    }
+#endif
+    for(; i < count; i++){
+        Uint32 p = src[i];
+        dst[i*4] = (p >> 16) & 0xFF;
+        dst[i*4 + 1] = (p >> 8) & 0xFF;
+        dst[i*4 + 2] = p & 0xFF;
+        dst[i*4 + 3] = p >> 24;
+    }
+}
+
+// luma of one row, Y = (77 R + 150 G + 29 B + 128) / 256, the weights add up to 256 so the sum fits in 16 bits
+void CFrameCapture::convertLuma(const Uint32* src, Uint8* dst, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    // 8 pixels at a time, channels are split into 16 bit lanes
+    const __m128i low = _mm_set1_epi32(0x000000FF);
+    const __m128i weightR = _mm_set1_epi16(77);
+    const __m128i weightG = _mm_set1_epi16(150);
+    const __m128i weightB = _mm_set1_epi16(29);
+    const __m128i round = _mm_set1_epi16(128);
+    for(; i + 8 <= count; i += 8){
+        __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4));
+        __m128i r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), low), _mm_and_si128(_mm_srli_epi32(p1, 16), low));
+        __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), low), _mm_and_si128(_mm_srli_epi32(p1, 8), low));
+        __m128i b = _mm_packs_epi32(_mm_and_si128(p0, low), _mm_and_si128(p1, low));
+
+        __m128i y = _mm_add_epi16(_mm_mullo_epi16(r, weightR), _mm_mullo_epi16(g, weightG));
+        y = _mm_add_epi16(y, _mm_mullo_epi16(b, weightB));
+        y = _mm_srli_epi16(_mm_add_epi16(y, round), 8);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(y, y));
+    }
+#endif
+    for(; i < count; i++){
+        Uint32 p = src[i];
+        dst[i] = (77*((p >> 16) & 0xFF) + 150*((p >> 8) & 0xFF) + 29*(p & 0xFF) + 128) >> 8;
+    }
+}
+
+// Y4M if path ends in .y4m, raw RGBA otherwise, frames of width x height at fps
+CFrameCapture::CFrameCapture(const std::string& path, int width, int height, int fps)
+    : _out(path, std::ios::binary), _format(CaptureFormat::RGBA), _width(width), _height(height), _frameUs(1000000 / fps),
+      _freeSlots(CConfig::get().captureRingFrames), _filledSlots(CConfig::get().captureRingFrames),
+      _heldSlot(-1), _previous(-1), _previousWritten(false), _nextFrameUs(0),
+      _captured(0), _dropped(0), _captureUsTotal(0), _captureUsMax(0),
+      _written(0), _duplicated(0), _skipped(0), _gaps(0), _running(true)
+{
+    if(!_out) return;
+
+    bool y4m = path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+    _format = y4m ? CaptureFormat::Y4M : CaptureFormat::RGBA;
+
+    // all buffers are allocated here, capturing a frame never allocates
+    _slots.resize(CConfig::get().captureRingFrames);
+    for(int i = 0; i < static_cast<int>(_slots.size()); i++){
+        _slots[i].pixels.resize(static_cast<size_t>(width)*height);
+        _freeSlots.push(i);
+    }
+
+    if(_format == CaptureFormat::Y4M){
+        int chromaSize = ((width + 1)/2) * ((height + 1)/2);
+        _converted.resize(static_cast<size_t>(width)*height + 2*chromaSize);
+        // the conversion is full range BT.601, without XCOLORRANGE players assume limited range and crush blacks and whites
+        _out << "YUV4MPEG2 W" << width << " H" << height << " F" << fps << ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+        std::cout << "Capturing Y4M " << width << "x" << height << " at " << fps << " fps to " << path << "\n";
+    }
+    else{
+        _converted.resize(static_cast<size_t>(width)*height*4);
+        std::cout << "Capturing raw RGBA " << width << "x" << height << " at " << fps << " fps to " << path << "\n";
+    }
+
+    _writer = std::thread(&CFrameCapture::writerLoop, this);
+}
+
+// write the remaining frames and print the summary
+CFrameCapture::~CFrameCapture()
+{
+    if(_writer.joinable()){
+        _running = false;
+        _wake.notify_one();
+        _writer.join();
+        printSummary();
+    }
+}
+
+bool CFrameCapture::isOpen() const
+{
+    return _out.is_open();
+}
+
+// read the frame drawn so far into a free ring buffer and hand it to the writer, dropped if the writer is behind
+// must be called before SDL_RenderPresent, the back buffer is undefined after presenting
+void CFrameCapture::captureFrame(SDL_Renderer& renderer)
+{
+    TRACE_SCOPE("captureFrame");
+    std::uint64_t startUs = CInputQueue::nowUs();
+
+    // a slot left over from a failed read back is used first, only the writer returns slots to the free queue
+    int slot = _heldSlot;
+    if(slot < 0 && !_freeSlots.pop(slot)){
+        _dropped++;
+        CMetrics::set(Metric::CAPTURE_TIME_US, 0);
+        return;
+    }
+    _heldSlot = -1;
+
+    CaptureSlot& frame = _slots[slot];
+    // the whole output is read, a rect would be in the scaled coordinates of a resized window
+    if(SDL_RenderReadPixels(&renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, frame.pixels.data(), _width * sizeof(Uint32)) != 0){
+        _heldSlot = slot;
+        _dropped++;
+        return;
+    }
+    frame.timeUs = startUs;
+    _filledSlots.push(slot);
+    _wake.notify_one();
+
+    std::uint64_t captureUs = CInputQueue::nowUs() - startUs;
+    _captured++;
+    _captureUsTotal += captureUs;
+    _captureUsMax = std::max(_captureUsMax, captureUs);
+    CMetrics::set(Metric::CAPTURE_TIME_US, captureUs);
+}
+
+// write frames until stopped
+void CFrameCapture::writerLoop()
+{
+    int slot = 0;
+
+    while(_running){
+        while(_filledSlots.pop(slot)){
+            addFrame(slot);
+        }
+
+        // the game thread notifies without the lock, the timeout covers a missed wake up
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wake.wait_for(lock, std::chrono::milliseconds(5));
+    }
+
+    while(_filledSlots.pop(slot)){
+        addFrame(slot);
+    }
+    if(_previous >= 0 && !_previousWritten){
+        writeFrame(_slots[_previous]);
+    }
+    _out.flush();
+}
+
+// fill the output frames up to this frame with the previous one
+// output frame k shows the newest frame read back before its time, so frames are repeated or skipped to keep the frame rate
+void CFrameCapture::addFrame(int slot)
+{
+    std::uint64_t timeUs = _slots[slot].timeUs;
+
+    if(_previous >= 0){
+        // a pause or menu is cut, the previous frame is shown once
+        if(timeUs > _nextFrameUs + static_cast<std::uint64_t>(AsteroidConstants::CAPTURE_MAX_GAP_MS) * 1000){
+            if(!_previousWritten) writeFrame(_slots[_previous]);
+            _previousWritten = true;
+            _nextFrameUs = timeUs;
+            _gaps++;
+        }
+
+        while(_nextFrameUs < timeUs){
+            if(_previousWritten) _duplicated++;
+            writeFrame(_slots[_previous]);
+            _previousWritten = true;
+            _nextFrameUs += _frameUs;
+        }
+        if(!_previousWritten) _skipped++;
+
+        _freeSlots.push(_previous);
+    }
+    else{
+        _nextFrameUs = timeUs;
+    }
+
+    _previous = slot;
+    _previousWritten = false;
+}
+
+// convert and write one output frame
+void CFrameCapture::writeFrame(const CaptureSlot& slot)
+{
+    const Uint32* pixels = slot.pixels.data();
+
+    if(_format == CaptureFormat::RGBA){
+        convertRgba(pixels, _converted.data(), _width*_height);
+        _out.write(reinterpret_cast<const char*>(_converted.data()), _converted.size());
+        _written++;
+        return;
+    }
+
+    Uint8* luma = _converted.data();
+    for(int y = 0; y < _height; y++){
+        convertLuma(pixels + y*_width, luma + y*_width, _width);
+    }
+
+    // chroma of each 2x2 block, edge pixels are repeated for odd sizes
+    int chromaWidth = (_width + 1)/2;
+    int chromaHeight = (_height + 1)/2;
+    Uint8* cb = luma + _width*_height;
+    Uint8* cr = cb + chromaWidth*chromaHeight;
+    for(int cy = 0; cy < chromaHeight; cy++){
+        const Uint32* row0 = pixels + (2*cy)*_width;
+        const Uint32* row1 = pixels + std::min(2*cy + 1, _height - 1)*_width;
+        for(int cx = 0; cx < chromaWidth; cx++){
+            int x0 = 2*cx;
+            int x1 = std::min(2*cx + 1, _width - 1);
+            Uint32 quad[4] = {row0[x0], row0[x1], row1[x0], row1[x1]};
+            int r = 0, g = 0, b = 0;
+            for(Uint32 p: quad){
+                r += (p >> 16) & 0xFF;
+                g += (p >> 8) & 0xFF;
+                b += p & 0xFF;
+            }
+            r = (r + 2) >> 2;
+            g = (g + 2) >> 2;
+            b = (b + 2) >> 2;
+            cb[cy*chromaWidth + cx] = clampByte(((-43*r - 85*g + 128*b + 128) >> 8) + 128);
+            cr[cy*chromaWidth + cx] = clampByte(((128*r - 107*g - 21*b + 128) >> 8) + 128);
+        }
+    }
+
+    _out << "FRAME\n";
+    _out.write(reinterpret_cast<const char*>(_converted.data()), _converted.size());
+    _written++;
+}
+
+// frames read back, dropped and written
+void CFrameCapture::printSummary() const
+{
+    std::cout << "Capture: " << _captured << " frames read back, mean " << (_captured > 0 ? _captureUsTotal / _captured : 0)
+              << " us max " << _captureUsMax << " us on the game thread, " << _dropped << " dropped with the ring full\n";
+    std::cout << "Capture: " << _written << " frames written, " << _duplicated << " repeated and " << _skipped
+              << " skipped for a constant frame rate, " << _gaps << " pauses cut\n";
+}
@@ -0,0 +1,95 @@
+/* File:            CFrameCapture.h
+ * Author:          Vish Potnis
+ * Description:     - Records the presented frames to a Y4M video or a raw RGBA file
+ *                  - Frames are read back into a ring of preallocated buffers, color conversion and file writes run on a writer thread
+ *                  - The writer repeats or skips frames so the output has a constant frame rate
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "constants.h"
+#include "CSpscQueue.h"
+
+enum class CaptureFormat
+{
+    Y4M,        // YUV 4:2:0 with full range BT.601 colors, playable with ffplay/mpv
+    RGBA        // raw 8 bit RGBA frames without header
+};
+
+class CFrameCapture
+{
+    public:
+        // Y4M if path ends in .y4m, raw RGBA otherwise, frames of width x height at fps
+        CFrameCapture(const std::string& path, int width, int height, int fps);
+        ~CFrameCapture();       // write the remaining frames and print the summary
+
+        CFrameCapture(const CFrameCapture&) = delete;
+        CFrameCapture& operator=(const CFrameCapture&) = delete;
+
+        bool isOpen() const;
+
+        // read the frame drawn so far into a free ring buffer and hand it to the writer, dropped if the writer is behind
+        void captureFrame(SDL_Renderer& renderer);
+
+        static void convertRgba(const Uint32* src, Uint8* dst, int count);     // ARGB8888 pixels to bytes in R, G, B, A order
+        static void convertLuma(const Uint32* src, Uint8* dst, int count);     // luma of one row of ARGB8888 pixels
+
+    private:
+
+        // one ring buffer
+        struct CaptureSlot
+        {
+            std::vector<Uint32> pixels;     // ARGB8888 frame
+            std::uint64_t timeUs;           // time the frame was read back
+        };
+
+        void writerLoop();                  // write frames until stopped
+        void addFrame(int slot);            // fill the output frames up to this frame with the previous one
+        void writeFrame(const CaptureSlot& slot);   // convert and write one output frame
+        void printSummary() const;
+
+        std::ofstream _out;
+        CaptureFormat _format;
+        int _width;
+        int _height;
+        std::uint64_t _frameUs;             // output frame interval
+
+        std::vector<CaptureSlot> _slots;
+        CSpscQueue<int> _freeSlots;         // slots the game thread can read into, returned by the writer
+        CSpscQueue<int> _filledSlots;       // slots waiting for the writer
+        int _heldSlot;                      // free slot kept by the game thread after a failed read back, -1 if none
+
+        // writer thread state
+        std::vector<Uint8> _converted;      // output frame after color conversion
+        int _previous;                      // slot shown until the next frame arrives, -1 before the first frame
+        bool _previousWritten;
+        std::uint64_t _nextFrameUs;         // time of the next output frame
+
+        // statistics, game thread
+        std::uint64_t _captured;
+        std::uint64_t _dropped;             // no free slot, the writer was behind
+        std::uint64_t _captureUsTotal;
+        std::uint64_t _captureUsMax;
+
+        // statistics, writer thread, read after it stopped
+        std::uint64_t _written;
+        std::uint64_t _duplicated;          // output frames repeating a frame to keep the frame rate
+        std::uint64_t _skipped;             // frames replaced by a newer one within the same output frame
+        std::uint64_t _gaps;                // pauses cut from the output
+
+        std::atomic<bool> _running;
+        std::mutex _wakeMutex;              // only used to park the writer thread between frames
+        std::condition_variable _wake;
+        std::thread _writer;
+};
@@ -0,0 +1,154 @@
+/* File:            CFrameGovernor.cpp
+ * Author:          Vish Potnis
+ * Description:     - Keeps level frames within the frame budget on slow hosts by stepping through quality levels
+ *                  - Watches the work time of recent frames, lowers quality quickly and raises it again only after sustained headroom
+ *                  - Every change is logged with the measurement that caused it
+ */
+
+#include "CFrameGovernor.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    const QualitySettings LEVELS[] =
+    {
+        {"full quality",                                                100, 100, 0, 1, 1},
+        {"half the particles, 16 explosions, score text every 8 frames", 100, 50, 16, 8, 1},
+        {"75% render resolution",                                       75, 50, 16, 8, 1},
+        {"50% render resolution, quarter of the particles, 8 explosions", 50, 25, 8, 16, 1},
+        {"half frame rate, simulation steps of two frames",             50, 25, 8, 16, 2},
+    };
+    static_assert(sizeof(LEVELS)/sizeof(LEVELS[0]) == static_cast<int>(QualityLevel::QUALITY_TOTAL), "one entry per quality level");
+
+    double toMs(std::uint64_t us) { return static_cast<double>(us) / 1000;}
+}
+
+CFrameGovernor::CFrameGovernor()
+    : _enabled(false), _allowScaling(false), _budgetUs(0), _level(0), _underWindows(0),
+      _recoverWindows(AsteroidConstants::GOVERNOR_RECOVER_WINDOWS), _recovering(false), _framesAtLevel{}, _changes(0)
+{}
+
+// print the frames spent at each level
+CFrameGovernor::~CFrameGovernor()
+{
+    if(!_enabled) return;
+
+    std::cout << "Governor: " << _changes << " quality changes, frames per level:";
+    for(int i = 0; i < static_cast<int>(QualityLevel::QUALITY_TOTAL); i++){
+        std::cout << " " << i << ":" << _framesAtLevel[i];
+    }
+    std::cout << "\n";
+}
+
+// start governing frames of budgetUs, render scaling is skipped if the frames cannot be drawn to a smaller target
+void CFrameGovernor::enable(std::uint64_t budgetUs, bool allowScaling)
+{
+    _enabled = true;
+    _allowScaling = allowScaling;
+    _budgetUs = budgetUs;
+    _window.reserve(AsteroidConstants::GOVERNOR_WINDOW_FRAMES);
+    _sorted.reserve(AsteroidConstants::GOVERNOR_WINDOW_FRAMES);
+
+    std::cout << "Governor: frame budget " << std::fixed << std::setprecision(1) << toMs(budgetUs) << std::defaultfloat << " ms"
+              << (allowScaling ? "" : ", render scaling unavailable") << "\n";
+}
+
+bool CFrameGovernor::isEnabled() const { return _enabled;}
+
+// add the work time of a frame, a decision is made every GOVERNOR_WINDOW_FRAMES frames
+void CFrameGovernor::addFrame(std::uint64_t workUs)
+{
+    if(!_enabled) return;
+
+    _framesAtLevel[_level]++;
+    _window.push_back(workUs);
+    if(static_cast<int>(_window.size()) >= AsteroidConstants::GOVERNOR_WINDOW_FRAMES){
+        decide();
+        _window.clear();
+    }
+}
+
+QualityLevel CFrameGovernor::getLevel() const { return static_cast<QualityLevel>(_level);}
+
+// levers of the current level, full resolution if scaling is not allowed
+QualitySettings CFrameGovernor::getSettings() const
+{
+    QualitySettings settings = LEVELS[_level];
+    if(!_allowScaling) settings.renderPercent = 100;
+    return settings;
+}
+
+// the score text may be redrawn this frame, on every hudInterval-th frame
+bool CFrameGovernor::isHudRefreshDue(std::uint64_t frame) const
+{
+    return frame % LEVELS[_level].hudInterval == 0;
+}
+
+// compare the window with the budget and step the level
+// a level is lowered after one window over budget, it is raised only after _recoverWindows windows with clear headroom
+// the thresholds differ, so a level that just fits does not flip back and forth
+void CFrameGovernor::decide()
+{
+    _sorted.assign(_window.begin(), _window.end());
+    auto p90 = _sorted.begin() + _sorted.size() * 9 / 10;
+    std::nth_element(_sorted.begin(), p90, _sorted.end());
+    std::uint64_t p90Us = *p90;
+
+    // the half rate level has twice the time per frame, raising it must fit the full rate budget
+    std::uint64_t levelBudgetUs = _budgetUs * LEVELS[_level].frameInterval;
+    bool over = p90Us * 100 > levelBudgetUs * AsteroidConstants::GOVERNOR_OVER_PERCENT;
+    bool under = p90Us * 100 < _budgetUs * AsteroidConstants::GOVERNOR_UNDER_PERCENT;
+
+    if(over){
+        // a recovery that did not hold makes the next one wait longer
+        if(_recovering){
+            _recoverWindows = std::min(_recoverWindows * 2, AsteroidConstants::GOVERNOR_MAX_RECOVER_WINDOWS);
+        }
+        _recovering = false;
+        _underWindows = 0;
+        int next = getNextLevel(1);
+        if(next != _level){
+            setLevel(next, p90Us, "above", AsteroidConstants::GOVERNOR_OVER_PERCENT, levelBudgetUs);
+        }
+        return;
+    }
+
+    if(_recovering){
+        _recovering = false;
+        _recoverWindows = AsteroidConstants::GOVERNOR_RECOVER_WINDOWS;
+    }
+
+    _underWindows = under ? _underWindows + 1 : 0;
+    if(_underWindows >= _recoverWindows && _level > 0){
+        _underWindows = 0;
+        _recovering = true;
+        setLevel(getNextLevel(-1), p90Us, "below", AsteroidConstants::GOVERNOR_UNDER_PERCENT, _budgetUs);
+    }
+}
+
+// log the change with the measurement and the threshold it crossed
+void CFrameGovernor::setLevel(int level, std::uint64_t p90Us, const char* direction, int percent, std::uint64_t budgetUs)
+{
+    _level = level;
+    _changes++;
+
+    std::cout << "Governor: work p90 " << std::fixed << std::setprecision(1) << toMs(p90Us) << " ms " << direction << " " << percent << "% of the "
+              << toMs(budgetUs) << std::defaultfloat << " ms budget, level " << level << ": " << LEVELS[level].description;
+    if(!_allowScaling && LEVELS[level].renderPercent < 100){
+        std::cout << " (at full resolution)";
+    }
+    std::cout << "\n";
+}
+
+// neighbouring level, the 75% level is skipped without scaling
+int CFrameGovernor::getNextLevel(int step) const
+{
+    int level = std::clamp(_level + step, 0, static_cast<int>(QualityLevel::QUALITY_TOTAL) - 1);
+    if(!_allowScaling && level == static_cast<int>(QualityLevel::RENDER_SCALE_75)){
+        level = std::clamp(level + step, 0, static_cast<int>(QualityLevel::QUALITY_TOTAL) - 1);
+    }
+    return level;
+}
@@ -0,0 +1,76 @@
+/* File:            CFrameGovernor.h
+ * Author:          Vish Potnis
+ * Description:     - Keeps level frames within the frame budget on slow hosts by stepping through quality levels
+ *                  - Watches the work time of recent frames, lowers quality quickly and raises it again only after sustained headroom
+ *                  - Every change is logged with the measurement that caused it
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+
+// quality levels from full quality down, each keeps the levers of the previous one
+enum class QualityLevel
+{
+    FULL,
+    REDUCED_EFFECTS,        // fewer particles and explosions, score text redrawn less often
+    RENDER_SCALE_75,        // frames drawn at 75% resolution and stretched to the screen
+    RENDER_SCALE_50,        // 50% resolution, fewer particles again
+    HALF_RATE,              // half frame rate, the simulation takes steps of two frames, game speed is unchanged since movement, turning and bot shots are timed
+    QUALITY_TOTAL
+};
+
+// levers applied at one quality level
+struct QualitySettings
+{
+    const char* description;
+    int renderPercent;      // render resolution in percent of the screen size
+    int particlePercent;    // share of debris particles emitted
+    int maxExplosions;      // concurrent explosion animations, 0 for no limit
+    int hudInterval;        // frames between score text redraws
+    int frameInterval;      // frame cap intervals per frame, only gameplay timed in ms keeps its speed at more than 1
+};
+
+class CFrameGovernor
+{
+    public:
+        CFrameGovernor();
+        ~CFrameGovernor();      // print the frames spent at each level
+
+        // start governing frames of budgetUs, render scaling is skipped if the frames cannot be drawn to a smaller target
+        void enable(std::uint64_t budgetUs, bool allowScaling);
+        bool isEnabled() const;
+
+        void addFrame(std::uint64_t workUs);        // add the work time of a frame, may change the level
+
+        QualityLevel getLevel() const;
+        QualitySettings getSettings() const;        // levers of the current level, full resolution if scaling is not allowed
+        bool isHudRefreshDue(std::uint64_t frame) const;    // the score text may be redrawn this frame
+
+    private:
+
+        void decide();                              // compare the window with the budget and step the level
+        // log the change with the measurement and the threshold it crossed
+        void setLevel(int level, std::uint64_t p90Us, const char* direction, int percent, std::uint64_t budgetUs);
+        int getNextLevel(int step) const;           // neighbouring level, the 75% level is skipped without scaling
+
+        bool _enabled;
+        bool _allowScaling;
+        std::uint64_t _budgetUs;                    // work time of one frame at the full frame rate
+        int _level;
+
+        std::vector<std::uint64_t> _window;         // work times since the last decision
+        std::vector<std::uint64_t> _sorted;         // scratch for the percentile
+        int _underWindows;                          // windows in a row below the raise threshold
+        int _recoverWindows;                        // windows needed to raise the level
+        bool _recovering;                           // the level was just raised, a step down in the next window doubles _recoverWindows
+
+        std::array<std::uint64_t, static_cast<int>(QualityLevel::QUALITY_TOTAL)> _framesAtLevel;
+        int _changes;
+};
@@ -0,0 +1,140 @@
+/* File:            CInputLatency.cpp
+ * Author:          Vish Potnis
+ * Description:     - Measures input to present latency: from the SDL event timestamp to the SDL_RenderPresent of the first frame showing its effect
+ *                  - Latency histograms are kept per input type and printed as a report
+ *                  - Optional late input sampling: waits after a present so input is polled as late as possible before the next one
+ */
+
+#include "CInputLatency.h"
+#include "CConfig.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+CInputLatency::CInputLatency()
+    : _pending(), _numPending(0), _histogram(), _counts(), _sums(), _max(), _workStart(0), _workEstimate(0), _lastPresent(0)
+{}
+
+// input with its SDL event time was applied to the game state this frame
+// inputs beyond INPUT_LATENCY_PENDING in one frame are not measured
+void CInputLatency::addInput(InputType type, Uint32 timestamp)
+{
+    if(_numPending < AsteroidConstants::INPUT_LATENCY_PENDING){
+        _pending[_numPending++] = PendingInput{type, timestamp};
+    }
+}
+
+// forget inputs not yet presented, e.g. after a menu
+void CInputLatency::discardPending()
+{
+    _numPending = 0;
+}
+
+// frame work starts, input is polled next
+void CInputLatency::beginWork(Uint32 now)
+{
+    _workStart = now;
+}
+
+// frame is rendered, about to present
+// the estimate follows slow changes and rises at once when a frame takes longer
+void CInputLatency::endWork(Uint32 now)
+{
+    double work = static_cast<double>(now - _workStart);
+    _workEstimate = std::max(work, _workEstimate * 0.9 + work * 0.1);
+}
+
+// pending inputs are visible, add their latency to the histograms
+void CInputLatency::onPresent(Uint32 now)
+{
+    for(int i = 0; i < _numPending; i++){
+        int type = static_cast<int>(_pending[i].type);
+        Uint32 latency = now - std::min(_pending[i].timestamp, now);
+
+        int bucket = std::min<int>(latency, AsteroidConstants::INPUT_LATENCY_BUCKETS - 1);
+        _histogram[type][bucket]++;
+        _counts[type]++;
+        _sums[type] += latency;
+        _max[type] = std::max(_max[type], latency);
+    }
+    _numPending = 0;
+    _lastPresent = now;
+}
+
+// ms to wait before polling input so the frame is ready just before the next present
+// the next present is expected one frame after the last one, the wait leaves room for the estimated work and a safety margin
+// frames also start at least one frame apart so the frame rate stays capped without vsync
+Uint32 CInputLatency::getLateSampleDelay(Uint32 now) const
+{
+    if(_lastPresent == 0) return 0;
+
+    int lead = static_cast<int>(std::ceil(_workEstimate)) + AsteroidConstants::INPUT_LATE_MARGIN_MS;
+    int ticksPerFrame = CConfig::get().getTicksPerFrame();
+    int target = static_cast<int>(_lastPresent - now) + ticksPerFrame - lead;
+    int cap = static_cast<int>(_workStart - now) + ticksPerFrame;
+    return static_cast<Uint32>(std::clamp(std::max(target, cap), 0, ticksPerFrame));
+}
+
+// latency percentiles and histogram per input type
+void CInputLatency::printReport() const
+{
+    std::cout << "Input to present latency (ms)\n";
+    std::cout << "  input          count    mean   p50   p95   p99   max\n";
+    for(int type = 0; type < static_cast<int>(InputType::INPUT_TOTAL); type++){
+        if(_counts[type] == 0) continue;
+
+        std::cout << "  " << std::left << std::setw(14) << getInputName(static_cast<InputType>(type)) << std::right
+                  << std::setw(6) << _counts[type]
+                  << std::setw(8) << std::fixed << std::setprecision(1) << static_cast<double>(_sums[type]) / _counts[type] << std::defaultfloat
+                  << std::setw(6) << getPercentile(type, 0.50) << std::setw(6) << getPercentile(type, 0.95)
+                  << std::setw(6) << getPercentile(type, 0.99) << std::setw(6) << _max[type] << "\n";
+    }
+
+    // histogram of all inputs in 4 ms rows
+    std::uint64_t rows[AsteroidConstants::INPUT_LATENCY_BUCKETS / 4 + 1] = {};
+    std::uint64_t largest = 0;
+    for(int type = 0; type < static_cast<int>(InputType::INPUT_TOTAL); type++){
+        for(int bucket = 0; bucket < AsteroidConstants::INPUT_LATENCY_BUCKETS; bucket++){
+            rows[bucket / 4] += _histogram[type][bucket];
+        }
+    }
+    int lastRow = -1;
+    for(int row = 0; row <= AsteroidConstants::INPUT_LATENCY_BUCKETS / 4; row++){
+        largest = std::max(largest, rows[row]);
+        if(rows[row] > 0) lastRow = row;
+    }
+    for(int row = 0; row <= lastRow; row++){
+        int bar = static_cast<int>(rows[row] * 50 / largest);
+        std::cout << "  " << std::setw(3) << row * 4 << "-" << std::left << std::setw(4) << row * 4 + 3 << std::right
+                  << std::setw(7) << rows[row] << " " << std::string(bar, '#') << "\n";
+    }
+}
+
+// names used in the report
+const char* CInputLatency::getInputName(InputType type)
+{
+    switch(type){
+        case InputType::ROTATE_LEFT:        return "rotate left";
+        case InputType::ROTATE_RIGHT:       return "rotate right";
+        case InputType::MOVE_FORWARD:       return "move forward";
+        case InputType::MOVE_BACKWARD:      return "move backward";
+        case InputType::RELEASE:            return "release";
+        case InputType::SHOOT:              return "shoot";
+        default:                            return "";
+    }
+}
+
+// latency in ms below which fraction of the samples fall
+int CInputLatency::getPercentile(int type, double fraction) const
+{
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(fraction * _counts[type]));
+    std::uint64_t seen = 0;
+    for(int bucket = 0; bucket < AsteroidConstants::INPUT_LATENCY_BUCKETS; bucket++){
+        seen += _histogram[type][bucket];
+        if(seen >= rank) return bucket;
+    }
+    return AsteroidConstants::INPUT_LATENCY_BUCKETS - 1;
+}
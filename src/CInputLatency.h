@@ -0,0 +1,68 @@
+/* File:            CInputLatency.h
+ * Author:          Vish Potnis
+ * Description:     - Measures input to present latency: from the SDL event timestamp to the SDL_RenderPresent of the first frame showing its effect
+ *                  - Latency histograms are kept per input type and printed as a report
+ *                  - Optional late input sampling: waits after a present so input is polled as late as possible before the next one
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <cstdint>
+
+#include "constants.h"
+
+// player inputs that change the game state
+enum class InputType
+{
+    ROTATE_LEFT,
+    ROTATE_RIGHT,
+    MOVE_FORWARD,
+    MOVE_BACKWARD,
+    RELEASE,            // a rotate or move key released
+    SHOOT,
+    INPUT_TOTAL
+};
+
+class CInputLatency
+{
+    public:
+        CInputLatency();
+
+        void addInput(InputType type, Uint32 timestamp);    // input with its SDL event time was applied to the game state this frame
+        void discardPending();                              // forget inputs not yet presented, e.g. after a menu
+
+        void beginWork(Uint32 now);             // frame work starts, input is polled next
+        void endWork(Uint32 now);               // frame is rendered, about to present
+        void onPresent(Uint32 now);             // pending inputs are visible, add their latency to the histograms
+
+        Uint32 getLateSampleDelay(Uint32 now) const;    // ms to wait before polling input so the frame is ready just before the next present
+
+        void printReport() const;               // latency percentiles and histogram per input type
+
+        static const char* getInputName(InputType type);
+
+    private:
+
+        struct PendingInput
+        {
+            InputType type;
+            Uint32 timestamp;
+        };
+
+        // latency in ms below which fraction of the samples fall
+        int getPercentile(int type, double fraction) const;
+
+        PendingInput _pending[AsteroidConstants::INPUT_LATENCY_PENDING];    // inputs applied since the last present
+        int _numPending;
+
+        std::uint64_t _histogram[static_cast<int>(InputType::INPUT_TOTAL)][AsteroidConstants::INPUT_LATENCY_BUCKETS];  // 1 ms buckets, last one holds everything longer
+        std::uint64_t _counts[static_cast<int>(InputType::INPUT_TOTAL)];
+        std::uint64_t _sums[static_cast<int>(InputType::INPUT_TOTAL)];
+        Uint32 _max[static_cast<int>(InputType::INPUT_TOTAL)];
+
+        Uint32 _workStart;          // SDL ticks when the current frame started polling input
+        double _workEstimate;       // smoothed ms from polling input to presenting
+        Uint32 _lastPresent;        // SDL ticks after the last present, 0 before the first one
+};
@@ -0,0 +1,99 @@
+/* File:            CInputQueue.cpp
+ * Author:          Vish Potnis
+ * Description:     - Keyboard and quit events collected as soon as they arrive and handed to the game at frame boundaries
+ *                  - Events are stamped with a microsecond clock when they are collected, the SDL event time is kept as well
+ *                  - Waiting for the next frame wakes on input instead of sleeping through it
+ *                  - While the window is hidden, minimized or unfocused the game sleeps until SDL has a new event
+ */
+
+#include "CInputQueue.h"
+#include "CConfig.h"
+
+CInputQueue::CInputQueue() : _queue(CConfig::get().inputQueueSize), _dropped(0)
+{}
+
+// move pending SDL events into the queue
+void CInputQueue::pump()
+{
+    SDL_Event event;
+    while(SDL_PollEvent(&event) != 0){
+        collect(event);
+    }
+}
+
+// wait until SDL_GetTicks reaches deadline, collecting events the moment they arrive
+// replaces SDL_Delay so input that arrives during the frame wait gets a precise collection time
+void CInputQueue::waitUntil(Uint32 deadline)
+{
+    SDL_Event event;
+    while(true){
+        Uint32 now = SDL_GetTicks();
+        if(static_cast<Sint32>(deadline - now) <= 0) break;
+
+        if(SDL_WaitEventTimeout(&event, static_cast<int>(deadline - now)) != 0){
+            collect(event);
+        }
+    }
+    pump();
+}
+
+// sleep in SDL_WaitEvent until the window is usable again or the game is quit, collecting events
+// SDL updates the window flags before it queues the window event, so they are current after every wake up
+void CInputQueue::waitWhileIdle(SDL_Window& window)
+{
+    SDL_Event event;
+    while(isIdle(window) && SDL_WaitEvent(&event) != 0){
+        collect(event);
+        if(event.type == SDL_QUIT) break;
+    }
+}
+
+// oldest collected event, false if there is none
+bool CInputQueue::pop(InputEvent& event)
+{
+    return _queue.pop(event);
+}
+
+// drop collected events, e.g. when a level starts
+void CInputQueue::clear()
+{
+    InputEvent event;
+    while(_queue.pop(event)){}
+}
+
+// events lost because the queue was full
+std::uint64_t CInputQueue::getDropped() const { return _dropped;}
+
+// microsecond clock used for collection times
+std::uint64_t CInputQueue::nowUs()
+{
+    // split into seconds and remainder so the multiplication cannot overflow
+    static const std::uint64_t frequency = SDL_GetPerformanceFrequency();
+    std::uint64_t counter = SDL_GetPerformanceCounter();
+    return counter / frequency * 1000000 + counter % frequency * 1000000 / frequency;
+}
+
+// window hidden, minimized or without input focus, false if idle_throttle is off
+bool CInputQueue::isIdle(SDL_Window& window)
+{
+    if(!CConfig::get().idleThrottle) return false;
+
+    Uint32 flags = SDL_GetWindowFlags(&window);
+    return (flags & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED)) != 0 || (flags & SDL_WINDOW_INPUT_FOCUS) == 0;
+}
+
+// add one SDL event if the game handles its type
+void CInputQueue::collect(const SDL_Event& event)
+{
+    if(event.type != SDL_KEYDOWN && event.type != SDL_KEYUP && event.type != SDL_QUIT) return;
+
+    InputEvent input;
+    input.type = event.type;
+    input.key = event.type == SDL_QUIT ? SDLK_UNKNOWN : event.key.keysym.sym;
+    input.repeat = event.type != SDL_QUIT && event.key.repeat != 0;
+    input.timestamp = event.common.timestamp;
+    input.collectedUs = nowUs();
+    if(!_queue.push(input)){
+        _dropped++;
+    }
+}
@@ -0,0 +1,52 @@
+/* File:            CInputQueue.h
+ * Author:          Vish Potnis
+ * Description:     - Keyboard and quit events collected as soon as they arrive and handed to the game at frame boundaries
+ *                  - Events are stamped with a microsecond clock when they are collected, the SDL event time is kept as well
+ *                  - Waiting for the next frame wakes on input instead of sleeping through it
+ *                  - While the window is hidden, minimized or unfocused the game sleeps until SDL has a new event
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <cstdint>
+
+#include "constants.h"
+#include "CSpscQueue.h"
+
+// input event as seen by the game
+struct InputEvent
+{
+    Uint32 type;                // SDL_KEYDOWN, SDL_KEYUP or SDL_QUIT
+    SDL_Keycode key;
+    bool repeat;                // key held down, not a new press
+    Uint32 timestamp;           // SDL event time in ms
+    std::uint64_t collectedUs;  // time the event was taken from SDL, CInputQueue::nowUs clock
+};
+
+class CInputQueue
+{
+    public:
+        CInputQueue();
+
+        // producer: must run on the thread that created the window, SDL only delivers events there
+        void pump();                            // move pending SDL events into the queue
+        void waitUntil(Uint32 deadline);        // wait until SDL_GetTicks reaches deadline, collecting events the moment they arrive
+        void waitWhileIdle(SDL_Window& window); // sleep in SDL_WaitEvent until the window is usable again or the game is quit, collecting events
+
+        // consumer
+        bool pop(InputEvent& event);            // oldest collected event, false if there is none
+        void clear();                           // drop collected events, e.g. when a level starts
+
+        std::uint64_t getDropped() const;       // events lost because the queue was full
+        static std::uint64_t nowUs();           // microsecond clock used for collection times
+        static bool isIdle(SDL_Window& window); // window hidden, minimized or without input focus, false if idle_throttle is off
+
+    private:
+
+        void collect(const SDL_Event& event);   // add one SDL event if the game handles its type
+
+        CSpscQueue<InputEvent> _queue;
+        std::uint64_t _dropped;
+};
@@ -0,0 +1,230 @@
+/* File:            CMetrics.cpp
+ * Author:          Vish Potnis
+ * Description:     - Registry of per frame counters and gauges
+ *                  - Counters are reset every frame, gauges keep their last value
+ *                  - Optional sink streams every frame as a CSV or NDJSON row from a background thread
+ *                  - Optional endpoint serves running totals and histograms to scrapers, see CMetricsServer
+ */
+
+#include "CMetrics.h"
+#include "CAllocTracker.h"
+#include "CConfig.h"
+#include "CMetricsServer.h"
+
+#include <chrono>
+#include <iostream>
+
+// initialize static variables
+std::int64_t CMetrics::_values[static_cast<int>(Metric::METRIC_TOTAL)] = {};
+std::uint64_t CMetrics::_frame = 0;
+std::unique_ptr<CMetricsSink> CMetrics::_sink;
+std::unique_ptr<CMetricsServer> CMetrics::_server;
+MetricsSnapshot CMetrics::_snapshot{};
+
+// getter
+std::int64_t CMetrics::get(Metric metric) { return _values[static_cast<int>(metric)];}
+
+// time of one run of a frame phase, only kept for the endpoint
+void CMetrics::addPhaseTime(AllocPhase phase, std::uint64_t us)
+{
+    _snapshot.phaseTimeUs[static_cast<int>(phase)] += us;
+    _snapshot.phaseRuns[static_cast<int>(phase)]++;
+}
+
+// snapshot metrics for the frame, send to the sink and the endpoint and reset counters
+void CMetrics::endFrame(std::uint64_t timeMs)
+{
+    set(Metric::ALLOCATIONS, CAllocTracker::takeAllocationCount());
+
+    if(_server){
+        // totals are kept here so a scrape that misses frames still sees all of them
+        _snapshot.frame++;
+        _snapshot.timeMs = timeMs;
+        for(int i = 0; i < static_cast<int>(Metric::METRIC_TOTAL); i++){
+            _snapshot.values[i] = _values[i];
+            if(isCounter(static_cast<Metric>(i))) _snapshot.totals[i] += _values[i];
+        }
+
+        std::int64_t frameTime = get(Metric::FRAME_TIME_US);
+        _snapshot.frameTimeSumUs += static_cast<std::uint64_t>(frameTime);
+        for(int i = 0; i < AsteroidConstants::METRICS_FRAME_BUCKETS; i++){
+            if(frameTime <= AsteroidConstants::METRICS_FRAME_BOUNDS_US[i]){
+                _snapshot.frameTimeBuckets[i]++;
+                break;
+            }
+        }
+
+        _server->getWriteBuffer() = _snapshot;
+        _server->publish();
+    }
+
+    if(_sink){
+        MetricsSample sample;
+        sample.frame = _frame;
+        sample.timeMs = timeMs;
+        for(int i = 0; i < static_cast<int>(Metric::METRIC_TOTAL); i++){
+            sample.values[i] = _values[i];
+        }
+        _sink->push(sample);
+    }
+
+    for(int i = 0; i < static_cast<int>(Metric::METRIC_TOTAL); i++){
+        if(isCounter(static_cast<Metric>(i))){
+            _values[i] = 0;
+        }
+    }
+    _frame++;
+}
+
+// stream frames to path, CSV if it ends in .csv otherwise NDJSON
+bool CMetrics::enableSink(const std::string& path)
+{
+    bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+
+    _sink = std::make_unique<CMetricsSink>(path, csv, CConfig::get().metricsQueueSize);
+    if(!_sink->isOpen()){
+        std::cout << "Unable to open metrics file " << path << "!\n";
+        _sink.reset();
+        return false;
+    }
+    return true;
+}
+
+// serve metrics on 127.0.0.1:<port> or a Unix socket path
+bool CMetrics::enableServer(const std::string& address)
+{
+    _server = std::make_unique<CMetricsServer>();
+    if(!_server->open(address)){
+        _server.reset();
+        return false;
+    }
+    _snapshot = MetricsSnapshot{};
+    return true;
+}
+
+// flush and close the sink, stop the endpoint
+void CMetrics::shutdown()
+{
+    _sink.reset();
+    _server.reset();
+}
+
+// column names used in the output
+const char* CMetrics::getName(Metric metric)
+{
+    switch(metric){
+        case Metric::FRAME_TIME_US:         return "frame_time_us";
+        case Metric::ASTEROIDS:             return "asteroids";
+        case Metric::LASERS:                return "lasers";
+        case Metric::EXPLOSIONS:            return "explosions";
+        case Metric::PARTICLES:             return "particles";
+        case Metric::CAPTURE_TIME_US:       return "capture_time_us";
+        case Metric::QUALITY_LEVEL:         return "quality_level";
+        case Metric::LEVEL:                 return "level";
+        case Metric::SCORE:                 return "score";
+        case Metric::SOUND_VOICES:          return "sound_voices";
+        case Metric::SOUND_CHANNELS:        return "sound_channels";
+        case Metric::COLLISION_TESTS:       return "collision_tests";
+        case Metric::CONTACT_TESTS:         return "contact_tests";
+        case Metric::RENDER_COPY:           return "render_copy";
+        case Metric::RENDER_COPY_EX:        return "render_copy_ex";
+        case Metric::RENDER_GEOMETRY:       return "render_geometry";
+        case Metric::TEXTURE_CREATIONS:     return "texture_creations";
+        case Metric::SOUNDS:                return "sounds";
+        case Metric::REWIND_OVERFLOWS:      return "rewind_overflows";
+        case Metric::ALLOCATIONS:           return "allocations";
+        default:                            return "";
+    }
+}
+
+// counters are reset every frame, gauges keep their value
+bool CMetrics::isCounter(Metric metric)
+{
+    return metric >= Metric::COLLISION_TESTS;
+}
+
+
+//////////// CMetricsSink ////////////
+
+CMetricsSink::CMetricsSink(const std::string& path, bool csv, std::size_t capacity)
+    : _out(path), _csv(csv), _queue(capacity), _dropped(0), _running(true)
+{
+    if(!_out) return;
+
+    if(_csv){
+        _out << "frame,time_ms";
+        for(int i = 0; i < static_cast<int>(Metric::METRIC_TOTAL); i++){
+            _out << "," << CMetrics::getName(static_cast<Metric>(i));
+        }
+        _out << "\n";
+    }
+
+    _writer = std::thread(&CMetricsSink::writerLoop, this);
+}
+
+// stop the writer and write the remaining samples
+CMetricsSink::~CMetricsSink()
+{
+    if(_writer.joinable()){
+        _running = false;
+        _wake.notify_one();
+        _writer.join();
+    }
+
+    if(_dropped > 0){
+        std::cout << "Metrics sink dropped " << _dropped << " frames\n";
+    }
+}
+
+bool CMetricsSink::isOpen() const
+{
+    return _out.is_open();
+}
+
+// queue sample without blocking, dropped if the writer is behind
+void CMetricsSink::push(const MetricsSample& sample)
+{
+    if(!_queue.push(sample)){
+        _dropped++;
+    }
+}
+
+// drain the queue to the file in batches until stopped
+void CMetricsSink::writerLoop()
+{
+    MetricsSample sample;
+
+    while(_running){
+        while(_queue.pop(sample)){
+            write(sample);
+        }
+        _out.flush();
+
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wake.wait_for(lock, std::chrono::milliseconds(100));
+    }
+
+    while(_queue.pop(sample)){
+        write(sample);
+    }
+    _out.flush();
+}
+
+// format one row
+void CMetricsSink::write(const MetricsSample& sample)
+{
+    if(_csv){
+        _out << sample.frame << "," << sample.timeMs;
+        for(int i = 0; i < static_cast<int>(Metric::METRIC_TOTAL); i++){
+            _out << "," << sample.values[i];
+        }
+        _out << "\n";
+    }
+    else{
+        _out << "{\"frame\":" << sample.frame << ",\"time_ms\":" << sample.timeMs;
+        for(int i = 0; i < static_cast<int>(Metric::METRIC_TOTAL); i++){
+            _out << ",\"" << CMetrics::getName(static_cast<Metric>(i)) << "\":" << sample.values[i];
+        }
+        _out << "}\n";
+    }
+}
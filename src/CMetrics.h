@@ -0,0 +1,129 @@
+/* File:            CMetrics.h
+ * Author:          Vish Potnis
+ * Description:     - Registry of per frame counters and gauges
+ *                  - Counters are reset every frame, gauges keep their last value
+ *                  - Optional sink streams every frame as a CSV or NDJSON row from a background thread
+ *                  - Optional endpoint serves running totals and histograms to scrapers, see CMetricsServer
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "constants.h"
+#include "CAllocTracker.h"
+#include "CSpscQueue.h"
+
+// metrics recorded every frame
+enum class Metric
+{
+    // gauges
+    FRAME_TIME_US,          // frame work time, the frame delay and the wait in SDL_RenderPresent excluded
+    ASTEROIDS,              // live objects per type
+    LASERS,
+    EXPLOSIONS,
+    PARTICLES,
+    CAPTURE_TIME_US,        // frame capture time on the game thread
+    QUALITY_LEVEL,          // quality level chosen by the frame governor, 0 is full quality
+    LEVEL,                  // current level
+    SCORE,                  // score of all local players together
+    SOUND_VOICES,           // mixer channels playing a sound
+    SOUND_CHANNELS,         // mixer channels allocated
+    // counters
+    COLLISION_TESTS,        // bounding box pairs tested
+    CONTACT_TESTS,          // asteroid pairs tested by the contact solver
+    RENDER_COPY,            // SDL_RenderCopy calls
+    RENDER_COPY_EX,         // SDL_RenderCopyEx calls
+    RENDER_GEOMETRY,        // SDL_RenderGeometry calls
+    TEXTURE_CREATIONS,      // textures created from surfaces
+    SOUNDS,                 // sounds started
+    REWIND_OVERFLOWS,       // frames too large for a save state, the rewind ring was dropped
+    ALLOCATIONS,            // global operator new calls on all threads, counted by CAllocTracker
+    METRIC_TOTAL
+};
+
+// snapshot of all metrics at the end of a frame
+struct MetricsSample
+{
+    std::uint64_t frame;
+    std::uint64_t timeMs;
+    std::int64_t values[static_cast<int>(Metric::METRIC_TOTAL)];
+};
+
+// running totals of all frames for the metrics endpoint, published once per frame
+struct MetricsSnapshot
+{
+    std::uint64_t frame;                    // frames since the endpoint was enabled
+    std::uint64_t timeMs;
+    std::int64_t values[static_cast<int>(Metric::METRIC_TOTAL)];        // gauges of the last frame
+    std::int64_t totals[static_cast<int>(Metric::METRIC_TOTAL)];        // counters summed over all frames
+    std::uint64_t frameTimeBuckets[AsteroidConstants::METRICS_FRAME_BUCKETS];     // frames per histogram bucket, longer frames are only counted in frame
+    std::uint64_t frameTimeSumUs;
+    std::uint64_t phaseTimeUs[static_cast<int>(AllocPhase::PHASE_TOTAL)];    // time spent in each frame phase over all frames
+    std::uint64_t phaseRuns[static_cast<int>(AllocPhase::PHASE_TOTAL)];
+};
+
+class CMetricsServer;
+
+// writes samples to a file on a background thread
+class CMetricsSink
+{
+    public:
+        CMetricsSink(const std::string& path, bool csv, std::size_t capacity);
+        ~CMetricsSink();
+
+        bool isOpen() const;
+        void push(const MetricsSample& sample);     // queue sample without blocking, dropped if the writer is behind
+
+    private:
+
+        void writerLoop();                          // drain the queue to the file until stopped
+        void write(const MetricsSample& sample);    // format one row
+
+        std::ofstream _out;
+        bool _csv;
+        CSpscQueue<MetricsSample> _queue;
+        std::uint64_t _dropped;                     // samples lost because the queue was full, written by the game thread
+
+        std::atomic<bool> _running;
+        std::mutex _wakeMutex;                      // only used to park the writer thread between batches
+        std::condition_variable _wake;
+        std::thread _writer;
+};
+
+class CMetrics
+{
+    public:
+        static void add(Metric metric, std::int64_t value = 1) { _values[static_cast<int>(metric)] += value;}   // increase counter
+        static void set(Metric metric, std::int64_t value) { _values[static_cast<int>(metric)] = value;}        // set gauge
+        static std::int64_t get(Metric metric);
+
+        static void addPhaseTime(AllocPhase phase, std::uint64_t us);   // time of one run of a frame phase, only kept for the endpoint
+
+        static void endFrame(std::uint64_t timeMs);     // snapshot metrics for the frame, send to the sink and the endpoint and reset counters
+
+        static bool enableSink(const std::string& path);    // stream frames to path, CSV if it ends in .csv otherwise NDJSON
+        static bool enableServer(const std::string& address);   // serve metrics on 127.0.0.1:<port> or a Unix socket path
+        static bool isServing() { return _server != nullptr;}
+        static void shutdown();                             // flush and close the sink, stop the endpoint
+
+        static const char* getName(Metric metric);
+        static bool isCounter(Metric metric);
+
+    private:
+
+        static std::int64_t _values[static_cast<int>(Metric::METRIC_TOTAL)];
+        static std::uint64_t _frame;
+        static std::unique_ptr<CMetricsSink> _sink;
+
+        // running totals, only kept while the endpoint is enabled
+        static std::unique_ptr<CMetricsServer> _server;
+        static MetricsSnapshot _snapshot;
+};
@@ -0,0 +1,353 @@
+/* File:            CMetricsServer.cpp
+ * Author:          Vish Potnis
+ * Description:     - Local HTTP endpoint serving the metrics registry in the Prometheus text format
+ *                  - Listens on 127.0.0.1:<port> or a Unix socket path, one scrape at a time on its own thread
+ *                  - The game thread publishes a snapshot per frame through a triple buffer and never waits for a scrape
+ */
+
+#include "CMetricsServer.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    using socklen_t = int;
+#else
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/time.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+#if defined(MSG_NOSIGNAL)
+    constexpr int SEND_FLAGS{MSG_NOSIGNAL};     // a scraper that hangs up early must not raise SIGPIPE in the game
+#else
+    constexpr int SEND_FLAGS{0};
+#endif
+
+    void closeHandle(std::intptr_t handle)
+    {
+#ifdef _WIN32
+        closesocket(static_cast<SOCKET>(handle));
+#else
+        ::close(static_cast<int>(handle));
+#endif
+    }
+
+    // blocking socket with send and receive timeouts, a stalled scraper holds the server thread for a bounded time only
+    void setClientOptions(std::intptr_t client)
+    {
+#ifdef _WIN32
+        u_long nonBlocking = 0;
+        ioctlsocket(static_cast<SOCKET>(client), FIONBIO, &nonBlocking);
+        DWORD timeout = AsteroidConstants::METRICS_CLIENT_TIMEOUT_MS;
+        setsockopt(static_cast<SOCKET>(client), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        setsockopt(static_cast<SOCKET>(client), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+        int handle = static_cast<int>(client);
+        fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) & ~O_NONBLOCK);
+        timeval timeout{};
+        timeout.tv_sec = AsteroidConstants::METRICS_CLIENT_TIMEOUT_MS / 1000;
+        timeout.tv_usec = (AsteroidConstants::METRICS_CLIENT_TIMEOUT_MS % 1000) * 1000;
+        setsockopt(handle, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(handle, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#if defined(SO_NOSIGPIPE)
+        int noSigPipe = 1;
+        setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+#endif
+    }
+
+    // send all of data, false if the client went away or timed out
+    bool sendAll(std::intptr_t client, const char* data, std::size_t size)
+    {
+        while(size > 0){
+            auto sent = send(client, data, static_cast<int>(size), SEND_FLAGS);
+            if(sent <= 0) return false;
+            data += sent;
+            size -= static_cast<std::size_t>(sent);
+        }
+        return true;
+    }
+
+    // printf into buffer at size, output that does not fit is cut off and size stops at capacity
+    void appendFormat(char* buffer, std::size_t capacity, std::size_t& size, const char* format, ...)
+    {
+        if(size >= capacity) return;
+
+        std::va_list args;
+        va_start(args, format);
+        int written = std::vsnprintf(buffer + size, capacity - size, format, args);
+        va_end(args);
+
+        if(written > 0) size += std::min(static_cast<std::size_t>(written), capacity - size);
+    }
+}
+
+CMetricsServer::CMetricsServer()
+    : _handle(-1), _running(false), _request{}, _body{}, _bodySize(0)
+{}
+
+CMetricsServer::~CMetricsServer()
+{
+    close();
+}
+
+// listen on 127.0.0.1:<port> if address is a number, otherwise on a Unix socket path
+bool CMetricsServer::open(const std::string& address)
+{
+    close();
+
+    bool tcp = !address.empty() && address.find_first_not_of("0123456789") == std::string::npos;
+    long port = tcp && address.size() <= 5 ? std::stol(address) : 0;
+    if(tcp && (port < 1 || port > 65535)){
+        std::cout << "Invalid metrics port " << address << "!\n";
+        return false;
+    }
+
+#ifdef _WIN32
+    if(!tcp){
+        std::cout << "Metrics on a Unix socket are not available on this platform, use a port number\n";
+        return false;
+    }
+
+    WSADATA wsaData;
+    if(WSAStartup(MAKEWORD(2, 2), &wsaData) != 0){
+        std::cout << "Unable to initialize Winsock!\n";
+        return false;
+    }
+#endif
+
+    auto handle = socket(tcp ? AF_INET : AF_UNIX, SOCK_STREAM, 0);
+#ifdef _WIN32
+    if(handle == INVALID_SOCKET){
+        WSACleanup();
+#else
+    if(handle < 0){
+#endif
+        std::cout << "Unable to create metrics socket!\n";
+        return false;
+    }
+    _handle = static_cast<std::intptr_t>(handle);
+
+    int bound = -1;
+    if(tcp){
+        // loopback only, the endpoint is for local monitoring
+        int reuse = 1;
+        setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in inet{};
+        inet.sin_family = AF_INET;
+        inet.sin_port = htons(static_cast<std::uint16_t>(port));
+        inet.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bound = bind(handle, reinterpret_cast<sockaddr*>(&inet), sizeof(inet));
+    }
+#ifndef _WIN32
+    else{
+        sockaddr_un local{};
+        local.sun_family = AF_UNIX;
+        if(address.size() >= sizeof(local.sun_path)){
+            std::cout << "Metrics socket path " << address << " is too long!\n";
+            close();
+            return false;
+        }
+        std::memcpy(local.sun_path, address.c_str(), address.size() + 1);
+
+        // a socket left behind by an earlier run is replaced, any other file is not touched
+        struct stat existing{};
+        if(lstat(address.c_str(), &existing) == 0){
+            if(!S_ISSOCK(existing.st_mode)){
+                std::cout << "Metrics socket path " << address << " exists and is not a socket!\n";
+                close();
+                return false;
+            }
+            unlink(address.c_str());
+        }
+
+        bound = bind(handle, reinterpret_cast<sockaddr*>(&local), sizeof(local));
+        if(bound == 0) _path = address;
+    }
+#endif
+
+    if(bound != 0 || listen(handle, 4) != 0){
+        std::cout << "Unable to listen for metrics on " << (tcp ? "127.0.0.1:" : "") << address << "!\n";
+        close();
+        return false;
+    }
+
+    // accept must not block if a scraper hangs up between select and accept
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(handle, FIONBIO, &nonBlocking);
+#else
+    fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    _running = true;
+    _thread = std::thread(&CMetricsServer::serveLoop, this);
+
+    std::cout << "Metrics: serving http://" << (tcp ? "127.0.0.1:" + address : "localhost (unix socket " + address + ")") << "/metrics\n";
+    return true;
+}
+
+// stop the thread, close the socket and remove the socket path
+void CMetricsServer::close()
+{
+    if(_thread.joinable()){
+        _running = false;
+        _thread.join();
+    }
+
+    if(_handle == -1) return;
+
+    closeHandle(_handle);
+#ifdef _WIN32
+    WSACleanup();
+#else
+    if(!_path.empty()) unlink(_path.c_str());
+#endif
+    _handle = -1;
+    _path.clear();
+}
+
+// accept clients until closed, waking up every METRICS_POLL_MS to check for shutdown
+void CMetricsServer::serveLoop()
+{
+    while(_running){
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(_handle, &readable);
+        timeval timeout{};
+        timeout.tv_usec = AsteroidConstants::METRICS_POLL_MS * 1000;
+
+        if(select(static_cast<int>(_handle) + 1, &readable, nullptr, nullptr, &timeout) <= 0){
+            continue;
+        }
+
+        auto client = accept(_handle, nullptr, nullptr);
+#ifdef _WIN32
+        if(client == INVALID_SOCKET) continue;
+#else
+        if(client < 0) continue;
+#endif
+
+        setClientOptions(static_cast<std::intptr_t>(client));
+        serveClient(static_cast<std::intptr_t>(client));
+        closeHandle(static_cast<std::intptr_t>(client));
+    }
+}
+
+// answer one request and hang up
+void CMetricsServer::serveClient(std::intptr_t client)
+{
+    // read the request head, the body of a GET is empty
+    std::size_t size = 0;
+    while(size < sizeof(_request) - 1){
+        auto received = recv(client, _request + size, static_cast<int>(sizeof(_request) - 1 - size), 0);
+        if(received <= 0) return;
+        size += static_cast<std::size_t>(received);
+        _request[size] = '\0';
+        if(std::strstr(_request, "\r\n\r\n") != nullptr) break;
+    }
+    _request[size] = '\0';
+
+    const char* status = "200 OK";
+    const char* contentType = "text/plain; version=0.0.4; charset=utf-8";
+
+    if(std::strncmp(_request, "GET ", 4) != 0){
+        status = "405 Method Not Allowed";
+    }
+    else{
+        // path up to the query string or the protocol
+        const char* path = _request + 4;
+        std::size_t length = std::strcspn(path, " ?\r\n");
+        bool metrics = (length == 8 && std::strncmp(path, "/metrics", 8) == 0) || (length == 1 && path[0] == '/');
+        if(!metrics) status = "404 Not Found";
+    }
+
+    if(std::strcmp(status, "200 OK") == 0){
+        // the newest snapshot, the previous one again if the game has not finished a frame since the last scrape
+        _snapshots.update();
+        formatMetrics(_snapshots.getReadBuffer());
+    }
+    else{
+        contentType = "text/plain; charset=utf-8";
+        _bodySize = 0;
+        appendFormat(_body, sizeof(_body), _bodySize, "%s\n", status);
+    }
+
+    char head[256];
+    int headSize = std::snprintf(head, sizeof(head),
+                                 "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                                 status, contentType, _bodySize);
+    if(headSize <= 0 || !sendAll(client, head, static_cast<std::size_t>(headSize))) return;
+    sendAll(client, _body, _bodySize);
+}
+
+// write the text format to _body
+// gauges are the values of the last frame, counters and the histogram are totals since the endpoint was enabled
+void CMetricsServer::formatMetrics(const MetricsSnapshot& snapshot)
+{
+    _bodySize = 0;
+    auto append = [this](const char* format, auto... args){
+        appendFormat(_body, sizeof(_body), _bodySize, format, args...);
+    };
+
+    append("# HELP asteroids_frames_total Frames run since the endpoint was enabled.\n"
+           "# TYPE asteroids_frames_total counter\n"
+           "asteroids_frames_total %llu\n", static_cast<unsigned long long>(snapshot.frame));
+    append("# HELP asteroids_game_time_seconds Game time of the last frame.\n"
+           "# TYPE asteroids_game_time_seconds gauge\n"
+           "asteroids_game_time_seconds %.3f\n", snapshot.timeMs / 1000.0);
+
+    for(int i = 0; i < static_cast<int>(Metric::METRIC_TOTAL); i++){
+        Metric metric = static_cast<Metric>(i);
+        if(CMetrics::isCounter(metric)){
+            append("# TYPE asteroids_%s_total counter\n"
+                   "asteroids_%s_total %lld\n", CMetrics::getName(metric), CMetrics::getName(metric), static_cast<long long>(snapshot.totals[i]));
+        }
+        else{
+            append("# TYPE asteroids_%s gauge\n"
+                   "asteroids_%s %lld\n", CMetrics::getName(metric), CMetrics::getName(metric), static_cast<long long>(snapshot.values[i]));
+        }
+    }
+
+    // buckets are cumulative in the text format
+    append("# HELP asteroids_frame_work_seconds Time the game thread worked on a frame, waits for the next frame and for the display excluded.\n"
+           "# TYPE asteroids_frame_work_seconds histogram\n");
+    std::uint64_t cumulative = 0;
+    for(int i = 0; i < AsteroidConstants::METRICS_FRAME_BUCKETS; i++){
+        cumulative += snapshot.frameTimeBuckets[i];
+        append("asteroids_frame_work_seconds_bucket{le=\"%g\"} %llu\n",
+               AsteroidConstants::METRICS_FRAME_BOUNDS_US[i] / 1e6, static_cast<unsigned long long>(cumulative));
+    }
+    append("asteroids_frame_work_seconds_bucket{le=\"+Inf\"} %llu\n"
+           "asteroids_frame_work_seconds_sum %.6f\n"
+           "asteroids_frame_work_seconds_count %llu\n",
+           static_cast<unsigned long long>(snapshot.frame), snapshot.frameTimeSumUs / 1e6, static_cast<unsigned long long>(snapshot.frame));
+
+    append("# HELP asteroids_phase_seconds_total Time the game thread spent in each frame phase, the present is not part of any phase.\n"
+           "# TYPE asteroids_phase_seconds_total counter\n");
+    for(int i = 0; i < static_cast<int>(AllocPhase::PHASE_TOTAL); i++){
+        append("asteroids_phase_seconds_total{phase=\"%s\"} %.6f\n",
+               CAllocTracker::getPhaseName(static_cast<AllocPhase>(i)), snapshot.phaseTimeUs[i] / 1e6);
+    }
+    append("# HELP asteroids_phase_runs_total Times each frame phase ran.\n"
+           "# TYPE asteroids_phase_runs_total counter\n");
+    for(int i = 0; i < static_cast<int>(AllocPhase::PHASE_TOTAL); i++){
+        append("asteroids_phase_runs_total{phase=\"%s\"} %llu\n",
+               CAllocTracker::getPhaseName(static_cast<AllocPhase>(i)), static_cast<unsigned long long>(snapshot.phaseRuns[i]));
+    }
+}
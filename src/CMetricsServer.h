@@ -0,0 +1,54 @@
+/* File:            CMetricsServer.h
+ * Author:          Vish Potnis
+ * Description:     - Local HTTP endpoint serving the metrics registry in the Prometheus text format
+ *                  - Listens on 127.0.0.1:<port> or a Unix socket path, one scrape at a time on its own thread
+ *                  - The game thread publishes a snapshot per frame through a triple buffer and never waits for a scrape
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "constants.h"
+#include "CMetrics.h"
+#include "CTripleBuffer.h"
+
+class CMetricsServer
+{
+    public:
+        CMetricsServer();
+        ~CMetricsServer();
+
+        // delete copy and assignment constructors, the socket and the thread have a single owner
+        CMetricsServer(const CMetricsServer&) = delete;
+        CMetricsServer& operator=(const CMetricsServer&) = delete;
+
+        bool open(const std::string& address);      // listen on 127.0.0.1:<port> if address is a number, otherwise on a Unix socket path
+        void close();                               // stop the thread, close the socket and remove the socket path
+
+        // game thread: fill the buffer and publish it, the snapshot is copied, nothing is locked
+        MetricsSnapshot& getWriteBuffer() { return _snapshots.getWriteBuffer();}
+        void publish() { _snapshots.publish();}
+
+    private:
+
+        void serveLoop();                           // accept clients until closed
+        void serveClient(std::intptr_t client);     // answer one request and hang up
+        void formatMetrics(const MetricsSnapshot& snapshot);    // write the text format to _body
+
+        std::intptr_t _handle;                      // native listening socket handle, -1 when closed
+        std::string _path;                          // Unix socket path to remove on close, empty for TCP
+        std::thread _thread;
+        std::atomic<bool> _running;
+
+        CTripleBuffer<MetricsSnapshot> _snapshots;
+
+        // fixed buffers so a scrape does not allocate and show up in the allocations metric
+        char _request[1024];
+        char _body[AsteroidConstants::METRICS_RESPONSE_SIZE];
+        std::size_t _bodySize;
+};
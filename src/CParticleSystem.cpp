@@ -0,0 +1,176 @@
+/* File:            CParticleSystem.cpp
+ * Author:          Vish Potnis
+ * Description:     - Particle system for explosion debris
+ *                  - Particle attributes are stored as separate arrays (structure of arrays)
+ *                  - All live particles are drawn with a single geometry call
+ */
+
+#include "CParticleSystem.h"
+#include "CSoftCompositor.h"
+#include <cmath>
+#include <algorithm>
+
+CParticleSystem::CParticleSystem(int capacity)
+    : _capacity(capacity), _count(0), _lastUpdated(SDL_GetTicks()), _rng(std::random_device{}())
+{
+    _posX.resize(capacity);
+    _posY.resize(capacity);
+    _velX.resize(capacity);
+    _velY.resize(capacity);
+    _age.resize(capacity);
+    _lifetime.resize(capacity);
+    _color.resize(capacity);
+
+    // every particle is a quad made of 2 triangles, the index pattern never changes
+    _vertices.resize(capacity * 4);
+    _indices.resize(capacity * 6);
+    for(int i = 0; i < capacity; i++){
+        int v = i * 4;
+        int* idx = &_indices[i * 6];
+        idx[0] = v;     idx[1] = v + 1; idx[2] = v + 2;
+        idx[3] = v + 2; idx[4] = v + 1; idx[5] = v + 3;
+    }
+}
+
+// spawn a burst of particles at pos moving outwards in random directions
+void CParticleSystem::emitBurst(const Point& pos, int count, double speed, double baseVelX, double baseVelY, SDL_Color color)
+{
+    std::uniform_real_distribution<float> randomAngle(0, 2 * AsteroidConstants::PI);
+    std::uniform_real_distribution<float> randomScale(0.3f, 1.0f);
+
+    count = std::min(count, _capacity - _count);
+    for(int i = 0; i < count; i++){
+        int p = _count++;
+        float angle = randomAngle(_rng);
+        float magnitude = speed * randomScale(_rng);
+
+        _posX[p] = pos.x;
+        _posY[p] = pos.y;
+        _velX[p] = baseVelX + magnitude * std::cos(angle);
+        _velY[p] = baseVelY + magnitude * std::sin(angle);
+        _age[p] = 0;
+        _lifetime[p] = AsteroidConstants::PARTICLE_LIFETIME * randomScale(_rng);
+        _color[p] = color;
+    }
+}
+
+// integrate particles and remove expired ones
+void CParticleSystem::update(const Uint32 updateTime)
+{
+    float timeDelta = static_cast<float>(updateTime - _lastUpdated)/1000;
+    float drag = std::pow(static_cast<float>(AsteroidConstants::PARTICLE_DRAG), timeDelta);
+    _lastUpdated = updateTime;
+
+    // plain loop over raw arrays without branches so the compiler can vectorize it
+    float* __restrict posX = _posX.data();
+    float* __restrict posY = _posY.data();
+    float* __restrict velX = _velX.data();
+    float* __restrict velY = _velY.data();
+    float* __restrict age = _age.data();
+    const int count = _count;
+
+    for(int i = 0; i < count; i++){
+        velX[i] *= drag;
+        velY[i] *= drag;
+        posX[i] += velX[i] * timeDelta;
+        posY[i] += velY[i] * timeDelta;
+        age[i] += timeDelta;
+    }
+
+    // compact expired particles, the swapped in particle is checked again on the next iteration
+    int i = 0;
+    while(i < _count){
+        if(_age[i] >= _lifetime[i]){
+            kill(i);
+        }
+        else{
+            i++;
+        }
+    }
+}
+
+// draw all visible particles with one geometry call
+// particles fade out over their lifetime
+void CParticleSystem::render(SDL_Renderer& renderer, const CCamera& camera)
+{
+    if(_count == 0) return;
+
+    const float worldWidth = AsteroidConstants::WORLD_WIDTH;
+    const float worldHeight = AsteroidConstants::WORLD_HEIGHT;
+    const float viewWidth = camera.getViewWidth();
+    const float viewHeight = camera.getViewHeight();
+    const float centerX = camera.getCenter().x;
+    const float centerY = camera.getCenter().y;
+    const float half = AsteroidConstants::PARTICLE_SIZE / 2.0f;
+
+    // the software compositor fills the pixels whose centers are inside the quad, like the geometry rasterizer
+    CSoftCompositor* compositor = CSoftCompositor::getActive();
+
+    int numVisible = 0;
+    for(int i = 0; i < _count; i++){
+        // closest copy across the world wrap, same as CCamera::worldToScreen
+        float dx = _posX[i] - centerX;
+        float dy = _posY[i] - centerY;
+        dx -= worldWidth * std::floor(dx / worldWidth + 0.5f);
+        dy -= worldHeight * std::floor(dy / worldHeight + 0.5f);
+        float x = dx + viewWidth / 2;
+        float y = dy + viewHeight / 2;
+
+        if(x < -half || x > viewWidth + half || y < -half || y > viewHeight + half)
+            continue;
+
+        SDL_Color color = _color[i];
+        color.a = static_cast<Uint8>(255 * (1 - _age[i] / _lifetime[i]));
+
+        if(compositor != nullptr){
+            int left = static_cast<int>(std::ceil(x - half - 0.5f));
+            int top = static_cast<int>(std::ceil(y - half - 0.5f));
+            int right = static_cast<int>(std::ceil(x + half - 0.5f));
+            int bottom = static_cast<int>(std::ceil(y + half - 0.5f));
+            compositor->fill(SDL_Rect{left, top, right - left, bottom - top}, color);
+            continue;
+        }
+
+        SDL_Vertex* v = &_vertices[numVisible * 4];
+        v[0] = SDL_Vertex{SDL_FPoint{x - half, y - half}, color, SDL_FPoint{0, 0}};
+        v[1] = SDL_Vertex{SDL_FPoint{x + half, y - half}, color, SDL_FPoint{0, 0}};
+        v[2] = SDL_Vertex{SDL_FPoint{x - half, y + half}, color, SDL_FPoint{0, 0}};
+        v[3] = SDL_Vertex{SDL_FPoint{x + half, y + half}, color, SDL_FPoint{0, 0}};
+        numVisible++;
+    }
+
+    if(numVisible > 0){
+        SDL_SetRenderDrawBlendMode(&renderer, SDL_BLENDMODE_BLEND);
+        SDL_RenderGeometry(&renderer, nullptr, _vertices.data(), numVisible * 4, _indices.data(), numVisible * 6);
+        CMetrics::add(Metric::RENDER_GEOMETRY);
+    }
+}
+
+// move the particle clock delta ms later, the time in between is not simulated
+void CParticleSystem::shiftTime(Uint32 delta)
+{
+    _lastUpdated += delta;
+}
+
+// remove all particles
+void CParticleSystem::clear()
+{
+    _count = 0;
+}
+
+// getter
+int CParticleSystem::getCount() const { return _count;}
+Uint32 CParticleSystem::getLastUpdated() const { return _lastUpdated;}
+
+// swap remove particle idx with the last live particle
+void CParticleSystem::kill(int idx)
+{
+    int last = --_count;
+    _posX[idx] = _posX[last];
+    _posY[idx] = _posY[last];
+    _velX[idx] = _velX[last];
+    _velY[idx] = _velY[last];
+    _age[idx] = _age[last];
+    _lifetime[idx] = _lifetime[last];
+    _color[idx] = _color[last];
+}
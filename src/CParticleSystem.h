@@ -0,0 +1,58 @@
+/* File:            CParticleSystem.h
+ * Author:          Vish Potnis
+ * Description:     - Particle system for explosion debris
+ *                  - Particle attributes are stored as separate arrays (structure of arrays)
+ *                  - All live particles are drawn with a single geometry call
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <vector>
+#include <random>
+
+#include "constants.h"
+#include "utility.h"
+#include "CCamera.h"
+#include "CMetrics.h"
+
+class CParticleSystem
+{
+    public:
+        explicit CParticleSystem(int capacity);
+
+        // spawn a burst of particles at pos moving outwards, baseVelX/Y is added to every particle (e.g. velocity of the destroyed asteroid)
+        void emitBurst(const Point& pos, int count, double speed, double baseVelX, double baseVelY, SDL_Color color);
+
+        void update(const Uint32 updateTime);                       // integrate particles and remove expired ones
+        void render(SDL_Renderer& renderer, const CCamera& camera); // draw all visible particles with one geometry call
+        void shiftTime(Uint32 delta);                               // move the particle clock delta ms later, the time in between is not simulated
+        void clear();                                               // remove all particles
+
+        int getCount() const;
+        Uint32 getLastUpdated() const;
+
+    private:
+
+        void kill(int idx);         // swap remove particle idx with the last live particle
+
+        int _capacity;              // maximum number of live particles, bursts are truncated once reached
+        int _count;                 // number of live particles
+        Uint32 _lastUpdated;        // time stamp denoting last update of the particles
+
+        // particle attributes, index i across all arrays is one particle
+        std::vector<float> _posX;
+        std::vector<float> _posY;
+        std::vector<float> _velX;
+        std::vector<float> _velY;
+        std::vector<float> _age;        // seconds since spawn
+        std::vector<float> _lifetime;   // seconds until expiry
+        std::vector<SDL_Color> _color;
+
+        // geometry buffers reused every frame
+        std::vector<SDL_Vertex> _vertices;
+        std::vector<int> _indices;      // constant quad index pattern, built once
+
+        std::mt19937 _rng;
+};
@@ -0,0 +1,294 @@
+/* File:            CPerfCounters.cpp
+ * Author:          Vish Potnis
+ * Description:     - Hardware performance counters (cycles, instructions, cache and branch misses) of the calling thread
+ *                  - Opened as one perf_event_open group on Linux and read with a single read(), unavailable counters read 0
+ *                  - Opt-in per frame phase accounting for the game loop with IPC and misses per entity printed on exit
+ *                  - The same phases can be timed for the metrics endpoint without the counters
+ */
+
+#include "CPerfCounters.h"
+#include "CMetrics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#if defined(__linux__)
+#define PERF_COUNTERS_SUPPORTED
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr int COUNTER_TOTAL{static_cast<int>(PerfCounter::PERF_COUNTER_TOTAL)};
+    constexpr int PHASE_TOTAL{static_cast<int>(AllocPhase::PHASE_TOTAL)};
+
+#ifdef PERF_COUNTERS_SUPPORTED
+    struct PerfEvent
+    {
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+
+    // event of each PerfCounter
+    const PerfEvent EVENTS[] =
+    {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+    static_assert(sizeof(EVENTS)/sizeof(EVENTS[0]) == COUNTER_TOTAL, "one event per counter");
+
+    // why no counter could be opened, with the usual fix
+    void printUnavailable(int error)
+    {
+        std::cout << "Hardware counters unavailable: " << std::strerror(error);
+        if(error == EACCES || error == EPERM){
+            std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+            int level = 0;
+            if(paranoid >> level){
+                std::cout << " (kernel.perf_event_paranoid is " << level << ", 2 or lower allows counting user space)";
+            }
+        }
+        else if(error == ENOENT || error == EOPNOTSUPP || error == ENODEV){
+            std::cout << " (the CPU or the virtual machine does not expose hardware counters)";
+        }
+        std::cout << "\n";
+    }
+#endif
+}
+
+// difference of two readings, scaled readings of a multiplexed group can step back and give 0
+PerfValues PerfValues::operator-(const PerfValues& start) const
+{
+    PerfValues delta{};
+    for(int i = 0; i < COUNTER_TOTAL; i++){
+        delta.values[i] = values[i] > start.values[i] ? values[i] - start.values[i] : 0;
+    }
+    return delta;
+}
+
+
+//////////// CPerfCounters ////////////
+
+CPerfCounters::CPerfCounters()
+    : _leader(-1), _count(0), _multiplexed(false)
+{
+    for(int i = 0; i < COUNTER_TOTAL; i++){
+        _fds[i] = -1;
+        _slots[i] = -1;
+    }
+}
+
+CPerfCounters::~CPerfCounters()
+{
+#ifdef PERF_COUNTERS_SUPPORTED
+    for(int fd: _fds){
+        if(fd >= 0) close(fd);
+    }
+#endif
+}
+
+// open and start the counters, false if none is available
+// counters the CPU or the kernel refuses are left out of the group and read 0
+bool CPerfCounters::open()
+{
+#ifdef PERF_COUNTERS_SUPPORTED
+    if(isOpen()) return true;
+
+    int error = 0;
+    for(int i = 0; i < COUNTER_TOTAL; i++){
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = EVENTS[i].type;
+        attr.config = EVENTS[i].config;
+        attr.disabled = _leader < 0 ? 1 : 0;        // the group starts when the leader is enabled
+        attr.exclude_kernel = 1;                    // user space only, allowed with the default perf_event_paranoid
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, _leader, 0));
+        if(fd < 0){
+            if(error == 0) error = errno;
+            continue;
+        }
+        if(_leader < 0) _leader = fd;
+        _fds[i] = fd;
+        _slots[i] = _count++;
+    }
+
+    if(_leader < 0){
+        printUnavailable(error);
+        return false;
+    }
+
+    ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    std::cout << "Hardware counters are not available on this platform\n";
+    return false;
+#endif
+}
+
+bool CPerfCounters::isOpen() const { return _leader >= 0;}
+bool CPerfCounters::isAvailable(PerfCounter counter) const { return _slots[static_cast<int>(counter)] >= 0;}
+bool CPerfCounters::isMultiplexed() const { return _multiplexed;}
+
+// counts since open, scaled if the group was multiplexed
+// the group is read with one read() call, all counters are from the same instant
+PerfValues CPerfCounters::read()
+{
+    PerfValues result{};
+#ifdef PERF_COUNTERS_SUPPORTED
+    if(!isOpen()) return result;
+
+    // number of counters, time enabled, time running, one value per counter
+    std::uint64_t buffer[3 + COUNTER_TOTAL] = {};
+    if(::read(_leader, buffer, sizeof(buffer)) < static_cast<ssize_t>(3 * sizeof(std::uint64_t))){
+        return result;
+    }
+
+    std::uint64_t enabled = buffer[1];
+    std::uint64_t running = buffer[2];
+    bool scaled = running > 0 && running < enabled;
+    _multiplexed |= scaled;
+
+    for(int i = 0; i < COUNTER_TOTAL; i++){
+        if(_slots[i] < 0 || static_cast<std::uint64_t>(_slots[i]) >= buffer[0]) continue;
+
+        std::uint64_t value = buffer[3 + _slots[i]];
+        result.values[i] = scaled ? static_cast<std::uint64_t>(static_cast<double>(value) * enabled / running) : value;
+    }
+#endif
+    return result;
+}
+
+// column names used in the report
+const char* CPerfCounters::getName(PerfCounter counter)
+{
+    switch(counter){
+        case PerfCounter::CYCLES:           return "cycles";
+        case PerfCounter::INSTRUCTIONS:     return "instructions";
+        case PerfCounter::CACHE_MISSES:     return "cache_misses";
+        case PerfCounter::L1D_MISSES:       return "l1d_misses";
+        case PerfCounter::BRANCH_MISSES:    return "branch_misses";
+        default:                            return "";
+    }
+}
+
+
+//////////// CPerfPhases ////////////
+
+// initialize static variables
+bool CPerfPhases::_enabled = false;
+bool CPerfPhases::_timing = false;
+CPerfCounters CPerfPhases::_counters;
+PerfValues CPerfPhases::_phaseStart{};
+std::chrono::steady_clock::time_point CPerfPhases::_phaseStartTime;
+PerfValues CPerfPhases::_totals[PHASE_TOTAL] = {};
+std::uint64_t CPerfPhases::_runs[PHASE_TOTAL] = {};
+std::uint64_t CPerfPhases::_entities[PHASE_TOTAL] = {};
+bool CPerfPhases::_ranThisFrame[PHASE_TOTAL] = {};
+
+// open the counters on the calling thread, the game runs on without them
+bool CPerfPhases::enable()
+{
+    if(!_counters.open()) return false;
+
+    _enabled = true;
+    std::cout << "Hardware counters:";
+    for(int i = 0; i < COUNTER_TOTAL; i++){
+        PerfCounter counter = static_cast<PerfCounter>(i);
+        std::cout << " " << CPerfCounters::getName(counter) << (_counters.isAvailable(counter) ? "" : " (unavailable)");
+    }
+    std::cout << "\n";
+    return true;
+}
+
+// time each phase run and add it to the metrics endpoint
+void CPerfPhases::enableTiming()
+{
+    _timing = true;
+}
+
+// read the counters and the clock at the start of a phase
+void CPerfPhases::beginPhase()
+{
+    if(_enabled) _phaseStart = _counters.read();
+    if(_timing) _phaseStartTime = std::chrono::steady_clock::now();
+}
+
+// add the counts and the time since beginPhase to phase
+void CPerfPhases::endPhase(AllocPhase phase)
+{
+    if(_timing){
+        auto elapsed = std::chrono::steady_clock::now() - _phaseStartTime;
+        CMetrics::addPhaseTime(phase, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+    if(!_enabled) return;
+
+    PerfValues delta = _counters.read() - _phaseStart;
+    int index = static_cast<int>(phase);
+    for(int i = 0; i < COUNTER_TOTAL; i++){
+        _totals[index].values[i] += delta.values[i];
+    }
+    _runs[index]++;
+    _ranThisFrame[index] = true;
+}
+
+// entities of the frame, counted for the phases that ran in it
+void CPerfPhases::endFrame(int entities)
+{
+    if(!_enabled) return;
+
+    for(int i = 0; i < PHASE_TOTAL; i++){
+        if(_ranThisFrame[i]) _entities[i] += entities;
+        _ranThisFrame[i] = false;
+    }
+}
+
+// counts per phase run, IPC and misses per entity
+void CPerfPhases::printReport()
+{
+    if(!_enabled) return;
+
+    std::cout << "Hardware counters per frame phase, user space only" << (_counters.isMultiplexed() ? ", multiplexed so values are estimates" : "") << "\n";
+    std::cout << "  phase         runs  kcycles/run  kinstr/run   IPC  cache miss/entity  l1d miss/entity  branch miss/entity\n";
+
+    // a column of a counter the CPU does not provide shows "-"
+    auto printColumn = [](bool available, double value, int width, int precision){
+        std::cout << std::setw(width);
+        if(available) std::cout << std::fixed << std::setprecision(precision) << value << std::defaultfloat;
+        else std::cout << "-";
+    };
+
+    for(int i = 0; i < PHASE_TOTAL; i++){
+        if(_runs[i] == 0) continue;
+
+        const PerfValues& total = _totals[i];
+        double runs = static_cast<double>(_runs[i]);
+        double entities = std::max<double>(static_cast<double>(_entities[i]), 1);
+        double cycles = static_cast<double>(total.get(PerfCounter::CYCLES));
+        double instructions = static_cast<double>(total.get(PerfCounter::INSTRUCTIONS));
+
+        std::cout << "  " << std::left << std::setw(10) << CAllocTracker::getPhaseName(static_cast<AllocPhase>(i)) << std::right
+                  << std::setw(8) << _runs[i];
+        printColumn(_counters.isAvailable(PerfCounter::CYCLES), cycles / runs / 1000, 13, 1);
+        printColumn(_counters.isAvailable(PerfCounter::INSTRUCTIONS), instructions / runs / 1000, 12, 1);
+        printColumn(_counters.isAvailable(PerfCounter::CYCLES) && _counters.isAvailable(PerfCounter::INSTRUCTIONS) && cycles > 0,
+                    instructions / std::max(cycles, 1.0), 6, 2);
+        printColumn(_counters.isAvailable(PerfCounter::CACHE_MISSES), total.get(PerfCounter::CACHE_MISSES) / entities, 19, 2);
+        printColumn(_counters.isAvailable(PerfCounter::L1D_MISSES), total.get(PerfCounter::L1D_MISSES) / entities, 17, 2);
+        printColumn(_counters.isAvailable(PerfCounter::BRANCH_MISSES), total.get(PerfCounter::BRANCH_MISSES) / entities, 20, 2);
+        std::cout << "\n";
+    }
+}
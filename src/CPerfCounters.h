@@ -0,0 +1,113 @@
+/* File:            CPerfCounters.h
+ * Author:          Vish Potnis
+ * Description:     - Hardware performance counters (cycles, instructions, cache and branch misses) of the calling thread
+ *                  - Opened as one perf_event_open group on Linux and read with a single read(), unavailable counters read 0
+ *                  - Opt-in per frame phase accounting for the game loop with IPC and misses per entity printed on exit
+ *                  - The same phases can be timed for the metrics endpoint without the counters
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "constants.h"
+#include "CAllocTracker.h"
+#include "CTracer.h"
+
+enum class PerfCounter
+{
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,           // last level cache misses
+    L1D_MISSES,             // level 1 data cache read misses
+    BRANCH_MISSES,
+    PERF_COUNTER_TOTAL
+};
+
+// counts of every counter at one point in time
+struct PerfValues
+{
+    std::uint64_t values[static_cast<int>(PerfCounter::PERF_COUNTER_TOTAL)];
+
+    std::uint64_t get(PerfCounter counter) const { return values[static_cast<int>(counter)];}
+    PerfValues operator-(const PerfValues& start) const;
+};
+
+// counter group of the thread that opened it
+class CPerfCounters
+{
+    public:
+        CPerfCounters();
+        ~CPerfCounters();
+
+        CPerfCounters(const CPerfCounters&) = delete;
+        CPerfCounters& operator=(const CPerfCounters&) = delete;
+
+        bool open();                                // open and start the counters, false if none is available
+        bool isOpen() const;
+        bool isAvailable(PerfCounter counter) const;
+        bool isMultiplexed() const;                 // the group did not run all the time, values are scaled estimates
+
+        PerfValues read();                          // counts since open, scaled if the group was multiplexed
+
+        static const char* getName(PerfCounter counter);
+
+    private:
+        int _leader;                                // file descriptor of the group leader, -1 when closed
+        int _fds[static_cast<int>(PerfCounter::PERF_COUNTER_TOTAL)];
+        int _slots[static_cast<int>(PerfCounter::PERF_COUNTER_TOTAL)];     // position of each counter in the group read, -1 if unavailable
+        int _count;                                 // counters in the group
+        bool _multiplexed;
+};
+
+#define PERF_PHASE(phase) CPerfPhaseScope TRACE_CONCAT(perfPhaseScope, __LINE__)(phase)
+
+// counters and time of the game thread accumulated per frame phase, set with PERF_PHASE
+class CPerfPhases
+{
+    public:
+        static bool enable();                       // open the counters on the calling thread, the game runs on without them
+        static void enableTiming();                 // time each phase run and add it to the metrics endpoint
+        static bool isEnabled() { return _enabled;}
+        static bool isActive() { return _enabled || _timing;}
+
+        static void beginPhase();                   // read the counters at the start of a phase
+        static void endPhase(AllocPhase phase);     // add the counts since beginPhase to phase
+        static void endFrame(int entities);         // entities of the frame, counted for the phases that ran in it
+        static void printReport();                  // counts per phase run, IPC and misses per entity
+
+    private:
+        static bool _enabled;
+        static bool _timing;
+        static CPerfCounters _counters;
+        static PerfValues _phaseStart;
+        static std::chrono::steady_clock::time_point _phaseStartTime;
+        static PerfValues _totals[static_cast<int>(AllocPhase::PHASE_TOTAL)];
+        static std::uint64_t _runs[static_cast<int>(AllocPhase::PHASE_TOTAL)];          // times each phase ran
+        static std::uint64_t _entities[static_cast<int>(AllocPhase::PHASE_TOTAL)];      // entities summed over the frames each phase ran in
+        static bool _ranThisFrame[static_cast<int>(AllocPhase::PHASE_TOTAL)];
+};
+
+// counts the enclosing scope as a frame phase, costs one branch when the counters and the timing are disabled
+class CPerfPhaseScope
+{
+    public:
+        explicit CPerfPhaseScope(AllocPhase phase)
+            : _phase(phase), _active(CPerfPhases::isActive())
+        {
+            if(_active) CPerfPhases::beginPhase();
+        }
+
+        ~CPerfPhaseScope()
+        {
+            if(_active) CPerfPhases::endPhase(_phase);
+        }
+
+        CPerfPhaseScope(const CPerfPhaseScope&) = delete;
+        CPerfPhaseScope& operator=(const CPerfPhaseScope&) = delete;
+
+    private:
+        AllocPhase _phase;
+        bool _active;
+};
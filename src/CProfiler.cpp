@@ -0,0 +1,261 @@
+/* File:            CProfiler.cpp
+ * Author:          Vish Potnis
+ * Description:     - Opt-in sampling profiler for hosts where external profilers are not available
+ *                  - A CPU time timer interrupts the game thread, the signal handler unwinds into a fixed table without allocating
+ *                  - Stacks are symbolized on exit and written as folded stacks for flame graphs, rooted at the frame phase
+ */
+
+#include "CProfiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#define PROFILER_SUPPORTED
+#include <csignal>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <sys/syscall.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+namespace
+{
+#ifdef PROFILER_SUPPORTED
+    timer_t g_timer;
+
+    // instruction the signal interrupted, nullptr on architectures without a known register layout
+    void* getInterruptedAddress(void* context)
+    {
+        const ucontext_t* uc = static_cast<const ucontext_t*>(context);
+#if defined(__x86_64__)
+        return reinterpret_cast<void*>(uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__i386__)
+        return reinterpret_cast<void*>(uc->uc_mcontext.gregs[REG_EIP]);
+#elif defined(__aarch64__)
+        return reinterpret_cast<void*>(uc->uc_mcontext.pc);
+#else
+        (void)uc;
+        return nullptr;
+#endif
+    }
+
+    // timer signal handler, expiries the kernel merged into this signal are counted as overruns
+    void onTimerSignal(int, siginfo_t* info, void* context)
+    {
+        int savedErrno = errno;
+        CProfiler::recordSample(getInterruptedAddress(context), 1 + std::max(info->si_overrun, 0));
+        errno = savedErrno;
+    }
+
+    // function name of a code address, module and offset when it has no exported symbol
+    std::string describeFrame(void* address)
+    {
+        Dl_info info;
+        if(dladdr(address, &info) == 0 || info.dli_fname == nullptr){
+            return "[unknown]";
+        }
+
+        if(info.dli_sname != nullptr){
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::string name = (status == 0 && demangled != nullptr) ? demangled : info.dli_sname;
+            std::free(demangled);
+            return name;
+        }
+
+        const char* module = std::strrchr(info.dli_fname, '/');
+        module = module ? module + 1 : info.dli_fname;
+
+        std::ostringstream out;
+        out << module << "+0x" << std::hex << reinterpret_cast<std::uintptr_t>(address) - reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+        return out.str();
+    }
+#endif
+}
+
+// initialize static variables
+bool CProfiler::_enabled = false;
+std::string CProfiler::_path;
+std::uint64_t CProfiler::_samples = 0;
+std::uint64_t CProfiler::_dropped = 0;
+CProfiler::Stack CProfiler::_stacks[AsteroidConstants::PROFILER_STACKS] = {};
+
+// sample the calling thread hz times per second of its CPU time
+// the timer runs on the thread CPU clock, so waits for the next frame and for events are not sampled
+bool CProfiler::enable(const std::string& path, int hz)
+{
+#ifdef PROFILER_SUPPORTED
+    if(_enabled) return true;
+
+    // backtrace loads the unwinder on its first call, which must not happen inside the signal handler
+    void* warmup[1];
+    backtrace(warmup, 1);
+
+    struct sigaction action{};
+    action.sa_sigaction = onTimerSignal;
+    action.sa_flags = SA_RESTART | SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    if(sigaction(SIGPROF, &action, nullptr) != 0){
+        std::cout << "Unable to install the profiler signal handler: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    // the signal goes to this thread only, phases are tracked on the game thread
+    sigevent event{};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+    if(timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &g_timer) != 0){
+        std::cout << "Unable to create the profiler timer: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    long intervalNs = 1000000000L / hz;
+    itimerspec interval{};
+    interval.it_interval.tv_sec = intervalNs / 1000000000L;
+    interval.it_interval.tv_nsec = intervalNs % 1000000000L;
+    interval.it_value = interval.it_interval;
+    if(timer_settime(g_timer, 0, &interval, nullptr) != 0){
+        std::cout << "Unable to start the profiler timer: " << std::strerror(errno) << "\n";
+        timer_delete(g_timer);
+        return false;
+    }
+
+    CAllocTracker::trackPhases();
+    _path = path;
+    _enabled = true;
+    std::cout << "Profiler: sampling the game thread " << hz << " times per second of CPU time\n";
+    return true;
+#else
+    (void)path;
+    (void)hz;
+    std::cout << "The sampling profiler is not available on this platform\n";
+    return false;
+#endif
+}
+
+// stop sampling and write the folded stacks to the profile file
+// each line is the phase, the frames from the outermost to the innermost separated by ';' and the sample count
+bool CProfiler::flush()
+{
+#ifdef PROFILER_SUPPORTED
+    if(!_enabled) return true;
+
+    // a signal still pending after the timer is deleted is ignored
+    timer_delete(g_timer);
+    std::signal(SIGPROF, SIG_IGN);
+    _enabled = false;
+
+    // return addresses point after the call, one byte back is inside the calling function
+    std::unordered_map<void*, std::string> names;
+    std::map<std::string, std::uint64_t> folded;
+    std::uint64_t phaseSamples[static_cast<int>(AllocPhase::PHASE_TOTAL)] = {};
+    for(const Stack& stack: _stacks){
+        if(stack.hash == 0) continue;
+
+        std::string line = CAllocTracker::getPhaseName(stack.phase);
+        for(int i = stack.depth - 1; i >= 0; i--){
+            void* address = i == 0 ? stack.frames[i] : static_cast<char*>(stack.frames[i]) - 1;
+            auto name = names.find(address);
+            if(name == names.end()){
+                name = names.emplace(address, describeFrame(address)).first;
+            }
+            line += ";" + name->second;
+        }
+        folded[line] += stack.count;
+        phaseSamples[static_cast<int>(stack.phase)] += stack.count;
+    }
+
+    std::ofstream file(_path);
+    if(!file){
+        std::cout << "Unable to write profile " << _path << "\n";
+        return false;
+    }
+    for(const auto& entry: folded){
+        file << entry.first << " " << entry.second << "\n";
+    }
+
+    std::cout << "Profiler: " << _samples << " samples in " << folded.size() << " stacks written to " << _path << "\n";
+    for(int i = 0; i < static_cast<int>(AllocPhase::PHASE_TOTAL); i++){
+        if(phaseSamples[i] == 0) continue;
+
+        std::cout << "  " << std::left << std::setw(10) << CAllocTracker::getPhaseName(static_cast<AllocPhase>(i)) << std::right
+                  << std::setw(8) << phaseSamples[i] << std::setw(8) << std::fixed << std::setprecision(1)
+                  << 100.0 * phaseSamples[i] / _samples << std::defaultfloat << "%\n";
+    }
+    if(_dropped > 0){
+        std::cout << "  " << _dropped << " samples did not fit in the stack table\n";
+    }
+    return true;
+#else
+    return true;
+#endif
+}
+
+// count the interrupted stack, called by the timer signal handler
+// only async signal safe work: backtrace was loaded in enable and the table is a fixed array
+void CProfiler::recordSample(void* interrupted, int weight)
+{
+#ifdef PROFILER_SUPPORTED
+    // the signal handler frames and the signal return trampoline are above the interrupted instruction
+    // how many frames that is depends on inlining and sanitizers, so the interrupted address is looked up
+    constexpr int HANDLER_FRAMES{3};
+    void* frames[AsteroidConstants::PROFILER_STACK_DEPTH + HANDLER_FRAMES + 2];
+    int captured = backtrace(frames, AsteroidConstants::PROFILER_STACK_DEPTH + HANDLER_FRAMES + 2);
+    int skip = std::min(HANDLER_FRAMES, captured);
+    for(int i = 0; i < captured && interrupted != nullptr; i++){
+        if(frames[i] == interrupted){
+            skip = i;
+            break;
+        }
+    }
+    int depth = std::min(captured - skip, AsteroidConstants::PROFILER_STACK_DEPTH);
+    AllocPhase phase = CAllocTracker::getPhase();
+    _samples += weight;
+
+    // FNV-1a over the addresses and the phase
+    std::uint64_t hash = 14695981039346656037ULL ^ static_cast<std::uint64_t>(phase);
+    for(int i = 0; i < depth; i++){
+        hash = (hash ^ reinterpret_cast<std::uintptr_t>(frames[i + skip])) * 1099511628211ULL;
+    }
+    if(hash == 0) hash = 1;
+
+    int mask = AsteroidConstants::PROFILER_STACKS - 1;
+    int slot = static_cast<int>(hash & mask);
+    for(int probe = 0; probe < AsteroidConstants::PROFILER_STACKS; probe++, slot = (slot + 1) & mask){
+        Stack& stack = _stacks[slot];
+        if(stack.hash == 0){
+            stack.hash = hash;
+            stack.phase = phase;
+            stack.depth = depth;
+            for(int i = 0; i < depth; i++){
+                stack.frames[i] = frames[i + skip];
+            }
+        }
+        if(stack.hash == hash){
+            stack.count += weight;
+            return;
+        }
+    }
+    _dropped += weight;
+#else
+    (void)interrupted;
+    (void)weight;
+#endif
+}
@@ -0,0 +1,46 @@
+/* File:            CProfiler.h
+ * Author:          Vish Potnis
+ * Description:     - Opt-in sampling profiler for hosts where external profilers are not available
+ *                  - A CPU time timer interrupts the game thread, the signal handler unwinds into a fixed table without allocating
+ *                  - Stacks are symbolized on exit and written as folded stacks for flame graphs, rooted at the frame phase
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "constants.h"
+#include "CAllocTracker.h"
+
+class CProfiler
+{
+    public:
+        static bool enable(const std::string& path, int hz);   // sample the calling thread hz times per second of its CPU time
+        static bool flush();                                    // stop sampling and write the folded stacks to the profile file
+
+        static bool isEnabled() { return _enabled;}
+
+        // called by the timer signal handler with the interrupted instruction
+        // weight is the number of timer intervals the sample stands for, the kernel merges expiries that happen within one tick
+        static void recordSample(void* interrupted, int weight);
+
+    private:
+
+        // samples with the same call stack in the same phase
+        struct Stack
+        {
+            std::uint64_t hash;                                 // 0 for an empty slot
+            void* frames[AsteroidConstants::PROFILER_STACK_DEPTH];     // innermost first, the first frame is the interrupted instruction
+            int depth;
+            AllocPhase phase;
+            std::uint64_t count;
+        };
+
+        static bool _enabled;
+        static std::string _path;
+        static std::uint64_t _samples;          // timer intervals sampled, including merged expiries
+        static std::uint64_t _dropped;          // samples that did not fit in the stack table
+
+        static Stack _stacks[AsteroidConstants::PROFILER_STACKS];  // open addressing table, filled without allocating
+};
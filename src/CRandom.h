@@ -0,0 +1,51 @@
+/* File:            CRandom.h
+ * Author:          Vish Potnis
+ * Description:     - Small seeded random number generator (PCG32)
+ *                  - State is two integers so it can be copied into save states and restored exactly
+ *                  - Meets the uniform random bit generator requirements, works with the std distributions
+ */
+
+#pragma once
+
+#include <cstdint>
+
+class CRandom
+{
+    public:
+        using result_type = std::uint32_t;
+
+        CRandom() { seed(0);}
+        explicit CRandom(std::uint64_t value) { seed(value);}
+
+        // restart the sequence for seed value
+        void seed(std::uint64_t value)
+        {
+            _state = 0;
+            _inc = (value << 1) | 1;
+            (*this)();
+            _state += value;
+            (*this)();
+        }
+
+        // next 32 random bits
+        result_type operator()()
+        {
+            std::uint64_t old = _state;
+            _state = old * 6364136223846793005ULL + _inc;
+            std::uint32_t xorShifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+            std::uint32_t rot = static_cast<std::uint32_t>(old >> 59);
+            return (xorShifted >> rot) | (xorShifted << ((32 - rot) & 31));
+        }
+
+        static constexpr result_type min() { return 0;}
+        static constexpr result_type max() { return UINT32_MAX;}
+
+        // raw state for save files
+        std::uint64_t getState() const { return _state;}
+        std::uint64_t getIncrement() const { return _inc;}
+        void setState(std::uint64_t state, std::uint64_t inc) { _state = state; _inc = inc | 1;}
+
+    private:
+        std::uint64_t _state;       // advanced on every draw
+        std::uint64_t _inc;         // stream selector, always odd
+};
@@ -0,0 +1,83 @@
+/* File:            CRollbackRing.h
+ * Author:          Vish Potnis
+ * Description:     - Ring of the states of the last N consecutive frames
+ *                  - Storage is allocated once, recording a frame reuses the slot of the oldest one
+ *                  - Used to rewind, or to roll back to an earlier frame and resimulate forward with corrected input
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template<typename T>
+class CRollbackRing
+{
+    public:
+        explicit CRollbackRing(std::size_t capacity)
+            : _slots(capacity), _oldest(0), _newest(0), _empty(true)
+        {}
+
+        CRollbackRing(const CRollbackRing&) = delete;
+        CRollbackRing& operator=(const CRollbackRing&) = delete;
+
+        // slot to record the state of frame in, frames are expected in order
+        // recording a frame that does not follow the newest one drops the stored frames first
+        T& record(std::uint32_t frame)
+        {
+            if(_empty || frame != _newest + 1){
+                _oldest = frame;
+                _empty = false;
+            }
+            else if(frame - _oldest >= _slots.size()){
+                _oldest++;
+            }
+            _newest = frame;
+            return _slots[frame % _slots.size()];
+        }
+
+        // stored state of frame, nullptr if it is not in the ring
+        const T* find(std::uint32_t frame) const
+        {
+            if(_empty || frame < _oldest || frame > _newest) return nullptr;
+            return &_slots[frame % _slots.size()];
+        }
+
+        // forget frames after frame, they are recorded again while resimulating
+        void discardAfter(std::uint32_t frame)
+        {
+            if(_empty || frame >= _newest) return;
+            if(frame < _oldest){
+                _empty = true;
+                return;
+            }
+            _newest = frame;
+        }
+
+        // forget the newest frame, used to step back one frame at a time
+        void discardNewest()
+        {
+            if(_empty) return;
+            if(_newest == _oldest){
+                _empty = true;
+                return;
+            }
+            _newest--;
+        }
+
+        void clear() { _empty = true;}
+
+        // getters
+        bool isEmpty() const { return _empty;}
+        std::size_t getSize() const { return _empty ? 0 : _newest - _oldest + 1;}
+        std::size_t getCapacity() const { return _slots.size();}
+        std::uint32_t getOldestFrame() const { return _oldest;}
+        std::uint32_t getNewestFrame() const { return _newest;}
+
+    private:
+        std::vector<T> _slots;          // frame f is stored at f % capacity
+        std::uint32_t _oldest;          // first stored frame
+        std::uint32_t _newest;          // last stored frame
+        bool _empty;
+};
@@ -0,0 +1,191 @@
+/* File:            CSoakMonitor.cpp
+ * Author:          Vish Potnis
+ * Description:     - Resource tracking for long running soak tests
+ *                  - Samples resident memory, live object and texture counts and frame time percentiles at a fixed interval
+ *                  - Fails the run when a resource grows steadily while the number of live objects does not, or frame time decays
+ */
+
+#include "CSoakMonitor.h"
+#include "CConfig.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+CSoakMonitor::CSoakMonitor(Uint32 durationMs)
+    : _durationMs(durationMs), _startTime(0), _lastSample(0), _started(false), _failed(false)
+{
+    _frameTimes.reserve(AsteroidConstants::SOAK_SAMPLE_MS / std::max(CConfig::get().getTicksPerFrame(), 1) + 1);
+}
+
+// mark the start of a frame
+void CSoakMonitor::beginFrame()
+{
+    if(!_started){
+        _startTime = SDL_GetTicks();
+        _lastSample = _startTime;
+        _started = true;
+    }
+    _frameStart = std::chrono::steady_clock::now();
+}
+
+// add the frame time since beginFrame to the current sample
+void CSoakMonitor::endFrame()
+{
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - _frameStart;
+    _frameTimes.push_back(elapsed.count());
+}
+
+// true every SOAK_SAMPLE_MS
+bool CSoakMonitor::isSampleDue(Uint32 now) const
+{
+    return _started && now - _lastSample >= static_cast<Uint32>(AsteroidConstants::SOAK_SAMPLE_MS);
+}
+
+// record and print one sample, then check for growth
+void CSoakMonitor::addSample(Uint32 now, const SoakCounts& counts)
+{
+    Sample sample;
+    sample.time = now - _startTime;
+    sample.rssKb = getResidentSetKb();
+    sample.counts = counts;
+    sample.liveObjects = counts.asteroids + counts.lasers + counts.explosions + counts.particles;
+    sample.p50Us = getPercentile(0.50);
+    sample.p95Us = getPercentile(0.95);
+    sample.p99Us = getPercentile(0.99);
+    _samples.push_back(sample);
+
+    _frameTimes.clear();
+    _lastSample = now;
+
+    printSample(sample);
+    checkGrowth();
+}
+
+// fail if the longest pending object step grew by the idle time, the next update would move objects over the whole idle gap
+// half the idle time is allowed as slack for the time spent between the two measurements
+void CSoakMonitor::checkIdleResume(Uint32 idleMs, Uint32 stepBefore, Uint32 stepAfter)
+{
+    if(_failed || stepAfter <= stepBefore + idleMs / 2) return;
+
+    _failed = true;
+    std::cout << "\n"
+              << "************************************************************\n"
+              << "SOAK FAILURE: objects would jump after an idle of " << idleMs << " ms following a frame over the save state caps\n"
+              << "  longest pending step before idle " << stepBefore << " ms, after " << stepAfter << " ms\n"
+              << "************************************************************\n\n";
+}
+
+// first and last sample and the verdict
+void CSoakMonitor::printSummary() const
+{
+    std::cout << "Soak test finished after " << (_samples.empty() ? 0 : _samples.back().time / 1000) << " s, " << _samples.size() << " samples\n";
+    if(!_samples.empty()){
+        std::cout << "  first: ";
+        printSample(_samples.front());
+        std::cout << "  last:  ";
+        printSample(_samples.back());
+    }
+    std::cout << (_failed ? "Soak test FAILED\n" : "Soak test passed\n");
+}
+
+// getters
+bool CSoakMonitor::isFinished(Uint32 now) const { return _started && now - _startTime >= _durationMs;}
+bool CSoakMonitor::hasFailed() const { return _failed;}
+
+// resident memory of this process, 0 if not available on the platform
+long CSoakMonitor::getResidentSetKb()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))){
+        return static_cast<long>(counters.WorkingSetSize / 1024);
+    }
+    return 0;
+#elif defined(__linux__)
+    // second field of statm is the resident set in pages
+    long pages = 0;
+    std::FILE* file = std::fopen("/proc/self/statm", "r");
+    if(file == nullptr) return 0;
+    if(std::fscanf(file, "%*s %ld", &pages) != 1) pages = 0;
+    std::fclose(file);
+    return pages * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+    return 0;
+#endif
+}
+
+void CSoakMonitor::printSample(const Sample& sample) const
+{
+    std::cout << "[soak " << std::setw(6) << sample.time / 1000 << " s] level " << sample.counts.level
+              << "  rss " << sample.rssKb << " KB  textures " << sample.counts.textures
+              << "  asteroids " << sample.counts.asteroids << "  lasers " << sample.counts.lasers
+              << "  explosions " << sample.counts.explosions << "  particles " << sample.counts.particles
+              << "  timers " << sample.counts.timers << std::fixed << std::setprecision(0)
+              << "  frame p50/p95/p99 " << sample.p50Us << "/" << sample.p95Us << "/" << sample.p99Us << " us\n"
+              << std::defaultfloat;
+}
+
+// fail on a resource that rose at every one of the last SOAK_GROWTH_SAMPLES samples
+// samples taken while caches and pools fill up are not checked
+void CSoakMonitor::checkGrowth()
+{
+    if(_failed || static_cast<int>(_samples.size()) < AsteroidConstants::SOAK_WARMUP_SAMPLES + AsteroidConstants::SOAK_GROWTH_SAMPLES) return;
+
+    const Sample& first = _samples[_samples.size() - AsteroidConstants::SOAK_GROWTH_SAMPLES];
+    const Sample& last = _samples.back();
+
+    const char* resource = nullptr;
+    if(isGrowing([](const Sample& s){ return static_cast<double>(s.rssKb);}) && last.rssKb - first.rssKb >= AsteroidConstants::SOAK_RSS_GROWTH_KB){
+        resource = "resident memory";
+    }
+    else if(isGrowing([](const Sample& s){ return static_cast<double>(s.counts.textures);})){
+        resource = "texture count";
+    }
+    else if(isGrowing([](const Sample& s){ return static_cast<double>(s.counts.timers);})){
+        resource = "timer count";
+    }
+    else if(isGrowing([](const Sample& s){ return s.p95Us;}) && last.p95Us >= first.p95Us * AsteroidConstants::SOAK_FRAME_DECAY){
+        resource = "frame time";
+    }
+    if(resource == nullptr) return;
+
+    _failed = true;
+    std::cout << "\n"
+              << "************************************************************\n"
+              << "SOAK FAILURE: " << resource << " grew at each of the last " << AsteroidConstants::SOAK_GROWTH_SAMPLES
+              << " samples while live objects did not\n"
+              << "  from: ";
+    printSample(first);
+    std::cout << "  to:   ";
+    printSample(last);
+    std::cout << "************************************************************\n\n";
+}
+
+// true if value rose at every one of the last SOAK_GROWTH_SAMPLES samples while live objects did not
+template<typename F>
+bool CSoakMonitor::isGrowing(F value) const
+{
+    std::size_t begin = _samples.size() - AsteroidConstants::SOAK_GROWTH_SAMPLES;
+    for(std::size_t i = begin + 1; i < _samples.size(); i++){
+        if(value(_samples[i]) <= value(_samples[i - 1])) return false;
+    }
+    return _samples.back().liveObjects <= _samples[begin].liveObjects;
+}
+
+// frame time percentile of the current interval, reorders _frameTimes
+double CSoakMonitor::getPercentile(double fraction)
+{
+    if(_frameTimes.empty()) return 0;
+    std::size_t index = std::min(_frameTimes.size() - 1, static_cast<std::size_t>(fraction * _frameTimes.size()));
+    std::nth_element(_frameTimes.begin(), _frameTimes.begin() + index, _frameTimes.end());
+    return _frameTimes[index];
+}
@@ -0,0 +1,81 @@
+/* File:            CSoakMonitor.h
+ * Author:          Vish Potnis
+ * Description:     - Resource tracking for long running soak tests
+ *                  - Samples resident memory, live object and texture counts and frame time percentiles at a fixed interval
+ *                  - Fails the run when a resource grows steadily while the number of live objects does not, or frame time decays
+ *                  - Optionally fails the run when objects jump by the idle time after the level continues from an idle window
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "constants.h"
+
+// live counts reported by the game with every sample
+struct SoakCounts
+{
+    int level;
+    int asteroids;
+    int lasers;
+    int explosions;
+    int particles;
+    int timers;             // pending timer wheel entries
+    int textures;           // live SDL textures
+};
+
+class CSoakMonitor
+{
+    public:
+        explicit CSoakMonitor(Uint32 durationMs);
+
+        void beginFrame();                              // mark the start of a frame
+        void endFrame();                                // add the frame time since beginFrame to the current sample
+
+        bool isSampleDue(Uint32 now) const;             // true every SOAK_SAMPLE_MS
+        void addSample(Uint32 now, const SoakCounts& counts);   // record and print one sample, then check for growth
+        void checkIdleResume(Uint32 idleMs, Uint32 stepBefore, Uint32 stepAfter);  // fail if the longest pending object step grew by the idle time
+        void printSummary() const;                      // first and last sample and the verdict
+
+        // getters
+        bool isFinished(Uint32 now) const;              // duration has passed
+        bool hasFailed() const;
+
+        static long getResidentSetKb();                 // resident memory of this process, 0 if not available on the platform
+
+    private:
+
+        struct Sample
+        {
+            Uint32 time;            // ms since the soak started
+            long rssKb;
+            SoakCounts counts;
+            int liveObjects;        // asteroids, lasers, explosions and particles
+            double p50Us;           // frame time percentiles over the sample interval
+            double p95Us;
+            double p99Us;
+        };
+
+        void printSample(const Sample& sample) const;
+        void checkGrowth();         // fail on a resource that rose at every one of the last SOAK_GROWTH_SAMPLES samples
+
+        // true if value rose at every one of the last SOAK_GROWTH_SAMPLES samples while live objects did not
+        template<typename F>
+        bool isGrowing(F value) const;
+
+        double getPercentile(double fraction);          // frame time percentile of the current interval, reorders _frameTimes
+
+        Uint32 _durationMs;
+        Uint32 _startTime;          // SDL ticks at the first frame
+        Uint32 _lastSample;         // SDL ticks of the last sample
+        bool _started;
+        bool _failed;
+
+        std::chrono::steady_clock::time_point _frameStart;
+        std::vector<double> _frameTimes;        // frame times in us since the last sample
+        std::vector<Sample> _samples;
+};
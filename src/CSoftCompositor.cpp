@@ -0,0 +1,384 @@
+/* File:            CSoftCompositor.cpp
+ * Author:          Vish Potnis
+ * Description:     - CPU compositor for renderers without a GPU
+ *                  - Records the copies and particle quads of a frame and composes them into a streaming texture
+ *                  - Premultiplied alpha blending with SSE2/AVX2 row kernels, the frame is split into row bands composed in parallel
+ */
+
+#include "CSoftCompositor.h"
+#include "CTracer.h"
+#include "CMetrics.h"
+#include "CConfig.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define COMPOSITOR_AVX2
+#endif
+
+CSoftCompositor* CSoftCompositor::_active{nullptr};
+
+namespace
+{
+    // premultiplied source over destination: d = s + d * (255 - sa) / 255, rounded, two channels per multiply
+    inline Uint32 blendPixel(Uint32 s, Uint32 d)
+    {
+        Uint32 inv = 255 - (s >> 24);
+        Uint32 rb = (d & 0x00FF00FF) * inv + 0x00800080;
+        rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+        Uint32 ag = ((d >> 8) & 0x00FF00FF) * inv + 0x00800080;
+        ag = (ag + ((ag >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+        return s + (rb | ag);
+    }
+
+    void blendRowScalar(Uint32* dst, const Uint32* src, int count)
+    {
+        for(int i = 0; i < count; i++){
+            dst[i] = blendPixel(src[i], dst[i]);
+        }
+    }
+
+#if defined(__SSE2__)
+    // 4 pixels per step, channels are widened to 16 bit and multiplied by the inverse source alpha of their pixel
+    void blendRowSse2(Uint32* dst, const Uint32* src, int count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMax = _mm_set1_epi32(255);
+        const __m128i round = _mm_set1_epi16(128);
+
+        int i = 0;
+        for(; i + 4 <= count; i += 4){
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i));
+
+            __m128i inv = _mm_sub_epi32(alphaMax, _mm_srli_epi32(s, 24));
+            inv = _mm_or_si128(inv, _mm_slli_epi32(inv, 16));
+
+            __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(inv, inv));
+            __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(inv, inv));
+            lo = _mm_add_epi16(lo, round);
+            hi = _mm_add_epi16(hi, round);
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi8(s, _mm_packus_epi16(lo, hi)));
+        }
+        blendRowScalar(dst + i, src + i, count - i);
+    }
+#endif
+
+#if defined(COMPOSITOR_AVX2)
+    // same as the SSE2 kernel with 8 pixels per step, compiled for AVX2 and only picked when the CPU supports it
+    __attribute__((target("avx2")))
+    void blendRowAvx2(Uint32* dst, const Uint32* src, int count)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i alphaMax = _mm256_set1_epi32(255);
+        const __m256i round = _mm256_set1_epi16(128);
+
+        int i = 0;
+        for(; i + 8 <= count; i += 8){
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i*>(dst + i));
+
+            __m256i inv = _mm256_sub_epi32(alphaMax, _mm256_srli_epi32(s, 24));
+            inv = _mm256_or_si256(inv, _mm256_slli_epi32(inv, 16));
+
+            // unpack and pack work within 128 bit lanes, so pixels come back in their original order
+            __m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi32(inv, inv));
+            __m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi32(inv, inv));
+            lo = _mm256_add_epi16(lo, round);
+            hi = _mm256_add_epi16(hi, round);
+            lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+            hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi8(s, _mm256_packus_epi16(lo, hi)));
+        }
+        blendRowScalar(dst + i, src + i, count - i);
+    }
+#endif
+}
+
+CSoftCompositor::CSoftCompositor()
+    : _width(0), _height(0), _pixels(nullptr), _pitch(0), _blendRow(blendRowScalar), _kernelName("scalar"),
+      _lastDifference(0), _maxDifference(0), _checkedFrames(0),
+      _numThreads(1), _generation(0), _pending(0), _running(true)
+{
+    // widest kernel the CPU runs
+#if defined(__SSE2__)
+    _blendRow = blendRowSse2;
+    _kernelName = "sse2";
+#endif
+#if defined(COMPOSITOR_AVX2)
+    if(__builtin_cpu_supports("avx2")){
+        _blendRow = blendRowAvx2;
+        _kernelName = "avx2";
+    }
+#endif
+}
+
+CSoftCompositor::~CSoftCompositor()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _startFrame.notify_all();
+
+    for(auto& worker: _workers){
+        worker.join();
+    }
+
+    if(_active == this) _active = nullptr;
+}
+
+// create the streaming texture and the worker threads, numThreads 0 uses one thread per core
+bool CSoftCompositor::init(SDL_Renderer& renderer, int width, int height, int numThreads)
+{
+    TRACE_SCOPE("CSoftCompositor::init");
+
+    if(!_target.createStreaming(renderer, width, height)){
+        return false;
+    }
+    // the composed frame is opaque and replaces the whole screen
+    SDL_SetTextureBlendMode(&_target.getTexture(), SDL_BLENDMODE_NONE);
+
+    _width = width;
+    _height = height;
+
+    if(numThreads <= 0) numThreads = SDL_GetCPUCount();
+    _numThreads = std::max(1, std::min(numThreads, AsteroidConstants::COMPOSITOR_MAX_THREADS));
+
+    _commands.reserve(CConfig::get().particleCapacity + AsteroidConstants::COMPOSITOR_SPRITE_COMMANDS);
+    _scratch.assign(_numThreads, std::vector<Uint32>(width));
+
+    // the calling thread composes the band of worker 0
+    for(int worker = 1; worker < _numThreads; worker++){
+        _workers.emplace_back(&CSoftCompositor::workerLoop, this, worker);
+    }
+
+    std::cout << "Software compositor: " << _width << "x" << _height << ", " << _numThreads << " threads, " << _kernelName << " blending\n";
+    return true;
+}
+
+// start recording a frame, texture copies are recorded instead of drawn until end
+void CSoftCompositor::begin()
+{
+    _commands.clear();
+    _active = this;
+}
+
+// record a copy of srcRect of tex (premultiplied pixel copy) scaled to dstRect, nullptr for the whole texture
+void CSoftCompositor::copy(const CTexture& tex, const SDL_Rect* srcRect, const SDL_Rect& dstRect)
+{
+    if(tex.getPixels() == nullptr) return;
+
+    SDL_Rect src = srcRect != nullptr ? *srcRect : SDL_Rect{0, 0, tex.getWidth(), tex.getHeight()};
+    if(src.w <= 0 || src.h <= 0 || dstRect.w <= 0 || dstRect.h <= 0) return;
+    if(dstRect.x >= _width || dstRect.y >= _height || dstRect.x + dstRect.w <= 0 || dstRect.y + dstRect.h <= 0) return;
+
+    _commands.push_back(DrawCommand{tex.getPixels(), tex.getWidth(), src, dstRect, 0});
+}
+
+// record a blended solid rectangle
+void CSoftCompositor::fill(const SDL_Rect& rect, SDL_Color color)
+{
+    if(rect.w <= 0 || rect.h <= 0 || color.a == 0) return;
+    if(rect.x >= _width || rect.y >= _height || rect.x + rect.w <= 0 || rect.y + rect.h <= 0) return;
+
+    // premultiply once per rectangle
+    auto premultiply = [&color](Uint8 c){ return static_cast<Uint32>((c * color.a + 127) / 255);};
+    Uint32 premultiplied = (static_cast<Uint32>(color.a) << 24) | (premultiply(color.r) << 16) | (premultiply(color.g) << 8) | premultiply(color.b);
+
+    _commands.push_back(DrawCommand{nullptr, 0, SDL_Rect{0, 0, 0, 0}, rect, premultiplied});
+}
+
+// compose the frame into the streaming texture and copy it to the renderer
+// reference is an optional ARGB8888 frame of the same size drawn by SDL, its largest color difference is recorded
+bool CSoftCompositor::end(SDL_Renderer& renderer, const Uint32* reference)
+{
+    TRACE_SCOPE("CSoftCompositor::end");
+    _active = nullptr;
+
+    void* pixels = nullptr;
+    int pitch = 0;
+    if(SDL_LockTexture(&_target.getTexture(), nullptr, &pixels, &pitch) != 0){
+        std::cout << "Unable to lock compositor texture! SDL Error: " << SDL_GetError() << "\n";
+        return false;
+    }
+    _pixels = static_cast<Uint32*>(pixels);
+    _pitch = pitch / sizeof(Uint32);
+
+    {
+        TRACE_SCOPE("compose");
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending = _numThreads - 1;
+            _generation++;
+        }
+        _startFrame.notify_all();
+
+        composeBand(0);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _finishFrame.wait(lock, [this]{ return _pending == 0;});
+    }
+
+    if(reference != nullptr){
+        _lastDifference = compare(reference);
+        _maxDifference = std::max(_maxDifference, _lastDifference);
+        _checkedFrames++;
+        if(_lastDifference > AsteroidConstants::COMPOSITOR_CHECK_TOLERANCE){
+            std::cout << "Compositor check: frame differs from the SDL image by " << _lastDifference << "\n";
+        }
+    }
+
+    SDL_UnlockTexture(&_target.getTexture());
+    _pixels = nullptr;
+
+    SDL_RenderCopy(&renderer, &_target.getTexture(), nullptr, nullptr);
+    CMetrics::add(Metric::RENDER_COPY);
+    return true;
+}
+
+// frames compared with the SDL image and their largest difference
+void CSoftCompositor::printCheckSummary() const
+{
+    std::cout << "Compositor check: " << _checkedFrames << " frames compared, largest channel difference " << _maxDifference
+              << " (tolerance " << AsteroidConstants::COMPOSITOR_CHECK_TOLERANCE << ")" << (hasFailed() ? " FAILED" : "") << "\n";
+}
+
+// wait for a frame and compose this worker's band
+void CSoftCompositor::workerLoop(int worker)
+{
+    std::uint64_t generation = 0;
+
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _startFrame.wait(lock, [this, generation]{ return !_running || _generation != generation;});
+            if(!_running) return;
+            generation = _generation;
+        }
+
+        composeBand(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending--;
+        }
+        _finishFrame.notify_one();
+    }
+}
+
+// compose all commands clipped to the rows of worker
+// every worker owns a contiguous band of rows, so commands are replayed in order without sharing any pixels
+void CSoftCompositor::composeBand(int worker)
+{
+    int bandTop = static_cast<long long>(_height) * worker / _numThreads;
+    int bandBottom = static_cast<long long>(_height) * (worker + 1) / _numThreads;
+    Uint32* scratch = _scratch[worker].data();
+
+    // cleared to opaque black like the SDL frame
+    for(int y = bandTop; y < bandBottom; y++){
+        std::fill(_pixels + y*_pitch, _pixels + y*_pitch + _width, 0xFF000000);
+    }
+
+    for(const DrawCommand& cmd: _commands){
+        const SDL_Rect& dst = cmd.dst;
+        int x0 = std::max(dst.x, 0);
+        int x1 = std::min(dst.x + dst.w, _width);
+        int y0 = std::max(dst.y, bandTop);
+        int y1 = std::min(dst.y + dst.h, bandBottom);
+        if(x0 >= x1 || y0 >= y1) continue;
+
+        int count = x1 - x0;
+
+        if(cmd.pixels == nullptr){
+            for(int y = y0; y < y1; y++){
+                Uint32* row = _pixels + y*_pitch;
+                for(int x = x0; x < x1; x++){
+                    row[x] = blendPixel(cmd.color, row[x]);
+                }
+            }
+            continue;
+        }
+
+        // nearest neighbour sampling with the 16.16 steps of SDL's scaled blits
+        const SDL_Rect& src = cmd.src;
+        bool scaled = src.w != dst.w || src.h != dst.h;
+        Uint32 stepX = (static_cast<Uint32>(src.w) << 16) / dst.w;
+        Uint32 stepY = (static_cast<Uint32>(src.h) << 16) / dst.h;
+
+        for(int y = y0; y < y1; y++){
+            int srcY = src.y + (scaled ? static_cast<int>((stepY/2 + static_cast<Uint32>(y - dst.y)*stepY) >> 16) : y - dst.y);
+            const Uint32* srcRow = cmd.pixels + srcY*cmd.pitch + src.x;
+
+            if(!scaled){
+                _blendRow(_pixels + y*_pitch + x0, srcRow + (x0 - dst.x), count);
+                continue;
+            }
+
+            Uint32 pos = stepX/2 + static_cast<Uint32>(x0 - dst.x)*stepX;
+            for(int i = 0; i < count; i++, pos += stepX){
+                scratch[i] = srcRow[pos >> 16];
+            }
+            _blendRow(_pixels + y*_pitch + x0, scratch, count);
+        }
+    }
+}
+
+// largest color channel difference to a frame drawn by SDL
+int CSoftCompositor::compare(const Uint32* reference) const
+{
+    int difference = 0;
+    for(int y = 0; y < _height; y++){
+        const Uint32* row = _pixels + y*_pitch;
+        const Uint32* refRow = reference + y*_width;
+        for(int x = 0; x < _width; x++){
+            for(int shift = 0; shift < 24; shift += 8){
+                int a = (row[x] >> shift) & 0xFF;
+                int b = (refRow[x] >> shift) & 0xFF;
+                difference = std::max(difference, std::abs(a - b));
+            }
+        }
+    }
+    return difference;
+}
+
+// compositor recording the current frame, nullptr outside begin/end
+CSoftCompositor* CSoftCompositor::getActive() { return _active;}
+
+// row kernel, nullptr if it is not compiled in or the CPU lacks it, lets the benchmarks run every variant on the same rows
+CSoftCompositor::BlendRowFn CSoftCompositor::getBlendKernel(BlendKernel kernel)
+{
+    switch(kernel){
+        case BlendKernel::SCALAR:
+            return blendRowScalar;
+#if defined(__SSE2__)
+        case BlendKernel::SSE2:
+            return blendRowSse2;
+#endif
+#if defined(COMPOSITOR_AVX2)
+        case BlendKernel::AVX2:
+            return __builtin_cpu_supports("avx2") ? blendRowAvx2 : nullptr;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+// getters
+const char* CSoftCompositor::getKernelName() const { return _kernelName;}
+int CSoftCompositor::getNumThreads() const { return _numThreads;}
+int CSoftCompositor::getWidth() const { return _width;}
+int CSoftCompositor::getHeight() const { return _height;}
+int CSoftCompositor::getLastDifference() const { return _lastDifference;}
+bool CSoftCompositor::hasFailed() const { return _maxDifference > AsteroidConstants::COMPOSITOR_CHECK_TOLERANCE;}
@@ -0,0 +1,112 @@
+/* File:            CSoftCompositor.h
+ * Author:          Vish Potnis
+ * Description:     - CPU compositor for renderers without a GPU
+ *                  - Records the copies and particle quads of a frame and composes them into a streaming texture
+ *                  - Premultiplied alpha blending with SSE2/AVX2 row kernels, the frame is split into row bands composed in parallel
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "constants.h"
+#include "utility.h"
+#include "CTexture.h"
+
+// premultiplied alpha row blend kernels, the compositor picks the widest one the CPU runs
+enum class BlendKernel
+{
+    SCALAR,
+    SSE2,
+    AVX2,
+    BLEND_KERNEL_TOTAL
+};
+
+class CSoftCompositor
+{
+    public:
+        using BlendRowFn = void (*)(Uint32* dst, const Uint32* src, int count);
+
+        CSoftCompositor();
+        ~CSoftCompositor();
+
+        CSoftCompositor(const CSoftCompositor&) = delete;
+        CSoftCompositor& operator=(const CSoftCompositor&) = delete;
+
+        // create the streaming texture and the worker threads, numThreads 0 uses one thread per core
+        bool init(SDL_Renderer& renderer, int width, int height, int numThreads = 0);
+
+        void begin();       // start recording a frame, texture copies are recorded instead of drawn until end
+
+        // record a copy of srcRect of tex (premultiplied pixel copy) scaled to dstRect, nullptr for the whole texture
+        void copy(const CTexture& tex, const SDL_Rect* srcRect, const SDL_Rect& dstRect);
+        void fill(const SDL_Rect& rect, SDL_Color color);      // record a blended solid rectangle
+
+        // compose the frame into the streaming texture and copy it to the renderer
+        // reference is an optional ARGB8888 frame of the same size drawn by SDL, its largest color difference is recorded
+        bool end(SDL_Renderer& renderer, const Uint32* reference = nullptr);
+
+        void printCheckSummary() const;     // frames compared with the SDL image and their largest difference
+
+        static CSoftCompositor* getActive();        // compositor recording the current frame, nullptr outside begin/end
+        static BlendRowFn getBlendKernel(BlendKernel kernel);  // row kernel, nullptr if it is not compiled in or the CPU lacks it
+
+        // getters
+        const char* getKernelName() const;          // blend kernel picked for this CPU
+        int getNumThreads() const;
+        int getWidth() const;
+        int getHeight() const;
+        int getLastDifference() const;              // largest channel difference of the last compared frame
+        bool hasFailed() const;                     // a compared frame differed by more than COMPOSITOR_CHECK_TOLERANCE
+
+    private:
+
+        // one recorded draw, a fill when pixels is nullptr
+        struct DrawCommand
+        {
+            const Uint32* pixels;       // premultiplied source pixels
+            int pitch;                  // source pixels per row
+            SDL_Rect src;
+            SDL_Rect dst;
+            Uint32 color;               // premultiplied fill color
+        };
+
+        void workerLoop(int worker);                // wait for a frame and compose this worker's band
+        void composeBand(int worker);               // compose all commands clipped to the rows of worker
+        int compare(const Uint32* reference) const; // largest color channel difference to a frame drawn by SDL
+
+        CTexture _target;                           // streaming texture the frame is composed into
+        int _width;
+        int _height;
+
+        Uint32* _pixels;                            // locked texture pixels of the frame being composed
+        int _pitch;                                 // locked pixels per row
+
+        std::vector<DrawCommand> _commands;         // draws of the current frame in order
+        std::vector<std::vector<Uint32>> _scratch;  // one row of scaled source pixels per worker
+        BlendRowFn _blendRow;
+        const char* _kernelName;
+
+        // comparison with the SDL renderer
+        int _lastDifference;
+        int _maxDifference;
+        int _checkedFrames;
+
+        // worker synchronization, every frame bumps the generation and waits for all workers to finish
+        int _numThreads;                            // worker threads plus the calling thread
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+        std::condition_variable _startFrame;
+        std::condition_variable _finishFrame;
+        std::uint64_t _generation;
+        int _pending;                               // workers still composing the current frame
+        bool _running;
+
+        static CSoftCompositor* _active;
+};
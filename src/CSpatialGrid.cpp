@@ -0,0 +1,84 @@
+/* File:            CSpatialGrid.cpp
+ * Author:          Vish Potnis
+ * Description:     - Uniform grid spatial index over the wrapping world
+ *                  - Objects are bucketed by their center position
+ *                  - Queries return the IDs of objects that may overlap a world rectangle
+ */
+
+#include "CSpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+CSpatialGrid::CSpatialGrid(int worldWidth, int worldHeight, int cellSize)
+    : _worldWidth(worldWidth), _worldHeight(worldHeight), _cellSize(cellSize), _maxHalfExtent(0)
+{
+    _cols = (worldWidth + cellSize - 1) / cellSize;
+    _rows = (worldHeight + cellSize - 1) / cellSize;
+    _cells.resize(_cols * _rows);
+}
+
+// remove all objects, cell storage is kept for the next frame
+void CSpatialGrid::clear()
+{
+    for(auto& cell: _cells){
+        cell.clear();
+    }
+    _maxHalfExtent = 0;
+}
+
+// add object with center position and half of its largest side
+void CSpatialGrid::insert(int id, const Point& pos, int halfExtent)
+{
+    int col = std::clamp(static_cast<int>(pos.x) / _cellSize, 0, _cols - 1);
+    int row = std::clamp(static_cast<int>(pos.y) / _cellSize, 0, _rows - 1);
+
+    _cells[row * _cols + col].push_back(id);
+    _maxHalfExtent = std::max(_maxHalfExtent, halfExtent);
+}
+
+// append IDs of objects that may overlap the world rectangle
+// the rectangle is grown by the largest object half extent since objects are bucketed by center only
+void CSpatialGrid::query(const SDL_Rect& rect, std::vector<int>& result) const
+{
+    _queryCols.clear();
+    _queryRows.clear();
+    cellRange(rect.x - _maxHalfExtent, rect.w + 2*_maxHalfExtent, _worldWidth, _cols, _queryCols);
+    cellRange(rect.y - _maxHalfExtent, rect.h + 2*_maxHalfExtent, _worldHeight, _rows, _queryRows);
+
+    for(int row: _queryRows){
+        for(int col: _queryCols){
+            const std::vector<int>& cell = _cells[row * _cols + col];
+            result.insert(result.end(), cell.begin(), cell.end());
+        }
+    }
+}
+
+// append wrapped cell indices covering [start, start+length) along one axis
+// the range is split in two where it crosses the world edge, each cell is added at most once
+void CSpatialGrid::cellRange(int start, int length, int worldSize, int numCells, std::vector<int>& cells) const
+{
+    if(length >= worldSize){
+        for(int i = 0; i < numCells; i++){
+            cells.push_back(i);
+        }
+        return;
+    }
+
+    start %= worldSize;
+    if(start < 0) start += worldSize;
+    int end = start + length;
+
+    int first = start / _cellSize;
+    int last = (std::min(end, worldSize) - 1) / _cellSize;
+    for(int i = first; i <= last; i++){
+        cells.push_back(i);
+    }
+
+    // range wraps around the world edge
+    if(end > worldSize){
+        int wrappedLast = std::min((end - worldSize - 1) / _cellSize, first - 1);
+        for(int i = 0; i <= wrappedLast; i++){
+            cells.push_back(i);
+        }
+    }
+}
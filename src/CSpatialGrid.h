@@ -0,0 +1,42 @@
+/* File:            CSpatialGrid.h
+ * Author:          Vish Potnis
+ * Description:     - Uniform grid spatial index over the wrapping world
+ *                  - Objects are bucketed by their center position
+ *                  - Queries return the IDs of objects that may overlap a world rectangle
+ */
+
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+#include "utility.h"
+
+class CSpatialGrid
+{
+    public:
+        CSpatialGrid(int worldWidth, int worldHeight, int cellSize);
+
+        void clear();                                               // remove all objects, cell storage is kept for the next frame
+        void insert(int id, const Point& pos, int halfExtent);      // add object with center position and half of its largest side
+
+        // append IDs of objects that may overlap the world rectangle, the rectangle can extend past the world edges
+        void query(const SDL_Rect& rect, std::vector<int>& result) const;
+
+    private:
+
+        // append wrapped cell indices covering [start, start+length) along one axis
+        void cellRange(int start, int length, int worldSize, int numCells, std::vector<int>& cells) const;
+
+        int _worldWidth;
+        int _worldHeight;
+        int _cellSize;
+        int _cols;
+        int _rows;
+        int _maxHalfExtent;         // largest object half extent inserted since the last clear, used to grow queries
+
+        std::vector<std::vector<int>> _cells;   // object IDs per cell, row major
+
+        mutable std::vector<int> _queryCols;    // scratch buffers for queries
+        mutable std::vector<int> _queryRows;
+};
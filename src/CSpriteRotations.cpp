@@ -0,0 +1,143 @@
+/* File:            CSpriteRotations.cpp
+ * Author:          Vish Potnis
+ * Description:     - Atlas of a sprite pre-rotated to every ship orientation
+ *                  - Built once with a render target, each orientation keeps its tight bounds from the alpha channel
+ *                  - Drawing an orientation is a plain copy instead of a rotation on every draw
+ */
+
+#include "CSpriteRotations.h"
+#include "CTracer.h"
+#include "CMetrics.h"
+
+#include <cmath>
+
+CSpriteRotations::CSpriteRotations()
+{}
+
+// rasterize tex scaled to width x height at every orientation, false if the renderer has no render targets
+bool CSpriteRotations::build(SDL_Renderer& renderer, const CTexture& tex, int width, int height)
+{
+    TRACE_SCOPE("CSpriteRotations::build");
+
+    free();
+
+    if(!SDL_RenderTargetSupported(&renderer)){
+        std::cout << "Render targets not supported, sprites are rotated on every draw\n";
+        return false;
+    }
+
+    const int count = AsteroidConstants::SPRITE_ROTATIONS;
+
+    // square cells large enough for the sprite at any angle
+    int cellSize = static_cast<int>(std::ceil(std::hypot(width, height))) + 2;
+    int columns = static_cast<int>(std::ceil(std::sqrt(count)));
+    int rows = (count + columns - 1) / columns;
+
+    if(!_atlas.createTarget(renderer, columns*cellSize, rows*cellSize)){
+        return false;
+    }
+
+    // the source is copied without blending so the atlas holds its exact alpha
+    SDL_Texture* prevTarget = SDL_GetRenderTarget(&renderer);
+    SDL_BlendMode prevBlend;
+    SDL_GetTextureBlendMode(&tex.getTexture(), &prevBlend);
+    SDL_SetTextureBlendMode(&tex.getTexture(), SDL_BLENDMODE_NONE);
+
+    SDL_SetRenderTarget(&renderer, &_atlas.getTexture());
+    SDL_SetRenderDrawColor(&renderer, 0, 0, 0, 0);
+    SDL_RenderClear(&renderer);
+
+    // sprite is placed in a cell like the unrotated sprite around its center
+    int left = (cellSize - width)/2;
+    int top = (cellSize - height)/2;
+
+    for(int i = 0; i < count; i++){
+        SDL_Rect dstRect{(i % columns)*cellSize + left, (i / columns)*cellSize + top, width, height};
+        SDL_RenderCopyEx(&renderer, &tex.getTexture(), nullptr, &dstRect, i*AsteroidConstants::SHIP_ROTATION_STEP, nullptr, SDL_FLIP_NONE);
+    }
+
+    // read back the atlas to find the tight bounds of every orientation
+    std::vector<Uint32> pixels(static_cast<size_t>(_atlas.getWidth())*_atlas.getHeight());
+    int readResult = SDL_RenderReadPixels(&renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, pixels.data(), _atlas.getWidth()*sizeof(Uint32));
+
+    SDL_SetRenderTarget(&renderer, prevTarget);
+    SDL_SetTextureBlendMode(&tex.getTexture(), prevBlend);
+    SDL_SetTextureBlendMode(&_atlas.getTexture(), SDL_BLENDMODE_BLEND);
+
+    if(readResult != 0){
+        std::cout << "Unable to read rotated sprites! SDL Error: " << SDL_GetError() << "\n";
+        free();
+        return false;
+    }
+
+    // the software compositor draws from the same pixels
+    if(CTexture::isKeepingPixelCopies()){
+        _atlas.storePixels(pixels.data(), _atlas.getWidth()*sizeof(Uint32));
+    }
+
+    _srcRects.resize(count);
+    _offsets.resize(count);
+    for(int i = 0; i < count; i++){
+        int cellX = (i % columns)*cellSize;
+        int cellY = (i / columns)*cellSize;
+
+        int minX = cellSize, minY = cellSize, maxX = -1, maxY = -1;
+        for(int y = 0; y < cellSize; y++){
+            const Uint32* row = &pixels[static_cast<size_t>(cellY + y)*_atlas.getWidth() + cellX];
+            for(int x = 0; x < cellSize; x++){
+                if((row[x] >> 24) == 0) continue;
+                if(x < minX) minX = x;
+                if(x > maxX) maxX = x;
+                if(y < minY) minY = y;
+                if(y > maxY) maxY = y;
+            }
+        }
+
+        // fully transparent orientation, keep the whole cell
+        if(maxX < 0){
+            minX = minY = 0;
+            maxX = maxY = cellSize - 1;
+        }
+
+        _srcRects[i] = SDL_Rect{cellX + minX, cellY + minY, maxX - minX + 1, maxY - minY + 1};
+        _offsets[i] = SDL_Point{minX - left - width/2, minY - top - height/2};
+    }
+
+    return true;
+}
+
+// world space bounds of the sprite centered on pos at rotation, the same placement as the unrotated sprite
+SDL_Rect CSpriteRotations::getBounds(const Point& pos, double rotation) const
+{
+    int index = getIndex(rotation);
+    int xPosCenter = std::round(pos.x);
+    int yPosCenter = std::round(pos.y);
+
+    return SDL_Rect{xPosCenter + _offsets[index].x, yPosCenter + _offsets[index].y, _srcRects[index].w, _srcRects[index].h};
+}
+
+// copy the sprite at rotation into the screen rectangle returned by the camera for getBounds
+void CSpriteRotations::render(SDL_Renderer& renderer, double rotation, const SDL_Rect& dstRect) const
+{
+    _atlas.render(renderer, &_srcRects[getIndex(rotation)], dstRect);
+    CMetrics::add(Metric::RENDER_COPY);
+}
+
+// orientation closest to a rotation in degrees
+int CSpriteRotations::getIndex(double rotation)
+{
+    const int count = AsteroidConstants::SPRITE_ROTATIONS;
+    int index = static_cast<int>(std::lround(rotation / AsteroidConstants::SHIP_ROTATION_STEP)) % count;
+    return index < 0 ? index + count : index;
+}
+
+bool CSpriteRotations::isBuilt() const { return !_srcRects.empty();}
+SDL_Texture& CSpriteRotations::getTexture() const { return _atlas.getTexture();}
+
+// release the atlas
+void CSpriteRotations::free()
+{
+    _atlas.free();
+    _srcRects.clear();
+    _offsets.clear();
+}
@@ -0,0 +1,43 @@
+/* File:            CSpriteRotations.h
+ * Author:          Vish Potnis
+ * Description:     - Atlas of a sprite pre-rotated to every ship orientation
+ *                  - Built once with a render target, each orientation keeps its tight bounds from the alpha channel
+ *                  - Drawing an orientation is a plain copy instead of a rotation on every draw
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <vector>
+
+#include "constants.h"
+#include "utility.h"
+#include "CTexture.h"
+
+class CSpriteRotations
+{
+    public:
+        CSpriteRotations();
+
+        // rasterize tex scaled to width x height at every orientation, false if the renderer has no render targets
+        bool build(SDL_Renderer& renderer, const CTexture& tex, int width, int height);
+
+        // world space bounds of the sprite centered on pos at rotation, the same placement as the unrotated sprite
+        SDL_Rect getBounds(const Point& pos, double rotation) const;
+
+        // copy the sprite at rotation into the screen rectangle returned by the camera for getBounds
+        void render(SDL_Renderer& renderer, double rotation, const SDL_Rect& dstRect) const;
+
+        static int getIndex(double rotation);      // orientation closest to a rotation in degrees
+
+        bool isBuilt() const;
+        SDL_Texture& getTexture() const;           // atlas texture, e.g. for color modulation
+        void free();
+
+    private:
+
+        CTexture _atlas;                    // all orientations in a grid of square cells
+        std::vector<SDL_Rect> _srcRects;    // tight rectangle of each orientation in the atlas
+        std::vector<SDL_Point> _offsets;    // top left of each tight rectangle relative to the object center
+};
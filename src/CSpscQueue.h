@@ -0,0 +1,79 @@
+/* File:            CSpscQueue.h
+ * Author:          Vish Potnis
+ * Description:     - Bounded lock-free queue for one producer thread and one consumer thread
+ *                  - Storage is allocated once, push fails instead of blocking when the queue is full
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+template<typename T>
+class CSpscQueue
+{
+    public:
+        // capacity is rounded up to a power of 2
+        explicit CSpscQueue(std::size_t capacity)
+        {
+            std::size_t size = 1;
+            while(size < capacity) size <<= 1;
+            _items.resize(size);
+            _mask = size - 1;
+        }
+
+        CSpscQueue(const CSpscQueue&) = delete;
+        CSpscQueue& operator=(const CSpscQueue&) = delete;
+
+        // producer: add item, returns false if the queue is full
+        bool push(const T& item)
+        {
+            std::size_t head = _head.load(std::memory_order_relaxed);
+            if(head - _tail.load(std::memory_order_acquire) > _mask){
+                return false;
+            }
+            _items[head & _mask] = item;
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer: remove oldest item, returns false if the queue is empty
+        bool pop(T& item)
+        {
+            std::size_t tail = _tail.load(std::memory_order_relaxed);
+            if(tail == _head.load(std::memory_order_acquire)){
+                return false;
+            }
+            item = _items[tail & _mask];
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer: look at oldest item without removing it, nullptr if the queue is empty
+        const T* peek() const
+        {
+            std::size_t tail = _tail.load(std::memory_order_relaxed);
+            if(tail == _head.load(std::memory_order_acquire)){
+                return nullptr;
+            }
+            return &_items[tail & _mask];
+        }
+
+        // approximate number of queued items, exact when called from either end while the other is idle
+        std::size_t size() const
+        {
+            return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+        }
+
+        std::size_t capacity() const { return _mask + 1;}
+
+    private:
+
+        std::vector<T> _items;
+        std::size_t _mask;
+
+        // producer and consumer indices on separate cache lines to avoid false sharing
+        alignas(64) std::atomic<std::size_t> _head{0};
+        alignas(64) std::atomic<std::size_t> _tail{0};
+};
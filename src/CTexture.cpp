@@ -5,6 +5,12 @@
 
 
 #include "CTexture.h"
+#include "CTracer.h"
+#include "CMetrics.h"
+#include "CSoftCompositor.h"
+
+int CTexture::_liveCount{0};
+bool CTexture::_keepPixels{false};
 
 CTexture::CTexture() : _texture(nullptr, SDL_DestroyTexture)
 {}
@@ -15,7 +21,7 @@ CTexture::~CTexture()
 }
 
 // move constructor for transferring ownership of texture 
-CTexture::CTexture(CTexture&& o) : _texture(std::move(o._texture))
+CTexture::CTexture(CTexture&& o) : _texture(std::move(o._texture)), _pixels(std::move(o._pixels))
 {
     _width = o._width;
     _height = o._height;
@@ -27,6 +33,8 @@ CTexture::CTexture(CTexture&& o) : _texture(std::move(o._texture))
 // create texture from png file
 bool CTexture::loadFromFile(SDL_Renderer& renderer, std::string path)
 {
+    TRACE_SCOPE("CTexture::loadFromFile");
+
     // destroy existing texture
     free();
 
@@ -38,15 +46,21 @@ bool CTexture::loadFromFile(SDL_Renderer& renderer, std::string path)
     }
     
     // convert SDL surface to SDL texture
-    _texture.reset(SDL_CreateTextureFromSurface(&renderer, loadedSurface));
+    {
+        TRACE_SCOPE("SDL_CreateTextureFromSurface");
+        _texture.reset(SDL_CreateTextureFromSurface(&renderer, loadedSurface));
+        CMetrics::add(Metric::TEXTURE_CREATIONS);
+    }
     if(_texture == nullptr){
         std::cout << "Unable to create texture from " << path << "! SDL Error: " << SDL_GetError() << "\n";
         return false;
     }
+    _liveCount++;
     
     //get image dimensions
     _width = loadedSurface->w;
     _height = loadedSurface->h;       
+    if(_keepPixels) storePixels(*loadedSurface);
     SDL_FreeSurface(loadedSurface);        
     
     return true;
@@ -56,6 +70,8 @@ bool CTexture::loadFromFile(SDL_Renderer& renderer, std::string path)
 // create texture from font file
 bool CTexture::loadFromRenderedText(SDL_Renderer& renderer, TTF_Font* font, std::string text, SDL_Color textColor)
 {
+    TRACE_SCOPE("CTexture::loadFromRenderedText");
+
     free();
 
     // create SDL surface from text using loaded font and specified color
@@ -66,30 +82,128 @@ bool CTexture::loadFromRenderedText(SDL_Renderer& renderer, TTF_Font* font, std:
     }
 
     // convert SDL surface to SDL texture
-    _texture.reset(SDL_CreateTextureFromSurface(&renderer, textSurface));
+    {
+        TRACE_SCOPE("SDL_CreateTextureFromSurface");
+        _texture.reset(SDL_CreateTextureFromSurface(&renderer, textSurface));
+        CMetrics::add(Metric::TEXTURE_CREATIONS);
+    }
     if(_texture == nullptr){
         std::cout << "Unable to create texture from rendered text! SDL Error: " << SDL_GetError() << "\n";
         return false;
     }
+    _liveCount++;
     
     //get image dimensions
     _width = textSurface->w;
     _height = textSurface->h;       
+    if(_keepPixels) storePixels(*textSurface);
     SDL_FreeSurface(textSurface);        
     
     return true;
 }
 
+// create an empty texture that can be used as render target
+bool CTexture::createTarget(SDL_Renderer& renderer, int width, int height)
+{
+    TRACE_SCOPE("CTexture::createTarget");
+
+    free();
+
+    _texture.reset(SDL_CreateTexture(&renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height));
+    CMetrics::add(Metric::TEXTURE_CREATIONS);
+    if(_texture == nullptr){
+        std::cout << "Unable to create target texture! SDL Error: " << SDL_GetError() << "\n";
+        return false;
+    }
+    _liveCount++;
+
+    _width = width;
+    _height = height;
+
+    return true;
+}
+// create an ARGB8888 texture that is updated from the CPU
+bool CTexture::createStreaming(SDL_Renderer& renderer, int width, int height)
+{
+    TRACE_SCOPE("CTexture::createStreaming");
+
+    free();
+
+    _texture.reset(SDL_CreateTexture(&renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height));
+    CMetrics::add(Metric::TEXTURE_CREATIONS);
+    if(_texture == nullptr){
+        std::cout << "Unable to create streaming texture! SDL Error: " << SDL_GetError() << "\n";
+        return false;
+    }
+    _liveCount++;
+
+    _width = width;
+    _height = height;
+
+    return true;
+}
+
+// copy srcRect (nullptr for the whole texture) to dstRect, recorded by the software compositor while it is active
+void CTexture::render(SDL_Renderer& renderer, const SDL_Rect* srcRect, const SDL_Rect& dstRect) const
+{
+    CSoftCompositor* compositor = CSoftCompositor::getActive();
+    if(compositor != nullptr && !_pixels.empty()){
+        compositor->copy(*this, srcRect, dstRect);
+        return;
+    }
+    SDL_RenderCopy(&renderer, _texture.get(), srcRect, &dstRect);
+}
+
+// keep a premultiplied copy of ARGB8888 pixels of the texture size for the software compositor
+void CTexture::storePixels(const Uint32* pixels, int pitch)
+{
+    _pixels.resize(static_cast<size_t>(_width)*_height);
+    for(int y = 0; y < _height; y++){
+        const Uint32* row = reinterpret_cast<const Uint32*>(reinterpret_cast<const Uint8*>(pixels) + y*pitch);
+        for(int x = 0; x < _width; x++){
+            Uint32 p = row[x];
+            Uint32 a = p >> 24;
+            Uint32 r = (((p >> 16) & 0xFF) * a + 127) / 255;
+            Uint32 g = (((p >> 8) & 0xFF) * a + 127) / 255;
+            Uint32 b = ((p & 0xFF) * a + 127) / 255;
+            _pixels[y*_width + x] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+}
+
+// convert a loaded surface to ARGB8888 and keep its pixels, color keyed pixels become transparent
+void CTexture::storePixels(const SDL_Surface& surface)
+{
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(const_cast<SDL_Surface*>(&surface), SDL_PIXELFORMAT_ARGB8888, 0);
+    if(converted == nullptr){
+        std::cout << "Unable to convert surface for the software compositor! SDL Error: " << SDL_GetError() << "\n";
+        return;
+    }
+    storePixels(static_cast<const Uint32*>(converted->pixels), converted->pitch);
+    SDL_FreeSurface(converted);
+}
 
 // getter functions
 SDL_Texture& CTexture::getTexture() const { return *_texture;}
 int CTexture::getWidth() const { return _width;}
 int CTexture::getHeight() const { return _height;}
+const Uint32* CTexture::getPixels() const { return _pixels.empty() ? nullptr : _pixels.data();}
+
+// number of SDL textures currently held by all texture objects
+int CTexture::getLiveCount() { return _liveCount;}
+
+// textures loaded afterwards keep a pixel copy for the software compositor
+void CTexture::keepPixelCopies(bool keep) { _keepPixels = keep;}
+bool CTexture::isKeepingPixelCopies() { return _keepPixels;}
 
 // reset class
 void CTexture::free()
 {
+    if(_texture != nullptr){
+        _liveCount--;
+    }
     _texture = nullptr;
+    _pixels.clear();
     _width = 0;
     _height = 0;
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "constants.h"
 #include "utility.h"
@@ -36,18 +37,41 @@ class CTexture
         // create texture from font file
         bool loadFromRenderedText(SDL_Renderer& renderer, TTF_Font* font, std::string text, SDL_Color textColor);
 
+        // create an empty texture that can be used as render target
+        bool createTarget(SDL_Renderer& renderer, int width, int height);
+
+        // create an ARGB8888 texture that is updated from the CPU
+        bool createStreaming(SDL_Renderer& renderer, int width, int height);
+
+        // copy srcRect (nullptr for the whole texture) to dstRect, recorded by the software compositor while it is active
+        void render(SDL_Renderer& renderer, const SDL_Rect* srcRect, const SDL_Rect& dstRect) const;
+
+        // keep a premultiplied copy of ARGB8888 pixels of the texture size for the software compositor
+        void storePixels(const Uint32* pixels, int pitch);
+
         // getter functions
         SDL_Texture& getTexture() const;        
         int getWidth() const;
         int getHeight() const;
+        const Uint32* getPixels() const;    // premultiplied pixel copy, nullptr if none is kept
+
+        static int getLiveCount();          // number of SDL textures currently held by all texture objects
+        static void keepPixelCopies(bool keep);     // textures loaded afterwards keep a pixel copy for the software compositor
+        static bool isKeepingPixelCopies();
         
         void free();        
 
     private:
+
+        void storePixels(const SDL_Surface& surface);   // convert a loaded surface to ARGB8888 and keep its pixels
         
         SDL_Texture_unique_ptr _texture;    // smart pointer holding the texture object
     
         int _width{0};      // width of texture
         int _height{0};     // height of texture
+        std::vector<Uint32> _pixels;        // premultiplied ARGB copy for the software compositor, empty if not kept
+
+        static int _liveCount;  // textures created and not yet destroyed, tracked to find texture leaks
+        static bool _keepPixels;    // keep pixel copies of loaded textures
 
 };
\ No newline at end of file
@@ -0,0 +1,216 @@
+/* File:            CTimerWheel.cpp
+ * Author:          Vish Potnis
+ * Description:     - Hierarchical timing wheel for scheduling game events
+ *                  - Callbacks are scheduled in milliseconds on the SDL_GetTicks clock
+ *                  - Advancing the wheel only touches timers that expire or cascade
+ */
+
+#include "CTimerWheel.h"
+#include <utility>
+
+CTimerWheel::CTimerWheel(Uint32 currentTime)
+    : _slots(NUM_LEVELS * NUM_SLOTS, -1), _currentTime(currentTime), _pending(0)
+{}
+
+// fire callback delay ms after the current wheel time
+TimerHandle CTimerWheel::schedule(Uint32 delay, TimerCallback callback)
+{
+    return scheduleAt(_currentTime + delay, std::move(callback));
+}
+
+// fire callback at the given time, past times fire on the next advance
+TimerHandle CTimerWheel::scheduleAt(Uint32 time, TimerCallback callback)
+{
+    // the current tick has already been processed
+    if(static_cast<Sint32>(time - _currentTime) <= 0){
+        time = _currentTime + 1;
+    }
+
+    int idx;
+    if(_freeList.empty()){
+        idx = static_cast<int>(_timers.size());
+        _timers.push_back(Timer{0, 0, -1, -1, -1, nullptr});
+    }
+    else{
+        idx = _freeList.back();
+        _freeList.pop_back();
+    }
+
+    Timer& timer = _timers[idx];
+    timer.expiry = time;
+    timer.callback = std::move(callback);
+    insert(idx);
+    _pending++;
+
+    return (static_cast<TimerHandle>(timer.generation) << 32) | static_cast<Uint32>(idx);
+}
+
+// remove a pending timer, returns false if it already fired or was cancelled
+bool CTimerWheel::cancel(TimerHandle handle)
+{
+    Uint32 idx = static_cast<Uint32>(handle & 0xFFFFFFFF);
+    Uint32 generation = static_cast<Uint32>(handle >> 32);
+
+    if(idx >= _timers.size() || _timers[idx].generation != generation || _timers[idx].slot < 0){
+        return false;
+    }
+
+    unlink(idx);
+    release(idx);
+    return true;
+}
+
+// move wheel time forward and fire all due callbacks in expiry order
+void CTimerWheel::advance(Uint32 now)
+{
+    while(static_cast<Sint32>(now - _currentTime) > 0){
+
+        // nothing left to fire, skip straight to the target time
+        if(_pending == 0){
+            _currentTime = now;
+            return;
+        }
+
+        _currentTime++;
+
+        // when a level wraps around pull the next slot of the coarser level down
+        for(int level = 1; level < NUM_LEVELS; level++){
+            if((_currentTime >> (SLOT_BITS * (level - 1))) & (NUM_SLOTS - 1)){
+                break;
+            }
+            cascade(level);
+        }
+
+        fireSlot(_currentTime & (NUM_SLOTS - 1));
+    }
+}
+
+// drop all pending timers and restart the wheel at currentTime
+void CTimerWheel::reset(Uint32 currentTime)
+{
+    for(unsigned int i = 0; i < _timers.size(); i++){
+        if(_timers[i].slot >= 0){
+            unlink(i);
+            release(i);
+        }
+    }
+    _currentTime = currentTime;
+}
+
+// move wheel time and every pending timer delta ms later, handles stay valid
+// the slot of a timer depends on the wheel time, so pending timers are taken out first and inserted again afterwards
+void CTimerWheel::shift(Uint32 delta)
+{
+    if(delta == 0 || _pending == 0){
+        _currentTime += delta;
+        return;
+    }
+
+    for(unsigned int i = 0; i < _timers.size(); i++){
+        if(_timers[i].slot >= 0){
+            unlink(i);
+        }
+    }
+
+    _currentTime += delta;
+
+    // released timers have no callback
+    for(unsigned int i = 0; i < _timers.size(); i++){
+        if(_timers[i].callback){
+            _timers[i].expiry += delta;
+            insert(i);
+        }
+    }
+}
+
+// getters
+int CTimerWheel::getPending() const { return _pending;}
+Uint32 CTimerWheel::getTime() const { return _currentTime;}
+
+// place timer into the slot matching its expiry
+// level n holds timers expiring less than 64^(n+1) ms from now, timers further out wait in the last level
+void CTimerWheel::insert(int idx)
+{
+    Timer& timer = _timers[idx];
+    Uint32 delta = timer.expiry - _currentTime;
+
+    int level = 0;
+    while(level < NUM_LEVELS - 1 && delta >= (1u << (SLOT_BITS * (level + 1)))){
+        level++;
+    }
+
+    Uint32 slotTime = timer.expiry;
+    if(level == NUM_LEVELS - 1 && delta >= (1u << (SLOT_BITS * NUM_LEVELS)) - 1){
+        slotTime = _currentTime + (1u << (SLOT_BITS * NUM_LEVELS)) - 1;
+    }
+
+    int slot = level * NUM_SLOTS + ((slotTime >> (SLOT_BITS * level)) & (NUM_SLOTS - 1));
+
+    timer.slot = slot;
+    timer.prev = -1;
+    timer.next = _slots[slot];
+    if(timer.next >= 0){
+        _timers[timer.next].prev = idx;
+    }
+    _slots[slot] = idx;
+}
+
+// remove timer from its slot list
+void CTimerWheel::unlink(int idx)
+{
+    Timer& timer = _timers[idx];
+
+    if(timer.prev >= 0){
+        _timers[timer.prev].next = timer.next;
+    }
+    else{
+        _slots[timer.slot] = timer.next;
+    }
+    if(timer.next >= 0){
+        _timers[timer.next].prev = timer.prev;
+    }
+
+    timer.slot = -1;
+    timer.prev = -1;
+    timer.next = -1;
+}
+
+// return timer to the free list
+void CTimerWheel::release(int idx)
+{
+    Timer& timer = _timers[idx];
+    timer.callback = nullptr;
+    timer.generation++;
+    _freeList.push_back(idx);
+    _pending--;
+}
+
+// move timers of the current level slot down to finer levels
+void CTimerWheel::cascade(int level)
+{
+    int slot = level * NUM_SLOTS + ((_currentTime >> (SLOT_BITS * level)) & (NUM_SLOTS - 1));
+
+    int idx = _slots[slot];
+    _slots[slot] = -1;
+
+    while(idx >= 0){
+        int next = _timers[idx].next;
+        insert(idx);
+        idx = next;
+    }
+}
+
+// fire all timers in a level 0 slot
+// timers are detached one at a time so callbacks can safely schedule or cancel other timers
+void CTimerWheel::fireSlot(int slot)
+{
+    while(_slots[slot] >= 0){
+        int idx = _slots[slot];
+        unlink(idx);
+
+        TimerCallback callback = std::move(_timers[idx].callback);
+        release(idx);
+
+        callback();
+    }
+}
@@ -0,0 +1,62 @@
+/* File:            CTimerWheel.h
+ * Author:          Vish Potnis
+ * Description:     - Hierarchical timing wheel for scheduling game events
+ *                  - Callbacks are scheduled in milliseconds on the SDL_GetTicks clock
+ *                  - Advancing the wheel only touches timers that expire or cascade
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <vector>
+#include <functional>
+
+using TimerCallback = std::function<void()>;
+using TimerHandle = Uint64;     // identifies a scheduled timer, stays invalid after the timer fired or was cancelled
+
+class CTimerWheel
+{
+    public:
+        explicit CTimerWheel(Uint32 currentTime);
+
+        TimerHandle schedule(Uint32 delay, TimerCallback callback);         // fire callback delay ms after the current wheel time
+        TimerHandle scheduleAt(Uint32 time, TimerCallback callback);        // fire callback at the given time, past times fire on the next advance
+        bool cancel(TimerHandle handle);                                    // remove a pending timer, returns false if it already fired
+
+        void advance(Uint32 now);       // move wheel time forward and fire all due callbacks in expiry order
+        void reset(Uint32 currentTime); // drop all pending timers and restart the wheel at currentTime
+        void shift(Uint32 delta);       // move wheel time and every pending timer delta ms later, handles stay valid
+
+        int getPending() const;         // number of timers waiting to fire
+        Uint32 getTime() const;         // current wheel time
+
+    private:
+
+        static constexpr int SLOT_BITS = 6;
+        static constexpr int NUM_SLOTS = 1 << SLOT_BITS;    // slots per level
+        static constexpr int NUM_LEVELS = 4;                // level n slots are 64^n ms wide, the wheel spans ~4.6 hours
+
+        struct Timer
+        {
+            Uint32 expiry;          // time to fire
+            Uint32 generation;      // bumped on every reuse so stale handles are rejected
+            int slot;               // index into _slots, -1 if unused
+            int prev;               // doubly linked list of timers in the same slot
+            int next;
+            TimerCallback callback;
+        };
+
+        void insert(int idx);           // place timer into the slot matching its expiry
+        void unlink(int idx);           // remove timer from its slot list
+        void release(int idx);          // return timer to the free list
+        void cascade(int level);        // move timers of the current level slot down to finer levels
+        void fireSlot(int slot);        // fire all timers in a level 0 slot
+
+        std::vector<Timer> _timers;     // timer storage, reused through _freeList
+        std::vector<int> _freeList;
+        std::vector<int> _slots;        // head timer index for each slot of each level, -1 if empty
+
+        Uint32 _currentTime;
+        int _pending;
+};
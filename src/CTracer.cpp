@@ -0,0 +1,107 @@
+/* File:            CTracer.cpp
+ * Author:          Vish Potnis
+ * Description:     - Opt-in timeline tracer
+ *                  - Scoped zones are recorded into a lock-free ring buffer per thread
+ *                  - Flushed as Chrome trace-event JSON (chrome://tracing, Perfetto)
+ */
+
+#include "CTracer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// initialize static variables
+bool CTracer::_enabled = false;
+std::string CTracer::_path;
+std::mutex CTracer::_registryMutex;
+std::vector<std::unique_ptr<CTracer::ThreadBuffer>> CTracer::_buffers;
+
+// start recording, trace is written to path on flush
+void CTracer::enable(const std::string& path)
+{
+    _path = path;
+    _enabled = true;
+}
+
+// trace clock in nanoseconds
+std::uint64_t CTracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// record a completed zone on the calling thread
+// the zone is written before the head is published so a concurrent flush never sees a half written zone
+void CTracer::record(const char* name, std::uint64_t start, std::uint64_t end)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+    buffer.zones[head % BUFFER_SIZE] = Zone{name, start, end};
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+// buffer of the calling thread, registered on first use
+CTracer::ThreadBuffer& CTracer::getThreadBuffer()
+{
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if(buffer == nullptr){
+        std::lock_guard<std::mutex> lock(_registryMutex);
+        _buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = _buffers.back().get();
+        buffer->threadID = static_cast<int>(_buffers.size());
+    }
+    return *buffer;
+}
+
+// write all buffered zones to the trace file as trace-event JSON
+bool CTracer::flush()
+{
+    if(!_enabled) return false;
+
+    std::lock_guard<std::mutex> lock(_registryMutex);
+
+    std::ofstream out(_path);
+    if(!out){
+        std::cout << "Unable to open trace file " << _path << "!\n";
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+
+    bool first = true;
+    std::vector<Zone> zones;
+    for(const auto& buffer: _buffers){
+
+        // copy the live part of the ring
+        std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+        std::uint64_t tail = head > BUFFER_SIZE ? head - BUFFER_SIZE : 0;
+        zones.clear();
+        for(std::uint64_t i = tail; i < head; i++){
+            zones.push_back(buffer->zones[i % BUFFER_SIZE]);
+        }
+
+        // drop zones the owning thread may have overwritten while copying
+        std::uint64_t newHead = buffer->head.load(std::memory_order_acquire);
+        std::uint64_t overwritten = newHead > BUFFER_SIZE ? newHead - BUFFER_SIZE : 0;
+        std::size_t skip = overwritten > tail ? std::min<std::size_t>(overwritten - tail, zones.size()) : 0;
+
+        if(!first) out << ",\n";
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadID
+            << ",\"args\":{\"name\":\"" << (buffer->threadID == 1 ? "main" : "thread") << " " << buffer->threadID << "\"}}";
+
+        for(std::size_t i = skip; i < zones.size(); i++){
+            const Zone& zone = zones[i];
+            out << ",\n{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadID
+                << ",\"ts\":" << zone.start / 1000.0 << ",\"dur\":" << (zone.end - zone.start) / 1000.0 << "}";
+        }
+    }
+    out << "\n]}\n";
+
+    std::cout << "Trace written to " << _path << "\n";
+    return true;
+}
@@ -0,0 +1,87 @@
+/* File:            CTracer.h
+ * Author:          Vish Potnis
+ * Description:     - Opt-in timeline tracer
+ *                  - Scoped zones are recorded into a lock-free ring buffer per thread
+ *                  - Flushed as Chrome trace-event JSON (chrome://tracing, Perfetto)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// record the enclosing scope as a trace zone, name must be a string literal
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) CTraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+class CTracer
+{
+    public:
+        static void enable(const std::string& path);    // start recording, trace is written to path on flush
+        static bool flush();                            // write all buffered zones to the trace file
+
+        static bool isEnabled() { return _enabled;}
+        static std::uint64_t now();                     // trace clock in nanoseconds
+
+        // record a completed zone on the calling thread
+        static void record(const char* name, std::uint64_t start, std::uint64_t end);
+
+    private:
+
+        static constexpr std::uint64_t BUFFER_SIZE = 1 << 16;      // zones kept per thread, oldest are overwritten
+
+        struct Zone
+        {
+            const char* name;
+            std::uint64_t start;
+            std::uint64_t end;
+        };
+
+        // single producer ring, only the owning thread writes and advances _head
+        struct ThreadBuffer
+        {
+            int threadID;
+            std::atomic<std::uint64_t> head{0};
+            Zone zones[BUFFER_SIZE];
+        };
+
+        static ThreadBuffer& getThreadBuffer();     // buffer of the calling thread, registered on first use
+
+        static bool _enabled;
+        static std::string _path;
+        static std::mutex _registryMutex;                           // guards registration and flush, never taken when recording
+        static std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+};
+
+// times the enclosing scope, costs one branch when tracing is disabled
+class CTraceScope
+{
+    public:
+        explicit CTraceScope(const char* name)
+        {
+            if(CTracer::isEnabled()){
+                _name = name;
+                _start = CTracer::now();
+            }
+        }
+
+        ~CTraceScope()
+        {
+            if(_name != nullptr){
+                CTracer::record(_name, _start, CTracer::now());
+            }
+        }
+
+        CTraceScope(const CTraceScope&) = delete;
+        CTraceScope& operator=(const CTraceScope&) = delete;
+
+    private:
+        const char* _name{nullptr};
+        std::uint64_t _start{0};
+};
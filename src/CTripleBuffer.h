@@ -0,0 +1,55 @@
+/* File:            CTripleBuffer.h
+ * Author:          Vish Potnis
+ * Description:     - Latest value handoff from one writer thread to one reader thread without locks
+ *                  - The writer never waits for the reader and the reader always sees a complete value, older values are skipped
+ */
+
+#pragma once
+
+#include <atomic>
+
+template<typename T>
+class CTripleBuffer
+{
+    public:
+        CTripleBuffer() = default;
+
+        CTripleBuffer(const CTripleBuffer&) = delete;
+        CTripleBuffer& operator=(const CTripleBuffer&) = delete;
+
+        // writer: buffer to fill with the next value, keeps its contents from two publishes ago
+        T& getWriteBuffer() { return _buffers[_write];}
+
+        // writer: hand the filled buffer to the reader, replacing a value it has not picked up yet
+        void publish()
+        {
+            int previous = _middle.exchange(_write | FRESH, std::memory_order_acq_rel);
+            _write = previous & INDEX_MASK;
+        }
+
+        // reader: switch to the newest published value, false if nothing was published since the last call
+        bool update()
+        {
+            if((_middle.load(std::memory_order_relaxed) & FRESH) == 0){
+                return false;
+            }
+            int previous = _middle.exchange(_read, std::memory_order_acq_rel);
+            _read = previous & INDEX_MASK;
+            return true;
+        }
+
+        // reader: value picked up by the last update
+        const T& getReadBuffer() const { return _buffers[_read];}
+
+    private:
+
+        static constexpr int INDEX_MASK{3};
+        static constexpr int FRESH{4};          // set while the middle buffer holds a value the reader has not picked up
+
+        T _buffers[3] = {};
+
+        // the writer and the reader own one buffer each, the third is swapped between them
+        alignas(64) int _write{0};
+        alignas(64) int _read{1};
+        alignas(64) std::atomic<int> _middle{2};
+};
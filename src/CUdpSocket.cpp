@@ -0,0 +1,129 @@
+/* File:            CUdpSocket.cpp
+ * Author:          Vish Potnis
+ * Description:     - Non blocking UDP socket bound to the loopback interface
+ *                  - Peers are identified by their local port number
+ */
+
+#include "CUdpSocket.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    using socklen_t = int;
+#else
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    sockaddr_in makeLoopbackAddress(std::uint16_t port)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return address;
+    }
+}
+
+CUdpSocket::CUdpSocket()
+    : _handle(-1), _port(0)
+{}
+
+CUdpSocket::~CUdpSocket()
+{
+    close();
+}
+
+// bind to 127.0.0.1:port, port 0 picks a free port
+bool CUdpSocket::open(std::uint16_t port)
+{
+    close();
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if(WSAStartup(MAKEWORD(2, 2), &wsaData) != 0){
+        std::cout << "Unable to initialize Winsock!\n";
+        return false;
+    }
+#endif
+
+    auto handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef _WIN32
+    if(handle == INVALID_SOCKET){
+#else
+    if(handle < 0){
+#endif
+        std::cout << "Unable to create UDP socket!\n";
+        return false;
+    }
+    _handle = static_cast<std::intptr_t>(handle);
+
+    sockaddr_in address = makeLoopbackAddress(port);
+    if(bind(handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0){
+        std::cout << "Unable to bind UDP socket to port " << port << "!\n";
+        close();
+        return false;
+    }
+
+    // read back the port in case a free port was picked
+    socklen_t length = sizeof(address);
+    getsockname(handle, reinterpret_cast<sockaddr*>(&address), &length);
+    _port = ntohs(address.sin_port);
+
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(handle, FIONBIO, &nonBlocking);
+#else
+    fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    return true;
+}
+
+void CUdpSocket::close()
+{
+    if(_handle == -1) return;
+
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(_handle));
+    WSACleanup();
+#else
+    ::close(static_cast<int>(_handle));
+#endif
+    _handle = -1;
+    _port = 0;
+}
+
+// send datagram to 127.0.0.1:port
+bool CUdpSocket::send(std::uint16_t port, const std::uint8_t* data, std::size_t size)
+{
+    if(_handle == -1) return false;
+
+    sockaddr_in address = makeLoopbackAddress(port);
+    auto sent = sendto(_handle, reinterpret_cast<const char*>(data), static_cast<int>(size), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    return sent == static_cast<decltype(sent)>(size);
+}
+
+// receive one pending datagram, returns its size or -1 if nothing is pending
+int CUdpSocket::receive(std::uint8_t* buffer, std::size_t capacity, std::uint16_t& fromPort)
+{
+    if(_handle == -1) return -1;
+
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    auto received = recvfrom(_handle, reinterpret_cast<char*>(buffer), static_cast<int>(capacity), 0, reinterpret_cast<sockaddr*>(&address), &length);
+    if(received < 0) return -1;
+
+    fromPort = ntohs(address.sin_port);
+    return static_cast<int>(received);
+}
+
+bool CUdpSocket::isOpen() const { return _handle != -1;}
+std::uint16_t CUdpSocket::getPort() const { return _port;}
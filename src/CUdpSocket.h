@@ -0,0 +1,37 @@
+/* File:            CUdpSocket.h
+ * Author:          Vish Potnis
+ * Description:     - Non blocking UDP socket bound to the loopback interface
+ *                  - Peers are identified by their local port number
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class CUdpSocket
+{
+    public:
+        CUdpSocket();
+        ~CUdpSocket();
+
+        // delete copy and assignment constructors, the socket handle has a single owner
+        CUdpSocket(const CUdpSocket&) = delete;
+        CUdpSocket& operator=(const CUdpSocket&) = delete;
+
+        bool open(std::uint16_t port);      // bind to 127.0.0.1:port, port 0 picks a free port
+        void close();
+
+        bool send(std::uint16_t port, const std::uint8_t* data, std::size_t size);     // send datagram to 127.0.0.1:port
+
+        // receive one pending datagram, returns its size or -1 if nothing is pending
+        int receive(std::uint8_t* buffer, std::size_t capacity, std::uint16_t& fromPort);
+
+        bool isOpen() const;
+        std::uint16_t getPort() const;
+
+    private:
+
+        std::intptr_t _handle;      // native socket handle, -1 when closed
+        std::uint16_t _port;        // bound port
+};
@@ -5,6 +5,8 @@
  *                  - Get x/y projects and add 2 vectors
  */
 
+#pragma once
+
 #include <cmath>
 #include <iostream>
 #include "constants.h"
@@ -9,7 +9,6 @@
 #include "GameObjectShip.h"
 #include "GameObjectLaser.h"
 #include "GameObjectStatic.h"
-#include "GameObjectExplosion.h"
 
 int GameObject::_count = 0;     // initialize static counter
 
@@ -31,7 +30,19 @@ void GameObject::render(SDL_Renderer& renderer)
 {
     // calculate target destination rectangle
     SDL_Rect renderQuad{static_cast<int>(_pos.x), static_cast<int>(_pos.y), _tex.getWidth(), _tex.getHeight()};
-    SDL_RenderCopy( &renderer, &_tex.getTexture(), nullptr, &renderQuad );    
+    _tex.render(renderer, nullptr, renderQuad);
+    CMetrics::add(Metric::RENDER_COPY);
+}
+
+// render object at its world position as seen by the camera, skipped if the object is outside the view
+void GameObject::render(SDL_Renderer& renderer, const CCamera& camera)
+{
+    SDL_Rect worldQuad{static_cast<int>(_pos.x), static_cast<int>(_pos.y), _tex.getWidth(), _tex.getHeight()};
+    SDL_Rect renderQuad = camera.worldToScreen(worldQuad);
+    if(camera.isVisible(renderQuad)){
+        _tex.render(renderer, nullptr, renderQuad);
+        CMetrics::add(Metric::RENDER_COPY);
+    }
 }
 
 // update the object position and texture based on time passed, overridden based on derived object type
@@ -40,6 +51,12 @@ void GameObject::update(const Uint32 updateTime)
     _lastUpdated = updateTime;
 }
 
+// move the object clock delta ms later, the time in between is not simulated
+void GameObject::shiftTime(Uint32 delta)
+{
+    _lastUpdated += delta;
+}
+
 // factory method for creating GameObjects based on ObjectType
 std::unique_ptr<GameObject> GameObject::Create(ObjectType type, Point pos, CTexture& tex, CVector velocity, double rotation)
 {
@@ -48,15 +65,33 @@ std::unique_ptr<GameObject> GameObject::Create(ObjectType type, Point pos, CText
         case ObjectType::ASTEROID:  return std::unique_ptr<GameObject>(new GameObjectAsteroid(pos, tex, velocity));
         case ObjectType::SHIP:      return std::unique_ptr<GameObject>(new GameObjectShip(pos, tex, velocity));
         case ObjectType::LASER:     return std::unique_ptr<GameObject>(new GameObjectLaser(pos, tex, velocity, rotation));
-        case ObjectType::EXPLOSION: return std::unique_ptr<GameObject>(new GameObjectExplosion(pos, tex));
         default: 
             return nullptr;
     }
 }
 
+// wrap position around the world edges
+void GameObject::wrapPosition()
+{
+    if(_pos.x >= AsteroidConstants::WORLD_WIDTH){
+        _pos.x -= AsteroidConstants::WORLD_WIDTH;
+    }
+    if(_pos.x < 0){
+        _pos.x += AsteroidConstants::WORLD_WIDTH;
+    }
+
+    if(_pos.y >= AsteroidConstants::WORLD_HEIGHT){
+        _pos.y -= AsteroidConstants::WORLD_HEIGHT;
+    }
+    if(_pos.y < 0){
+        _pos.y += AsteroidConstants::WORLD_HEIGHT;
+    }
+}
+
 // getter functions
 CVector GameObject::getVelocity() const { return _velocity;}
 int GameObject::getID() const { return _id;}
+Uint32 GameObject::getLastUpdated() const { return _lastUpdated;}
 Point GameObject::getPos() const { return _pos;}
 double GameObject::getRotation() const { return _rotation;}
 
@@ -11,6 +11,8 @@
 
 #include "CTexture.h"
 #include "CVector.h"
+#include "CCamera.h"
+#include "CMetrics.h"
 #include "utility.h"
 
 class GameObject{
@@ -24,7 +26,9 @@ class GameObject{
         virtual ~GameObject() = default;
 
         virtual void render(SDL_Renderer& renderer);      // render object to screen, overridden based on derived object type
+        virtual void render(SDL_Renderer& renderer, const CCamera& camera);    // render object at its world position as seen by the camera
         virtual void update(const Uint32 updateTime);           // update the object position and texture based on time passed, overridden based on derived object type
+        virtual void shiftTime(Uint32 delta);                   // move the object clock delta ms later, the time in between is not simulated
         
         // factory method for creating GameObjects based on ObjectType
         static std::unique_ptr<GameObject> Create(ObjectType type, Point pos, CTexture& tex, CVector velocity=CVector(), double rotation=0);
@@ -34,10 +38,13 @@ class GameObject{
         CVector getVelocity() const;
         double getRotation() const;
         int getID() const;
+        Uint32 getLastUpdated() const;
         
     protected:        
 
-        Point _pos;             // position of center of object on screen
+        void wrapPosition();    // wrap position around the world edges
+
+        Point _pos;             // position of center of object in the world
         const CTexture& _tex;   // reference to the texture for the object
         CVector _velocity;      // current velocity of the object
         double _rotation;       // rotation of the texture
@@ -7,33 +7,25 @@
 #include "GameObjectAsteroid.h"
 #include "constants.h"
 #include <cmath>
+#include <algorithm>
 
 GameObjectAsteroid::GameObjectAsteroid(const Point& pos, const CTexture& tex, CVector velocity)
     : GameObject(pos, tex, velocity)
-{}
-
-// render asteroid to screen
-void GameObjectAsteroid::render(SDL_Renderer& renderer)
 {
-    int xPosCenter = std::round(_pos.x);
-    int yPosCenter = std::round(_pos.y);
-
-    std::vector<SDL_Rect> srcRect;  // source rectangles defining texture boundary for wrap around the screen
-    std::vector<SDL_Rect> dstRect;  // destination rectangles for the screen for source rectangles
-
-    int width = _tex.getWidth();
-    int height = _tex.getHeight();
-
-    // calculate screen wrap around based on position and texture dimensions
-    calculateRenderRectangles(xPosCenter, yPosCenter, width, height, AsteroidConstants::SCREEN_WIDTH, AsteroidConstants::SCREEN_HEIGHT, srcRect, dstRect);    
+    updateBoundingBoxes();
+}
 
+// render visible parts of the asteroid to screen
+void GameObjectAsteroid::render(SDL_Renderer& renderer, const CCamera& camera)
+{
     // render texture in potential parts
-    for(unsigned long i = 0; i < srcRect.size(); i++){
-        SDL_RenderCopy( &renderer, &_tex.getTexture(), &srcRect[i], &dstRect[i]);
+    for(unsigned long i = 0; i < _srcRects.size(); i++){
+        SDL_Rect dstRect = camera.worldToScreen(_boundingBoxes[i]);
+        if(camera.isVisible(dstRect)){
+            _tex.render(renderer, &_srcRects[i], dstRect);
+            CMetrics::add(Metric::RENDER_COPY);
+        }
     }
-
-    // desRect (on screen rectangles) define the bounding box for the asteroid
-    _boundingBoxes = std::move(dstRect);    
 }
 
 
@@ -47,33 +39,50 @@ void GameObjectAsteroid::update(Uint32 updateTime)
     _pos.x += _velocity.getXProjection() * timeDelta;
     _pos.y += _velocity.getYProjection() * timeDelta;
 
-    // wrap around the screen
-    if(_pos.x >= AsteroidConstants::SCREEN_WIDTH){
-        _pos.x = 0;
-    }
-    if(_pos.x < 0){
-        _pos.x = AsteroidConstants::SCREEN_WIDTH;
-    }
-
-    if(_pos.y >= AsteroidConstants::SCREEN_HEIGHT){
-        _pos.y = 0;
-    }
-    if(_pos.y < 0){
-        _pos.y = AsteroidConstants::SCREEN_HEIGHT;
-    }
+    // wrap around the world
+    wrapPosition();
+    updateBoundingBoxes();
 
     _lastUpdated = updateTime;
 
 }
 
+// recalculate world wrap rectangles for current position
+void GameObjectAsteroid::updateBoundingBoxes()
+{
+    int xPosCenter = std::round(_pos.x);
+    int yPosCenter = std::round(_pos.y);
+
+    int width = _tex.getWidth();
+    int height = _tex.getHeight();
+
+    _srcRects.clear();
+    _boundingBoxes.clear();
+
+    // calculate world wrap around based on position and texture dimensions
+    // dstRect (world rectangles) define the bounding boxes for the asteroid
+    calculateRenderRectangles(xPosCenter, yPosCenter, width, height, AsteroidConstants::WORLD_WIDTH, AsteroidConstants::WORLD_HEIGHT, _srcRects, _boundingBoxes);
+}
+
 void GameObjectAsteroid::setAsteroidAttr(AsteroidSize size, AsteroidColor color)
 {
     _asteroidSize = size;
     _asteroidColor = color;
 }
 
+// position and velocity after a contact with another asteroid
+void GameObjectAsteroid::setMotion(const Point& pos, CVector velocity)
+{
+    _pos = pos;
+    _velocity = velocity;
+    wrapPosition();
+    updateBoundingBoxes();
+}
+
 // getters
 const std::vector<SDL_Rect>& GameObjectAsteroid::getBoundingBoxes() { return _boundingBoxes;}
+int GameObjectAsteroid::getHalfExtent() const { return std::max(_tex.getWidth(), _tex.getHeight())/2;}
+double GameObjectAsteroid::getRadius() const { return (_tex.getWidth() + _tex.getHeight())/4.0;}
 AsteroidSize GameObjectAsteroid::getSize() const { return _asteroidSize;}
 AsteroidSize GameObjectAsteroid::getNextSize() const
 {
@@ -123,11 +132,44 @@ TextureType GameObjectAsteroid::getAsteroidTexture(AsteroidSize size, AsteroidCo
     return TextureType::TEX_ASTEROID_BIG_1;
 }
 
+// static function to get explosion debris color matching the asteroid texture
+SDL_Color GameObjectAsteroid::getDebrisColor(AsteroidColor color)
+{
+    switch(color){
+        case AsteroidColor::GREY:   return SDL_Color{170, 170, 170, 255};
+        case AsteroidColor::RED:    return SDL_Color{200, 90, 60, 255};
+        case AsteroidColor::BROWN:  return SDL_Color{150, 110, 70, 255};
+    }
+    return SDL_Color{170, 170, 170, 255};
+}
+
+// static function to get number of explosion debris particles based on size
+int GameObjectAsteroid::getDebrisCount(AsteroidSize size)
+{
+    switch(size){
+        case AsteroidSize::BIG:     return AsteroidConstants::PARTICLE_BURST_BIG;
+        case AsteroidSize::MED:     return AsteroidConstants::PARTICLE_BURST_MED;
+        case AsteroidSize::SMALL:   return AsteroidConstants::PARTICLE_BURST_SMALL;
+    }
+    return AsteroidConstants::PARTICLE_BURST_SMALL;
+}
+
+// static function to get contact mass based on size, proportional to the sprite area
+// the simulation sizes are used so the client and the server agree
+double GameObjectAsteroid::getMass(AsteroidSize size)
+{
+    switch(size){
+        case AsteroidSize::BIG:     return AsteroidConstants::SIM_ASTEROID_BIG_W * AsteroidConstants::SIM_ASTEROID_BIG_H;
+        case AsteroidSize::MED:     return AsteroidConstants::SIM_ASTEROID_MED_W * AsteroidConstants::SIM_ASTEROID_MED_H;
+        case AsteroidSize::SMALL:   return AsteroidConstants::SIM_ASTEROID_SMALL_W * AsteroidConstants::SIM_ASTEROID_SMALL_H;
+    }
+    return AsteroidConstants::SIM_ASTEROID_SMALL_W * AsteroidConstants::SIM_ASTEROID_SMALL_H;
+}
 
-// calculate offscreen wrap arounds for textures
+// calculate world wrap arounds for textures
 // srcRect contains the rectangles defining the texture area 
 // destRect contains the recatangles defining the destination area
-void GameObjectAsteroid::calculateRenderRectangles(int objPosX, int objPosY, int objWidth, int objHeight, int screenWidth, int screenHeight, 
+void GameObjectAsteroid::calculateRenderRectangles(int objPosX, int objPosY, int objWidth, int objHeight, int worldWidth, int worldHeight, 
                                         std::vector<SDL_Rect> &srcRect, std::vector<SDL_Rect> &dstRect)
 {
     
@@ -136,51 +178,51 @@ void GameObjectAsteroid::calculateRenderRectangles(int objPosX, int objPosY, int
     int right = left + objWidth - 1;
     int bottom = top + objHeight - 1;
     
-    // entire object fits on screen without wrapping
-    if(left >= 0 && right < screenWidth && top >= 0 && bottom < screenHeight){
+    // entire object fits in the world without wrapping
+    if(left >= 0 && right < worldWidth && top >= 0 && bottom < worldHeight){
         srcRect.push_back(SDL_Rect{0, 0, objWidth, objHeight});
         dstRect.push_back(SDL_Rect{left, top, objWidth, objHeight});        
         return;
     }
-    // object height is within the screen
-    if(top >= 0 && bottom < screenHeight){
+    // object height is within the world
+    if(top >= 0 && bottom < worldHeight){
         // object wraps on the left side
         if(left < 0){
             srcRect.push_back(SDL_Rect{0, 0, 0-left, objHeight});
             srcRect.push_back(SDL_Rect{0-left, 0, right+1, objHeight});
 
-            dstRect.push_back(SDL_Rect{left+screenWidth, top, 0-left, objHeight});
+            dstRect.push_back(SDL_Rect{left+worldWidth, top, 0-left, objHeight});
             dstRect.push_back(SDL_Rect{0, top, right+1, objHeight});
             return;
         }
         // object wraps on the right side
         else{
-            srcRect.push_back(SDL_Rect{0, 0, screenWidth-left, objHeight});
-            srcRect.push_back(SDL_Rect{screenWidth-left, 0, right-screenWidth+1, objHeight});
+            srcRect.push_back(SDL_Rect{0, 0, worldWidth-left, objHeight});
+            srcRect.push_back(SDL_Rect{worldWidth-left, 0, right-worldWidth+1, objHeight});
 
-            dstRect.push_back(SDL_Rect{left, top, screenWidth-left, objHeight});
-            dstRect.push_back(SDL_Rect{0, top, right-screenWidth+1, objHeight});
+            dstRect.push_back(SDL_Rect{left, top, worldWidth-left, objHeight});
+            dstRect.push_back(SDL_Rect{0, top, right-worldWidth+1, objHeight});
             return;
         }
     }
-    // object width is within the screen
-    if(left >= 0 && right < screenWidth){
+    // object width is within the world
+    if(left >= 0 && right < worldWidth){
         // object wraps on the top
         if(top < 0){
             srcRect.push_back(SDL_Rect{0, 0, objWidth, 0-top});
             srcRect.push_back(SDL_Rect{0, 0-top, objWidth, bottom+1});
 
-            dstRect.push_back(SDL_Rect{left, top+screenHeight, objWidth, 0-top});
+            dstRect.push_back(SDL_Rect{left, top+worldHeight, objWidth, 0-top});
             dstRect.push_back(SDL_Rect{left, 0, objWidth, bottom+1});
             return;
         }
         // object wraps on the bottom
         else{
-            srcRect.push_back(SDL_Rect{0, 0, objWidth, screenHeight-top});
-            srcRect.push_back(SDL_Rect{0, screenHeight-top, objWidth, bottom-screenHeight+1});
+            srcRect.push_back(SDL_Rect{0, 0, objWidth, worldHeight-top});
+            srcRect.push_back(SDL_Rect{0, worldHeight-top, objWidth, bottom-worldHeight+1});
 
-            dstRect.push_back(SDL_Rect{left, top, objWidth, screenHeight-top});
-            dstRect.push_back(SDL_Rect{left, 0, objWidth, bottom-screenHeight+1});
+            dstRect.push_back(SDL_Rect{left, top, objWidth, worldHeight-top});
+            dstRect.push_back(SDL_Rect{left, 0, objWidth, bottom-worldHeight+1});
             return;
         }
     }
@@ -191,49 +233,49 @@ void GameObjectAsteroid::calculateRenderRectangles(int objPosX, int objPosY, int
         srcRect.push_back(SDL_Rect{0-left, 0, right+1, 0-top});
         srcRect.push_back(SDL_Rect{0-left, 0-top, right+1, bottom+1});
 
-        dstRect.push_back(SDL_Rect{left+screenWidth, top+screenHeight, 0-left, 0-top});
-        dstRect.push_back(SDL_Rect{left+screenWidth, 0, 0-left, bottom+1});
-        dstRect.push_back(SDL_Rect{0, top+screenHeight, right+1, 0-top});
+        dstRect.push_back(SDL_Rect{left+worldWidth, top+worldHeight, 0-left, 0-top});
+        dstRect.push_back(SDL_Rect{left+worldWidth, 0, 0-left, bottom+1});
+        dstRect.push_back(SDL_Rect{0, top+worldHeight, right+1, 0-top});
         dstRect.push_back(SDL_Rect{0, 0, right+1, bottom+1});
         return;
     }
     // object wraps bottom left corner
-    if(left < 0 && bottom >= screenHeight){
-        srcRect.push_back(SDL_Rect{0, 0, 0-left, screenHeight-top});
-        srcRect.push_back(SDL_Rect{0, screenHeight-top, 0-left, bottom-screenHeight+1});
-        srcRect.push_back(SDL_Rect{0-left, 0, right+1, screenHeight-top});
-        srcRect.push_back(SDL_Rect{0-left, screenHeight-top, right+1, bottom-screenHeight+1});
-
-        dstRect.push_back(SDL_Rect{left+screenWidth, top, 0-left, screenHeight-top});
-        dstRect.push_back(SDL_Rect{left+screenWidth, 0, 0-left, bottom-screenHeight+1});
-        dstRect.push_back(SDL_Rect{0, top, right+1, screenHeight-top});
-        dstRect.push_back(SDL_Rect{0, 0, right+1, bottom-screenHeight+1});
+    if(left < 0 && bottom >= worldHeight){
+        srcRect.push_back(SDL_Rect{0, 0, 0-left, worldHeight-top});
+        srcRect.push_back(SDL_Rect{0, worldHeight-top, 0-left, bottom-worldHeight+1});
+        srcRect.push_back(SDL_Rect{0-left, 0, right+1, worldHeight-top});
+        srcRect.push_back(SDL_Rect{0-left, worldHeight-top, right+1, bottom-worldHeight+1});
+
+        dstRect.push_back(SDL_Rect{left+worldWidth, top, 0-left, worldHeight-top});
+        dstRect.push_back(SDL_Rect{left+worldWidth, 0, 0-left, bottom-worldHeight+1});
+        dstRect.push_back(SDL_Rect{0, top, right+1, worldHeight-top});
+        dstRect.push_back(SDL_Rect{0, 0, right+1, bottom-worldHeight+1});
         return;
     }
     // object wraps top right corner
-    if(top < 0 && right >= screenWidth){
-        srcRect.push_back(SDL_Rect{0, 0, screenWidth-left, 0-top});
-        srcRect.push_back(SDL_Rect{0, 0-top, screenWidth-left, bottom+1});
-        srcRect.push_back(SDL_Rect{screenWidth-left, 0, right-screenWidth+1, 0-top});
-        srcRect.push_back(SDL_Rect{screenWidth-left, 0-top, right-screenWidth+1, bottom+1});
-
-        dstRect.push_back(SDL_Rect{left, top+screenHeight, screenWidth-left, 0-top});
-        dstRect.push_back(SDL_Rect{left, 0, screenWidth-left, bottom+1});
-        dstRect.push_back(SDL_Rect{0, top+screenHeight, right-screenWidth+1, 0-top});
-        dstRect.push_back(SDL_Rect{0, 0, right-screenWidth+1, bottom+1});
+    if(top < 0 && right >= worldWidth){
+        srcRect.push_back(SDL_Rect{0, 0, worldWidth-left, 0-top});
+        srcRect.push_back(SDL_Rect{0, 0-top, worldWidth-left, bottom+1});
+        srcRect.push_back(SDL_Rect{worldWidth-left, 0, right-worldWidth+1, 0-top});
+        srcRect.push_back(SDL_Rect{worldWidth-left, 0-top, right-worldWidth+1, bottom+1});
+
+        dstRect.push_back(SDL_Rect{left, top+worldHeight, worldWidth-left, 0-top});
+        dstRect.push_back(SDL_Rect{left, 0, worldWidth-left, bottom+1});
+        dstRect.push_back(SDL_Rect{0, top+worldHeight, right-worldWidth+1, 0-top});
+        dstRect.push_back(SDL_Rect{0, 0, right-worldWidth+1, bottom+1});
         return;
     }
     // object wraps bottom right corner
-    if(right >= screenWidth && bottom >= screenHeight){
-        srcRect.push_back(SDL_Rect{0, 0, screenWidth-left, screenHeight-top});
-        srcRect.push_back(SDL_Rect{0, screenHeight-top, screenWidth-left, bottom-screenHeight+1});
-        srcRect.push_back(SDL_Rect{screenWidth-left, 0, right-screenWidth+1, screenHeight-top});
-        srcRect.push_back(SDL_Rect{screenWidth-left, screenHeight-top, right-screenWidth+1, bottom-screenHeight+1});
-
-        dstRect.push_back(SDL_Rect{left, top, screenWidth-left, screenHeight-top});
-        dstRect.push_back(SDL_Rect{left, 0, screenWidth-left, bottom-screenHeight+1});
-        dstRect.push_back(SDL_Rect{0, top, right-screenWidth+1, screenHeight-top});
-        dstRect.push_back(SDL_Rect{0, 0, right-screenWidth+1, bottom-screenHeight+1});
+    if(right >= worldWidth && bottom >= worldHeight){
+        srcRect.push_back(SDL_Rect{0, 0, worldWidth-left, worldHeight-top});
+        srcRect.push_back(SDL_Rect{0, worldHeight-top, worldWidth-left, bottom-worldHeight+1});
+        srcRect.push_back(SDL_Rect{worldWidth-left, 0, right-worldWidth+1, worldHeight-top});
+        srcRect.push_back(SDL_Rect{worldWidth-left, worldHeight-top, right-worldWidth+1, bottom-worldHeight+1});
+
+        dstRect.push_back(SDL_Rect{left, top, worldWidth-left, worldHeight-top});
+        dstRect.push_back(SDL_Rect{left, 0, worldWidth-left, bottom-worldHeight+1});
+        dstRect.push_back(SDL_Rect{0, top, right-worldWidth+1, worldHeight-top});
+        dstRect.push_back(SDL_Rect{0, 0, right-worldWidth+1, bottom-worldHeight+1});
         return;
     }            
 }
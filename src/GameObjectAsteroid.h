@@ -14,27 +14,37 @@ class GameObjectAsteroid : public GameObject
     public:
         GameObjectAsteroid(const Point& pos, const CTexture& tex, CVector velocity);
         
-        void render(SDL_Renderer& renderer) override;       // render asteroid to screen
+        using GameObject::render;
+        void render(SDL_Renderer& renderer, const CCamera& camera) override;    // render visible parts of the asteroid to screen
         void update(const Uint32 updateTime) override;      // update asteroid position based on velocity and time delta
 
          void setAsteroidAttr(AsteroidSize size, AsteroidColor color);
+        void setMotion(const Point& pos, CVector velocity);     // position and velocity after a contact with another asteroid
         
         // getters
         const std::vector<SDL_Rect>& getBoundingBoxes();
+        int getHalfExtent() const;
+        double getRadius() const;           // radius of the circle used for asteroid contacts
         AsteroidSize getSize() const;
         AsteroidSize getNextSize() const;
                
         static AsteroidColor getNextColor(AsteroidColor color);     // static function to determine next color based on input color (cycle through colors)
         static TextureType getAsteroidTexture(AsteroidSize size, AsteroidColor color);  // static function to get asteroid texture enum based on size and clor
+        static SDL_Color getDebrisColor(AsteroidColor color);                           // static function to get explosion debris color matching the asteroid texture
+        static int getDebrisCount(AsteroidSize size);                                   // static function to get number of explosion debris particles based on size
+        static double getMass(AsteroidSize size);                                       // static function to get contact mass based on size, proportional to the sprite area
 
-    private:
-        
-        // calculate offscreen wrap arounds for textures
-        void calculateRenderRectangles(int objPosX, int objPosY, int objWidth, int objHeight, int screenWidth, int screenHeight, 
+        // calculate world wrap arounds for textures
+        static void calculateRenderRectangles(int objPosX, int objPosY, int objWidth, int objHeight, int worldWidth, int worldHeight, 
                                         std::vector<SDL_Rect> &srcRect, std::vector<SDL_Rect> &dstRect);
 
+    private:
+
+        void updateBoundingBoxes();     // recalculate world wrap rectangles for current position
+        
         AsteroidSize _asteroidSize;
         AsteroidColor _asteroidColor;           
 
-        std::vector<SDL_Rect> _boundingBoxes;       // bounding boxes for asteroid used for collision detection
+        std::vector<SDL_Rect> _srcRects;            // texture parts for each bounding box
+        std::vector<SDL_Rect> _boundingBoxes;       // world space bounding boxes for asteroid used for collision detection
 };
\ No newline at end of file
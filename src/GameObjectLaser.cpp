@@ -7,28 +7,29 @@
 #include "constants.h"
 
 GameObjectLaser::GameObjectLaser(const Point& pos, const CTexture& tex, CVector velocity, double rotation)
-    : GameObject(pos, tex, velocity, rotation)
+    : GameObject(pos, tex, velocity, rotation), _rotations(nullptr), _spawnTime(_lastUpdated), _owner(0)
 {
     // rescale original texture
     _width = _tex.getWidth()/AsteroidConstants::SCALE_LASER_W;
     _height = _tex.getHeight()/AsteroidConstants::SCALE_LASER_H;
+
+    updateBoundingBox();
 }
 
 // render laser to the screen
-void GameObjectLaser::render(SDL_Renderer& renderer)
+void GameObjectLaser::render(SDL_Renderer& renderer, const CCamera& camera)
 {
-    int xPosCenter = std::round(_pos.x);
-    int yPosCenter = std::round(_pos.y);
-
-    int left = xPosCenter - _width/2;
-    int top = yPosCenter - _height/2;
+    SDL_Rect dstRect = camera.worldToScreen(_boundingBox);
 
-    SDL_Rect dstRect{left, top, _width, _height};
-
-    SDL_RenderCopyEx( &renderer, &_tex.getTexture(), nullptr, &dstRect, _rotation, nullptr, SDL_FLIP_NONE);
-
-    // desRect (on screen rectangle) defines the bounding box for the laser
-    _boundingBox = std::move(dstRect);
+    if(camera.isVisible(dstRect)){
+        if(_rotations != nullptr){
+            _rotations->render(renderer, _rotation, dstRect);
+        }
+        else{
+            SDL_RenderCopyEx( &renderer, &_tex.getTexture(), nullptr, &dstRect, _rotation, nullptr, SDL_FLIP_NONE);
+            CMetrics::add(Metric::RENDER_COPY_EX);
+        }
+    }
 }
 
 // update asteroid position based on velocity and time delta
@@ -39,18 +40,51 @@ void GameObjectLaser::update(const Uint32 updateTime)
     _pos.x += _velocity.getXProjection() * timeDelta;
     _pos.y += _velocity.getYProjection() * timeDelta;
 
+    wrapPosition();
+    updateBoundingBox();
+
     _lastUpdated = updateTime;
 }
 
-// check if laser has gone off screen
-bool GameObjectLaser::checkOffscreen() const
+// move the object clock and the spawn time delta ms later, the expiry timer is shifted by the owner
+void GameObjectLaser::shiftTime(Uint32 delta)
+{
+    GameObject::shiftTime(delta);
+    _spawnTime += delta;
+}
+
+// recalculate world space bounding box for current position
+void GameObjectLaser::updateBoundingBox()
+{
+    // tight bounds of the rotated sprite
+    if(_rotations != nullptr){
+        _boundingBox = _rotations->getBounds(_pos, _rotation);
+        return;
+    }
+
+    int xPosCenter = std::round(_pos.x);
+    int yPosCenter = std::round(_pos.y);
+
+    int left = xPosCenter - _width/2;
+    int top = yPosCenter - _height/2;
+
+    _boundingBox = SDL_Rect{left, top, _width, _height};
+}
+
+// used when restoring a save state
+void GameObjectLaser::setSpawnTime(Uint32 time) { _spawnTime = time;}
+
+// player credited with the asteroids the laser hits
+void GameObjectLaser::setOwner(int player) { _owner = player;}
+
+// draw pre-rotated sprites and collide with their tight bounds, nullptr to rotate on every draw
+void GameObjectLaser::setRotationCache(const CSpriteRotations* rotations)
 {
-    if(_pos.x < -AsteroidConstants::OFFSCREEN_BOUNDARY || _pos.x > AsteroidConstants::SCREEN_WIDTH + AsteroidConstants::OFFSCREEN_BOUNDARY)
-        return true;
-    if(_pos.y < -AsteroidConstants::OFFSCREEN_BOUNDARY || _pos.y > AsteroidConstants::SCREEN_HEIGHT + AsteroidConstants::OFFSCREEN_BOUNDARY)
-        return true;
-    return false;
+    _rotations = (rotations != nullptr && rotations->isBuilt()) ? rotations : nullptr;
+    updateBoundingBox();
 }
 
-// getter
-const SDL_Rect& GameObjectLaser::getBoundingBox() { return _boundingBox;}
\ No newline at end of file
+// getters
+const SDL_Rect& GameObjectLaser::getBoundingBox() { return _boundingBox;}
+Uint32 GameObjectLaser::getSpawnTime() const { return _spawnTime;}
+int GameObjectLaser::getOwner() const { return _owner;}
\ No newline at end of file
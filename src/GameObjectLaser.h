@@ -6,6 +6,7 @@
 #pragma once
 
 #include "GameObject.h"
+#include "CSpriteRotations.h"
 
 class GameObjectLaser : public GameObject
 {
@@ -13,17 +14,28 @@ class GameObjectLaser : public GameObject
 
         GameObjectLaser(const Point& pos, const CTexture& tex, CVector velocity, double rotation) ;
 
-        void render(SDL_Renderer &renderer) override;       // render laser to the screen
+        using GameObject::render;
+        void render(SDL_Renderer &renderer, const CCamera& camera) override;    // render laser to the screen
         void update(const Uint32 updateTime) override;      // update laser position based on velocity and time delta
-        
-        bool checkOffscreen() const;        // check if laser has gone off screen
+        void shiftTime(Uint32 delta) override;              // move the object clock and the spawn time delta ms later
+
+        void setSpawnTime(Uint32 time);     // used when restoring a save state
+        void setOwner(int player);          // player credited with the asteroids the laser hits
+        void setRotationCache(const CSpriteRotations* rotations);  // draw pre-rotated sprites and collide with their tight bounds, nullptr to rotate on every draw
 
-        // getter
+        // getters
         const SDL_Rect& getBoundingBox();
+        Uint32 getSpawnTime() const;
+        int getOwner() const;
         
     private:
 
+        void updateBoundingBox();   // recalculate world space bounding box for current position
+
         int _width;             // resize original texture
         int _height;            // resize original texture
-        SDL_Rect _boundingBox;  // bounding box for laser used for collision detection
+        SDL_Rect _boundingBox;  // world space bounding box for laser used for collision detection
+        const CSpriteRotations* _rotations;     // pre-rotated sprites, not owned
+        Uint32 _spawnTime;      // time stamp of creation, the laser expires LASER_LIFETIME_MS later
+        int _owner;             // index of the player that fired the laser
 };
\ No newline at end of file
@@ -5,31 +5,31 @@
 
 #include "GameObjectShip.h"
 #include "constants.h"
+#include <cmath>
 
 GameObjectShip::GameObjectShip(const Point& pos, const CTexture& tex, CVector velocity)
-    : GameObject(pos, tex, velocity), _rotateLeft(false), _rotateRight(false), _moveForward(false), _moveBackward(false)
+    : GameObject(pos, tex, velocity), _rotations(nullptr), _rotateLeft(false), _rotateRight(false), _moveForward(false), _moveBackward(false),
+      _turnDirection(0), _turnAngle(0)
 {
     // rescale original texture
     _width = _tex.getWidth()/AsteroidConstants::SCALE_SHIP_W;
     _height = _tex.getHeight()/AsteroidConstants::SCALE_SHIP_H;
+
+    updateBoundingBox();
 }
 
 // render ship to the screen
-void GameObjectShip::render(SDL_Renderer& renderer)
+void GameObjectShip::render(SDL_Renderer& renderer, const CCamera& camera)
 {
-    int xPosCenter = std::round(_pos.x);
-    int yPosCenter = std::round(_pos.y);
-
-    int left = xPosCenter - _width/2;
-    int top = yPosCenter - _height/2;
-
-
-    SDL_Rect dstRect{left, top, _width, _height};
-
-    SDL_RenderCopyEx( &renderer, &_tex.getTexture(), nullptr, &dstRect, _rotation, nullptr, SDL_FLIP_NONE);
-
-    _boundingBox = std::move(dstRect);
+    SDL_Rect dstRect = camera.worldToScreen(_boundingBox);
 
+    if(_rotations != nullptr){
+        _rotations->render(renderer, _rotation, dstRect);
+    }
+    else{
+        SDL_RenderCopyEx( &renderer, &_tex.getTexture(), nullptr, &dstRect, _rotation, nullptr, SDL_FLIP_NONE);
+        CMetrics::add(Metric::RENDER_COPY_EX);
+    }
 }
 
 // update ship position and direction based on movement booleans
@@ -39,10 +39,10 @@ void GameObjectShip::update(Uint32 updateTime)
     // if move forward or move backward is true set current velocity
     if(_moveForward || _moveBackward){
         if(_moveForward){
-            _velocity = CVector(150, _rotation-90, VectorType::POLAR);
+            _velocity = CVector(AsteroidConstants::SHIP_VELOCITY, _rotation-90, VectorType::POLAR);
         }
         else{
-            _velocity = CVector(-150, _rotation-90, VectorType::POLAR);
+            _velocity = CVector(-AsteroidConstants::SHIP_VELOCITY, _rotation-90, VectorType::POLAR);
         }
     }
     // otherwise set current velocity to 0
@@ -50,27 +50,70 @@ void GameObjectShip::update(Uint32 updateTime)
         _velocity = CVector(0, 0, VectorType::POLAR);
     }
 
-    // if rorate left or rotate right change the velocity angle
-    if(_rotateLeft ^ _rotateRight){
-        if(_rotateLeft){
-            _rotation -= 5;
-        }
-        else{
-            _rotation += 5;
-        }
+    double timeDelta = static_cast<double>(updateTime - _lastUpdated)/1000;
+
+    // if rorate left or rotate right turn at SHIP_TURN_RATE, so the turn speed does not depend on the frame rate
+    // the direction changes in whole steps to match the pre-rotated sprites
+    int direction = (_rotateLeft ^ _rotateRight) ? (_rotateLeft ? -1 : 1) : 0;
+    if(direction != _turnDirection){
+        // a new turn starts with one whole step, so a short tap still turns the ship
+        _turnDirection = direction;
+        _turnAngle = AsteroidConstants::SHIP_ROTATION_STEP;
+    }
+    else{
+        _turnAngle += AsteroidConstants::SHIP_TURN_RATE * timeDelta;
+    }
+    if(direction != 0){
+        int steps = static_cast<int>(_turnAngle / AsteroidConstants::SHIP_ROTATION_STEP);
+        _turnAngle -= steps * AsteroidConstants::SHIP_ROTATION_STEP;
+        _rotation = std::fmod(_rotation + direction * steps * AsteroidConstants::SHIP_ROTATION_STEP, 360.0);
         if(_rotation < 0) _rotation += 360;
-        if(_rotation >= 360) _rotation -= 360;
     }
 
     // compute new position based on velocity vector and time delta
-    double timeDelta = static_cast<double>(updateTime - _lastUpdated)/1000;
 
     _pos.x += _velocity.getXProjection() * timeDelta;
     _pos.y += _velocity.getYProjection() * timeDelta;
 
+    wrapPosition();
+    updateBoundingBox();
+
     _lastUpdated = updateTime;
 }
 
+// recalculate world space bounding box for current position
+void GameObjectShip::updateBoundingBox()
+{
+    // tight bounds of the rotated sprite
+    if(_rotations != nullptr){
+        _boundingBox = _rotations->getBounds(_pos, _rotation);
+        return;
+    }
+
+    int xPosCenter = std::round(_pos.x);
+    int yPosCenter = std::round(_pos.y);
+
+    int left = xPosCenter - _width/2;
+    int top = yPosCenter - _height/2;
+
+    _boundingBox = SDL_Rect{left, top, _width, _height};
+}
+
+// move the ship to a saved position and direction, movement flags are kept
+void GameObjectShip::restore(const Point& pos, double rotation)
+{
+    _pos = pos;
+    _rotation = rotation;
+    _lastUpdated = SDL_GetTicks();
+    updateBoundingBox();
+}
+
+// draw pre-rotated sprites and collide with their tight bounds, nullptr to rotate on every draw
+void GameObjectShip::setRotationCache(const CSpriteRotations* rotations)
+{
+    _rotations = (rotations != nullptr && rotations->isBuilt()) ? rotations : nullptr;
+    updateBoundingBox();
+}
 
 // setter functions for ship movement
 void GameObjectShip::setRotateLeft(bool val) { _rotateLeft = val;}
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "GameObject.h"
+#include "CSpriteRotations.h"
 #include <vector>
 
 enum class ShipMovement
@@ -22,7 +23,8 @@ class GameObjectShip : public GameObject
 
         GameObjectShip(const Point& pos, const CTexture& tex, CVector velocity);
         
-        void render(SDL_Renderer& renderer) override;   // render ship to the screen
+        using GameObject::render;
+        void render(SDL_Renderer& renderer, const CCamera& camera) override;    // render ship to the screen
         void update(const Uint32 updateTime) override;  // update ship position and direction based on movement booleans
         
         // setter functions for ship movement
@@ -31,18 +33,27 @@ class GameObjectShip : public GameObject
         void setMoveForward(bool val);
         void setMoveBackward(bool val);
 
+        void restore(const Point& pos, double rotation);    // move the ship to a saved position and direction, movement flags are kept
+        void setRotationCache(const CSpriteRotations* rotations);  // draw pre-rotated sprites and collide with their tight bounds, nullptr to rotate on every draw
+
         // getter
         const SDL_Rect& getBoundingBox();
 
     private:
 
+        void updateBoundingBox();   // recalculate world space bounding box for current position
+
         int _width;             // resize original texture
         int _height;            // resize original texture
-        SDL_Rect _boundingBox;  // bounding box for laser used for collision detection
+        SDL_Rect _boundingBox;  // world space bounding box for ship used for collision detection
+        const CSpriteRotations* _rotations;     // pre-rotated sprites, not owned
 
         // used for movement update based on keyboard input
         bool _rotateLeft;
         bool _rotateRight;
         bool _moveForward;
         bool _moveBackward;
+
+        int _turnDirection;     // -1 turning left, 1 turning right, 0 not turning
+        double _turnAngle;      // degrees turned since the last whole rotation step
 };
\ No newline at end of file
@@ -15,11 +15,13 @@ GameObjectStatic::GameObjectStatic(const Point& pos, const CTexture& tex)
 void GameObjectStatic::render(SDL_Renderer& renderer) 
 {
     SDL_Rect renderQuad{static_cast<int>(_pos.x), static_cast<int>(_pos.y), _tex.getWidth(), _tex.getHeight()};
-    SDL_RenderCopy( &renderer, &_tex.getTexture(), nullptr, &renderQuad);    
+    _tex.render(renderer, nullptr, renderQuad);
+    CMetrics::add(Metric::RENDER_COPY);
 }
 
 // render object to screen, destination is given by dest
 void GameObjectStatic::render(SDL_Renderer& renderer, SDL_Rect& dest) const
 {
-    SDL_RenderCopy( &renderer, &_tex.getTexture(), nullptr, &dest);    
+    _tex.render(renderer, nullptr, dest);
+    CMetrics::add(Metric::RENDER_COPY);
 }
\ No newline at end of file
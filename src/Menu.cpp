@@ -17,6 +17,7 @@ Menu::Menu(SDL_Renderer& renderer, const GameObjectStatic& backgroundObject, con
 // run menu loop
 GameState Menu::run()
 {
+    TRACE_SCOPE("Menu::run");
     SDL_Event event;
 
     while(true){
@@ -35,14 +36,17 @@ GameState Menu::run()
             }
         }
 
-        // render items
-        render();
+        // render items, nothing is drawn while the window is idle
+        if(!waitIfIdle()){
+            render();
+        }
     }
 }
 
  // initialize renderer and render objects
 void Menu::render()
 {
+    TRACE_SCOPE("Menu::render");
     SDL_SetRenderDrawColor(&_renderer, 0x00, 0x00, 0x00, 0xFF );
     SDL_RenderClear(&_renderer);
 
@@ -55,6 +59,17 @@ void Menu::render()
     SDL_RenderPresent(&_renderer);
 }
 
+// sleep until the next SDL event if the window is hidden, minimized or unfocused, true if it slept
+// the event is left in the queue for the menu loop
+bool Menu::waitIfIdle()
+{
+    SDL_Window* window = SDL_RenderGetWindow(&_renderer);
+    if(window == nullptr || !CInputQueue::isIdle(*window)) return false;
+
+    SDL_WaitEvent(nullptr);
+    return true;
+}
+
 // render text objects
 void Menu::renderMenuItems()
 {
@@ -20,6 +20,8 @@
 #include "GameObjectStatic.h"
 #include "constants.h"
 #include "utility.h"
+#include "CTracer.h"
+#include "CInputQueue.h"
 
 class Menu
 {
@@ -29,12 +31,13 @@ class Menu
         virtual ~Menu() = default;
 
         virtual GameState run();    // run menu loop
+        void render();              // draw and present one frame of the menu, used by menus shown inside the game loop
     
     protected:
 
         virtual void initMenuItems(){};             // initialize static objects to be rendered
-        void render();                        // initialize renderer and render objects
         virtual void renderMenuItems();       // render text objects
+        bool waitIfIdle();                    // sleep until the next SDL event if the window is hidden, minimized or unfocused
 
         // wrapper for factory method for creating static game objects
         std::unique_ptr<GameObjectStatic> createStaticTextObject(Point pos, CTexture &tex);
@@ -16,6 +16,7 @@ MenuGameOver::MenuGameOver(SDL_Renderer& renderer, const GameObjectStatic& backg
 // run menu loop
 GameState MenuGameOver::run()
 {
+    TRACE_SCOPE("MenuGameOver::run");
     SDL_Event event;
 
     while(true){
@@ -42,8 +43,10 @@ GameState MenuGameOver::run()
                 }
             }
         }
-        // render items
-        render();
+        // render items, nothing is drawn while the window is idle
+        if(!waitIfIdle()){
+            render();
+        }
     }
 }
 
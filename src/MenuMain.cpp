@@ -15,6 +15,7 @@ MenuMain::MenuMain(SDL_Renderer& renderer, const GameObjectStatic& backgroundObj
 // run menu loop
 GameState MenuMain::run()
 {
+    TRACE_SCOPE("MenuMain::run");
     SDL_Event event;
 
     while(true){
@@ -40,8 +41,10 @@ GameState MenuMain::run()
                 }
             }
         }
-        // render items
-        render();
+        // render items, nothing is drawn while the window is idle
+        if(!waitIfIdle()){
+            render();
+        }
     }
 }
 
@@ -0,0 +1,263 @@
+/* File:            NetClient.cpp
+ * Author:          Vish Potnis
+ * Description:     - Multiplayer client connection to a NetServer on the loopback interface
+ *                  - Sends control input, decodes delta compressed snapshots
+ *                  - Renders a short delay behind the server, interpolating between the two snapshots around the render time
+ */
+
+#include "NetClient.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // interval between hello packets while connecting
+    constexpr Uint32 HELLO_RETRY_MS{250};
+
+    // fraction of the difference a later clock sample moves the offset by, follows a server that fell behind its clock
+    constexpr double CLOCK_OFFSET_DRIFT{0.01};
+
+    // entities that moved further than this between snapshots were respawned, they are not interpolated
+    constexpr int SNAP_DISTANCE{64 * AsteroidConstants::NET_POS_SCALE};
+
+    // interpolate a quantized position across the world wrap
+    std::uint16_t lerpPosition(std::uint16_t a, std::uint16_t b, double t, int worldSize)
+    {
+        int delta = static_cast<int>(b) - static_cast<int>(a);
+        if(delta > worldSize/2) delta -= worldSize;
+        if(delta < -worldSize/2) delta += worldSize;
+        if(std::abs(delta) > SNAP_DISTANCE) return b;
+
+        int value = a + static_cast<int>(std::lround(delta * t));
+        if(value < 0) value += worldSize;
+        if(value >= worldSize) value -= worldSize;
+        return static_cast<std::uint16_t>(value);
+    }
+
+    // interpolate a quantized rotation the short way around
+    std::uint8_t lerpRotation(std::uint8_t a, std::uint8_t b, double t)
+    {
+        int delta = static_cast<std::int8_t>(static_cast<std::uint8_t>(b - a));
+        return static_cast<std::uint8_t>(a + std::lround(delta * t));
+    }
+}
+
+NetClient::NetClient()
+    : _serverPort(0), _slot(-1), _latestTick(0), _lastReceived(0), _clockOffset(0), _hasClockOffset(false),
+      _receiveBuffer(AsteroidConstants::NET_MAX_PACKET)
+{}
+
+NetClient::~NetClient()
+{
+    disconnect();
+}
+
+// handshake with the server, false if it did not answer or is full
+bool NetClient::connect(std::uint16_t serverPort, Uint32 timeoutMs)
+{
+    disconnect();
+    if(!_socket.open(0)) return false;
+
+    _serverPort = serverPort;
+    _history.clear();
+    _latestTick = 0;
+    _hasClockOffset = false;
+
+    Uint32 start = SDL_GetTicks();
+    Uint32 lastHello = 0;
+    bool helloSent = false;
+    while(SDL_GetTicks() - start < timeoutMs){
+        Uint32 now = SDL_GetTicks();
+        if(!helloSent || now - lastHello >= HELLO_RETRY_MS){
+            _writer.clear();
+            _writer.writeU8(static_cast<std::uint8_t>(NetPacket::HELLO));
+            _writer.writeU32(NET_PROTOCOL_VERSION);
+            _socket.send(_serverPort, _writer.data(), _writer.size());
+            lastHello = now;
+            helloSent = true;
+        }
+
+        std::uint16_t port;
+        int size;
+        while((size = _socket.receive(_receiveBuffer.data(), _receiveBuffer.size(), port)) > 0){
+            if(port != _serverPort) continue;
+
+            CNetReader reader(_receiveBuffer.data(), size);
+            NetPacket type = static_cast<NetPacket>(reader.readU8());
+            if(type == NetPacket::WELCOME){
+                _slot = reader.readU8();
+                _lastReceived = SDL_GetTicks();
+                std::cout << "Connected to server on port " << _serverPort << " as player " << _slot + 1 << "\n";
+                return true;
+            }
+            if(type == NetPacket::REJECT){
+                std::cout << "Server on port " << _serverPort << " rejected the connection!\n";
+                _socket.close();
+                return false;
+            }
+        }
+        SDL_Delay(10);
+    }
+
+    std::cout << "No answer from server on port " << _serverPort << "!\n";
+    _socket.close();
+    return false;
+}
+
+void NetClient::disconnect()
+{
+    if(_slot >= 0){
+        _writer.clear();
+        _writer.writeU8(static_cast<std::uint8_t>(NetPacket::BYE));
+        _socket.send(_serverPort, _writer.data(), _writer.size());
+    }
+    _slot = -1;
+    _socket.close();
+}
+
+// controls and acknowledgement of the newest snapshot
+// sent every frame, so a lost input packet is replaced by the next one
+void NetClient::sendInput(const SimControls& controls, std::uint8_t shotCounter)
+{
+    if(_slot < 0) return;
+
+    std::uint8_t flags = 0;
+    if(controls.rotateLeft) flags |= NET_INPUT_ROTATE_LEFT;
+    if(controls.rotateRight) flags |= NET_INPUT_ROTATE_RIGHT;
+    if(controls.moveForward) flags |= NET_INPUT_MOVE_FORWARD;
+    if(controls.moveBackward) flags |= NET_INPUT_MOVE_BACKWARD;
+
+    _writer.clear();
+    _writer.writeU8(static_cast<std::uint8_t>(NetPacket::INPUT));
+    _writer.writeU32(_latestTick);
+    _writer.writeU8(flags);
+    _writer.writeU8(shotCounter);
+    _socket.send(_serverPort, _writer.data(), _writer.size());
+}
+
+// decode all pending snapshots
+// snapshots whose baseline is no longer in history are dropped, the server falls back to a full snapshot once acks stop advancing
+void NetClient::receive(Uint32 now)
+{
+    if(_slot < 0) return;
+
+    const std::uint32_t historySpan = AsteroidConstants::NET_HISTORY * AsteroidConstants::NET_SNAPSHOT_INTERVAL;
+
+    std::uint16_t port;
+    int size;
+    while((size = _socket.receive(_receiveBuffer.data(), _receiveBuffer.size(), port)) > 0){
+        if(port != _serverPort) continue;
+
+        CNetReader reader(_receiveBuffer.data(), size);
+        if(static_cast<NetPacket>(reader.readU8()) != NetPacket::SNAPSHOT) continue;
+        if(!CSnapshotCodec::decode(reader, _history, _decoded)) continue;
+
+        // too old to keep, its slot holds a newer snapshot
+        if(_decoded.tick + historySpan <= _latestTick) continue;
+
+        NetSnapshot& slot = _history.slot(_decoded.tick);
+        slot.tick = _decoded.tick;
+        slot.ship = _decoded.ship;
+        slot.shipAlive = _decoded.shipAlive;
+        slot.level = _decoded.level;
+        slot.color = _decoded.color;
+        slot.shipScore = _decoded.shipScore;
+        slot.totalScore = _decoded.totalScore;
+        slot.entities.assign(_decoded.entities.begin(), _decoded.entities.end());
+
+        if(_decoded.tick > _latestTick) _latestTick = _decoded.tick;
+        _lastReceived = now;
+
+        // the fastest snapshot so far gives the best estimate of the server clock
+        double sample = static_cast<double>(now) - static_cast<double>(_decoded.tick) * AsteroidConstants::SIM_TICK_MS;
+        if(!_hasClockOffset || sample < _clockOffset){
+            _clockOffset = sample;
+            _hasClockOffset = true;
+        }
+        else{
+            _clockOffset += (sample - _clockOffset) * CLOCK_OFFSET_DRIFT;
+        }
+    }
+}
+
+// world state at the render time now - NET_INTERP_DELAY_MS, false until the first snapshot arrived
+// falls back to the newest snapshot if the render time is past it
+bool NetClient::getInterpolated(Uint32 now, NetSnapshot& out) const
+{
+    const NetSnapshot* latest = _history.find(_latestTick);
+    if(!latest) return false;
+
+    const int interval = AsteroidConstants::NET_SNAPSHOT_INTERVAL;
+    const std::uint32_t historySpan = AsteroidConstants::NET_HISTORY * interval;
+
+    double renderTick = (static_cast<double>(now) - _clockOffset - AsteroidConstants::NET_INTERP_DELAY_MS) / AsteroidConstants::SIM_TICK_MS;
+    if(renderTick >= _latestTick || renderTick <= 0){
+        out = *latest;
+        return true;
+    }
+
+    // nearest snapshots before and after the render time
+    std::uint32_t first = static_cast<std::uint32_t>(renderTick) / interval * interval;
+    const NetSnapshot* from = nullptr;
+    for(std::uint32_t tick = first; tick > 0 && _latestTick - tick < historySpan; tick -= interval){
+        if((from = _history.find(tick))) break;
+    }
+    const NetSnapshot* to = nullptr;
+    for(std::uint32_t tick = first + interval; tick <= _latestTick; tick += interval){
+        if((to = _history.find(tick))) break;
+    }
+
+    if(!from || !to){
+        out = to ? *to : *latest;
+        return true;
+    }
+
+    double t = (renderTick - from->tick) / (to->tick - from->tick);
+    interpolate(*from, *to, std::min(std::max(t, 0.0), 1.0), out);
+    return true;
+}
+
+// entities of to, moved back towards their position in from
+// entities that are only in from were removed and are not shown
+void NetClient::interpolate(const NetSnapshot& from, const NetSnapshot& to, double t, NetSnapshot& out) const
+{
+    const int worldWidth = AsteroidConstants::WORLD_WIDTH * AsteroidConstants::NET_POS_SCALE;
+    const int worldHeight = AsteroidConstants::WORLD_HEIGHT * AsteroidConstants::NET_POS_SCALE;
+
+    out.tick = to.tick;
+    out.ship = to.ship;
+    out.shipAlive = to.shipAlive;
+    out.level = to.level;
+    out.color = to.color;
+    out.shipScore = to.shipScore;
+    out.totalScore = to.totalScore;
+    out.entities.clear();
+
+    // both lists are in id order
+    std::size_t next = 0;
+    for(const NetEntity& entity: to.entities){
+        while(next < from.entities.size() && from.entities[next].id < entity.id){
+            next++;
+        }
+
+        NetEntity result = entity;
+        if(next < from.entities.size() && from.entities[next].id == entity.id && from.entities[next].type == entity.type){
+            const NetEntity& previous = from.entities[next];
+            result.x = lerpPosition(previous.x, entity.x, t, worldWidth);
+            result.y = lerpPosition(previous.y, entity.y, t, worldHeight);
+            result.rotation = lerpRotation(previous.rotation, entity.rotation, t);
+        }
+        out.entities.push_back(result);
+    }
+}
+
+bool NetClient::isConnected() const { return _slot >= 0;}
+int NetClient::getSlot() const { return _slot;}
+
+// no snapshot for NET_TIMEOUT_MS
+bool NetClient::hasTimedOut(Uint32 now) const
+{
+    return _slot >= 0 && now - _lastReceived > static_cast<Uint32>(AsteroidConstants::NET_TIMEOUT_MS);
+}
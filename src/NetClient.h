@@ -0,0 +1,59 @@
+/* File:            NetClient.h
+ * Author:          Vish Potnis
+ * Description:     - Multiplayer client connection to a NetServer on the loopback interface
+ *                  - Sends control input, decodes delta compressed snapshots
+ *                  - Renders a short delay behind the server, interpolating between the two snapshots around the render time
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+#include "CUdpSocket.h"
+#include "NetProtocol.h"
+#include "SimWorld.h"
+
+class NetClient
+{
+    public:
+        NetClient();
+        ~NetClient();
+
+        bool connect(std::uint16_t serverPort, Uint32 timeoutMs);     // handshake with the server, false if it did not answer or is full
+        void disconnect();
+
+        void sendInput(const SimControls& controls, std::uint8_t shotCounter);     // controls and acknowledgement of the newest snapshot
+        void receive(Uint32 now);                                     // decode all pending snapshots
+
+        // world state at the render time now - NET_INTERP_DELAY_MS, false until the first snapshot arrived
+        bool getInterpolated(Uint32 now, NetSnapshot& out) const;
+
+        // getters
+        bool isConnected() const;
+        bool hasTimedOut(Uint32 now) const;         // no snapshot for NET_TIMEOUT_MS
+        int getSlot() const;
+
+    private:
+
+        void interpolate(const NetSnapshot& from, const NetSnapshot& to, double t, NetSnapshot& out) const;
+
+        CUdpSocket _socket;
+        std::uint16_t _serverPort;
+        int _slot;                          // ship slot assigned by the server, -1 if not connected
+
+        CSnapshotHistory _history;          // decoded snapshots, baselines for the following ones
+        std::uint32_t _latestTick;          // newest decoded snapshot, acknowledged with every input
+        Uint32 _lastReceived;               // local time of the last snapshot
+
+        // local time minus server time of the fastest snapshot, maps server ticks to local time
+        double _clockOffset;
+        bool _hasClockOffset;
+
+        std::vector<std::uint8_t> _receiveBuffer;
+        NetSnapshot _decoded;               // scratch snapshot, copied into history once it decoded
+        CNetWriter _writer;
+};
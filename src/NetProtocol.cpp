@@ -0,0 +1,425 @@
+/* File:            NetProtocol.cpp
+ * Author:          Vish Potnis
+ * Description:     - Packet layout shared by the multiplayer server and clients
+ *                  - Entity state is quantized to 16 bit positions/velocities and 8 bit rotations
+ *                  - Snapshots are delta compressed against a snapshot the client acknowledged (the baseline),
+ *                    positions that match the dead reckoned baseline position are not sent
+ */
+
+#include "NetProtocol.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // per entity flags in a snapshot, an entity without changes is not written at all
+    enum EntityFlags : std::uint8_t
+    {
+        ENTITY_FULL     = 1 << 0,   // new entity, every field follows
+        ENTITY_POS      = 1 << 1,
+        ENTITY_VEL      = 1 << 2,
+        ENTITY_ROT      = 1 << 3
+    };
+
+    constexpr int WORLD_X{AsteroidConstants::WORLD_WIDTH * AsteroidConstants::NET_POS_SCALE};
+    constexpr int WORLD_Y{AsteroidConstants::WORLD_HEIGHT * AsteroidConstants::NET_POS_SCALE};
+
+    bool lessID(const NetEntity& a, const NetEntity& b) { return a.id < b.id;}
+}
+
+
+//////////// CNetWriter ////////////
+
+void CNetWriter::writeU16(std::uint16_t value)
+{
+    _data.push_back(value & 0xFF);
+    _data.push_back(value >> 8);
+}
+
+void CNetWriter::writeU32(std::uint32_t value)
+{
+    writeU16(value & 0xFFFF);
+    writeU16(value >> 16);
+}
+
+void CNetWriter::writeU64(std::uint64_t value)
+{
+    writeU32(value & 0xFFFFFFFF);
+    writeU32(value >> 32);
+}
+
+// 7 bits per byte, small values take one byte
+void CNetWriter::writeVarint(std::uint32_t value)
+{
+    while(value >= 0x80){
+        _data.push_back(static_cast<std::uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    _data.push_back(static_cast<std::uint8_t>(value));
+}
+
+void CNetWriter::patchU16(std::size_t offset, std::uint16_t value)
+{
+    _data[offset] = value & 0xFF;
+    _data[offset + 1] = value >> 8;
+}
+
+
+//////////// CNetReader ////////////
+
+std::uint8_t CNetReader::readU8()
+{
+    if(_pos >= _size){
+        _ok = false;
+        return 0;
+    }
+    return _data[_pos++];
+}
+
+std::uint16_t CNetReader::readU16()
+{
+    std::uint16_t low = readU8();
+    return low | (readU8() << 8);
+}
+
+std::uint32_t CNetReader::readU32()
+{
+    std::uint32_t low = readU16();
+    return low | (static_cast<std::uint32_t>(readU16()) << 16);
+}
+
+std::uint64_t CNetReader::readU64()
+{
+    std::uint64_t low = readU32();
+    return low | (static_cast<std::uint64_t>(readU32()) << 32);
+}
+
+std::uint32_t CNetReader::readVarint()
+{
+    std::uint32_t value = 0;
+    for(int shift = 0; shift < 35; shift += 7){
+        std::uint8_t byte = readU8();
+        value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) return value;
+    }
+    _ok = false;
+    return 0;
+}
+
+
+//////////// CSnapshotHistory ////////////
+
+CSnapshotHistory::CSnapshotHistory()
+    : _slots(AsteroidConstants::NET_HISTORY)
+{
+    for(auto& snapshot: _slots){
+        snapshot.entities.reserve(AsteroidConstants::NET_MAX_ENTITIES);
+    }
+}
+
+// slot a snapshot for tick is stored in, overwrites the oldest
+NetSnapshot& CSnapshotHistory::slot(std::uint32_t tick)
+{
+    return _slots[(tick / AsteroidConstants::NET_SNAPSHOT_INTERVAL) % _slots.size()];
+}
+
+// stored snapshot for tick, nullptr if it was overwritten
+const NetSnapshot* CSnapshotHistory::find(std::uint32_t tick) const
+{
+    const NetSnapshot& snapshot = _slots[(tick / AsteroidConstants::NET_SNAPSHOT_INTERVAL) % _slots.size()];
+    return (tick != 0 && snapshot.tick == tick) ? &snapshot : nullptr;
+}
+
+void CSnapshotHistory::clear()
+{
+    for(auto& snapshot: _slots){
+        snapshot.tick = 0;
+        snapshot.entities.clear();
+    }
+}
+
+
+//////////// CSnapshotCodec ////////////
+
+// write a SNAPSHOT packet for current relative to baseline (nullptr for a full snapshot)
+// layout: header, ids removed since the baseline, then new and changed entities in id order
+void CSnapshotCodec::encode(const NetSnapshot& current, const NetSnapshot* baseline, CNetWriter& writer, NetSnapshot& reconstructed)
+{
+    writer.writeU8(static_cast<std::uint8_t>(NetPacket::SNAPSHOT));
+    writer.writeU32(current.tick);
+    writer.writeU32(baseline ? baseline->tick : 0);
+    writer.writeU8(current.ship);
+    writer.writeU8(current.shipAlive);
+    writer.writeU16(current.level);
+    writer.writeU8(current.color);
+    writer.writeU32(current.shipScore);
+    writer.writeU32(current.totalScore);
+
+    reconstructed.tick = current.tick;
+    reconstructed.ship = current.ship;
+    reconstructed.shipAlive = current.shipAlive;
+    reconstructed.level = current.level;
+    reconstructed.color = current.color;
+    reconstructed.shipScore = current.shipScore;
+    reconstructed.totalScore = current.totalScore;
+    reconstructed.entities.clear();
+
+    std::uint32_t dtMs = baseline ? (current.tick - baseline->tick) * AsteroidConstants::SIM_TICK_MS : 0;
+    const std::vector<NetEntity> empty;
+    const std::vector<NetEntity>& base = baseline ? baseline->entities : empty;
+
+    // removed entities, ids are written as differences to the previous id
+    std::size_t countOffset = writer.size();
+    writer.writeU16(0);
+    std::uint16_t numRemoved = 0;
+    std::uint32_t previousID = 0;
+    auto it = current.entities.begin();
+    for(const NetEntity& old: base){
+        while(it != current.entities.end() && it->id < old.id) ++it;
+        if(it == current.entities.end() || it->id != old.id){
+            writer.writeVarint(old.id - previousID);
+            previousID = old.id;
+            numRemoved++;
+        }
+    }
+    writer.patchU16(countOffset, numRemoved);
+
+    // new and changed entities
+    countOffset = writer.size();
+    writer.writeU16(0);
+    std::uint16_t numWritten = 0;
+    previousID = 0;
+    auto baseIt = base.begin();
+    for(const NetEntity& entity: current.entities){
+        while(baseIt != base.end() && baseIt->id < entity.id) ++baseIt;
+
+        std::uint8_t flags = 0;
+        NetEntity known = entity;
+        if(baseIt == base.end() || baseIt->id != entity.id || baseIt->type != entity.type || baseIt->attr != entity.attr){
+            flags = ENTITY_FULL;
+        }
+        else{
+            // start from what the client predicts and only send what it got wrong
+            known = *baseIt;
+            known.x = predict(baseIt->x, baseIt->velX, dtMs, WORLD_X);
+            known.y = predict(baseIt->y, baseIt->velY, dtMs, WORLD_Y);
+
+            if(wrapDistance(known.x, entity.x, WORLD_X) > AsteroidConstants::NET_POS_TOLERANCE ||
+               wrapDistance(known.y, entity.y, WORLD_Y) > AsteroidConstants::NET_POS_TOLERANCE){
+                flags |= ENTITY_POS;
+                known.x = entity.x;
+                known.y = entity.y;
+            }
+            if(known.velX != entity.velX || known.velY != entity.velY){
+                flags |= ENTITY_VEL;
+                known.velX = entity.velX;
+                known.velY = entity.velY;
+            }
+            if(known.rotation != entity.rotation){
+                flags |= ENTITY_ROT;
+                known.rotation = entity.rotation;
+            }
+        }
+        reconstructed.entities.push_back(known);
+
+        if(flags == 0) continue;
+
+        writer.writeVarint(entity.id - previousID);
+        writer.writeU8(flags);
+        previousID = entity.id;
+        numWritten++;
+
+        if(flags & ENTITY_FULL){
+            writeFull(writer, entity);
+            continue;
+        }
+        if(flags & ENTITY_POS){
+            writer.writeU16(entity.x);
+            writer.writeU16(entity.y);
+        }
+        if(flags & ENTITY_VEL){
+            writer.writeU16(static_cast<std::uint16_t>(entity.velX));
+            writer.writeU16(static_cast<std::uint16_t>(entity.velY));
+        }
+        if(flags & ENTITY_ROT){
+            writer.writeU8(entity.rotation);
+        }
+    }
+    writer.patchU16(countOffset, numWritten);
+}
+
+// read a SNAPSHOT packet after the packet type byte, returns false if it is corrupt or its baseline is not in history
+bool CSnapshotCodec::decode(CNetReader& reader, const CSnapshotHistory& history, NetSnapshot& out)
+{
+    out.tick = reader.readU32();
+    std::uint32_t baselineTick = reader.readU32();
+    out.ship = reader.readU8();
+    out.shipAlive = reader.readU8();
+    out.level = reader.readU16();
+    out.color = reader.readU8();
+    out.shipScore = static_cast<std::int32_t>(reader.readU32());
+    out.totalScore = static_cast<std::int32_t>(reader.readU32());
+    if(!reader.ok()) return false;
+
+    // start from the dead reckoned baseline
+    out.entities.clear();
+    if(baselineTick != 0){
+        const NetSnapshot* baseline = history.find(baselineTick);
+        if(!baseline) return false;
+        predictAll(*baseline, out.tick, out.entities);
+    }
+
+    // drop removed entities, both lists are in id order
+    std::uint16_t numRemoved = reader.readU16();
+    std::uint32_t id = 0;
+    std::size_t numKept = 0;
+    std::size_t next = 0;
+    for(int i = 0; i < numRemoved && reader.ok(); i++){
+        id += reader.readVarint();
+        while(next < out.entities.size() && out.entities[next].id < id){
+            out.entities[numKept++] = out.entities[next++];
+        }
+        if(next < out.entities.size() && out.entities[next].id == id){
+            next++;
+        }
+    }
+    while(next < out.entities.size()){
+        out.entities[numKept++] = out.entities[next++];
+    }
+    out.entities.resize(numKept);
+
+    // apply new and changed entities
+    std::uint16_t numWritten = reader.readU16();
+    std::size_t numExisting = out.entities.size();
+    id = 0;
+    for(int i = 0; i < numWritten && reader.ok(); i++){
+        id += reader.readVarint();
+        std::uint8_t flags = reader.readU8();
+
+        if(flags & ENTITY_FULL){
+            NetEntity entity;
+            entity.id = id;
+            if(!readFull(reader, entity)) return false;
+
+            auto it = std::lower_bound(out.entities.begin(), out.entities.begin() + numExisting, entity, lessID);
+            if(it != out.entities.begin() + numExisting && it->id == id){
+                *it = entity;
+            }
+            else{
+                out.entities.push_back(entity);
+            }
+            continue;
+        }
+
+        NetEntity key{};
+        key.id = id;
+        auto it = std::lower_bound(out.entities.begin(), out.entities.begin() + numExisting, key, lessID);
+        if(it == out.entities.begin() + numExisting || it->id != id) return false;
+
+        if(flags & ENTITY_POS){
+            it->x = reader.readU16();
+            it->y = reader.readU16();
+        }
+        if(flags & ENTITY_VEL){
+            it->velX = static_cast<std::int16_t>(reader.readU16());
+            it->velY = static_cast<std::int16_t>(reader.readU16());
+        }
+        if(flags & ENTITY_ROT){
+            it->rotation = reader.readU8();
+        }
+    }
+
+    // new entities were appended, restore id order
+    if(out.entities.size() != numExisting){
+        std::sort(out.entities.begin(), out.entities.end(), lessID);
+    }
+    return reader.ok();
+}
+
+// quantize simulation state
+NetEntity CSnapshotCodec::quantize(std::uint32_t id, NetEntityType type, std::uint8_t attr, const Point& pos, double velX, double velY, double rotation)
+{
+    auto quantizeVelocity = [](double vel){
+        return static_cast<std::int16_t>(std::clamp<long>(std::lround(vel * AsteroidConstants::NET_VEL_SCALE), -32768, 32767));
+    };
+
+    NetEntity entity;
+    entity.id = id;
+    entity.type = type;
+    entity.attr = attr;
+    entity.x = static_cast<std::uint16_t>(std::lround(pos.x * AsteroidConstants::NET_POS_SCALE) % WORLD_X);
+    entity.y = static_cast<std::uint16_t>(std::lround(pos.y * AsteroidConstants::NET_POS_SCALE) % WORLD_Y);
+    entity.velX = quantizeVelocity(velX);
+    entity.velY = quantizeVelocity(velY);
+    entity.rotation = static_cast<std::uint8_t>(std::lround(rotation * 256 / 360) & 0xFF);
+    return entity;
+}
+
+// dead reckoned position after dtMs, wrapped around the quantized world size
+// integer math so server and client predict exactly the same value
+std::uint16_t CSnapshotCodec::predict(std::uint16_t pos, std::int16_t vel, std::uint32_t dtMs, int worldSize)
+{
+    const std::int64_t denominator = AsteroidConstants::NET_VEL_SCALE * 1000;
+    std::int64_t numerator = static_cast<std::int64_t>(vel) * dtMs * AsteroidConstants::NET_POS_SCALE;
+    std::int64_t delta = (numerator >= 0 ? numerator + denominator/2 : numerator - denominator/2) / denominator;
+
+    std::int64_t result = (pos + delta) % worldSize;
+    if(result < 0) result += worldSize;
+    return static_cast<std::uint16_t>(result);
+}
+
+// absolute distance across the world wrap in quantization steps
+int CSnapshotCodec::wrapDistance(std::uint16_t a, std::uint16_t b, int worldSize)
+{
+    int distance = std::abs(static_cast<int>(a) - static_cast<int>(b));
+    return std::min(distance, worldSize - distance);
+}
+
+void CSnapshotCodec::predictAll(const NetSnapshot& baseline, std::uint32_t tick, std::vector<NetEntity>& out)
+{
+    std::uint32_t dtMs = (tick - baseline.tick) * AsteroidConstants::SIM_TICK_MS;
+    for(NetEntity entity: baseline.entities){
+        entity.x = predict(entity.x, entity.velX, dtMs, WORLD_X);
+        entity.y = predict(entity.y, entity.velY, dtMs, WORLD_Y);
+        out.push_back(entity);
+    }
+}
+
+void CSnapshotCodec::writeFull(CNetWriter& writer, const NetEntity& entity)
+{
+    writer.writeU8(static_cast<std::uint8_t>(entity.type));
+    writer.writeU8(entity.attr);
+    writer.writeU16(entity.x);
+    writer.writeU16(entity.y);
+    writer.writeU16(static_cast<std::uint16_t>(entity.velX));
+    writer.writeU16(static_cast<std::uint16_t>(entity.velY));
+    writer.writeU8(entity.rotation);
+}
+
+// type and attr index texture tables on the client, values the server never sends reject the whole snapshot
+bool CSnapshotCodec::readFull(CNetReader& reader, NetEntity& entity)
+{
+    std::uint8_t type = reader.readU8();
+    entity.attr = reader.readU8();
+    entity.x = reader.readU16();
+    entity.y = reader.readU16();
+    entity.velX = static_cast<std::int16_t>(reader.readU16());
+    entity.velY = static_cast<std::int16_t>(reader.readU16());
+    entity.rotation = reader.readU8();
+
+    switch(type){
+        case static_cast<std::uint8_t>(NetEntityType::SHIP):
+        case static_cast<std::uint8_t>(NetEntityType::LASER):
+            // ship slot or laser owner
+            if(entity.attr >= AsteroidConstants::NET_MAX_CLIENTS) return false;
+            break;
+        case static_cast<std::uint8_t>(NetEntityType::ASTEROID):
+            if(entity.attr > static_cast<std::uint8_t>(AsteroidSize::SMALL)) return false;
+            break;
+        default:
+            return false;
+    }
+    entity.type = static_cast<NetEntityType>(type);
+    return true;
+}
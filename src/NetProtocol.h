@@ -0,0 +1,157 @@
+/* File:            NetProtocol.h
+ * Author:          Vish Potnis
+ * Description:     - Packet layout shared by the multiplayer server and clients
+ *                  - Entity state is quantized to 16 bit positions/velocities and 8 bit rotations
+ *                  - Snapshots are delta compressed against a snapshot the client acknowledged (the baseline),
+ *                    positions that match the dead reckoned baseline position are not sent
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+#include "utility.h"
+
+constexpr std::uint32_t NET_PROTOCOL_VERSION{1};
+
+// first byte of every packet
+enum class NetPacket : std::uint8_t
+{
+    HELLO = 1,      // client -> server: protocol version
+    WELCOME,        // server -> client: assigned ship slot
+    REJECT,         // server -> client: server is full or version mismatch
+    INPUT,          // client -> server: acknowledged snapshot tick, control flags, shot counter
+    SNAPSHOT,       // server -> client: world state around the client ship
+    BYE             // client -> server: disconnect
+};
+
+// control flags in an INPUT packet
+enum NetInputFlags : std::uint8_t
+{
+    NET_INPUT_ROTATE_LEFT   = 1 << 0,
+    NET_INPUT_ROTATE_RIGHT  = 1 << 1,
+    NET_INPUT_MOVE_FORWARD  = 1 << 2,
+    NET_INPUT_MOVE_BACKWARD = 1 << 3
+};
+
+enum class NetEntityType : std::uint8_t
+{
+    SHIP,
+    ASTEROID,
+    LASER
+};
+
+// quantized state of one entity
+struct NetEntity
+{
+    std::uint32_t id;           // ships use their slot index, other entities are offset by NET_MAX_CLIENTS
+    NetEntityType type;
+    std::uint8_t attr;          // ship slot, asteroid size or laser owner
+    std::uint16_t x;            // position * NET_POS_SCALE
+    std::uint16_t y;
+    std::int16_t velX;          // velocity * NET_VEL_SCALE
+    std::int16_t velY;
+    std::uint8_t rotation;      // rotation * 256 / 360
+};
+
+// world state sent to one client
+struct NetSnapshot
+{
+    std::uint32_t tick{0};          // simulation step, 0 marks an empty history slot
+    std::uint8_t ship{0};           // slot of the receiving client
+    std::uint8_t shipAlive{0};
+    std::uint16_t level{0};
+    std::uint8_t color{0};          // AsteroidColor of the level
+    std::int32_t shipScore{0};
+    std::int32_t totalScore{0};
+    std::vector<NetEntity> entities;    // sorted by id
+};
+
+// growing byte buffer for building packets, storage is reused after clear
+class CNetWriter
+{
+    public:
+        void clear() { _data.clear();}
+
+        void writeU8(std::uint8_t value) { _data.push_back(value);}
+        void writeU16(std::uint16_t value);
+        void writeU32(std::uint32_t value);
+        void writeU64(std::uint64_t value);
+        void writeVarint(std::uint32_t value);          // 7 bits per byte, small values take one byte
+        void patchU16(std::size_t offset, std::uint16_t value);
+
+        const std::uint8_t* data() const { return _data.data();}
+        std::size_t size() const { return _data.size();}
+
+    private:
+        std::vector<std::uint8_t> _data;
+};
+
+// reads a packet, reads past the end return 0 and mark the reader as failed
+class CNetReader
+{
+    public:
+        CNetReader(const std::uint8_t* data, std::size_t size) : _data(data), _size(size), _pos(0), _ok(true) {}
+
+        std::uint8_t readU8();
+        std::uint16_t readU16();
+        std::uint32_t readU32();
+        std::uint64_t readU64();
+        std::uint32_t readVarint();
+
+        bool ok() const { return _ok;}
+
+    private:
+        const std::uint8_t* _data;
+        std::size_t _size;
+        std::size_t _pos;
+        bool _ok;
+};
+
+// ring of past snapshots indexed by tick
+class CSnapshotHistory
+{
+    public:
+        CSnapshotHistory();
+
+        NetSnapshot& slot(std::uint32_t tick);          // slot a snapshot for tick is stored in, overwrites the oldest
+        const NetSnapshot* find(std::uint32_t tick) const;   // stored snapshot for tick, nullptr if it was overwritten
+        void clear();
+
+    private:
+        std::vector<NetSnapshot> _slots;
+};
+
+class CSnapshotCodec
+{
+    public:
+        // write a SNAPSHOT packet for current relative to baseline (nullptr for a full snapshot)
+        // reconstructed receives the state the client will decode, it is the baseline for later snapshots
+        static void encode(const NetSnapshot& current, const NetSnapshot* baseline, CNetWriter& writer, NetSnapshot& reconstructed);
+
+        // read a SNAPSHOT packet after the packet type byte, returns false if it is corrupt or its baseline is not in history
+        static bool decode(CNetReader& reader, const CSnapshotHistory& history, NetSnapshot& out);
+
+        // quantize simulation state
+        static NetEntity quantize(std::uint32_t id, NetEntityType type, std::uint8_t attr, const Point& pos, double velX, double velY, double rotation);
+
+        // convert quantized values back
+        static double toPosition(std::uint16_t value) { return static_cast<double>(value) / AsteroidConstants::NET_POS_SCALE;}
+        static double toVelocity(std::int16_t value) { return static_cast<double>(value) / AsteroidConstants::NET_VEL_SCALE;}
+        static double toRotation(std::uint8_t value) { return value * 360.0 / 256;}
+
+    private:
+
+        // dead reckoned position after dtMs, wrapped around the quantized world size
+        static std::uint16_t predict(std::uint16_t pos, std::int16_t vel, std::uint32_t dtMs, int worldSize);
+        static int wrapDistance(std::uint16_t a, std::uint16_t b, int worldSize);     // absolute distance across the world wrap in quantization steps
+
+        static void predictAll(const NetSnapshot& baseline, std::uint32_t tick, std::vector<NetEntity>& out);
+
+        static void writeFull(CNetWriter& writer, const NetEntity& entity);
+        static bool readFull(CNetReader& reader, NetEntity& entity);     // false if type or attr is not one the server sends
+};
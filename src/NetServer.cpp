@@ -0,0 +1,351 @@
+/* File:            NetServer.cpp
+ * Author:          Vish Potnis
+ * Description:     - Headless authoritative multiplayer server on the loopback interface
+ *                  - Owns the simulation (SimWorld) with one ship per connected client
+ *                  - Sends every client a delta compressed snapshot of the entities near its ship at a fixed tick
+ */
+
+#include "NetServer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    // world parameters of the server, ships respawn instead of ending the session
+    SimParams makeServerParams()
+    {
+        SimParams params;
+        params.numShips = AsteroidConstants::NET_MAX_CLIENTS;
+        params.respawnMs = AsteroidConstants::NET_RESPAWN_MS;
+        return params;
+    }
+
+    // shortest signed distance across the world wrap
+    double wrapDelta(double delta, double worldSize)
+    {
+        return delta - worldSize * std::floor(delta / worldSize + 0.5);
+    }
+
+    // steps the server catches up at once after a stall before it skips ahead
+    constexpr int MAX_CATCHUP_STEPS{5};
+}
+
+NetServer::NetServer(std::uint16_t port, int startLevel)
+    : _world(static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()), makeServerParams()),
+      _clients(AsteroidConstants::NET_MAX_CLIENTS), _tick(0), _running(false),
+      _receiveBuffer(AsteroidConstants::NET_MAX_PACKET), _statsTicks(0), _statsSnapshots(0), _statsTickTime(0)
+{
+    // ship slots are filled as clients connect
+    for(int i = 0; i < AsteroidConstants::NET_MAX_CLIENTS; i++){
+        _world.setShipActive(i, false);
+    }
+    _world.reset(std::max(startLevel, 1));
+
+    if(_socket.open(port)){
+        std::cout << "Server listening on 127.0.0.1:" << _socket.getPort() << "\n";
+    }
+}
+
+bool NetServer::isOpen() const { return _socket.isOpen();}
+
+// run the simulation until stop is called
+// the world is stepped at a fixed tick and a snapshot goes out every NET_SNAPSHOT_INTERVAL steps
+void NetServer::run()
+{
+    _running = true;
+    const auto tickDuration = std::chrono::milliseconds(AsteroidConstants::SIM_TICK_MS);
+
+    Clock::time_point nextStep = Clock::now();
+    _statsStart = nextStep;
+
+    while(_running){
+        receivePackets();
+        checkTimeouts();
+
+        Clock::time_point now = Clock::now();
+        int steps = 0;
+        while(now >= nextStep && steps < MAX_CATCHUP_STEPS){
+            Clock::time_point tickStart = Clock::now();
+            stepSimulation();
+            if(_tick % AsteroidConstants::NET_SNAPSHOT_INTERVAL == 0){
+                sendSnapshots();
+            }
+            _statsTickTime += Clock::now() - tickStart;
+            _statsTicks++;
+
+            nextStep += tickDuration;
+            steps++;
+        }
+        // fell too far behind, skip the missed steps instead of running faster and faster
+        if(now >= nextStep){
+            nextStep = now + tickDuration;
+        }
+
+        if(now - _statsStart >= std::chrono::milliseconds(AsteroidConstants::NET_STATS_INTERVAL_MS)){
+            printStats();
+        }
+
+        std::this_thread::sleep_until(nextStep);
+    }
+}
+
+// safe to call from a signal handler or another thread
+void NetServer::stop()
+{
+    _running = false;
+}
+
+// handle hello, input and bye packets
+void NetServer::receivePackets()
+{
+    std::uint16_t port;
+    int size;
+    while((size = _socket.receive(_receiveBuffer.data(), _receiveBuffer.size(), port)) > 0){
+        CNetReader reader(_receiveBuffer.data(), size);
+        NetPacket type = static_cast<NetPacket>(reader.readU8());
+
+        if(type == NetPacket::HELLO){
+            handleHello(port, reader);
+            continue;
+        }
+
+        int slot = findSlot(port);
+        if(slot < 0) continue;
+
+        _clients[slot].lastHeard = Clock::now();
+        switch(type){
+            case NetPacket::INPUT:  handleInput(_clients[slot], reader);    break;
+            case NetPacket::BYE:    disconnect(slot);                       break;
+            default:                                                        break;
+        }
+    }
+}
+
+// assign a free ship slot to a new client, hello from a known client is answered again in case the welcome was lost
+void NetServer::handleHello(std::uint16_t port, CNetReader& reader)
+{
+    std::uint32_t version = reader.readU32();
+
+    int slot = findSlot(port);
+    if(slot < 0 && reader.ok() && version == NET_PROTOCOL_VERSION){
+        for(int i = 0; i < static_cast<int>(_clients.size()); i++){
+            if(!_clients[i].connected){
+                slot = i;
+                break;
+            }
+        }
+        if(slot >= 0){
+            ClientSlot& client = _clients[slot];
+            client.connected = true;
+            client.port = port;
+            client.controls = SimControls{};
+            client.shotCounter = 0;
+            client.pendingShots = 0;
+            client.ackTick = 0;
+            client.history.clear();
+            _world.setShipActive(slot, true);
+            std::cout << "Client " << port << " joined as player " << slot + 1 << "\n";
+        }
+    }
+
+    _writer.clear();
+    if(slot < 0){
+        _writer.writeU8(static_cast<std::uint8_t>(NetPacket::REJECT));
+    }
+    else{
+        _clients[slot].lastHeard = Clock::now();
+        _writer.writeU8(static_cast<std::uint8_t>(NetPacket::WELCOME));
+        _writer.writeU8(static_cast<std::uint8_t>(slot));
+    }
+    _socket.send(port, _writer.data(), _writer.size());
+}
+
+// latest control flags, shots are counted so a lost input packet does not lose a shot
+void NetServer::handleInput(ClientSlot& client, CNetReader& reader)
+{
+    std::uint32_t ackTick = reader.readU32();
+    std::uint8_t flags = reader.readU8();
+    std::uint8_t shotCounter = reader.readU8();
+    if(!reader.ok()) return;
+
+    if(ackTick > client.ackTick && client.history.find(ackTick)){
+        client.ackTick = ackTick;
+    }
+
+    client.controls.rotateLeft = (flags & NET_INPUT_ROTATE_LEFT) != 0;
+    client.controls.rotateRight = (flags & NET_INPUT_ROTATE_RIGHT) != 0;
+    client.controls.moveForward = (flags & NET_INPUT_MOVE_FORWARD) != 0;
+    client.controls.moveBackward = (flags & NET_INPUT_MOVE_BACKWARD) != 0;
+
+    client.pendingShots += static_cast<std::uint8_t>(shotCounter - client.shotCounter);
+    client.shotCounter = shotCounter;
+}
+
+void NetServer::disconnect(int slot)
+{
+    ClientSlot& client = _clients[slot];
+    std::cout << "Client " << client.port << " (player " << slot + 1 << ") left\n";
+
+    client.connected = false;
+    client.port = 0;
+    _world.setShipActive(slot, false);
+}
+
+void NetServer::checkTimeouts()
+{
+    Clock::time_point now = Clock::now();
+    for(int i = 0; i < static_cast<int>(_clients.size()); i++){
+        if(_clients[i].connected && now - _clients[i].lastHeard > std::chrono::milliseconds(AsteroidConstants::NET_TIMEOUT_MS)){
+            disconnect(i);
+        }
+    }
+}
+
+// apply client input and advance the world by one step
+void NetServer::stepSimulation()
+{
+    SimControls controls[AsteroidConstants::NET_MAX_CLIENTS] = {};
+    for(int i = 0; i < static_cast<int>(_clients.size()); i++){
+        ClientSlot& client = _clients[i];
+        if(!client.connected) continue;
+
+        controls[i] = client.controls;
+        controls[i].shoot = client.pendingShots > 0;
+        if(client.pendingShots > 0) client.pendingShots--;
+    }
+
+    _world.step(controls);
+    _tick++;
+}
+
+// send a snapshot of the entities near each client ship
+// encoded against the newest snapshot the client acknowledged, or in full if it has none
+void NetServer::sendSnapshots()
+{
+    const std::uint32_t historySpan = AsteroidConstants::NET_HISTORY * AsteroidConstants::NET_SNAPSHOT_INTERVAL;
+
+    for(int i = 0; i < static_cast<int>(_clients.size()); i++){
+        ClientSlot& client = _clients[i];
+        if(!client.connected) continue;
+
+        buildSnapshot(i, _current);
+
+        // a baseline in the slot that is about to be overwritten can not be used
+        const NetSnapshot* baseline = nullptr;
+        if(client.ackTick != 0 && _tick - client.ackTick < historySpan){
+            baseline = client.history.find(client.ackTick);
+        }
+
+        _writer.clear();
+        CSnapshotCodec::encode(_current, baseline, _writer, client.history.slot(_tick));
+        _socket.send(client.port, _writer.data(), _writer.size());
+
+        client.bytesSent += _writer.size();
+        _statsSnapshots++;
+    }
+}
+
+// entities around the client ship, nearest first up to NET_MAX_ENTITIES
+// asteroids are looked up in the spatial index so the cost does not grow with the world population
+void NetServer::buildSnapshot(int slot, NetSnapshot& snapshot)
+{
+    const SimShip& ship = _world.getShip(slot);
+    const Point center = ship.pos;
+    const int halfWidth = AsteroidConstants::SCREEN_WIDTH/2 + AsteroidConstants::NET_INTEREST_MARGIN;
+    const int halfHeight = AsteroidConstants::SCREEN_HEIGHT/2 + AsteroidConstants::NET_INTEREST_MARGIN;
+
+    snapshot.tick = _tick;
+    snapshot.ship = slot;
+    snapshot.shipAlive = ship.alive;
+    snapshot.level = _world.getLevel();
+    snapshot.color = static_cast<std::uint8_t>(_world.getColor());
+    snapshot.shipScore = ship.score;
+    snapshot.totalScore = _world.getScore();
+
+    _candidates.clear();
+    auto addCandidate = [&](const Point& pos, const NetEntity& entity){
+        double dx = wrapDelta(pos.x - center.x, AsteroidConstants::WORLD_WIDTH);
+        double dy = wrapDelta(pos.y - center.y, AsteroidConstants::WORLD_HEIGHT);
+        if(std::abs(dx) <= halfWidth && std::abs(dy) <= halfHeight){
+            _candidates.emplace_back(static_cast<int>(dx*dx + dy*dy), entity);
+        }
+    };
+
+    const std::vector<SimShip>& ships = _world.getShips();
+    for(int i = 0; i < static_cast<int>(ships.size()); i++){
+        if(ships[i].alive){
+            addCandidate(ships[i].pos, CSnapshotCodec::quantize(i, NetEntityType::SHIP, i, ships[i].pos, ships[i].velX, ships[i].velY, ships[i].rotation));
+        }
+    }
+
+    const std::vector<SimAsteroid>& asteroids = _world.getAsteroids();
+    SDL_Rect interest{static_cast<int>(center.x) - halfWidth, static_cast<int>(center.y) - halfHeight, 2*halfWidth, 2*halfHeight};
+    _queryResult.clear();
+    _world.queryAsteroids(interest, _queryResult);
+    for(int idx: _queryResult){
+        const SimAsteroid& asteroid = asteroids[idx];
+        addCandidate(asteroid.pos, CSnapshotCodec::quantize(asteroid.id + AsteroidConstants::NET_MAX_CLIENTS, NetEntityType::ASTEROID,
+                                                            static_cast<std::uint8_t>(asteroid.size), asteroid.pos, asteroid.velX, asteroid.velY, 0));
+    }
+
+    for(const SimLaser& laser: _world.getLasers()){
+        double rotation = std::atan2(laser.velY, laser.velX) / AsteroidConstants::PI * 180 + 90;
+        if(rotation < 0) rotation += 360;
+        addCandidate(laser.pos, CSnapshotCodec::quantize(laser.id + AsteroidConstants::NET_MAX_CLIENTS, NetEntityType::LASER,
+                                                         static_cast<std::uint8_t>(laser.owner), laser.pos, laser.velX, laser.velY, rotation));
+    }
+
+    // keep the nearest entities so the snapshot size does not depend on how crowded the area is
+    auto byDistance = [](const std::pair<int, NetEntity>& a, const std::pair<int, NetEntity>& b){ return a.first < b.first;};
+    if(static_cast<int>(_candidates.size()) > AsteroidConstants::NET_MAX_ENTITIES){
+        std::nth_element(_candidates.begin(), _candidates.begin() + AsteroidConstants::NET_MAX_ENTITIES, _candidates.end(), byDistance);
+        _candidates.resize(AsteroidConstants::NET_MAX_ENTITIES);
+    }
+
+    snapshot.entities.clear();
+    for(const auto& candidate: _candidates){
+        snapshot.entities.push_back(candidate.second);
+    }
+    std::sort(snapshot.entities.begin(), snapshot.entities.end(), [](const NetEntity& a, const NetEntity& b){ return a.id < b.id;});
+}
+
+void NetServer::printStats()
+{
+    Clock::time_point now = Clock::now();
+    double seconds = std::chrono::duration<double>(now - _statsStart).count();
+
+    int numClients = 0;
+    std::uint64_t bytes = 0;
+    for(ClientSlot& client: _clients){
+        if(client.connected){
+            numClients++;
+            bytes += client.bytesSent;
+        }
+        client.bytesSent = 0;
+    }
+
+    double tickUs = _statsTicks ? std::chrono::duration<double, std::micro>(_statsTickTime).count() / _statsTicks : 0;
+    std::cout << "Server: level " << _world.getLevel() << ", " << _world.getAsteroids().size() << " asteroids, " << numClients << " clients, "
+              << "tick " << tickUs << " us";
+    if(numClients > 0 && _statsSnapshots > 0){
+        std::cout << ", " << bytes / _statsSnapshots << " bytes/snapshot, " << bytes * 8 / 1000 / seconds / numClients << " kbit/s per client";
+    }
+    std::cout << "\n";
+
+    _statsStart = now;
+    _statsTicks = 0;
+    _statsSnapshots = 0;
+    _statsTickTime = Clock::duration(0);
+}
+
+// slot of the client at port, -1 if unknown
+int NetServer::findSlot(std::uint16_t port) const
+{
+    for(int i = 0; i < static_cast<int>(_clients.size()); i++){
+        if(_clients[i].connected && _clients[i].port == port) return i;
+    }
+    return -1;
+}
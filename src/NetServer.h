@@ -0,0 +1,78 @@
+/* File:            NetServer.h
+ * Author:          Vish Potnis
+ * Description:     - Headless authoritative multiplayer server on the loopback interface
+ *                  - Owns the simulation (SimWorld) with one ship per connected client
+ *                  - Sends every client a delta compressed snapshot of the entities near its ship at a fixed tick
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+#include "CUdpSocket.h"
+#include "NetProtocol.h"
+#include "SimWorld.h"
+
+class NetServer
+{
+    public:
+        NetServer(std::uint16_t port, int startLevel);
+
+        bool isOpen() const;
+        void run();                         // run the simulation until stop is called
+        void stop();                        // safe to call from a signal handler or another thread
+
+    private:
+
+        using Clock = std::chrono::steady_clock;
+
+        // connection state of one ship slot
+        struct ClientSlot
+        {
+            bool connected{false};
+            std::uint16_t port{0};
+            Clock::time_point lastHeard;
+            SimControls controls{};             // latest control flags, held until the next input
+            std::uint8_t shotCounter{0};        // last shot counter received from the client
+            int pendingShots{0};                // shots received but not fired yet, one is fired per step
+            std::uint32_t ackTick{0};           // newest snapshot the client decoded
+            CSnapshotHistory history;           // snapshots as the client decodes them, used as baselines
+            std::uint64_t bytesSent{0};         // since the last statistics print
+        };
+
+        void receivePackets();                          // handle hello, input and bye packets
+        void handleHello(std::uint16_t port, CNetReader& reader);
+        void handleInput(ClientSlot& client, CNetReader& reader);
+        void disconnect(int slot);
+        void checkTimeouts();
+
+        void stepSimulation();                          // apply client input and advance the world by one step
+        void sendSnapshots();                           // send a snapshot of the entities near each client ship
+        void buildSnapshot(int slot, NetSnapshot& snapshot);   // entities around the client ship, nearest first up to NET_MAX_ENTITIES
+        void printStats();
+
+        int findSlot(std::uint16_t port) const;         // slot of the client at port, -1 if unknown
+
+        CUdpSocket _socket;
+        SimWorld _world;
+        std::vector<ClientSlot> _clients;
+        std::uint32_t _tick;                            // simulation steps since start, snapshots are tagged with it
+        std::atomic<bool> _running;
+
+        // scratch buffers reused every tick
+        CNetWriter _writer;
+        NetSnapshot _current;
+        std::vector<int> _queryResult;
+        std::vector<std::pair<int, NetEntity>> _candidates;     // squared distance in pixels and entity
+        std::vector<std::uint8_t> _receiveBuffer;
+
+        // statistics since the last print
+        Clock::time_point _statsStart;
+        std::uint64_t _statsTicks;
+        std::uint64_t _statsSnapshots;
+        Clock::duration _statsTickTime;
+};
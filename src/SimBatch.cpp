@@ -0,0 +1,148 @@
+/* File:            SimBatch.cpp
+ * Author:          Vish Potnis
+ * Description:     - Steps many independent SimWorld instances in lockstep across a pool of threads
+ *                  - Controls are passed in as an array, one entry per world
+ *                  - Observations, scores, levels and done flags are returned in contiguous buffers indexed by world
+ */
+
+#include "SimBatch.h"
+
+#include <algorithm>
+
+SimBatch::SimBatch(int numWorlds, int numThreads, std::uint64_t seed, const SimParams& params)
+    : _numThreads(std::max(1, std::min(numThreads, numWorlds))), _controls(nullptr), _generation(0), _pending(0), _running(true)
+{
+    // one ship per world, controlled by the matching controls entry
+    SimParams worldParams = params;
+    worldParams.numShips = 1;
+
+    _worlds.reserve(numWorlds);
+    for(int i = 0; i < numWorlds; i++){
+        _worlds.emplace_back(seed + i, worldParams);
+    }
+
+    _observations.resize(numWorlds * SimWorld::OBS_SIZE);
+    _scores.resize(numWorlds);
+    _levels.resize(numWorlds);
+    _done.resize(numWorlds);
+    for(int i = 0; i < numWorlds; i++){
+        writeResults(i);
+    }
+
+    // the calling thread runs the share of worker 0
+    for(int worker = 1; worker < _numThreads; worker++){
+        _workers.emplace_back(&SimBatch::workerLoop, this, worker);
+    }
+}
+
+SimBatch::~SimBatch()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _startStep.notify_all();
+
+    for(auto& worker: _workers){
+        worker.join();
+    }
+}
+
+// start a new session in every world
+void SimBatch::reset(int level)
+{
+    for(int i = 0; i < getNumWorlds(); i++){
+        reset(i, level);
+    }
+}
+
+// start a new session in one world
+void SimBatch::reset(int index, int level)
+{
+    _worlds[index].reset(level);
+    writeResults(index);
+}
+
+// start a new session in every world that is done
+void SimBatch::resetDone(int level)
+{
+    for(int i = 0; i < getNumWorlds(); i++){
+        if(_done[i]){
+            reset(i, level);
+        }
+    }
+}
+
+// advance every world by one step with controls[world], blocks until all worlds are done
+void SimBatch::step(const SimControls* controls)
+{
+    _controls = controls;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending = _numThreads - 1;
+        _generation++;
+    }
+    _startStep.notify_all();
+
+    runRange(0);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finishStep.wait(lock, [this]{ return _pending == 0;});
+}
+
+// getters
+const float* SimBatch::getObservations() const { return _observations.data();}
+const int* SimBatch::getScores() const { return _scores.data();}
+const int* SimBatch::getLevels() const { return _levels.data();}
+const Uint8* SimBatch::getDone() const { return _done.data();}
+int SimBatch::getNumWorlds() const { return _worlds.size();}
+int SimBatch::getNumThreads() const { return _numThreads;}
+const SimWorld& SimBatch::getWorld(int index) const { return _worlds[index];}
+
+// wait for a step and run this worker's share of worlds
+void SimBatch::workerLoop(int worker)
+{
+    std::uint64_t generation = 0;
+
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _startStep.wait(lock, [this, generation]{ return !_running || _generation != generation;});
+            if(!_running) return;
+            generation = _generation;
+        }
+
+        runRange(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending--;
+        }
+        _finishStep.notify_one();
+    }
+}
+
+// step worlds assigned to worker and write their results
+// every worker owns a contiguous block of worlds so output buffers are written without sharing
+void SimBatch::runRange(int worker)
+{
+    int numWorlds = getNumWorlds();
+    int first = static_cast<long long>(numWorlds) * worker / _numThreads;
+    int last = static_cast<long long>(numWorlds) * (worker + 1) / _numThreads;
+
+    for(int i = first; i < last; i++){
+        _worlds[i].step(&_controls[i]);
+        writeResults(i);
+    }
+}
+
+// copy observation, score, level and done flag of one world
+void SimBatch::writeResults(int index)
+{
+    const SimWorld& world = _worlds[index];
+    world.writeObservation(&_observations[index * SimWorld::OBS_SIZE]);
+    _scores[index] = world.getScore();
+    _levels[index] = world.getLevel();
+    _done[index] = world.isDone();
+}
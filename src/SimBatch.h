@@ -0,0 +1,71 @@
+/* File:            SimBatch.h
+ * Author:          Vish Potnis
+ * Description:     - Steps many independent SimWorld instances in lockstep across a pool of threads
+ *                  - Controls are passed in as an array, one entry per world
+ *                  - Observations, scores, levels and done flags are returned in contiguous buffers indexed by world
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SimWorld.h"
+
+class SimBatch
+{
+    public:
+        // world i is seeded with seed + i, results do not depend on the number of threads
+        SimBatch(int numWorlds, int numThreads, std::uint64_t seed, const SimParams& params = SimParams());
+        ~SimBatch();
+
+        SimBatch(const SimBatch&) = delete;
+        SimBatch& operator=(const SimBatch&) = delete;
+
+        void reset(int level = 1);                  // start a new session in every world
+        void reset(int index, int level);           // start a new session in one world
+        void resetDone(int level = 1);              // start a new session in every world that is done
+
+        void step(const SimControls* controls);     // advance every world by one step with controls[world], blocks until all worlds are done
+
+        // buffers are valid until the next step or reset
+        const float* getObservations() const;       // getNumWorlds() * SimWorld::OBS_SIZE floats
+        const int* getScores() const;
+        const int* getLevels() const;
+        const Uint8* getDone() const;
+
+        int getNumWorlds() const;
+        int getNumThreads() const;
+        const SimWorld& getWorld(int index) const;
+
+    private:
+
+        void workerLoop(int worker);                // wait for a step and run this worker's share of worlds
+        void runRange(int worker);                  // step worlds assigned to worker and write their results
+        void writeResults(int index);               // copy observation, score, level and done flag of one world
+
+        std::vector<SimWorld> _worlds;
+        int _numThreads;                            // worker threads plus the calling thread
+
+        const SimControls* _controls;               // controls of the step in progress
+
+        // output buffers indexed by world
+        std::vector<float> _observations;
+        std::vector<int> _scores;
+        std::vector<int> _levels;
+        std::vector<Uint8> _done;
+
+        // worker synchronization, every step bumps the generation and waits for all workers to finish
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+        std::condition_variable _startStep;
+        std::condition_variable _finishStep;
+        std::uint64_t _generation;
+        int _pending;                               // workers still running the current step
+        bool _running;
+};
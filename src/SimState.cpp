@@ -0,0 +1,239 @@
+/* File:            SimState.cpp
+ * Author:          Vish Potnis
+ * Description:     - Entity records of the simulation and a flat save state holding all of them
+ *                  - The save state is trivially copyable, saving and restoring a frame is a copy of the used entries
+ *                  - Written to disk in a compact versioned binary format
+ */
+
+#include "SimState.h"
+#include "NetProtocol.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // first bytes of every save file
+    constexpr std::uint32_t SAVESTATE_MAGIC{0x56415341};    // "ASAV"
+
+    // doubles are stored bit exact so a loaded state resimulates the same way
+    void writeDouble(CNetWriter& writer, double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writer.writeU64(bits);
+    }
+
+    double readDouble(CNetReader& reader)
+    {
+        std::uint64_t bits = reader.readU64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void writePoint(CNetWriter& writer, const Point& pos)
+    {
+        writeDouble(writer, pos.x);
+        writeDouble(writer, pos.y);
+    }
+
+    Point readPoint(CNetReader& reader)
+    {
+        double x = readDouble(reader);
+        return Point{x, readDouble(reader)};
+    }
+}
+
+// empty state, no entities
+void SimState::clear()
+{
+    level = 1;
+    color = AsteroidColor::GREY;
+    done = false;
+    time = 0;
+    stepCount = 0;
+    nextID = 0;
+    rng.seed(0);
+    numShips = 0;
+    numAsteroids = 0;
+    numLasers = 0;
+    numExplosions = 0;
+}
+
+// write the used entries to a save file
+// layout: magic, version, header, entity counts, then each entity field by field in little endian order
+bool SimState::saveToFile(const std::string& path) const
+{
+    CNetWriter writer;
+    writer.writeU32(SAVESTATE_MAGIC);
+    writer.writeU16(AsteroidConstants::SAVESTATE_VERSION);
+
+    writer.writeU32(level);
+    writer.writeU8(static_cast<std::uint8_t>(color));
+    writer.writeU8(done);
+    writer.writeU32(time);
+    writer.writeU32(stepCount);
+    writer.writeU32(nextID);
+    writer.writeU64(rng.getState());
+    writer.writeU64(rng.getIncrement());
+
+    writer.writeU8(numShips);
+    writer.writeU16(numAsteroids);
+    writer.writeU16(numLasers);
+    writer.writeU16(numExplosions);
+
+    for(int i = 0; i < numShips; i++){
+        const SimShip& ship = ships[i];
+        writePoint(writer, ship.pos);
+        writeDouble(writer, ship.velX);
+        writeDouble(writer, ship.velY);
+        writeDouble(writer, ship.rotation);
+        writer.writeU8(ship.active | (ship.alive << 1));
+        writer.writeU32(ship.respawnTime);
+        writer.writeU32(ship.score);
+    }
+    for(int i = 0; i < numAsteroids; i++){
+        const SimAsteroid& asteroid = asteroids[i];
+        writer.writeU32(asteroid.id);
+        writePoint(writer, asteroid.pos);
+        writeDouble(writer, asteroid.velX);
+        writeDouble(writer, asteroid.velY);
+        writer.writeU8(static_cast<std::uint8_t>(asteroid.size));
+    }
+    for(int i = 0; i < numLasers; i++){
+        const SimLaser& laser = lasers[i];
+        writer.writeU32(laser.id);
+        writePoint(writer, laser.pos);
+        writeDouble(writer, laser.velX);
+        writeDouble(writer, laser.velY);
+        writer.writeU32(laser.expireTime);
+        writer.writeU8(laser.owner);
+    }
+    for(int i = 0; i < numExplosions; i++){
+        const SimExplosion& explosion = explosions[i];
+        writePoint(writer, explosion.pos);
+        writer.writeU8(static_cast<std::uint8_t>(explosion.size));
+        writer.writeU32(explosion.startTime);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if(!out){
+        std::cout << "Unable to open save file " << path << "!\n";
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(writer.data()), writer.size());
+    if(!out){
+        std::cout << "Unable to write save file " << path << "!\n";
+        return false;
+    }
+    return true;
+}
+
+// read a save file, false if it is missing, corrupt or from another version
+// the state is only changed if the whole file could be read
+bool SimState::loadFromFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if(!in){
+        std::cout << "Unable to open save file " << path << "!\n";
+        return false;
+    }
+    std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    CNetReader reader(data.data(), data.size());
+    if(reader.readU32() != SAVESTATE_MAGIC){
+        std::cout << path << " is not a save file!\n";
+        return false;
+    }
+    std::uint16_t version = reader.readU16();
+    if(version != AsteroidConstants::SAVESTATE_VERSION){
+        std::cout << "Save file " << path << " has version " << version << ", expected " << AsteroidConstants::SAVESTATE_VERSION << "!\n";
+        return false;
+    }
+
+    int fileLevel = static_cast<int>(reader.readU32());
+    std::uint8_t fileColor = reader.readU8();
+    bool fileDone = reader.readU8() != 0;
+    Uint32 fileTime = reader.readU32();
+    int fileStepCount = static_cast<int>(reader.readU32());
+    int fileNextID = static_cast<int>(reader.readU32());
+    std::uint64_t rngState = reader.readU64();
+    std::uint64_t rngIncrement = reader.readU64();
+
+    int fileShips = reader.readU8();
+    int fileAsteroids = reader.readU16();
+    int fileLasers = reader.readU16();
+    int fileExplosions = reader.readU16();
+    if(!reader.ok() || fileColor > static_cast<std::uint8_t>(AsteroidColor::BROWN) ||
+       fileShips > AsteroidConstants::SIM_MAX_SHIPS || fileAsteroids > AsteroidConstants::SIM_MAX_ASTEROIDS ||
+       fileLasers > AsteroidConstants::SIM_MAX_LASERS || fileExplosions > AsteroidConstants::SIM_MAX_EXPLOSIONS){
+        std::cout << "Save file " << path << " is corrupt!\n";
+        return false;
+    }
+
+    // entities are read into a scratch state first so a corrupt file leaves this state untouched
+    std::unique_ptr<SimState> pLoaded = std::make_unique<SimState>();
+    SimState& loaded = *pLoaded;
+    for(int i = 0; i < fileShips; i++){
+        SimShip& ship = loaded.ships[i];
+        ship.pos = readPoint(reader);
+        ship.velX = readDouble(reader);
+        ship.velY = readDouble(reader);
+        ship.rotation = readDouble(reader);
+        std::uint8_t flags = reader.readU8();
+        ship.active = flags & 1;
+        ship.alive = (flags >> 1) & 1;
+        ship.respawnTime = reader.readU32();
+        ship.score = static_cast<int>(reader.readU32());
+    }
+    for(int i = 0; i < fileAsteroids; i++){
+        SimAsteroid& asteroid = loaded.asteroids[i];
+        asteroid.id = static_cast<int>(reader.readU32());
+        asteroid.pos = readPoint(reader);
+        asteroid.velX = readDouble(reader);
+        asteroid.velY = readDouble(reader);
+        asteroid.size = static_cast<AsteroidSize>(std::min<std::uint8_t>(reader.readU8(), static_cast<std::uint8_t>(AsteroidSize::SMALL)));
+    }
+    for(int i = 0; i < fileLasers; i++){
+        SimLaser& laser = loaded.lasers[i];
+        laser.id = static_cast<int>(reader.readU32());
+        laser.pos = readPoint(reader);
+        laser.velX = readDouble(reader);
+        laser.velY = readDouble(reader);
+        laser.expireTime = reader.readU32();
+        laser.owner = std::min<int>(reader.readU8(), std::max(fileShips - 1, 0));
+    }
+    for(int i = 0; i < fileExplosions; i++){
+        SimExplosion& explosion = loaded.explosions[i];
+        explosion.pos = readPoint(reader);
+        explosion.size = static_cast<AsteroidSize>(std::min<std::uint8_t>(reader.readU8(), static_cast<std::uint8_t>(AsteroidSize::SMALL)));
+        explosion.startTime = reader.readU32();
+    }
+    if(!reader.ok()){
+        std::cout << "Save file " << path << " is truncated!\n";
+        return false;
+    }
+
+    level = fileLevel;
+    color = static_cast<AsteroidColor>(fileColor);
+    done = fileDone;
+    time = fileTime;
+    stepCount = fileStepCount;
+    nextID = fileNextID;
+    rng.setState(rngState, rngIncrement);
+    numShips = fileShips;
+    numAsteroids = fileAsteroids;
+    numLasers = fileLasers;
+    numExplosions = fileExplosions;
+    std::copy(loaded.ships, loaded.ships + numShips, ships);
+    std::copy(loaded.asteroids, loaded.asteroids + numAsteroids, asteroids);
+    std::copy(loaded.lasers, loaded.lasers + numLasers, lasers);
+    std::copy(loaded.explosions, loaded.explosions + numExplosions, explosions);
+    return true;
+}
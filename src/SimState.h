@@ -0,0 +1,85 @@
+/* File:            SimState.h
+ * Author:          Vish Potnis
+ * Description:     - Entity records of the simulation and a flat save state holding all of them
+ *                  - The save state is trivially copyable, saving and restoring a frame is a copy of the used entries
+ *                  - Written to disk in a compact versioned binary format
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "constants.h"
+#include "utility.h"
+#include "CRandom.h"
+
+struct SimShip
+{
+    Point pos;
+    double velX;
+    double velY;
+    double rotation;        // degrees, 0 is facing up
+    bool active;            // slot is in use, inactive ships are not simulated
+    bool alive;             // false after crashing into an asteroid
+    Uint32 respawnTime;     // simulation time in ms when a crashed ship respawns
+    int score;              // score of asteroids destroyed by this ship's lasers
+};
+
+struct SimAsteroid
+{
+    int id;
+    Point pos;
+    double velX;
+    double velY;
+    AsteroidSize size;
+};
+
+struct SimLaser
+{
+    int id;
+    Point pos;
+    double velX;
+    double velY;
+    Uint32 expireTime;      // simulation time in ms when the laser is removed
+    int owner;              // index of the ship that fired the laser
+};
+
+// explosion animation, only kept by the game
+struct SimExplosion
+{
+    Point pos;
+    AsteroidSize size;
+    Uint32 startTime;       // time in ms the animation started
+};
+
+// complete state of one frame, times of lasers and explosions are on the same clock as time
+struct SimState
+{
+    int level;
+    AsteroidColor color;
+    bool done;
+    Uint32 time;            // simulation time in ms, or the game clock when the state was captured
+    int stepCount;
+    int nextID;
+    CRandom rng;
+
+    int numShips;
+    int numAsteroids;
+    int numLasers;
+    int numExplosions;
+    SimShip ships[AsteroidConstants::SIM_MAX_SHIPS];
+    SimAsteroid asteroids[AsteroidConstants::SIM_MAX_ASTEROIDS];
+    SimLaser lasers[AsteroidConstants::SIM_MAX_LASERS];
+    SimExplosion explosions[AsteroidConstants::SIM_MAX_EXPLOSIONS];
+
+    void clear();                                       // empty state, no entities
+
+    bool saveToFile(const std::string& path) const;     // write the used entries to a save file
+    bool loadFromFile(const std::string& path);         // read a save file, false if it is missing, corrupt or from another version
+};
+
+static_assert(std::is_trivially_copyable<SimState>::value, "save states are copied as flat memory");
@@ -0,0 +1,538 @@
+/* File:            SimWorld.cpp
+ * Author:          Vish Potnis
+ * Description:     - Render free simulation of one game session
+ *                  - Holds all game state (ships, lasers, asteroids, score, level, random generator), no globals or SDL calls
+ *                  - Advanced in fixed steps with explicit controls so several worlds can run side by side on different threads
+ */
+
+#include "SimWorld.h"
+#include "CVector.h"
+#include "GameObjectAsteroid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SimWorld::SimWorld(std::uint64_t seed, const SimParams& params)
+    : _params(params), _rng(seed),
+      _asteroidGrid(AsteroidConstants::WORLD_WIDTH, AsteroidConstants::WORLD_HEIGHT, AsteroidConstants::GRID_CELL_SIZE),
+      _physics(AsteroidConstants::WORLD_WIDTH, AsteroidConstants::WORLD_HEIGHT)
+{
+    _params.numShips = std::max(_params.numShips, 1);
+    _ships.resize(_params.numShips);
+    for(SimShip& ship: _ships){
+        ship.active = true;
+    }
+    reset();
+}
+
+// start a new session at level
+void SimWorld::reset(int level)
+{
+    _level = level;
+    _color = AsteroidColor::GREY;
+    _done = false;
+    _time = 0;
+    _stepCount = 0;
+    _nextID = 0;
+
+    for(SimShip& ship: _ships){
+        ship.score = 0;
+    }
+
+    initLevel();
+}
+
+// advance the simulation by one fixed step with one controls entry per ship, same order as AsteroidGame::runLevel
+void SimWorld::step(const SimControls* controls)
+{
+    if(_done) return;
+
+    _time += AsteroidConstants::SIM_TICK_MS;
+    _stepCount++;
+
+    // input is handled before objects are updated, the laser starts at the current ship position
+    for(int i = 0; i < static_cast<int>(_ships.size()); i++){
+        SimShip& ship = _ships[i];
+        if(!ship.active) continue;
+
+        if(!ship.alive){
+            if(_params.respawnMs > 0 && _time >= ship.respawnTime){
+                spawnShip(ship);
+            }
+            continue;
+        }
+        if(controls[i].shoot){
+            shootLaser(i);
+        }
+        updateShip(ship, controls[i]);
+    }
+    updateAsteroids();
+    updateLasers();
+    updateAsteroidGrid();
+
+    checkShipCollision();
+    checkAsteroidCollision();
+    checkDone();
+
+    // level completed, continue with the next level like choosing next in the level menu
+    if(!_done && _asteroids.empty()){
+        _level++;
+        _color = GameObjectAsteroid::getNextColor(_color);
+        initLevel();
+    }
+
+    if(_params.maxSteps > 0 && _stepCount >= _params.maxSteps){
+        _done = true;
+    }
+}
+
+// add or remove a ship during the session, added ships spawn away from asteroids
+void SimWorld::setShipActive(int ship, bool active)
+{
+    SimShip& s = _ships[ship];
+    if(s.active == active) return;
+
+    s.active = active;
+    s.score = 0;
+    if(active){
+        spawnShip(s);
+    }
+    else{
+        s.alive = false;
+    }
+}
+
+// copy the complete world state, false if it does not fit in a save state
+bool SimWorld::saveState(SimState& state) const
+{
+    if(_ships.size() > AsteroidConstants::SIM_MAX_SHIPS || _asteroids.size() > AsteroidConstants::SIM_MAX_ASTEROIDS ||
+       _lasers.size() > AsteroidConstants::SIM_MAX_LASERS){
+        return false;
+    }
+
+    state.level = _level;
+    state.color = _color;
+    state.done = _done;
+    state.time = _time;
+    state.stepCount = _stepCount;
+    state.nextID = _nextID;
+    state.rng = _rng;
+
+    state.numShips = _ships.size();
+    state.numAsteroids = _asteroids.size();
+    state.numLasers = _lasers.size();
+    state.numExplosions = 0;
+    std::copy(_ships.begin(), _ships.end(), state.ships);
+    std::copy(_asteroids.begin(), _asteroids.end(), state.asteroids);
+    std::copy(_lasers.begin(), _lasers.end(), state.lasers);
+    return true;
+}
+
+// continue from a saved state, false if it has a different number of ships
+// stepping the restored world with the same controls gives the same frames as the world it was saved from
+bool SimWorld::loadState(const SimState& state)
+{
+    if(state.numShips != static_cast<int>(_ships.size())) return false;
+
+    _level = state.level;
+    _color = state.color;
+    _done = state.done;
+    _time = state.time;
+    _stepCount = state.stepCount;
+    _nextID = state.nextID;
+    _rng = state.rng;
+
+    _ships.assign(state.ships, state.ships + state.numShips);
+    _asteroids.assign(state.asteroids, state.asteroids + state.numAsteroids);
+    _lasers.assign(state.lasers, state.lasers + state.numLasers);
+
+    updateAsteroidGrid();
+    return true;
+}
+
+// write OBS_SIZE floats seen from ship, nearest asteroids first
+void SimWorld::writeObservation(float* out, int ship) const
+{
+    const SimShip& observer = _ships[ship];
+
+    out[0] = observer.pos.x;
+    out[1] = observer.pos.y;
+    out[2] = observer.velX;
+    out[3] = observer.velY;
+    out[4] = observer.rotation;
+
+    // order asteroids by distance to the ship across the world wrap, only the closest ones are sorted
+    _nearest.clear();
+    for(int i = 0; i < static_cast<int>(_asteroids.size()); i++){
+        double dx = wrapDelta(_asteroids[i].pos.x - observer.pos.x, AsteroidConstants::WORLD_WIDTH);
+        double dy = wrapDelta(_asteroids[i].pos.y - observer.pos.y, AsteroidConstants::WORLD_HEIGHT);
+        _nearest.emplace_back(dx*dx + dy*dy, i);
+    }
+    int numObserved = std::min(static_cast<int>(_nearest.size()), AsteroidConstants::SIM_OBS_ASTEROIDS);
+    std::partial_sort(_nearest.begin(), _nearest.begin() + numObserved, _nearest.end());
+
+    float* slot = out + OBS_SHIP_SIZE;
+    for(int i = 0; i < AsteroidConstants::SIM_OBS_ASTEROIDS; i++, slot += OBS_ASTEROID_SIZE){
+        if(i >= numObserved){
+            std::fill(slot, slot + OBS_ASTEROID_SIZE, 0.0f);
+            continue;
+        }
+        const SimAsteroid& asteroid = _asteroids[_nearest[i].second];
+        slot[0] = wrapDelta(asteroid.pos.x - observer.pos.x, AsteroidConstants::WORLD_WIDTH);
+        slot[1] = wrapDelta(asteroid.pos.y - observer.pos.y, AsteroidConstants::WORLD_HEIGHT);
+        slot[2] = asteroid.velX;
+        slot[3] = asteroid.velY;
+        slot[4] = std::max(getAsteroidWidth(asteroid.size), getAsteroidHeight(asteroid.size)) / 2.0f;
+    }
+}
+
+// append indices into getAsteroids() of asteroids that may overlap the world rectangle
+void SimWorld::queryAsteroids(const SDL_Rect& rect, std::vector<int>& result) const
+{
+    _asteroidGrid.query(rect, result);
+}
+
+// getters
+bool SimWorld::isDone() const { return _done;}
+int SimWorld::getLevel() const { return _level;}
+AsteroidColor SimWorld::getColor() const { return _color;}
+Uint32 SimWorld::getTime() const { return _time;}
+int SimWorld::getStepCount() const { return _stepCount;}
+const SimShip& SimWorld::getShip(int ship) const { return _ships[ship];}
+const std::vector<SimShip>& SimWorld::getShips() const { return _ships;}
+const std::vector<SimAsteroid>& SimWorld::getAsteroids() const { return _asteroids;}
+const std::vector<SimLaser>& SimWorld::getLasers() const { return _lasers;}
+
+int SimWorld::getScore() const
+{
+    int score = 0;
+    for(const SimShip& ship: _ships){
+        score += ship.score;
+    }
+    return score;
+}
+
+// collision size of an asteroid based on size
+int SimWorld::getAsteroidWidth(AsteroidSize size)
+{
+    switch(size){
+        case AsteroidSize::BIG:     return AsteroidConstants::SIM_ASTEROID_BIG_W;
+        case AsteroidSize::MED:     return AsteroidConstants::SIM_ASTEROID_MED_W;
+        case AsteroidSize::SMALL:   return AsteroidConstants::SIM_ASTEROID_SMALL_W;
+    }
+    return AsteroidConstants::SIM_ASTEROID_SMALL_W;
+}
+
+int SimWorld::getAsteroidHeight(AsteroidSize size)
+{
+    switch(size){
+        case AsteroidSize::BIG:     return AsteroidConstants::SIM_ASTEROID_BIG_H;
+        case AsteroidSize::MED:     return AsteroidConstants::SIM_ASTEROID_MED_H;
+        case AsteroidSize::SMALL:   return AsteroidConstants::SIM_ASTEROID_SMALL_H;
+    }
+    return AsteroidConstants::SIM_ASTEROID_SMALL_H;
+}
+
+// spawn asteroids for the current level around the ships, same as AsteroidGame::initLevel
+// active ships start next to each other in the center of the world
+void SimWorld::initLevel()
+{
+    _asteroids.clear();
+    _lasers.clear();
+
+    double startX = AsteroidConstants::WORLD_WIDTH/2 - (_ships.size() - 1) * AsteroidConstants::SIM_SHIP_SPACING / 2.0;
+    for(int i = 0; i < static_cast<int>(_ships.size()); i++){
+        SimShip& ship = _ships[i];
+        ship.pos = Point{startX + i * AsteroidConstants::SIM_SHIP_SPACING, AsteroidConstants::WORLD_HEIGHT/2};
+        ship.velX = 0;
+        ship.velY = 0;
+        ship.rotation = 0;
+        ship.alive = ship.active;
+        ship.respawnTime = 0;
+    }
+
+    int screensPerWorld = (AsteroidConstants::WORLD_WIDTH * AsteroidConstants::WORLD_HEIGHT) / (AsteroidConstants::SCREEN_WIDTH * AsteroidConstants::SCREEN_HEIGHT);
+    int numAsteroid = _level * _params.asteroidsPerScreen * std::max(screensPerWorld, 1);
+
+    double asteroidVelocity = _params.initAsteroidVelocity * std::pow(_params.asteroidVelocityMultiplier, _level-1);
+
+    std::uniform_int_distribution<> randomAngle(0, 360);
+
+    for(int i = 0; i < numAsteroid; i++){
+        CVector velocity{asteroidVelocity, static_cast<double>(randomAngle(_rng)), VectorType::POLAR};
+        _asteroids.push_back(SimAsteroid{_nextID++, getRandomSpawnPosition(), velocity.getXProjection(), velocity.getYProjection(), AsteroidSize::BIG});
+    }
+    updateAsteroidGrid();
+}
+
+// same movement rules as GameObjectShip::update
+void SimWorld::updateShip(SimShip& ship, const SimControls& controls)
+{
+    if(controls.moveForward || controls.moveBackward){
+        double speed = controls.moveForward ? AsteroidConstants::SHIP_VELOCITY : -AsteroidConstants::SHIP_VELOCITY;
+        CVector velocity{speed, ship.rotation-90, VectorType::POLAR};
+        ship.velX = velocity.getXProjection();
+        ship.velY = velocity.getYProjection();
+    }
+    else{
+        ship.velX = 0;
+        ship.velY = 0;
+    }
+
+    if(static_cast<bool>(controls.rotateLeft) ^ static_cast<bool>(controls.rotateRight)){
+        ship.rotation += controls.rotateLeft ? -AsteroidConstants::SHIP_ROTATION_STEP : AsteroidConstants::SHIP_ROTATION_STEP;
+        if(ship.rotation < 0) ship.rotation += 360;
+        if(ship.rotation >= 360) ship.rotation -= 360;
+    }
+
+    double timeDelta = AsteroidConstants::SIM_TICK_MS / 1000.0;
+    ship.pos.x += ship.velX * timeDelta;
+    ship.pos.y += ship.velY * timeDelta;
+    wrapPosition(ship.pos);
+}
+
+void SimWorld::updateAsteroids()
+{
+    double timeDelta = AsteroidConstants::SIM_TICK_MS / 1000.0;
+    for(SimAsteroid& asteroid: _asteroids){
+        asteroid.pos.x += asteroid.velX * timeDelta;
+        asteroid.pos.y += asteroid.velY * timeDelta;
+        wrapPosition(asteroid.pos);
+    }
+    resolveAsteroidContacts();
+}
+
+// bounce touching asteroids off each other, same contacts as the rendered game
+void SimWorld::resolveAsteroidContacts()
+{
+    _physics.clear();
+    for(const SimAsteroid& asteroid: _asteroids){
+        double radius = (getAsteroidWidth(asteroid.size) + getAsteroidHeight(asteroid.size)) / 4.0;
+        _physics.add(asteroid.pos, asteroid.velX, asteroid.velY, radius, GameObjectAsteroid::getMass(asteroid.size));
+    }
+
+    _physics.solve();
+
+    for(int i = 0; i < _physics.getSize(); i++){
+        if(!_physics.isChanged(i)) continue;
+
+        _asteroids[i].pos = _physics.getPos(i);
+        _asteroids[i].velX = _physics.getVelX(i);
+        _asteroids[i].velY = _physics.getVelY(i);
+    }
+}
+
+// move lasers and remove the ones that are out of range
+void SimWorld::updateLasers()
+{
+    double timeDelta = AsteroidConstants::SIM_TICK_MS / 1000.0;
+    for(SimLaser& laser: _lasers){
+        laser.pos.x += laser.velX * timeDelta;
+        laser.pos.y += laser.velY * timeDelta;
+        wrapPosition(laser.pos);
+    }
+
+    Uint32 now = _time;
+    _lasers.erase(std::remove_if(_lasers.begin(), _lasers.end(), [now](const SimLaser& laser){ return laser.expireTime <= now;}), _lasers.end());
+}
+
+// rebuild spatial index of asteroid positions
+void SimWorld::updateAsteroidGrid()
+{
+    _asteroidGrid.clear();
+    for(int i = 0; i < static_cast<int>(_asteroids.size()); i++){
+        const SimAsteroid& asteroid = _asteroids[i];
+        int halfExtent = std::max(getAsteroidWidth(asteroid.size), getAsteroidHeight(asteroid.size)) / 2;
+        _asteroidGrid.insert(i, asteroid.pos, halfExtent);
+    }
+}
+
+// ships touching an asteroid crash
+void SimWorld::checkShipCollision()
+{
+    for(SimShip& ship: _ships){
+        if(!ship.alive) continue;
+
+        SDL_Rect shipRect{static_cast<int>(ship.pos.x) - AsteroidConstants::SIM_SHIP_W/2, static_cast<int>(ship.pos.y) - AsteroidConstants::SIM_SHIP_H/2,
+                          AsteroidConstants::SIM_SHIP_W, AsteroidConstants::SIM_SHIP_H};
+        _queryResult.clear();
+        _asteroidGrid.query(shipRect, _queryResult);
+
+        for(int idx: _queryResult){
+            const SimAsteroid& asteroid = _asteroids[idx];
+            if(checkOverlap(ship.pos, AsteroidConstants::SIM_SHIP_W, AsteroidConstants::SIM_SHIP_H,
+                            asteroid.pos, getAsteroidWidth(asteroid.size), getAsteroidHeight(asteroid.size))){
+                ship.alive = false;
+                ship.respawnTime = _time + _params.respawnMs;
+                break;
+            }
+        }
+    }
+}
+
+// destroy and split asteroids hit by lasers
+// an asteroid hit by several lasers in the same step is only split and scored once, every laser that hit is spent
+void SimWorld::checkAsteroidCollision()
+{
+    if(_lasers.empty() || _asteroids.empty()) return;
+
+    _destroyed.assign(_asteroids.size(), 0);
+    bool anyDestroyed = false;
+
+    auto isSpent = [this, &anyDestroyed](const SimLaser& laser){
+        SDL_Rect laserRect{static_cast<int>(laser.pos.x) - AsteroidConstants::SIM_LASER_W/2, static_cast<int>(laser.pos.y) - AsteroidConstants::SIM_LASER_H/2,
+                           AsteroidConstants::SIM_LASER_W, AsteroidConstants::SIM_LASER_H};
+        _queryResult.clear();
+        _asteroidGrid.query(laserRect, _queryResult);
+
+        for(int idx: _queryResult){
+            const SimAsteroid& asteroid = _asteroids[idx];
+            if(checkOverlap(laser.pos, AsteroidConstants::SIM_LASER_W, AsteroidConstants::SIM_LASER_H,
+                            asteroid.pos, getAsteroidWidth(asteroid.size), getAsteroidHeight(asteroid.size))){
+                // the first laser to hit an asteroid scores it
+                if(!_destroyed[idx]){
+                    _ships[laser.owner].score += AsteroidConstants::SCORE_PER_ASTEROID;
+                }
+                _destroyed[idx] = 1;
+                anyDestroyed = true;
+                return true;
+            }
+        }
+        return false;
+    };
+    _lasers.erase(std::remove_if(_lasers.begin(), _lasers.end(), isSpent), _lasers.end());
+
+    if(!anyDestroyed) return;
+
+    // split destroyed asteroids and keep the rest in order so runs are reproducible
+    _spawned.clear();
+    int numKept = 0;
+    for(int i = 0; i < static_cast<int>(_asteroids.size()); i++){
+        if(_destroyed[i]){
+            splitAsteroid(_asteroids[i]);
+        }
+        else{
+            _asteroids[numKept++] = _asteroids[i];
+        }
+    }
+    _asteroids.resize(numKept);
+    _asteroids.insert(_asteroids.end(), _spawned.begin(), _spawned.end());
+
+    // indices changed, keep the index valid for queries after the step
+    updateAsteroidGrid();
+}
+
+// session ends when every active ship crashed and there is no respawn
+void SimWorld::checkDone()
+{
+    if(_params.respawnMs > 0) return;
+
+    bool anyActive = false;
+    for(const SimShip& ship: _ships){
+        if(ship.alive) return;
+        anyActive = anyActive || ship.active;
+    }
+    _done = anyActive;
+}
+
+// split asteroid into 2 smaller asteroids at 45 degree angles, same as AsteroidGame::splitAsteroid
+void SimWorld::splitAsteroid(const SimAsteroid& asteroid)
+{
+    if(asteroid.size == AsteroidSize::SMALL) return;
+
+    AsteroidSize nextSize = (asteroid.size == AsteroidSize::BIG) ? AsteroidSize::MED : AsteroidSize::SMALL;
+    CVector currentVelocity{asteroid.velX, asteroid.velY, VectorType::XY};
+
+    CVector velocity1(currentVelocity.getMag(), currentVelocity.getAngle() - 45, VectorType::POLAR);
+    CVector velocity2(currentVelocity.getMag(), currentVelocity.getAngle() + 45, VectorType::POLAR);
+
+    _spawned.push_back(SimAsteroid{_nextID++, asteroid.pos, velocity1.getXProjection(), velocity1.getYProjection(), nextSize});
+    _spawned.push_back(SimAsteroid{_nextID++, asteroid.pos, velocity2.getXProjection(), velocity2.getYProjection(), nextSize});
+}
+
+// fire a laser from the ship in the direction it is facing
+void SimWorld::shootLaser(int ship)
+{
+    const SimShip& s = _ships[ship];
+    CVector velocity{AsteroidConstants::LASER_VELOCITY, s.rotation - 90, VectorType::POLAR};
+    _lasers.push_back(SimLaser{_nextID++, s.pos, velocity.getXProjection(), velocity.getYProjection(),
+                               _time + AsteroidConstants::LASER_LIFETIME_MS, ship});
+}
+
+// place a ship where no asteroid is close, gives up after a few attempts and uses the last position
+void SimWorld::spawnShip(SimShip& ship)
+{
+    std::uniform_real_distribution<> rdX(0, AsteroidConstants::WORLD_WIDTH);
+    std::uniform_real_distribution<> rdY(0, AsteroidConstants::WORLD_HEIGHT);
+
+    for(int attempt = 0; attempt < AsteroidConstants::SIM_SPAWN_ATTEMPTS; attempt++){
+        ship.pos = Point{rdX(_rng), rdY(_rng)};
+
+        int radius = _params.spawnSafeRadius;
+        SDL_Rect safeRect{static_cast<int>(ship.pos.x) - radius, static_cast<int>(ship.pos.y) - radius, 2*radius, 2*radius};
+        _queryResult.clear();
+        _asteroidGrid.query(safeRect, _queryResult);
+        if(_queryResult.empty()) break;
+    }
+
+    ship.velX = 0;
+    ship.velY = 0;
+    ship.rotation = 0;
+    ship.alive = true;
+}
+
+// random position in the world that is not too close to any ship
+// spawnSafeRadius is set by the caller and may cover the whole world, after SPAWN_ATTEMPTS the farthest candidate is used
+Point SimWorld::getRandomSpawnPosition()
+{
+    std::uniform_real_distribution<> rdX(0, AsteroidConstants::WORLD_WIDTH);
+    std::uniform_real_distribution<> rdY(0, AsteroidConstants::WORLD_HEIGHT);
+
+    // distance to the closest active ship across the world wrap
+    auto getShipDistance = [this](const Point& pos){
+        double closest = std::numeric_limits<double>::max();
+        for(const SimShip& ship: _ships){
+            if(ship.active){
+                closest = std::min(closest, std::hypot(wrapDelta(pos.x - ship.pos.x, AsteroidConstants::WORLD_WIDTH),
+                                                       wrapDelta(pos.y - ship.pos.y, AsteroidConstants::WORLD_HEIGHT)));
+            }
+        }
+        return closest;
+    };
+
+    Point best{0, 0};
+    double bestDistance = -1;
+    for(int attempt = 0; attempt < AsteroidConstants::SPAWN_ATTEMPTS; attempt++){
+        Point pos{rdX(_rng), rdY(_rng)};
+        double distance = getShipDistance(pos);
+        if(distance >= _params.spawnSafeRadius) return pos;
+        if(distance > bestDistance){
+            best = pos;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+// overlap test of two centered boxes across the world wrap
+bool SimWorld::checkOverlap(const Point& a, int aw, int ah, const Point& b, int bw, int bh)
+{
+    double dx = std::abs(wrapDelta(a.x - b.x, AsteroidConstants::WORLD_WIDTH));
+    double dy = std::abs(wrapDelta(a.y - b.y, AsteroidConstants::WORLD_HEIGHT));
+    return 2*dx < aw + bw && 2*dy < ah + bh;
+}
+
+// shortest signed distance across the world wrap, in [-worldSize/2, worldSize/2)
+double SimWorld::wrapDelta(double delta, double worldSize)
+{
+    return delta - worldSize * std::floor(delta / worldSize + 0.5);
+}
+
+void SimWorld::wrapPosition(Point& pos)
+{
+    if(pos.x >= AsteroidConstants::WORLD_WIDTH) pos.x -= AsteroidConstants::WORLD_WIDTH;
+    if(pos.x < 0) pos.x += AsteroidConstants::WORLD_WIDTH;
+    if(pos.y >= AsteroidConstants::WORLD_HEIGHT) pos.y -= AsteroidConstants::WORLD_HEIGHT;
+    if(pos.y < 0) pos.y += AsteroidConstants::WORLD_HEIGHT;
+}
@@ -0,0 +1,126 @@
+/* File:            SimWorld.h
+ * Author:          Vish Potnis
+ * Description:     - Render free simulation of one game session
+ *                  - Holds all game state (ships, lasers, asteroids, score, level, random generator), no globals or SDL calls
+ *                  - Advanced in fixed steps with explicit controls so several worlds can run side by side on different threads
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "constants.h"
+#include "utility.h"
+#include "CSpatialGrid.h"
+#include "CAsteroidPhysics.h"
+#include "CRandom.h"
+#include "SimState.h"
+
+// controls applied for one simulation step, same as the ship movement flags and the shoot key
+struct SimControls
+{
+    Uint8 rotateLeft;
+    Uint8 rotateRight;
+    Uint8 moveForward;
+    Uint8 moveBackward;
+    Uint8 shoot;            // fire one laser this step
+};
+
+// difficulty parameters used when a level is initialized
+struct SimParams
+{
+    int asteroidsPerScreen{1};                                                      // asteroids per level for every screen sized area of the world
+    double initAsteroidVelocity{AsteroidConstants::INIT_ASTEROID_VELOCITY};         // asteroid speed on level 1
+    double asteroidVelocityMultiplier{AsteroidConstants::ASTEROID_VELOCITY_MULTIPLIER}; // asteroid speed factor per level
+    int spawnSafeRadius{AsteroidConstants::SPAWN_SAFE_RADIUS};                      // asteroids are not spawned this close to the ship if a free spot is found in SPAWN_ATTEMPTS tries
+    int maxSteps{0};                                                                // session ends after this many steps, 0 for no limit
+    int numShips{1};                                                                // ship slots, each controlled by one SimControls entry
+    int respawnMs{0};                                                               // crashed ships respawn after this time, 0 to end the session instead
+};
+
+class SimWorld
+{
+    public:
+        // floats written per world by writeObservation
+        static constexpr int OBS_SHIP_SIZE{5};          // ship x, y, velocity x, velocity y, rotation
+        static constexpr int OBS_ASTEROID_SIZE{5};      // offset x, y from the ship, velocity x, y, half extent (0 for empty slots)
+        static constexpr int OBS_SIZE{OBS_SHIP_SIZE + OBS_ASTEROID_SIZE * AsteroidConstants::SIM_OBS_ASTEROIDS};
+
+        explicit SimWorld(std::uint64_t seed, const SimParams& params = SimParams());
+
+        void reset(int level = 1);                      // start a new session at level
+        void step(const SimControls* controls);         // advance the simulation by one fixed step with one controls entry per ship, no effect once done
+
+        void setShipActive(int ship, bool active);      // add or remove a ship during the session, added ships spawn away from asteroids
+
+        bool saveState(SimState& state) const;          // copy the complete world state, false if it does not fit in a save state
+        bool loadState(const SimState& state);          // continue from a saved state, false if it has a different number of ships
+
+        void writeObservation(float* out, int ship = 0) const;      // write OBS_SIZE floats seen from ship, nearest asteroids first
+
+        // append indices into getAsteroids() of asteroids that may overlap the world rectangle
+        void queryAsteroids(const SDL_Rect& rect, std::vector<int>& result) const;
+
+        // getters
+        bool isDone() const;
+        int getScore() const;                           // total score of all ships
+        int getLevel() const;
+        AsteroidColor getColor() const;
+        Uint32 getTime() const;
+        int getStepCount() const;
+        const SimShip& getShip(int ship = 0) const;
+        const std::vector<SimShip>& getShips() const;
+        const std::vector<SimAsteroid>& getAsteroids() const;
+        const std::vector<SimLaser>& getLasers() const;
+
+        static int getAsteroidWidth(AsteroidSize size);     // collision size of an asteroid based on size
+        static int getAsteroidHeight(AsteroidSize size);
+        static double wrapDelta(double delta, double worldSize);     // shortest signed distance across the world wrap
+
+    private:
+
+        void initLevel();                           // spawn asteroids for the current level around the ships
+        void updateShip(SimShip& ship, const SimControls& controls);
+        void updateAsteroids();
+        void resolveAsteroidContacts();             // bounce touching asteroids off each other
+        void updateLasers();
+        void updateAsteroidGrid();                  // rebuild spatial index of asteroid positions
+        void checkShipCollision();                  // ships touching an asteroid crash
+        void checkAsteroidCollision();              // destroy and split asteroids hit by lasers
+        void checkDone();                           // session ends when every active ship crashed and there is no respawn
+        void splitAsteroid(const SimAsteroid& asteroid);
+        void shootLaser(int ship);
+        void spawnShip(SimShip& ship);              // place a ship where no asteroid is close
+
+        Point getRandomSpawnPosition();             // random asteroid position away from all ships
+
+        // overlap test of two centered boxes across the world wrap
+        static bool checkOverlap(const Point& a, int aw, int ah, const Point& b, int bw, int bh);
+        static void wrapPosition(Point& pos);
+
+        SimParams _params;
+        CRandom _rng;
+
+        std::vector<SimShip> _ships;
+        std::vector<SimAsteroid> _asteroids;
+        std::vector<SimLaser> _lasers;
+
+        int _level;
+        AsteroidColor _color;       // asteroid color of the current level
+        bool _done;
+        Uint32 _time;               // simulation time in ms
+        int _stepCount;
+        int _nextID;                // IDs are unique per world
+
+        // scratch buffers reused every step
+        CSpatialGrid _asteroidGrid;                 // spatial index of asteroids, IDs are indices into _asteroids
+        std::vector<int> _queryResult;
+        CAsteroidPhysics _physics;                  // asteroid contacts, bodies are indexed like _asteroids
+        std::vector<Uint8> _destroyed;              // asteroids hit this step, indexed like _asteroids
+        std::vector<SimAsteroid> _spawned;          // asteroids split off this step
+        mutable std::vector<std::pair<double, int>> _nearest;   // squared distance and index for observations
+};
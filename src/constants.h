@@ -14,13 +14,42 @@ namespace AsteroidConstants
     constexpr int SCREEN_HEIGHT{600};        
     constexpr double PI{3.14159265};
 
+    // world dimensions, the camera shows a SCREEN_WIDTH x SCREEN_HEIGHT window of the world
+    // the world wraps around at its edges and must be at least as large as the screen
+    constexpr int WORLD_WIDTH{SCREEN_WIDTH*3};
+    constexpr int WORLD_HEIGHT{SCREEN_HEIGHT*3};
+    static_assert(WORLD_WIDTH >= SCREEN_WIDTH && WORLD_HEIGHT >= SCREEN_HEIGHT, "world must be at least as large as the screen");
+
+    // cell size of the spatial grid used for culling and collision queries
+    constexpr int GRID_CELL_SIZE{256};
+
+    // asteroids outside the view are only updated every n-th frame
+    constexpr int OFFVIEW_UPDATE_INTERVAL{4};
+
+    // asteroids are not spawned within this distance of the ship
+    constexpr int SPAWN_SAFE_RADIUS{250};
+    constexpr int SPAWN_ATTEMPTS{64};               // random asteroid positions tried, then the one farthest from the ships is used
+
+    // split screen co-op, each player sees one side of the screen and the ships start this far apart
+    constexpr int MAX_LOCAL_PLAYERS{2};
+    constexpr int COOP_SHIP_SPACING{150};
+
     // init laser and asteroid attributes
     constexpr int INIT_ASTEROID_VELOCITY{100};
     constexpr double ASTEROID_VELOCITY_MULTIPLIER{1.1};
     constexpr int LASER_VELOCITY{500};
 
-    // off screen boundary for deleting laser objects
-    constexpr int OFFSCREEN_BOUNDARY{50};
+    // ship movement
+    constexpr int SHIP_VELOCITY{150};               // speed while moving forward or backward
+    constexpr int SHIP_ROTATION_STEP{5};            // ship direction is always a multiple of this many degrees
+    constexpr double SHIP_TURN_RATE{SHIP_ROTATION_STEP * 1000.0 / TICKS_PER_FRAME};    // degrees per second while turning, one step per frame at the default frame cap
+    static_assert(360 % SHIP_ROTATION_STEP == 0, "ship rotation step must divide a full turn");
+
+    // ship and laser sprites are pre-rotated into an atlas once for every ship orientation
+    constexpr int SPRITE_ROTATIONS{360 / SHIP_ROTATION_STEP};
+
+    // score for each asteroid hit
+    constexpr int SCORE_PER_ASTEROID{10};
 
     // font size
     constexpr int FONTSIZE_TITLE1{100};
@@ -44,6 +73,135 @@ namespace AsteroidConstants
     constexpr int EXPLOSION_SPRITE_WIDTH{64};
     constexpr int EXPLOSION_SPRITE_HEIGHT{64};
     constexpr int EXPLOSION_SPRITE_NUM{25};
+    constexpr int EXPLOSION_FRAME_MS{50};           // time each explosion sprite is shown
+    constexpr int EXPLOSION_MAX{64};                // live explosion animations, further explosions only emit debris
+
+    // lasers are removed after this time, the ship is slower than a laser so any laser has left the view by then
+    constexpr int LASER_LIFETIME_MS{1600};
+
+    // explosion debris particles
+    constexpr int PARTICLE_MAX{100000};             // maximum number of live particles
+    constexpr int PARTICLE_SIZE{3};                 // side length of a particle quad in pixels
+    constexpr double PARTICLE_LIFETIME{0.9};        // maximum lifetime of a particle in seconds
+    constexpr double PARTICLE_SPEED{160};           // maximum burst speed in pixels per second
+    constexpr double PARTICLE_DRAG{0.25};           // fraction of particle velocity left after 1 second
+    constexpr int PARTICLE_BURST_BIG{64};           // particles per burst based on asteroid size
+    constexpr int PARTICLE_BURST_MED{32};
+    constexpr int PARTICLE_BURST_SMALL{16};
+
+    // render free simulation (SimWorld)
+    constexpr int SIM_TICK_MS{TICKS_PER_FRAME};     // fixed simulation step
+    constexpr int SIM_OBS_ASTEROIDS{16};            // nearest asteroids reported in an observation
+    constexpr int SIM_SHIP_SPACING{80};             // horizontal distance between ships at the start of a level
+    constexpr int SIM_SPAWN_ATTEMPTS{32};           // random positions tried when respawning a ship away from asteroids
+    // collision sizes, match the loaded textures and the ship/laser scaling
+    constexpr int SIM_ASTEROID_BIG_W{145};
+    constexpr int SIM_ASTEROID_BIG_H{139};
+    constexpr int SIM_ASTEROID_MED_W{60};
+    constexpr int SIM_ASTEROID_MED_H{55};
+    constexpr int SIM_ASTEROID_SMALL_W{30};
+    constexpr int SIM_ASTEROID_SMALL_H{29};
+    constexpr int SIM_SHIP_W{38};
+    constexpr int SIM_SHIP_H{40};
+    constexpr int SIM_LASER_W{6};
+    constexpr int SIM_LASER_H{17};
+
+    // loopback multiplayer
+    constexpr int NET_DEFAULT_PORT{27960};          // server port when none is given
+    constexpr int NET_MAX_CLIENTS{4};               // ship slots on the server
+    constexpr int NET_SNAPSHOT_INTERVAL{2};         // simulation steps between snapshots sent to each client
+    constexpr int NET_HISTORY{32};                  // snapshots kept per client as possible delta baselines
+    constexpr int NET_MAX_ENTITIES{96};             // entities per snapshot, nearest to the client ship first
+    constexpr int NET_MAX_PACKET{4096};             // receive buffer size, larger than a snapshot with NET_MAX_ENTITIES removed and added
+    constexpr int NET_INTEREST_MARGIN{200};         // entities this far outside the client view are still sent
+    constexpr int NET_POS_SCALE{16};                // quantization steps per pixel for positions
+    constexpr int NET_VEL_SCALE{8};                 // quantization steps per pixel per second for velocities
+    constexpr int NET_POS_TOLERANCE{2};             // dead reckoned positions closer than this (in steps) to the real position are not sent
+    constexpr int NET_INTERP_DELAY_MS{100};         // clients render this far behind the newest snapshot
+    constexpr int NET_TIMEOUT_MS{5000};             // peers that are silent for this long are disconnected
+    constexpr int NET_RESPAWN_MS{2000};             // crashed ships respawn after this time
+    constexpr int NET_STATS_INTERVAL_MS{5000};      // server statistics print interval
+    static_assert(WORLD_WIDTH * NET_POS_SCALE <= 65535 && WORLD_HEIGHT * NET_POS_SCALE <= 65535, "quantized positions must fit in 16 bits");
+
+    // save states (SimState)
+    constexpr int SIM_MAX_SHIPS{4};                 // capacity of a save state, larger worlds can not be saved and are not rewound
+    constexpr int SIM_MAX_ASTEROIDS{1024};
+    constexpr int SIM_MAX_LASERS{256};
+    constexpr int SIM_MAX_EXPLOSIONS{64};
+    constexpr int SAVESTATE_VERSION{1};             // bumped whenever the save file layout changes
+    constexpr int REWIND_FRAMES{90};                // frames kept for rewinding the game
+    constexpr const char* QUICKSAVE_FILE{"quicksave.sav"};
+    static_assert(NET_MAX_CLIENTS <= SIM_MAX_SHIPS, "server worlds must fit in a save state");
+    static_assert(MAX_LOCAL_PLAYERS <= SIM_MAX_SHIPS, "local players must fit in a save state");
+    static_assert(EXPLOSION_MAX <= SIM_MAX_EXPLOSIONS, "live explosions must fit in a save state");
+
+    // autopilot bot (CAutopilot)
+    constexpr int AUTOPILOT_VIEW_RADIUS{600};       // asteroids this close to the ship are considered
+    constexpr int AUTOPILOT_SAFE_GAP{60};           // asteroids closer than this to the ship edge are always evaded
+    constexpr double AUTOPILOT_EVADE_TIME{1.0};     // asteroids reaching the safe gap sooner than this (seconds) are evaded
+    constexpr double AUTOPILOT_AIM_TOLERANCE{4};    // degrees off the lead angle the bot still shoots at
+    constexpr int AUTOPILOT_FIRE_MS{3 * TICKS_PER_FRAME};      // ms between shots, three frames at the default frame cap
+
+    // soak test (CSoakMonitor)
+    constexpr int SOAK_SAMPLE_MS{10000};            // resource sample interval
+    constexpr int SOAK_WARMUP_SAMPLES{6};           // samples not checked while pools and caches fill up
+    constexpr int SOAK_GROWTH_SAMPLES{12};          // a value rising at this many consecutive samples without more live objects fails the run
+    constexpr int SOAK_RSS_GROWTH_KB{4096};         // smallest resident set growth over those samples that counts as a leak
+    constexpr double SOAK_FRAME_DECAY{1.5};         // p95 frame time growth factor over those samples that counts as decay
+    constexpr int SOAK_IDLE_CHECK_MS{200};          // idle time simulated after a frame over the save state caps with --soak-idle-check
+
+    // allocation tracking (CAllocTracker)
+    constexpr int ALLOC_STACK_DEPTH{8};             // return addresses kept per callsite
+    constexpr int ALLOC_CALLSITES{4096};            // distinct callsites tracked, power of two
+    constexpr int ALLOC_REPORT_TOP{20};             // callsites listed in the report
+    constexpr int ALLOC_BUDGET_WARMUP_FRAMES{60};   // frames not checked against the budgets while scratch buffers grow
+    constexpr int ALLOC_BUDGET_INPUT{8};            // allocations allowed per frame and phase with --alloc-budget
+    constexpr int ALLOC_BUDGET_UPDATE{32};          // grid cells and bounding box lists still growing
+    constexpr int ALLOC_BUDGET_RENDER{0};
+    constexpr int ALLOC_BUDGET_EXPIRY{16};
+    constexpr int ALLOC_BUDGET_COLLISION{16};       // event buffer still growing
+    constexpr int ALLOC_BUDGET_EVENTS{64};          // split asteroids, explosions and the score text
+    constexpr int ALLOC_BUDGET_RECORD{0};
+
+    // input latency (CInputLatency)
+    constexpr int INPUT_LATENCY_PENDING{64};        // inputs measured per frame
+    constexpr int INPUT_LATENCY_BUCKETS{100};       // 1 ms histogram buckets, the last one holds longer latencies
+    constexpr int INPUT_LATE_MARGIN_MS{2};          // late input sampling finishes the frame this long before the expected present
+    constexpr int INPUT_QUEUE_SIZE{256};            // input events collected between two frames (CInputQueue)
+
+    // software compositor (CSoftCompositor)
+    constexpr int COMPOSITOR_MAX_THREADS{8};        // row bands composed in parallel, including the main thread
+    constexpr int COMPOSITOR_SPRITE_COMMANDS{4096}; // draw commands reserved up front besides one per particle
+    constexpr int COMPOSITOR_CHECK_INTERVAL{60};    // frames between comparisons with the SDL renderer image with --compositor-check
+    constexpr int COMPOSITOR_CHECK_TOLERANCE{2};    // largest color channel difference to the SDL image that passes the check
+
+    // gameplay capture (CFrameCapture)
+    constexpr int CAPTURE_RING_FRAMES{8};           // frames read back and waiting for the writer, frames are dropped when all are in use
+    constexpr int CAPTURE_MAX_GAP_MS{1000};         // longer gaps between captured frames (menus, pauses) are cut instead of filled with duplicates
+
+    // frame budget governor (CFrameGovernor)
+    constexpr int GOVERNOR_WINDOW_FRAMES{30};       // frames measured before each decision
+    constexpr int GOVERNOR_OVER_PERCENT{90};        // quality is lowered when the 90th percentile work time exceeds this share of the frame budget
+    constexpr int GOVERNOR_UNDER_PERCENT{60};       // quality is raised when it stays below this share of the full rate frame budget
+    constexpr int GOVERNOR_RECOVER_WINDOWS{4};      // windows in a row below the budget before raising quality, doubled after a failed recovery
+    constexpr int GOVERNOR_MAX_RECOVER_WINDOWS{64};
+
+    // asteroid contacts (CAsteroidPhysics)
+    constexpr double CONTACT_RESTITUTION{1.0};      // share of the approach speed kept after a contact, 1 is perfectly elastic
+    constexpr double CONTACT_SLOP{0.5};             // overlap in pixels left in place so resting contacts do not jitter
+    constexpr double CONTACT_CORRECTION{0.8};       // share of the remaining overlap pushed apart per solve
+    constexpr double CONTACT_SLEEP_SPEED{1.0};      // bodies slower than this in pixels per second sleep until an awake body touches them
+
+    // sampling profiler (CProfiler)
+    constexpr int PROFILER_HZ{997};                 // samples per second of game thread CPU time, not a multiple of the frame rate
+    constexpr int PROFILER_STACK_DEPTH{64};         // return addresses kept per sample, deeper stacks are cut at the outer end
+    constexpr int PROFILER_STACKS{8192};            // distinct stacks counted, power of two
 
+    // metrics endpoint (CMetricsServer)
+    constexpr int METRICS_FRAME_BUCKETS{8};
+    constexpr int METRICS_FRAME_BOUNDS_US[METRICS_FRAME_BUCKETS]{2000, 4000, 8000, 12000, 16667, 25000, 33333, 50000};   // frame work time histogram bounds
+    constexpr int METRICS_RESPONSE_SIZE{16384};     // scrape responses are formatted into a fixed buffer of this size, nothing is allocated per scrape
+    constexpr int METRICS_CLIENT_TIMEOUT_MS{1000};  // scrapers that do not send their request or read the response in time are dropped
+    constexpr int METRICS_POLL_MS{100};             // how often the server thread checks for shutdown while no scraper connects
 
 } 
@@ -1,14 +1,250 @@
 /* File:            main.cpp
  * Author:          Vish Potnis
  * Description:     - Instantiate an asteroid game object and run the main game loop
+ *                  - Optional command line flags:
+ *                      --trace <file>      record a timeline trace, written on exit or with F12
+ *                      --metrics <file>    stream per frame metrics, CSV if the file ends in .csv otherwise NDJSON
+ *                      --server [port]     run a headless multiplayer server on the loopback interface, stopped with Ctrl+C
+ *                      --level <n>         level the game or the server starts at
+ *                      --connect [port]    join a multiplayer server on the loopback interface
+ *                      --autopilot         let a bot play the game, menus are skipped
+ *                      --soak <minutes>    play with the bot while tracking resource growth, exits with 1 if a leak is detected
+ *                      --soak-idle-check   with --soak, idle after frames over the save state caps and exit with 1 if objects jump
+ *                      --alloc-report      attribute allocations to frame phases and callsites, report printed on exit
+ *                      --alloc-budget      like --alloc-report and exit with 1 if a frame phase exceeds its allocation budget
+ *                      --alloc-sdl         count SDL's own allocations as well
+ *                      --latency           print input to present latency per input type on exit
+ *                      --late-input        poll input as late as possible before the next present
+ *                      --soft-compositor   compose level frames on the CPU with SIMD blending across threads
+ *                      --compositor-check  like --soft-compositor and compare frames with the SDL renderer, exits with 1 if they differ
+ *                      --capture <file>    record level frames, Y4M if the file ends in .y4m otherwise raw RGBA
+ *                      --governor          lower render resolution, effects and frame rate when frames exceed the frame budget
+ *                      --config <file>     load settings from key = value lines, applied in order with --set
+ *                      --set <key=value>   change one setting, e.g. --set fps=144 or --set renderer=software
+ *                      --print-config      print the effective settings, also printed when --config or --set is used
+ *                      --profile <file>    sample the game thread and write folded stacks per frame phase on exit
+ *                      --perf-counters     count cycles, instructions, cache and branch misses per frame phase, report printed on exit
+ *                      --coop              two local players on a split screen
+ *                      --metrics-http <port|path>  serve live metrics for Prometheus on 127.0.0.1:<port> or a Unix socket path
  */
 
 #include "AsteroidGame.h"
+#include "NetServer.h"
+#include "CTracer.h"
+#include "CMetrics.h"
+#include "CAllocTracker.h"
+#include "CProfiler.h"
+#include "CPerfCounters.h"
+#include "CConfig.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    NetServer* g_server = nullptr;
+
+    void stopServer(int)
+    {
+        if(g_server) g_server->stop();
+    }
+
+    // optional port argument following a flag
+    std::uint16_t readPort(int argc, char *argv[], int& i)
+    {
+        if(i + 1 < argc && argv[i + 1][0] != '-'){
+            return static_cast<std::uint16_t>(std::atoi(argv[++i]));
+        }
+        return AsteroidConstants::NET_DEFAULT_PORT;
+    }
+}
 
 int main(int argc, char *argv[])
 {
-    AsteroidGame game;
-    game.run();
+    bool server = false;
+    bool connect = false;
+    std::uint16_t port = AsteroidConstants::NET_DEFAULT_PORT;
+    int startLevel = 1;
+    bool autopilot = false;
+    int soakMinutes = 0;
+    bool soakIdleCheck = false;
+    bool latencyReport = false;
+    bool lateInput = false;
+    bool softCompositor = false;
+    bool compositorCheck = false;
+    const char* capturePath = nullptr;
+    const char* metricsPath = nullptr;
+    const char* metricsAddress = nullptr;
+    const char* profilePath = nullptr;
+    bool perfCounters = false;
+    bool governor = false;
+    bool coop = false;
+    bool printConfig = false;
+    bool configValid = true;
+
+    for(int i = 1; i < argc; i++){
+        if(std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc){
+            CTracer::enable(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc){
+            metricsPath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--server") == 0){
+            server = true;
+            port = readPort(argc, argv, i);
+        }
+        else if(std::strcmp(argv[i], "--level") == 0 && i + 1 < argc){
+            startLevel = std::atoi(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--connect") == 0){
+            connect = true;
+            port = readPort(argc, argv, i);
+        }
+        else if(std::strcmp(argv[i], "--autopilot") == 0){
+            autopilot = true;
+        }
+        else if(std::strcmp(argv[i], "--soak") == 0 && i + 1 < argc){
+            soakMinutes = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if(std::strcmp(argv[i], "--soak-idle-check") == 0){
+            soakIdleCheck = true;
+        }
+        else if(std::strcmp(argv[i], "--alloc-report") == 0){
+            CAllocTracker::enable();
+        }
+        else if(std::strcmp(argv[i], "--alloc-budget") == 0){
+            CAllocTracker::enableBudgets();
+        }
+        else if(std::strcmp(argv[i], "--alloc-sdl") == 0){
+            CAllocTracker::hookSdl();
+        }
+        else if(std::strcmp(argv[i], "--latency") == 0){
+            latencyReport = true;
+        }
+        else if(std::strcmp(argv[i], "--late-input") == 0){
+            lateInput = true;
+        }
+        else if(std::strcmp(argv[i], "--soft-compositor") == 0){
+            softCompositor = true;
+        }
+        else if(std::strcmp(argv[i], "--compositor-check") == 0){
+            softCompositor = true;
+            compositorCheck = true;
+        }
+        else if(std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc){
+            capturePath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--governor") == 0){
+            governor = true;
+        }
+        else if(std::strcmp(argv[i], "--config") == 0 && i + 1 < argc){
+            configValid &= CConfig::loadFile(argv[++i]);
+            printConfig = true;
+        }
+        else if(std::strcmp(argv[i], "--set") == 0 && i + 1 < argc){
+            configValid &= CConfig::set(argv[++i]);
+            printConfig = true;
+        }
+        else if(std::strcmp(argv[i], "--print-config") == 0){
+            printConfig = true;
+        }
+        else if(std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc){
+            profilePath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--perf-counters") == 0){
+            perfCounters = true;
+        }
+        else if(std::strcmp(argv[i], "--coop") == 0){
+            coop = true;
+        }
+        else if(std::strcmp(argv[i], "--metrics-http") == 0 && i + 1 < argc){
+            metricsAddress = argv[++i];
+        }
+    }
+
+    // settings are complete before anything sized by them is created
+    if(!configValid){
+        std::cout << "Invalid config, the game is not started\n";
+        return 1;
+    }
+    if(printConfig){
+        CConfig::print();
+    }
+    if(metricsPath != nullptr){
+        CMetrics::enableSink(metricsPath);
+    }
+    // frame phases are only timed while the endpoint is serving
+    if(metricsAddress != nullptr && CMetrics::enableServer(metricsAddress)){
+        CPerfPhases::enableTiming();
+    }
+    if(profilePath != nullptr){
+        CProfiler::enable(profilePath, CConfig::get().profileHz);
+    }
+    if(perfCounters){
+        CPerfPhases::enable();
+    }
+
+    bool failed = false;
+
+    // the server is headless, no window or assets are loaded
+    if(server){
+        NetServer netServer(port, startLevel);
+        if(netServer.isOpen()){
+            g_server = &netServer;
+            std::signal(SIGINT, stopServer);
+            netServer.run();
+            g_server = nullptr;
+        }
+    }
+    else{
+        // the compositor blends from CPU copies of the textures, they are kept while the textures load
+        CTexture::keepPixelCopies(softCompositor);
+
+        AsteroidGame game;
+        if(connect){
+            game.runNetworkGame(port);
+        }
+        else{
+            game.setStartLevel(startLevel);
+            if(soakMinutes > 0){
+                game.enableSoak(static_cast<Uint32>(soakMinutes) * 60 * 1000);
+                if(soakIdleCheck) game.enableSoakIdleCheck();
+            }
+            else if(autopilot){
+                game.enableAutopilot();
+            }
+            if(lateInput){
+                game.enableLateInput();
+            }
+            // the views are split before the compositor and the governor check what they can do with them
+            if(coop){
+                game.enableCoop();
+            }
+            if(softCompositor){
+                game.enableSoftCompositor(compositorCheck);
+            }
+            if(capturePath != nullptr){
+                game.enableCapture(capturePath);
+            }
+            if(governor){
+                game.enableGovernor();
+            }
+            game.run();
+            failed = game.hasSoakFailed() || game.hasCompositorFailed();
+            game.printCompositorReport();
+            if(latencyReport){
+                game.printLatencyReport();
+            }
+        }
+    }
+
+    CTracer::flush();
+    CMetrics::shutdown();
+    CAllocTracker::printReport();
+    CPerfPhases::printReport();
+    CProfiler::flush();
     
-    return 0;
-}
\ No newline at end of file
+    return (failed || CAllocTracker::hasFailed()) ? 1 : 0;
+}
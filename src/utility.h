@@ -56,7 +56,8 @@ enum class GameState
     LEVEL_COMPLETE,
     GAMEOVER,
     RUNNING,
-    PLAY_AGAIN
+    PLAY_AGAIN,
+    PAUSED
 };
 
 // used in the factory method for generating game objects
@@ -65,8 +66,7 @@ enum class ObjectType
     STATIC,
     ASTEROID,
     SHIP,
-    LASER,
-    EXPLOSION
+    LASER
 };
 
 // asteroid attribute